@@ -10,8 +10,13 @@ glabel gMapStrings
 .incbin "bin/name.bin"
 glabel gMapStringsEnd
 
+.balign 16
+glabel gMapIndex
+.incbin "bin/index.bin"
+glabel gMapIndexEnd
+
 .balign 16
 glabel gMapEntrySize
-.word (gMapEntryEnd - gMapEntries) / 4
+.word (gMapEntryEnd - gMapEntries) / 8
 glabel gMapStringSize
 .word (gMapStringsEnd - gMapStrings)
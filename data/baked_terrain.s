@@ -0,0 +1,6 @@
+.include "macros.inc"
+
+.section .data
+
+// Static surfaces of every area, baked by tools/bake_terrain.py and read by src/engine/surface_load.c
+.incbin "data/baked_terrain.bin"
@@ -3821,7 +3821,7 @@ const BehaviorScript bhvCirclingAmp[] = {
 
 const BehaviorScript bhvButterfly[] = {
     BEGIN(OBJ_LIST_DEFAULT),
-    OR_INT(oFlags, (OBJ_FLAG_SET_FACE_YAW_TO_MOVE_YAW | OBJ_FLAG_UPDATE_GFX_POS_AND_ANGLE)),
+    OR_LONG(oFlags, (OBJ_FLAG_SET_FACE_YAW_TO_MOVE_YAW | OBJ_FLAG_UPDATE_GFX_POS_AND_ANGLE | OBJ_FLAG_REDUCED_UPDATE_RATE)),
     LOAD_ANIMATIONS(oAnimations, butterfly_seg3_anims_030056B0),
     DROP_TO_FLOOR(),
     SET_FLOAT(oGraphYOffset, 5),
@@ -6142,3 +6142,8 @@ const BehaviorScript bhvFirePlatform[] = {
         CALL_NATIVE(bhvMovingPlatform_loop),
     END_LOOP(),
 };
+
+#ifdef NATIVE_BEHAVIOR_LOOPS
+// Generated by tools/bhv_compile.py from the scripts above.
+#include "data/behavior_native.inc.c"
+#endif
@@ -5,3 +5,7 @@
 glabel _capcomRomStart
 .incbin "data/capcom.hvqm"
 glabel _capcomRomEnd
+
+// Record index built by tools/hvqm_index.py, read by src/hvqm/getrecord.c
+.balign 8
+.incbin "data/capcom.idx"
@@ -34,3 +34,19 @@
  */
 #define COLLISION_DATA_TYPE s16
 #define ROOM_DATA_TYPE s8
+
+/**
+ * The spatial partition of each level is fitted to the bounds of its collision when the level is loaded,
+ * using the smallest power of two cell size from this up to CELL_SIZE that needs at most NUM_CELLS * NUM_CELLS cells.
+ * Smaller cells mean fewer surfaces to check per collision query, at the cost of more surface nodes.
+ */
+#define PARTITION_MIN_CELL_SIZE 0x200
+
+/**
+ * Bakes the static surfaces and partition of every area at build time (tools/bake_terrain.py),
+ * so loading an area only has to DMA them in instead of processing the collision data.
+ * Areas whose collision data is not found in the baked table are still loaded the normal way, which is counted
+ * on the PUPPYPRINT_DEBUG collision page. Costs about 3.5 MB of ROM with the vanilla levels (3,557,568 bytes),
+ * since the surfaces are stored already processed.
+ */
+#define BAKED_TERRAIN
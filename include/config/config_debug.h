@@ -24,6 +24,20 @@
  */
 //#define USE_PROFILER
 
+/**
+ * Enables a statistical sampling profiler, which records the code the CPU was running 1000 times a second (see profiling.h).
+ * Adds a top functions page to PUPPYPRINT_DEBUG, and streams the raw samples over USB when UNF is enabled.
+ * Requires USE_PROFILER.
+ */
+// #define PROFILER_SAMPLING
+
+/**
+ * Streams a compact binary record of every frame's performance counters, for capturing long soak runs.
+ * Sent over USB with UNF, or printed to the IS-Viewer log with ISVPRINT, so emulators can capture it too.
+ * Decode the captures with tools/telemetry.py.
+ */
+// #define TELEMETRY
+
 /**
  * -- TEST LEVEL --
  * Uncomment this define and set a test level in order to boot straight into said level.
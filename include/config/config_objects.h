@@ -4,6 +4,28 @@
  * SPECIFIC OBJECT SETTINGS *
  ****************************/
 
+/*****************
+ * -- GENERAL --
+ *****************/
+
+/**
+ * Runs the straight-line BEGIN_LOOP/END_LOOP bodies of behavior scripts as native C functions generated
+ * at build time by tools/bhv_compile.py, instead of interpreting them every frame.
+ * Loops that can't be translated still go through the behavior script interpreter.
+ */
+#define NATIVE_BEHAVIOR_LOOPS
+
+/**
+ * Objects with OBJ_FLAG_REDUCED_UPDATE_RATE (set with OR_LONG in their behavior script) only run their behavior
+ * every 2nd frame when further than UPDATE_RATE_HALF_DIST from both Mario and the camera, and every 4th frame
+ * when further than UPDATE_RATE_QUARTER_DIST. Their behavior, physics and oTimer run at that reduced rate, and on skipped
+ * frames only their rendered position and angle are interpolated along the movement and rotation of their last update.
+ * Only opt in behaviors that still look right at a lower rate, like ambient decorations.
+ */
+#define DISTANCE_BASED_UPDATE_RATES
+#define UPDATE_RATE_HALF_DIST    4000.0f
+#define UPDATE_RATE_QUARTER_DIST 8000.0f
+
 /**************
  * -- COIN --
  **************/
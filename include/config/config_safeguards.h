@@ -56,6 +56,8 @@
 #ifdef DISABLE_ALL
     #undef DEBUG_ALL
     #undef USE_PROFILER
+    #undef PROFILER_SAMPLING
+    #undef TELEMETRY
     #undef TEST_LEVEL
     #undef DEBUG_LEVEL_SELECT
     #undef ENABLE_DEBUG_FREE_MOVE
@@ -106,6 +108,14 @@
     #define USE_PROFILER
 #endif // PUPPYPRINT_DEBUG
 
+#ifndef USE_PROFILER
+    #undef PROFILER_SAMPLING
+#endif // !USE_PROFILER
+
+#if !defined(UNF) && !defined(ISVPRINT)
+    #undef TELEMETRY // There is no way to send the records anywhere.
+#endif
+
 #ifdef COMPLETE_SAVE_FILE
     #undef UNLOCK_ALL
     #define UNLOCK_ALL
@@ -68,11 +68,7 @@
 STATIC_ASSERT(((EXTENDED_BOUNDS_MODE >= 0) && (EXTENDED_BOUNDS_MODE <= 3)), "You must set a valid extended bounds mode!");
 
 /**
- * The amount of cells in each axis in an area.
+ * The amount of cells in each axis in an area at CELL_SIZE.
+ * The spatial partition of a level never uses more than NUM_CELLS * NUM_CELLS cells (see PARTITION_MIN_CELL_SIZE).
  */
 #define NUM_CELLS                   (2 * LEVEL_BOUNDARY_MAX / CELL_SIZE)
-
-/**
- * Use this to convert game units to cell coordinates.
- */
-#define GET_CELL_COORD(p)   ((((s32)(p) + LEVEL_BOUNDARY_MAX) / CELL_SIZE) & (NUM_CELLS - 1))
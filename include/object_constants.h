@@ -55,6 +55,7 @@ enum ObjFlags {
     OBJ_FLAG_EMIT_LIGHT                        = (1 << 22), // 0x00400000
     OBJ_FLAG_ONLY_PROCESS_INSIDE_ROOM          = (1 << 23), // 0x00800000
     OBJ_FLAG_THROW_ROTATION                    = (1 << 24),
+    OBJ_FLAG_REDUCED_UPDATE_RATE               = (1 << 25), // 0x02000000
     OBJ_FLAG_HITBOX_WAS_SET                    = (1 << 30), // 0x40000000
 };
 
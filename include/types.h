@@ -240,6 +240,18 @@ struct AnimInfo {
                   f32 animAccelF;
 };
 
+/**
+ * What a shadow is cast on, found during the game update so the render path
+ * doesn't have to query collision. See update_shadow_floor.
+ */
+struct ShadowFloor {
+    struct Surface *floor;      // NULL if there is no floor under the object
+    struct Surface *waterFloor; // NULL for water boxes
+    f32 floorHeight;
+    f32 waterLevel;
+    u8 found;                   // Whether the floor was found under the object rather than referenced by it
+};
+
 struct GraphNodeObject {
     /*0x00*/ struct GraphNode node;
     /*0x14*/ struct GraphNode *sharedChild;
@@ -255,6 +267,13 @@ struct GraphNodeObject {
              Vec3f scaleLerp;
              Quat rotLerp;
              Quat throwRotation;
+             Mtx lerpMtx[2]; // The object's fixed point matrix for each gfx pool, only rewritten when lerpMtxGen changes
+             u32 lerpMtxGen; // Bumped when the interpolated transform changes
+             u32 lerpMtxBufGen[2];
+             struct ShadowFloor shadowFloor;
+             struct ShadowFloor shadowFloorCache;
+             struct ShadowFloor shadowFloorVideoCache;
+             u8 hasShadow;
     /*0x38*/ struct AnimInfo animInfo;
     /*0x4C*/ struct SpawnInfo *spawnInfo;
     /*0x54*/ Vec3f cameraToObject;
@@ -310,7 +329,7 @@ struct Object {
         const void *asConstVoidPtr[MAX_OBJECT_FIELDS];
     } ptrData;
 #endif
-    /*0x1C8*/ u32 unused1;
+    /*0x1C8*/ const struct BhvNativeLoop *nativeLoop;
     /*0x1CC*/ const BehaviorScript *curBhvCommand;
     /*0x1D0*/ u32 bhvStackIndex;
     /*0x1D4*/ uintptr_t bhvStack[8];
@@ -327,6 +346,10 @@ struct Object {
     /*0x218*/ void *collisionData;
     /*0x21C*/ Mat4 transform;
     /*0x25C*/ void *respawnInfo;
+#ifdef DISTANCE_BASED_UPDATE_RATES
+    /*0x260*/ Vec3f reducedUpdatePosStep;
+    /*0x26C*/ Vec3s reducedUpdateAngleStep;
+#endif
 };
 
 struct ObjectHitbox {
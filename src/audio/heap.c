@@ -300,28 +300,47 @@ void sound_init_main_pools(s32 sizeForAudioInitPool) {
     sound_alloc_pool_init(&gAudioSessionPool, (gAudioHeap + sizeForAudioInitPool), (gAudioHeapSize - sizeForAudioInitPool));
 }
 
+#if defined(PUPPYPRINT_DEBUG) || defined(TELEMETRY)
+static const struct SoundAllocPool *const sDebugAudioPools[] = {
+    &gAudioInitPool,
+    &gNotesAndBuffersPool,
+    &gSeqLoadedPool.persistent.pool,
+    &gBankLoadedPool.persistent.pool,
+    &gSeqLoadedPool.temporary.pool,
+    &gBankLoadedPool.temporary.pool,
+#ifdef BETTER_REVERB
+    &gBetterReverbPool,
+#endif
+};
+#endif
+
 #ifdef PUPPYPRINT_DEBUG
 void puppyprint_get_allocated_pools(s32 *audioPoolList) {
     u32 i, j;
-    const struct SoundAllocPool *pools[NUM_AUDIO_POOLS] = {
-        &gAudioInitPool,
-        &gNotesAndBuffersPool,
-        &gSeqLoadedPool.persistent.pool,
-        &gBankLoadedPool.persistent.pool,
-        &gSeqLoadedPool.temporary.pool,
-        &gBankLoadedPool.temporary.pool,
-#ifdef BETTER_REVERB
-        &gBetterReverbPool,
-#endif
-    };
 
     for (i = 0, j = 0; j < NUM_AUDIO_POOLS; i += 2, j++) {
-        audioPoolList[i    ] = (s32) pools[j]->size;
-        audioPoolList[i + 1] = (s32) (pools[j]->cur - pools[j]->start);
+        audioPoolList[i    ] = (s32) sDebugAudioPools[j]->size;
+        audioPoolList[i + 1] = (s32) (sDebugAudioPools[j]->cur - sDebugAudioPools[j]->start);
     }
 }
 #endif
 
+#ifdef TELEMETRY
+/**
+ * Returns the amount of bytes allocated from the pools puppyprint shows.
+ */
+u32 audio_heap_get_used(void) {
+    u32 used = 0;
+    s32 i;
+
+    for (i = 0; i < ARRAY_COUNT(sDebugAudioPools); i++) {
+        used += sDebugAudioPools[i]->cur - sDebugAudioPools[i]->start;
+    }
+
+    return used;
+}
+#endif
+
 #ifdef VERSION_SH
 #define SOUND_ALLOC_FUNC sound_alloc_uninitialized
 #else
@@ -403,6 +403,8 @@ void thread3_main(UNUSED void *arg) {
 
     create_thread(&gGraphicsThread, THREAD_10_GRAPHICS, thread10_graphics_loop, NULL, gThread10Stack + THREAD10_STACK, 1);
 
+    profiler_sampler_init();
+
     while (TRUE) {
         OSMesg msg;
         osRecvMesg(&gIntrMesgQueue, &msg, OS_MESG_BLOCK);
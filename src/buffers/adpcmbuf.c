@@ -15,9 +15,10 @@
 #include <hvqm/hvqm.h>
 
 /*
- * Buffer for audio records (ADPCM data) read from the HVQM2 data.
+ * Read-ahead ring buffer for audio records (ADPCM data) read from 
+ * the HVQM2 data.
  * (Note) Please locate at a 16byte aligned address with the spec file. 
  */
-ALIGNED16 u8 adpcmbuf[AUDIO_RECORD_SIZE_MAX];
+ALIGNED16 u8 adpcmbuf[AUDIO_READAHEAD_SIZE];
 
 /* end */
@@ -15,10 +15,11 @@
 #include <hvqm/hvqm.h>
 
 /*
- *  Buffer for video records (HVQM2 compressed data) read from 
- * the HVQM2 data.
+ *  Read-ahead ring buffer for video records (HVQM2 compressed data) 
+ * read from the HVQM2 data. Holds several records at once, so 
+ * upcoming records are read while the current one is decoded.
  * (Note) Please locate at a 16byte aligned address with the spec file.
  */
-ALIGNED16 u8 hvqbuf[HVQ_DATASIZE_MAX];
+ALIGNED16 u8 hvqbuf[HVQ_READAHEAD_SIZE];
 
 /* end */
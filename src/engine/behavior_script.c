@@ -290,10 +290,29 @@ static s32 bhv_cmd_end_repeat_continue(void) {
     return BHV_PROC_CONTINUE;
 }
 
+#ifdef NATIVE_BEHAVIOR_LOOPS
+// Find the native translation of the loop starting at loopStart, if tools/bhv_compile.py generated one.
+static const struct BhvNativeLoop *find_native_loop(const BehaviorScript *loopStart) {
+    s32 i;
+
+    for (i = 0; i < gBhvNativeLoopCount; i++) {
+        if (gBhvNativeLoops[i].loopStart == loopStart) {
+            return &gBhvNativeLoops[i];
+        }
+    }
+
+    return NULL;
+}
+#endif
+
 // Command 0x08: Marks the beginning of an infinite loop.
 // Usage: BEGIN_LOOP()
 static s32 bhv_cmd_begin_loop(void) {
     cur_obj_bhv_stack_push(BHV_CMD_GET_ADDR_OF_CMD(1)); // Store address of the first command of the loop in the stack
+#ifdef NATIVE_BEHAVIOR_LOOPS
+    // Looked up once here, later frames that start at the top of the loop run it natively.
+    gCurrentObject->nativeLoop = find_native_loop(&gCurBhvCommand[1]);
+#endif
 
     gCurBhvCommand++;
     return BHV_PROC_CONTINUE;
@@ -854,6 +873,12 @@ void cur_obj_update(void) {
     // Execute the behavior script.
     gCurBhvCommand = o->curBhvCommand;
 
+#ifdef NATIVE_BEHAVIOR_LOOPS
+    if (o->nativeLoop != NULL && gCurBhvCommand == o->nativeLoop->loopStart) {
+        // Same effect as interpreting the loop body and END_LOOP, which returns to the top of the loop.
+        o->nativeLoop->func();
+    } else
+#endif
     do {
         bhvCmdProc = BehaviorCmdTable[*gCurBhvCommand >> 24];
         bhvProcResult = bhvCmdProc();
@@ -3,6 +3,8 @@
 
 #include <PR/ultratypes.h>
 
+#include "types.h"
+
 enum BhvProc {
     BHV_PROC_CONTINUE,
     BHV_PROC_BREAK
@@ -21,6 +23,18 @@ enum BhvProc {
 
 #define obj_and_int(object, offset, value) object->OBJECT_FIELD_S32(offset) &= (s32)(value)
 
+// A behavior script loop body translated to C by tools/bhv_compile.py.
+struct BhvNativeLoop {
+    const BehaviorScript *loopStart; // First command after the BEGIN_LOOP.
+    void (*func)(void);
+};
+
+#ifdef NATIVE_BEHAVIOR_LOOPS
+extern const struct BhvNativeLoop gBhvNativeLoops[];
+extern const s32 gBhvNativeLoopCount;
+#endif
+
+void obj_update_gfx_pos_and_angle(struct Object *obj);
 void cur_obj_update(void);
 
 #endif // BEHAVIOR_SCRIPT_H
@@ -294,6 +294,15 @@ struct GraphNodeScale *init_graph_node_scale(struct AllocOnlyPool *pool,
     return graphNode;
 }
 
+/**
+ * Makes an object node rewrite both of its fixed point matrices the next time it's drawn.
+ */
+static void invalidate_object_mtx(struct GraphNodeObject *graphNode) {
+    graphNode->lerpMtxGen++;
+    graphNode->lerpMtxBufGen[0] = graphNode->lerpMtxGen - 1;
+    graphNode->lerpMtxBufGen[1] = graphNode->lerpMtxGen - 1;
+}
+
 /**
  * Allocates and returns a newly created object node
  */
@@ -316,8 +325,14 @@ struct GraphNodeObject *init_graph_node_object(struct AllocOnlyPool *pool,
         vec3f_copy(graphNode->scaleLerp, scale);
         quat_identity(graphNode->throwRotation);
         quat_from_zxy_euler(graphNode->rotLerp, angle);
+        invalidate_object_mtx(graphNode);
         graphNode->sharedChild = sharedChild;
 
+        bzero(&graphNode->shadowFloor, sizeof(graphNode->shadowFloor));
+        bzero(&graphNode->shadowFloorCache, sizeof(graphNode->shadowFloorCache));
+        bzero(&graphNode->shadowFloorVideoCache, sizeof(graphNode->shadowFloorVideoCache));
+        graphNode->hasShadow = FALSE;
+
         graphNode->animInfo.animID = 0;
         graphNode->animInfo.curAnim = NULL;
         graphNode->animInfo.animFrame = 0;
@@ -720,6 +735,7 @@ void geo_obj_init(struct GraphNodeObject *graphNode, void *sharedChild, Vec3f po
     vec3f_copy(graphNode->posLerp, pos);
     vec3f_copy(graphNode->posCache, pos);
     vec3f_copy(graphNode->posVideoCache, pos);
+    invalidate_object_mtx(graphNode);
 
     graphNode->sharedChild = sharedChild;
     graphNode->spawnInfo = 0;
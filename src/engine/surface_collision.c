@@ -277,6 +277,66 @@ static s32 collide_sphere_with_triangle(
     return TRUE;
 }
 
+/**
+ * Whether a wall can be collided with by the current object, regardless of its position.
+ */
+static s32 is_collidable_wall(struct Surface *surf) {
+    TerrainData type = surf->type;
+
+    // Only treat reasonably vertical surfaces as walls
+    if (absf(surf->normal.y) > 0.8f) return FALSE;
+
+    if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+        if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) return FALSE;
+    } else {
+        if (type == SURFACE_CAMERA_BOUNDARY) return FALSE;
+
+        if (type == SURFACE_VANISH_CAP_WALLS && o != NULL) {
+            if (o->activeFlags & ACTIVE_FLAG_MOVE_THROUGH_GRATE) return FALSE;
+            if (o == gMarioObject && gMarioState->flags & MARIO_VANISH_CAP) return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Pushes a sphere out of a wall in XZ. Returns TRUE if they collided.
+ */
+static s32 push_out_of_wall(struct Surface *surf, Vec3f pos, f32 radius) {
+    f32 offset = (surf->normal.x * pos[0])
+               + (surf->normal.y * pos[1])
+               + (surf->normal.z * pos[2])
+               + surf->originOffset;
+
+    if (offset < -radius || offset > radius) return FALSE;
+
+    Vec3f push = { 0.0f, 0.0f, 0.0f };
+    if (!collide_sphere_with_triangle(pos, radius, surf, push)) {
+        return FALSE;
+    }
+
+    // For Mario, ensure horizontal push opposes his motion
+    if (o == gMarioObject && gMarioState != NULL) {
+        f32 velX = gMarioState->vel[0];
+        f32 velZ = gMarioState->vel[2];
+        f32 pushX = push[0];
+        f32 pushZ = push[2];
+
+        f32 dot = velX * pushX + velZ * pushZ;
+        if (dot > 0.0f) {
+            push[0] = -push[0];
+            push[2] = -push[2];
+        }
+    }
+
+    // Apply push only in XZ for walls
+    pos[0] += push[0];
+    pos[2] += push[2];
+
+    return TRUE;
+}
+
 /**
  * Iterate through the list of walls and apply robust sphere collision.
  * Raycast helpers are available but movement integration is left to callers,
@@ -285,7 +345,6 @@ static s32 collide_sphere_with_triangle(
 static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struct WallCollisionData *data) {
     const f32 radius = data->radius;
     struct Surface *surf;
-    TerrainData type = SURFACE_DEFAULT;
     s32 numCols = 0;
 
     Vec3f pos = { data->x, data->y + data->offsetY, data->z };
@@ -293,53 +352,13 @@ static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struc
     while (surfaceNode != NULL) {
         surf        = surfaceNode->surface;
         surfaceNode = surfaceNode->next;
-        type        = surf->type;
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_surfaces);
 
         if (pos[1] < surf->lowerY || pos[1] > surf->upperY) continue;
 
-        // Only treat reasonably vertical surfaces as walls
-        if (absf(surf->normal.y) > 0.8f) continue;
-
-        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
-            if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) continue;
-        } else {
-            if (type == SURFACE_CAMERA_BOUNDARY) continue;
-
-            if (type == SURFACE_VANISH_CAP_WALLS && o != NULL) {
-                if (o->activeFlags & ACTIVE_FLAG_MOVE_THROUGH_GRATE) continue;
-                if (o == gMarioObject && gMarioState->flags & MARIO_VANISH_CAP) continue;
-            }
-        }
+        if (!is_collidable_wall(surf)) continue;
 
-        f32 offset = (surf->normal.x * pos[0])
-                   + (surf->normal.y * pos[1])
-                   + (surf->normal.z * pos[2])
-                   + surf->originOffset;
-
-        if (offset < -radius || offset > radius) continue;
-
-        Vec3f push = { 0.0f, 0.0f, 0.0f };
-        if (!collide_sphere_with_triangle(pos, radius, surf, push)) {
-            continue;
-        }
-
-        // For Mario, ensure horizontal push opposes his motion
-        if (o == gMarioObject && gMarioState != NULL) {
-            f32 velX = gMarioState->vel[0];
-            f32 velZ = gMarioState->vel[2];
-            f32 pushX = push[0];
-            f32 pushZ = push[2];
-
-            f32 dot = velX * pushX + velZ * pushZ;
-            if (dot > 0.0f) {
-                push[0] = -push[0];
-                push[2] = -push[2];
-            }
-        }
-
-        // Apply push only in XZ for walls
-        pos[0] += push[0];
-        pos[2] += push[2];
+        if (!push_out_of_wall(surf, pos, radius)) continue;
 
         if (data->numWalls < MAX_REFERENCED_WALLS) {
             data->walls[data->numWalls++] = surf;
@@ -398,19 +417,19 @@ s32 find_wall_collisions(struct WallCollisionData *colData) {
         return numCollisions;
     }
 
-    s32 minCellX = GET_CELL_COORD(x - colData->radius);
-    s32 minCellZ = GET_CELL_COORD(z - colData->radius);
-    s32 maxCellX = GET_CELL_COORD(x + colData->radius);
-    s32 maxCellZ = GET_CELL_COORD(z + colData->radius);
+    s32 minCellX = GET_CELL_X(x - colData->radius);
+    s32 minCellZ = GET_CELL_Z(z - colData->radius);
+    s32 maxCellX = GET_CELL_X(x + colData->radius);
+    s32 maxCellZ = GET_CELL_Z(z + colData->radius);
 
     for (s32 cellX = minCellX; cellX <= maxCellX; cellX++) {
         for (s32 cellZ = minCellZ; cellZ <= maxCellZ; cellZ++) {
             if (!(gCollisionFlags & COLLISION_FLAG_EXCLUDE_DYNAMIC)) {
-                node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS];
+                node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WALLS];
                 numCollisions += find_wall_collisions_from_list(node, colData);
             }
 
-            node = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS];
+            node = gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WALLS];
             numCollisions += find_wall_collisions_from_list(node, colData);
         }
     }
@@ -497,6 +516,7 @@ static struct Surface *find_ceil_from_list(struct SurfaceNode *surfaceNode, s32
     while (nodeIter != NULL) {
         surf = nodeIter->surface;
         nodeIter = nodeIter->next;
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_surfaces);
         type = surf->type;
 
         if (y > surf->upperY) continue;
@@ -552,25 +572,11 @@ static struct Surface *find_ceil_from_list(struct SurfaceNode *surfaceNode, s32
 }
 
 /**
- * Find the lowest ceiling above a given position and return the height.
+ * Find the lowest static or dynamic ceiling above a point within a cell.
  */
-f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
+static f32 find_ceil_in_cell(s32 cellX, s32 cellZ, s32 x, s32 y, s32 z, struct Surface **pceil) {
     f32 height        = CELL_HEIGHT_LIMIT;
     f32 dynamicHeight = CELL_HEIGHT_LIMIT;
-    PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_ceil);
-    PUPPYPRINT_GET_SNAPSHOT();
-    s32 x = posX;
-    s32 y = posY;
-    s32 z = posZ;
-    *pceil = NULL;
-
-    if (is_outside_level_bounds(x, z)) {
-        profiler_collision_update(first);
-        return height;
-    }
-
-    s32 cellX = GET_CELL_COORD(x);
-    s32 cellZ = GET_CELL_COORD(z);
 
     struct SurfaceNode *surfaceList;
     struct Surface *ceil = NULL;
@@ -579,12 +585,12 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
     s32 includeDynamic = !(gCollisionFlags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
 
     if (includeDynamic) {
-        surfaceList = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS];
+        surfaceList = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_CEILS];
         dynamicCeil = find_ceil_from_list(surfaceList, x, y, z, &dynamicHeight);
         height = dynamicHeight;
     }
 
-    surfaceList = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS];
+    surfaceList = gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_CEILS];
     ceil = find_ceil_from_list(surfaceList, x, y, z, &height);
 
     if (includeDynamic && height >= dynamicHeight) {
@@ -592,9 +598,31 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
         height = dynamicHeight;
     }
 
+    *pceil = ceil;
+    return height;
+}
+
+/**
+ * Find the lowest ceiling above a given position and return the height.
+ */
+f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
+    f32 height        = CELL_HEIGHT_LIMIT;
+    PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_ceil);
+    PUPPYPRINT_GET_SNAPSHOT();
+    s32 x = posX;
+    s32 y = posY;
+    s32 z = posZ;
+    *pceil = NULL;
+
+    if (is_outside_level_bounds(x, z)) {
+        profiler_collision_update(first);
+        return height;
+    }
+
+    height = find_ceil_in_cell(GET_CELL_X(x), GET_CELL_Z(z), x, y, z, pceil);
+
     gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
 
-    *pceil = ceil;
 #ifdef VANILLA_DEBUG
     gNumCalls.ceil++;
 #endif
@@ -641,6 +669,7 @@ static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32
     while (surfaceNode != NULL) {
         surf = surfaceNode->surface;
         surfaceNode = surfaceNode->next;
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_surfaces);
         type        = surf->type;
 
         // Skip intangible floors unless explicitly requested
@@ -708,6 +737,7 @@ struct Surface *find_water_floor_from_list(struct SurfaceNode *surfaceNode, s32
     while (bottomSurfaceNode != NULL) {
         surf = bottomSurfaceNode->surface;
         bottomSurfaceNode = bottomSurfaceNode->next;
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_surfaces);
 
         if (surf->type != SURFACE_NEW_WATER_BOTTOM || absf(surf->normal.y) < NORMAL_FLOOR_THRESHOLD) continue;
 
@@ -725,6 +755,7 @@ struct Surface *find_water_floor_from_list(struct SurfaceNode *surfaceNode, s32
     while (topSurfaceNode != NULL) {
         surf = topSurfaceNode->surface;
         topSurfaceNode = topSurfaceNode->next;
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_surfaces);
 
         if (surf->type == SURFACE_NEW_WATER_BOTTOM || absf(surf->normal.y) < NORMAL_FLOOR_THRESHOLD) continue;
 
@@ -762,10 +793,10 @@ f32 unused_find_dynamic_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfl
     s32 y = yPos;
     s32 z = zPos;
 
-    s32 cellX = GET_CELL_COORD(x);
-    s32 cellZ = GET_CELL_COORD(z);
+    s32 cellX = GET_CELL_X(x);
+    s32 cellZ = GET_CELL_Z(z);
 
-    struct SurfaceNode *surfaceList = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS];
+    struct SurfaceNode *surfaceList = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_FLOORS];
 
     *pfloor = find_floor_from_list(surfaceList, x, y, z, &floorHeight);
 
@@ -773,29 +804,12 @@ f32 unused_find_dynamic_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfl
 }
 
 /**
- * Find the highest floor under a given position and return the height.
+ * Find the highest static or dynamic floor under a point within a cell.
  */
-f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
-    PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_floor);
-    PUPPYPRINT_GET_SNAPSHOT();
-
+static f32 find_floor_in_cell(s32 cellX, s32 cellZ, s32 x, s32 y, s32 z, struct Surface **pfloor) {
     f32 height        = FLOOR_LOWER_LIMIT;
     f32 dynamicHeight = FLOOR_LOWER_LIMIT;
 
-    s32 x = xPos;
-    s32 y = yPos;
-    s32 z = zPos;
-
-    *pfloor = NULL;
-
-    if (is_outside_level_bounds(x, z)) {
-        profiler_collision_update(first);
-        return height;
-    }
-
-    s32 cellX = GET_CELL_COORD(x);
-    s32 cellZ = GET_CELL_COORD(z);
-
     struct SurfaceNode *surfaceList;
     struct Surface *floor = NULL;
     struct Surface *dynamicFloor = NULL;
@@ -803,12 +817,12 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
     s32 includeDynamic = !(gCollisionFlags & COLLISION_FLAG_EXCLUDE_DYNAMIC);
 
     if (includeDynamic) {
-        surfaceList = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS];
+        surfaceList = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_FLOORS];
         dynamicFloor = find_floor_from_list(surfaceList, x, y, z, &dynamicHeight);
         height = dynamicHeight;
     }
 
-    surfaceList = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS];
+    surfaceList = gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_FLOORS];
     floor = find_floor_from_list(surfaceList, x, y, z, &height);
 
     if (includeDynamic && height <= dynamicHeight) {
@@ -816,12 +830,38 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
         height = dynamicHeight;
     }
 
-    gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
     if (floor == NULL) {
         gNumFindFloorMisses++;
     }
 
     *pfloor = floor;
+    return height;
+}
+
+/**
+ * Find the highest floor under a given position and return the height.
+ */
+f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
+    PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_floor);
+    PUPPYPRINT_GET_SNAPSHOT();
+
+    f32 height        = FLOOR_LOWER_LIMIT;
+
+    s32 x = xPos;
+    s32 y = yPos;
+    s32 z = zPos;
+
+    *pfloor = NULL;
+
+    if (is_outside_level_bounds(x, z)) {
+        profiler_collision_update(first);
+        return height;
+    }
+
+    height = find_floor_in_cell(GET_CELL_X(x), GET_CELL_Z(z), x, y, z, pfloor);
+
+    gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
+
 #ifdef VANILLA_DEBUG
     gNumCalls.floor++;
 #endif
@@ -865,10 +905,10 @@ f32 find_water_floor(s32 xPos, s32 yPos, s32 zPos, struct Surface **pfloor) {
 
     if (is_outside_level_bounds(x, z)) return height;
 
-    s32 cellX = GET_CELL_COORD(x);
-    s32 cellZ = GET_CELL_COORD(z);
+    s32 cellX = GET_CELL_X(x);
+    s32 cellZ = GET_CELL_Z(z);
 
-    struct SurfaceNode *surfaceList = gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER];
+    struct SurfaceNode *surfaceList = gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WATER];
     struct Surface     *floor       = find_water_floor_from_list(surfaceList, x, y, z, &height);
 
     if (floor == NULL) {
@@ -924,12 +964,39 @@ s32 find_water_level_and_floor(s32 x, s32 y, s32 z, struct Surface **pfloor) {
 }
 
 /**
- * Finds the height of water at a given location.
+ * Finds the height of the water box at a given location, if any.
  */
-s32 find_water_level(s32 x, s32 z) { // TODO: Allow y pos
+static s32 find_water_box_level(s32 x, s32 z) {
     s32 val;
     s32 loX, hiX, loZ, hiZ;
     TerrainData *p = gEnvironmentRegions;
+
+    if (p == NULL) {
+        return FLOOR_LOWER_LIMIT;
+    }
+
+    s32 numRegions = *p++;
+
+    for (s32 i = 0; i < numRegions; i++) {
+        val = *p++;
+        loX = *p++;
+        loZ = *p++;
+        hiX = *p++;
+        hiZ = *p++;
+
+        if ((loX < x) && (x < hiX) && (loZ < z) && (z < hiZ) && (val < 50)) {
+            return *p;
+        }
+        p++;
+    }
+
+    return FLOOR_LOWER_LIMIT;
+}
+
+/**
+ * Finds the height of water at a given location.
+ */
+s32 find_water_level(s32 x, s32 z) { // TODO: Allow y pos
     struct Surface *floor = NULL;
     PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_water);
     PUPPYPRINT_GET_SNAPSHOT();
@@ -940,22 +1007,8 @@ s32 find_water_level(s32 x, s32 z) { // TODO: Allow y pos
         &floor
     );
 
-    if ((p != NULL) && (waterLevel == FLOOR_LOWER_LIMIT)) {
-        s32 numRegions = *p++;
-
-        for (s32 i = 0; i < numRegions; i++) {
-            val = *p++;
-            loX = *p++;
-            loZ = *p++;
-            hiX = *p++;
-            hiZ = *p++;
-
-            if ((loX < x) && (x < hiX) && (loZ < z) && (z < hiZ) && (val < 50)) {
-                waterLevel = *p;
-                break;
-            }
-            p++;
-        }
+    if (waterLevel == FLOOR_LOWER_LIMIT) {
+        waterLevel = find_water_box_level(x, z);
     }
 
     profiler_collision_update(first);
@@ -990,3 +1043,237 @@ s32 find_poison_gas_level(s32 x, s32 z) {
 
     return FLOOR_LOWER_LIMIT;
 }
+
+/**************************************************
+ *                COLLISION PROBES                *
+ **************************************************/
+
+struct ProbeWallCandidate {
+    struct Surface *surf;
+    s16 cellX, cellZ;
+};
+
+static struct ProbeWallCandidate sProbeWallCandidates[PROBE_MAX_WALL_CANDIDATES];
+
+/**
+ * Queries of a probe one at a time, for when gCollisionFlags are set.
+ */
+static void find_collision_probe_unfused(Vec3f pos, struct CollisionProbe *probe) {
+    for (s32 i = 0; i < probe->numWallChecks; i++) {
+        resolve_and_return_wall_collisions(pos, probe->walls[i].offsetY, probe->walls[i].radius, &probe->walls[i]);
+    }
+
+    if (probe->flags & (PROBE_FIND_FLOOR | PROBE_FIND_CEIL)) {
+        probe->floorHeight = find_floor(pos[0], pos[1], pos[2], &probe->floor);
+    }
+    if (probe->flags & PROBE_FIND_CEIL) {
+        probe->ceilHeight = find_mario_ceil(pos, probe->floorHeight, &probe->ceil);
+    }
+    if (probe->flags & PROBE_FIND_WATER) {
+        probe->waterLevel = find_water_level(pos[0], pos[2]);
+    }
+}
+
+/**
+ * Collects the walls in a cell range that any of the probe's wall checks could collide with,
+ * in the order find_wall_collisions visits them. Returns FALSE if there are too many.
+ */
+static s32 collect_probe_walls(s32 minCellX, s32 minCellZ, s32 maxCellX, s32 maxCellZ, f32 minY, f32 maxY, s32 *numCandidates) {
+    struct ProbeWallCandidate *candidate = sProbeWallCandidates;
+    struct SurfaceNode *node;
+    struct Surface *surf;
+
+    for (s32 cellX = minCellX; cellX <= maxCellX; cellX++) {
+        for (s32 cellZ = minCellZ; cellZ <= maxCellZ; cellZ++) {
+            node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WALLS];
+
+            // Dynamic walls first, then static walls, like find_wall_collisions.
+            for (s32 list = 0; list < 2; list++) {
+                while (node != NULL) {
+                    surf = node->surface;
+                    node = node->next;
+                    PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_surfaces);
+
+                    if (maxY < surf->lowerY || minY > surf->upperY) continue;
+
+                    if (!is_collidable_wall(surf)) continue;
+
+                    if (candidate == &sProbeWallCandidates[PROBE_MAX_WALL_CANDIDATES]) {
+                        return FALSE;
+                    }
+
+                    candidate->surf  = surf;
+                    candidate->cellX = cellX;
+                    candidate->cellZ = cellZ;
+                    candidate++;
+                }
+
+                node = gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WALLS];
+            }
+        }
+    }
+
+    *numCandidates = (candidate - sProbeWallCandidates);
+    return TRUE;
+}
+
+/**
+ * Runs one wall check of a probe against the collected walls.
+ * Returns FALSE if the check needs walls outside of the collected cells.
+ */
+static s32 probe_wall_check(Vec3f pos, struct WallCollisionData *data, s32 numCandidates,
+                            s32 minCellX, s32 minCellZ, s32 maxCellX, s32 maxCellZ) {
+    const f32 radius = data->radius;
+    s32 x = pos[0];
+    s32 z = pos[2];
+
+    data->x = pos[0];
+    data->y = pos[1];
+    data->z = pos[2];
+    data->numWalls = 0;
+
+    if (is_outside_level_bounds(x, z)) {
+        return TRUE;
+    }
+
+    s32 checkMinCellX = GET_CELL_X(x - radius);
+    s32 checkMinCellZ = GET_CELL_Z(z - radius);
+    s32 checkMaxCellX = GET_CELL_X(x + radius);
+    s32 checkMaxCellZ = GET_CELL_Z(z + radius);
+
+    if (checkMinCellX < minCellX || checkMaxCellX > maxCellX || checkMinCellZ < minCellZ || checkMaxCellZ > maxCellZ) {
+        return FALSE;
+    }
+
+    Vec3f checkPos = { pos[0], pos[1] + data->offsetY, pos[2] };
+    struct ProbeWallCandidate *candidate = sProbeWallCandidates;
+
+    for (s32 i = 0; i < numCandidates; i++, candidate++) {
+        if (candidate->cellX < checkMinCellX || candidate->cellX > checkMaxCellX
+         || candidate->cellZ < checkMinCellZ || candidate->cellZ > checkMaxCellZ) continue;
+
+        if (checkPos[1] < candidate->surf->lowerY || checkPos[1] > candidate->surf->upperY) continue;
+
+        if (!push_out_of_wall(candidate->surf, checkPos, radius)) continue;
+
+        if (data->numWalls < MAX_REFERENCED_WALLS) {
+            data->walls[data->numWalls++] = candidate->surf;
+        }
+    }
+
+    pos[0] = data->x = checkPos[0];
+    pos[2] = data->z = checkPos[2];
+    return TRUE;
+}
+
+/**
+ * Resolves the wall checks of a probe, then finds the floor, ceiling and water level at the
+ * resolved position, giving the same results as calling resolve_and_return_wall_collisions
+ * for each wall check, then find_floor, find_mario_ceil and find_water_level.
+ *
+ * The walls of every check are collected in a single pass over the cells, and the floor,
+ * ceiling and water are found in the same cell, so each cell lookup, bounds check and
+ * list filter only happens once per probe.
+ */
+void find_collision_probe(Vec3f pos, struct CollisionProbe *probe) {
+    s32 numCandidates = 0;
+    s32 i;
+
+    probe->floor       = NULL;
+    probe->ceil        = NULL;
+    probe->floorHeight = FLOOR_LOWER_LIMIT;
+    probe->ceilHeight  = CELL_HEIGHT_LIMIT;
+    probe->waterLevel  = FLOOR_LOWER_LIMIT;
+
+    // Flags change what each query filters and are cleared after the first one, so keep them separate.
+    if (gCollisionFlags != COLLISION_FLAGS_NONE) {
+        find_collision_probe_unfused(pos, probe);
+        return;
+    }
+
+    PUPPYPRINT_GET_SNAPSHOT();
+
+    if (probe->numWallChecks > 0) {
+        f32 maxRadius = probe->walls[0].radius;
+        f32 minY = probe->walls[0].offsetY;
+        f32 maxY = probe->walls[0].offsetY;
+        s32 x = pos[0];
+        s32 z = pos[2];
+
+        for (i = 1; i < probe->numWallChecks; i++) {
+            maxRadius = MAX(maxRadius, probe->walls[i].radius);
+            minY = MIN(minY, probe->walls[i].offsetY);
+            maxY = MAX(maxY, probe->walls[i].offsetY);
+        }
+
+        s32 minCellX = GET_CELL_X(x - maxRadius);
+        s32 minCellZ = GET_CELL_Z(z - maxRadius);
+        s32 maxCellX = GET_CELL_X(x + maxRadius);
+        s32 maxCellZ = GET_CELL_Z(z + maxRadius);
+
+        // If there are too many walls around to collect, each check finds its own.
+        s32 collected = collect_probe_walls(minCellX, minCellZ, maxCellX, maxCellZ, pos[1] + minY, pos[1] + maxY, &numCandidates);
+
+        for (i = 0; i < probe->numWallChecks; i++) {
+            if (collected && probe_wall_check(pos, &probe->walls[i], numCandidates, minCellX, minCellZ, maxCellX, maxCellZ)) {
+                PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_wall);
+#ifdef VANILLA_DEBUG
+                gNumCalls.wall++;
+#endif
+            } else {
+                // Pushed out of the collected cells.
+                resolve_and_return_wall_collisions(pos, probe->walls[i].offsetY, probe->walls[i].radius, &probe->walls[i]);
+            }
+        }
+    }
+
+    s32 x = pos[0];
+    s32 y = pos[1];
+    s32 z = pos[2];
+    s32 outOfBounds = is_outside_level_bounds(x, z);
+    s32 cellX = GET_CELL_X(x);
+    s32 cellZ = GET_CELL_Z(z);
+
+    if (probe->flags & (PROBE_FIND_FLOOR | PROBE_FIND_CEIL)) {
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_floor);
+#ifdef VANILLA_DEBUG
+        gNumCalls.floor++;
+#endif
+        if (!outOfBounds) {
+            probe->floorHeight = find_floor_in_cell(cellX, cellZ, x, y, z, &probe->floor);
+        }
+    }
+
+    if (probe->flags & PROBE_FIND_CEIL) {
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_ceil);
+#ifdef VANILLA_DEBUG
+        gNumCalls.ceil++;
+#endif
+        if (!outOfBounds) {
+            // Like find_mario_ceil
+            s32 ceilY = (MAX(probe->floorHeight, pos[1]) + 3.0f);
+            probe->ceilHeight = find_ceil_in_cell(cellX, cellZ, x, ceilY, z, &probe->ceil);
+        }
+    }
+
+    if (probe->flags & PROBE_FIND_WATER) {
+        f32 waterHeight = FLOOR_LOWER_LIMIT;
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.collision_water);
+#ifdef VANILLA_DEBUG
+        gNumCalls.floor++;
+#endif
+        // Water surfaces are checked at Mario's height, like find_water_level.
+        if (!outOfBounds) {
+            struct SurfaceNode *surfaceList = gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WATER];
+            if (find_water_floor_from_list(surfaceList, x, gMarioState->pos[1], z, &waterHeight) != NULL) {
+                probe->waterLevel = waterHeight;
+            }
+        }
+
+        if (probe->waterLevel == FLOOR_LOWER_LIMIT) {
+            probe->waterLevel = find_water_box_level(x, z);
+        }
+    }
+
+    profiler_collision_update(first);
+}
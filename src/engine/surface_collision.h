@@ -42,6 +42,44 @@ struct WallCollisionData {
     /*0x18*/ struct Surface *walls[MAX_REFERENCED_WALLS];
 };
 
+enum CollisionProbeFlags {
+    PROBE_FIND_FLOOR = (1 << 0),
+    PROBE_FIND_CEIL  = (1 << 1), // Also finds the floor, since the ceiling is found above it.
+    PROBE_FIND_WATER = (1 << 2),
+};
+
+// Wall heights a single probe can check.
+#define PROBE_MAX_WALL_CHECKS 2
+// Walls a probe can collect around it before checking each height separately.
+#define PROBE_MAX_WALL_CANDIDATES 64
+
+/**
+ * Several collision queries at one position, answered together by find_collision_probe.
+ * Set the flags and add the wall checks with collision_probe_add_wall_check, in the order
+ * they should be resolved.
+ */
+struct CollisionProbe {
+    u32 flags;
+    s32 numWallChecks;
+    struct WallCollisionData walls[PROBE_MAX_WALL_CHECKS];
+    struct Surface *floor;
+    struct Surface *ceil;
+    f32 floorHeight;
+    f32 ceilHeight;
+    s32 waterLevel;
+};
+
+ALWAYS_INLINE void collision_probe_init(struct CollisionProbe *probe, u32 flags) {
+    probe->flags = flags;
+    probe->numWallChecks = 0;
+}
+
+ALWAYS_INLINE void collision_probe_add_wall_check(struct CollisionProbe *probe, f32 offsetY, f32 radius) {
+    struct WallCollisionData *data = &probe->walls[probe->numWallChecks++];
+    data->offsetY = offsetY;
+    data->radius = radius;
+}
+
 s32 f32_find_wall_collision(f32 *xPtr, f32 *yPtr, f32 *zPtr, f32 offsetY, f32 radius);
 s32 find_wall_collisions(struct WallCollisionData *colData);
 void resolve_and_return_wall_collisions(Vec3f pos, f32 offset, f32 radius, struct WallCollisionData *collisionData);
@@ -59,6 +97,7 @@ s32 get_room_at_pos(f32 x, f32 y, f32 z);
 s32 find_water_level_and_floor(s32 x, s32 y, s32 z, struct Surface **pfloor);
 s32 find_water_level(s32 x, s32 z);
 s32 find_poison_gas_level(s32 x, s32 z);
+void find_collision_probe(Vec3f pos, struct CollisionProbe *probe);
 #ifdef VANILLA_DEBUG
 void debug_surface_list_info(f32 xPos, f32 zPos);
 #endif
@@ -15,19 +15,21 @@
 #include "surface_load.h"
 #include "game/puppyprint.h"
 #include "game/debug.h"
+#include "game/area.h"
 #include <PR/os_internal_reg.h>
 
 #include "config.h"
 
 /**
- * Partitions for course and object surfaces. The arrays represent
- * the 16x16 cells that each level is split into.
+ * Partitions for course and object surfaces. The arrays represent the cells of gPartitionGrid,
+ * which are allocated for each level. Until then, they point to a single empty cell.
  */
-SpatialPartitionCell gStaticSurfacePartition[NUM_CELLS][NUM_CELLS];
-SpatialPartitionCell gDynamicSurfacePartition[NUM_CELLS][NUM_CELLS];
+static SpatialPartitionCell sEmptyPartitions[2];
+struct PartitionGrid gPartitionGrid = { 0, 0, 1, 1, 0 };
+SpatialPartitionCell *gStaticSurfacePartition = &sEmptyPartitions[0];
+SpatialPartitionCell *gDynamicSurfacePartition = &sEmptyPartitions[1];
 struct CellCoords {
-    u8 z;
-    u8 x;
+    u16 cell;
     u8 partition;
 };
 struct CellCoords sCellsUsed[NUM_CELLS];
@@ -53,6 +55,15 @@ void *gDynamicSurfacePoolEnd;
  */
 u32 gTotalStaticSurfaceData;
 
+#ifdef BAKED_TERRAIN
+/**
+ * How many areas were loaded from the baked terrain since boot, and how many had to be
+ * loaded from their collision data because they weren't baked or the table didn't match.
+ */
+u16 gBakedTerrainHits = 0;
+u16 gBakedTerrainMisses = 0;
+#endif
+
 /**
  * Allocate the part of the surface node pool to contain a surface node.
  */
@@ -119,19 +130,18 @@ static void add_surface_to_cell(s32 dynamic, s32 cellX, s32 cellZ, struct Surfac
     newNode->surface = surface;
 
     if (dynamic) {
-        list = &gDynamicSurfacePartition[cellZ][cellX][listIndex];
+        list = &gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][listIndex];
         if (sNumCellsUsed >= sizeof(sCellsUsed) / sizeof(struct CellCoords)) {
             sClearAllCells = TRUE;
         } else {
             if (*list == NULL) {
-                sCellsUsed[sNumCellsUsed].z = cellZ;
-                sCellsUsed[sNumCellsUsed].x = cellX;
+                sCellsUsed[sNumCellsUsed].cell = PARTITION_CELL(cellX, cellZ);
                 sCellsUsed[sNumCellsUsed].partition = listIndex;
                 sNumCellsUsed++;
             }
         }
     } else {
-        list = &gStaticSurfacePartition[cellZ][cellX][listIndex];
+        list = &gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][listIndex];
     }
 
     if (*list == NULL) {
@@ -165,47 +175,9 @@ static void add_surface_to_cell(s32 dynamic, s32 cellX, s32 cellZ, struct Surfac
 }
 
 /**
- * Every level is split into CELL_SIZE * CELL_SIZE cells of surfaces (to limit computing
- * time). This function determines the lower cell for a given x/z position.
- * @param coord The coordinate to test
- */
-static s32 lower_cell_index(s32 coord) {
-    // Move from range [-LEVEL_BOUNDARY_MAX, LEVEL_BOUNDARY_MAX) to [0, 2 * LEVEL_BOUNDARY_MAX)
-    coord += LEVEL_BOUNDARY_MAX;
-    if (coord < 0) {
-        coord = 0;
-    }
-
-    // [0, NUM_CELLS)
-    s32 index = coord / CELL_SIZE;
-
-    // Potentially > NUM_CELLS - 1, but since the upper index is <= NUM_CELLS - 1, not exploitable
-    return MAX(0, index);
-}
-
-/**
- * Every level is split into CELL_SIZE * CELL_SIZE cells of surfaces (to limit computing
- * time). This function determines the upper cell for a given x/z position.
- * @param coord The coordinate to test
- */
-static s32 upper_cell_index(s32 coord) {
-    // Move from range [-LEVEL_BOUNDARY_MAX, LEVEL_BOUNDARY_MAX) to [0, 2 * LEVEL_BOUNDARY_MAX)
-    coord += LEVEL_BOUNDARY_MAX;
-    if (coord < 0) {
-        coord = 0;
-    }
-
-    // [0, NUM_CELLS)
-    s32 index = coord / CELL_SIZE;
-
-    // Potentially < 0, but since lower index is >= 0, not exploitable
-    return MIN((NUM_CELLS - 1), index);
-}
-
-/**
- * Every level is split into 16x16 cells, this takes a surface, finds
+ * Every level is split into the cells of gPartitionGrid, this takes a surface, finds
  * the appropriate cells (with a buffer), and adds the surface to those
- * cells.
+ * cells. Surfaces outside of the grid are added to the cells at its edges.
  * @param surface The surface to check
  * @param dynamic Boolean determining whether the surface is static or dynamic
  */
@@ -216,10 +188,10 @@ static void add_surface(struct Surface *surface, s32 dynamic) {
     min_max_3i(surface->vertex1[0], surface->vertex2[0], surface->vertex3[0], &minX, &maxX);
     min_max_3i(surface->vertex1[2], surface->vertex2[2], surface->vertex3[2], &minZ, &maxZ);
 
-    s32 minCellX = lower_cell_index(minX);
-    s32 maxCellX = upper_cell_index(maxX);
-    s32 minCellZ = lower_cell_index(minZ);
-    s32 maxCellZ = upper_cell_index(maxZ);
+    s32 minCellX = GET_CELL_X(minX);
+    s32 maxCellX = GET_CELL_X(maxX);
+    s32 minCellZ = GET_CELL_Z(minZ);
+    s32 maxCellZ = GET_CELL_Z(maxZ);
 
     for (cellZ = minCellZ; cellZ <= maxCellZ; cellZ++) {
         for (cellX = minCellX; cellX <= maxCellX; cellX++) {
@@ -404,9 +376,294 @@ static void load_environmental_regions(TerrainData **data) {
 }
 
 /**
- * Allocate the dynamic surface pool for object collision.
+ * The number of TerrainData values each surface of this type takes up.
+ */
+static s32 get_surface_data_length(UNUSED s32 surfaceType) {
+#ifdef ALL_SURFACES_HAVE_FORCE
+    return 4;
+#else
+    return 3 + surface_has_force(surfaceType);
+#endif
+}
+
+#ifdef BAKED_TERRAIN
+/**
+ * The first node of a static partition list, in a block of surfaces and surface nodes that is
+ * loaded as a whole. Pointers in the block are offsets from its start, and a next node of 0 is NULL,
+ * since a block never starts with a node.
+ */
+struct PartitionListHead {
+    u16 cell;
+    u16 partition;
+    u32 node;
+};
+
+/**
+ * Set the static partition lists of a block loaded into the static surface pool,
+ * turning the offsets in its nodes into pointers.
+ */
+static void relocate_static_partition(u8 *pool, struct PartitionListHead *head, u32 numHeads) {
+    while (numHeads-- != 0) {
+        struct SurfaceNode *node = (struct SurfaceNode *) (pool + head->node);
+
+        gStaticSurfacePartition[head->cell][head->partition] = node;
+        while (TRUE) {
+            node->surface = (struct Surface *) (pool + (uintptr_t) node->surface);
+            if (node->next == NULL) {
+                break;
+            }
+            node->next = (struct SurfaceNode *) (pool + (uintptr_t) node->next);
+            node = node->next;
+        }
+        head++;
+    }
+}
+#endif
+
+#ifdef BAKED_TERRAIN
+extern u8 _bakedTerrainSegmentRomStart[];
+
+#define BAKED_TERRAIN_MAGIC   0x424B5452 // 'BKTR'
+#define BAKED_TERRAIN_VERSION 2
+
+#ifdef ALL_SURFACES_HAVE_FORCE
+    #define BAKED_TERRAIN_FLAG_FORCE (1 << 0)
+#else
+    #define BAKED_TERRAIN_FLAG_FORCE 0
+#endif
+#ifdef ENABLE_VANILLA_LEVEL_SPECIFIC_CHECKS
+    #define BAKED_TERRAIN_FLAG_VANILLA_CHECKS (1 << 1)
+#else
+    #define BAKED_TERRAIN_FLAG_VANILLA_CHECKS 0
+#endif
+#define BAKED_TERRAIN_FLAGS (BAKED_TERRAIN_FLAG_FORCE | BAKED_TERRAIN_FLAG_VANILLA_CHECKS)
+
+/**
+ * The table of baked areas written by tools/bake_terrain.py, followed by their blobs.
+ * The header is checked against this build, since the blobs are copies of struct Surface.
+ */
+struct BakedTerrainHeader {
+    u32 magic;
+    u16 version;
+    u16 count;
+    u16 surfaceSize;
+    u8 flags;
+    u8 pad;
+    u32 reserved; // Keeps the entry table after the header 8 byte aligned for the PI DMA
+};
+STATIC_ASSERT(sizeof(struct BakedTerrainHeader) % 8 == 0, "The baked terrain entries must stay 8 byte aligned for osPiStartDma");
+
+struct BakedTerrainEntry {
+    u32 key;
+    u32 offset;
+    u32 numSurfaces;
+    u32 numNodes;
+    u32 numHeads;
+    u32 numDropped;
+};
+
+/**
+ * Hashes the vertex and surface commands of the terrain data (FNV-1a), the key of its baked surfaces.
+ * Objects and environment regions are not part of the key, since they are still loaded from the data.
+ * The partition grid of the level is, since the baked lists depend on it.
+ */
+static u32 get_area_terrain_key(TerrainData *data) {
+    u32 key = 0x811C9DC5;
+    TerrainData *start;
+    s32 terrainLoadType;
+
+    while (TRUE) {
+        start = data;
+        terrainLoadType = *data++;
+
+        if (TERRAIN_LOAD_IS_SURFACE_TYPE_LOW(terrainLoadType) || TERRAIN_LOAD_IS_SURFACE_TYPE_HIGH(terrainLoadType)) {
+            data += 1 + *data * get_surface_data_length(terrainLoadType);
+        } else if (terrainLoadType == TERRAIN_LOAD_VERTICES) {
+            data += 1 + 3 * *data;
+        } else if (terrainLoadType == TERRAIN_LOAD_OBJECTS) {
+            data += get_special_objects_size(data);
+            continue;
+        } else if (terrainLoadType == TERRAIN_LOAD_ENVIRONMENT) {
+            data += 1 + 6 * *data;
+            continue;
+        } else if (terrainLoadType == TERRAIN_LOAD_END) {
+            break;
+        } else {
+            continue;
+        }
+
+        while (start < data) {
+            key = (key ^ (u32) *start++) * 0x01000193;
+        }
+    }
+
+    key = (key ^ (u32) gPartitionGrid.originX) * 0x01000193;
+    key = (key ^ (u32) gPartitionGrid.originZ) * 0x01000193;
+    key = (key ^ (u32) gPartitionGrid.numCellsX) * 0x01000193;
+    key = (key ^ (u32) gPartitionGrid.numCellsZ) * 0x01000193;
+    key = (key ^ (u32) gPartitionGrid.cellShift) * 0x01000193;
+
+    return key;
+}
+
+/**
+ * Look up the terrain data in the baked areas, and if found, DMA its surfaces and partition
+ * into the static surface pool, relocate them and apply the surface rooms.
+ * Returns whether the surfaces were loaded, otherwise they have to be read from the data.
+ */
+static s32 load_baked_terrain(TerrainData *data, RoomData *surfaceRooms, u32 poolSize) {
+    u8 *rom = _bakedTerrainSegmentRomStart;
+    u8 *pool = gCurrStaticSurfacePool;
+    struct BakedTerrainHeader *header = gCurrStaticSurfacePool;
+    struct BakedTerrainEntry *entries = (struct BakedTerrainEntry *) (header + 1);
+    struct BakedTerrainEntry entry;
+    s32 i;
+
+    // The pool is free until the surfaces are loaded, so the table is read into it too.
+    dma_read((u8 *) header, rom, rom + sizeof(struct BakedTerrainHeader));
+    if (header->magic != BAKED_TERRAIN_MAGIC || header->version != BAKED_TERRAIN_VERSION
+        || header->surfaceSize != sizeof(struct Surface) || header->flags != BAKED_TERRAIN_FLAGS || header->count == 0) {
+        return FALSE;
+    }
+
+    u32 tableEnd = sizeof(struct BakedTerrainHeader) + header->count * sizeof(struct BakedTerrainEntry);
+    if (ALIGN16(tableEnd) > poolSize) {
+        return FALSE;
+    }
+    dma_read((u8 *) entries, rom + sizeof(struct BakedTerrainHeader), rom + tableEnd);
+
+    u32 key = get_area_terrain_key(data);
+    s32 low = 0;
+    s32 high = header->count - 1;
+    while (TRUE) {
+        if (low > high) {
+            return FALSE;
+        }
+        i = (low + high) / 2;
+        if (entries[i].key == key) {
+            break;
+        } else if (entries[i].key < key) {
+            low = i + 1;
+        } else {
+            high = i - 1;
+        }
+    }
+    entry = entries[i];
+
+    u32 surfacesSize = entry.numSurfaces * sizeof(struct Surface);
+    u32 nodesSize = entry.numNodes * sizeof(struct SurfaceNode);
+    u32 size = surfacesSize + nodesSize + entry.numHeads * sizeof(struct PartitionListHead) + entry.numDropped * sizeof(u16);
+    if (ALIGN16(size) > poolSize) {
+        return FALSE;
+    }
+    dma_read(pool, rom + entry.offset, rom + entry.offset + size);
+
+    struct PartitionListHead *heads = (struct PartitionListHead *) (pool + surfacesSize + nodesSize);
+    relocate_static_partition(pool, heads, entry.numHeads);
+
+    // Rooms are still consumed by the triangles that were dropped as degenerate.
+    if (surfaceRooms != NULL) {
+        struct Surface *surface = (struct Surface *) pool;
+        u16 *dropped = (u16 *) (heads + entry.numHeads);
+        u32 numDropped = entry.numDropped;
+        u32 numTriangles = entry.numSurfaces + entry.numDropped;
+
+        for (i = 0; i < (s32) numTriangles; i++) {
+            RoomData room = *surfaceRooms++;
+
+            if (numDropped != 0 && *dropped == i) {
+                dropped++;
+                numDropped--;
+            } else {
+                (surface++)->room = room;
+            }
+        }
+    }
+
+    // The heads and dropped triangles past the nodes are freed with the rest of the pool.
+    gCurrStaticSurfacePoolEnd = pool + surfacesSize + nodesSize;
+    gSurfacesAllocated = entry.numSurfaces;
+    gSurfaceNodesAllocated = entry.numNodes;
+
+    return TRUE;
+}
+#endif
+
+/**
+ * Fit the partition grid to the bounds of the vertices of every area in the level, using the smallest
+ * cell size that doesn't need more cells than the largest partition (NUM_CELLS * NUM_CELLS).
+ * tools/bake_terrain.py picks the grid of each level the same way.
+ */
+static void init_partition_grid(void) {
+    s32 minX = LEVEL_BOUNDARY_MAX - 1;
+    s32 minZ = LEVEL_BOUNDARY_MAX - 1;
+    s32 maxX = -LEVEL_BOUNDARY_MAX;
+    s32 maxZ = -LEVEL_BOUNDARY_MAX;
+    s32 terrainLoadType;
+    s32 i;
+
+    for (i = 0; i < AREA_COUNT; i++) {
+        TerrainData *data = gAreaData[i].terrainData;
+
+        while (data != NULL) {
+            terrainLoadType = *data++;
+
+            if (TERRAIN_LOAD_IS_SURFACE_TYPE_LOW(terrainLoadType) || TERRAIN_LOAD_IS_SURFACE_TYPE_HIGH(terrainLoadType)) {
+                data += 1 + *data * get_surface_data_length(terrainLoadType);
+            } else if (terrainLoadType == TERRAIN_LOAD_VERTICES) {
+                s32 numVertices = *data++;
+
+                for (; numVertices > 0; numVertices--, data += 3) {
+                    minX = MIN(minX, data[0]);
+                    maxX = MAX(maxX, data[0]);
+                    minZ = MIN(minZ, data[2]);
+                    maxZ = MAX(maxZ, data[2]);
+                }
+            } else if (terrainLoadType == TERRAIN_LOAD_OBJECTS) {
+                data += get_special_objects_size(data);
+            } else if (terrainLoadType == TERRAIN_LOAD_ENVIRONMENT) {
+                data += 1 + 6 * *data;
+            } else if (terrainLoadType == TERRAIN_LOAD_END) {
+                break;
+            }
+        }
+    }
+
+    // Surfaces outside of the level bounds can't be collided with anyway.
+    minX = CLAMP(minX, -LEVEL_BOUNDARY_MAX, LEVEL_BOUNDARY_MAX - 1);
+    maxX = CLAMP(maxX, minX, LEVEL_BOUNDARY_MAX - 1);
+    minZ = CLAMP(minZ, -LEVEL_BOUNDARY_MAX, LEVEL_BOUNDARY_MAX - 1);
+    maxZ = CLAMP(maxZ, minZ, LEVEL_BOUNDARY_MAX - 1);
+
+    s32 shift = 0;
+    while ((1 << shift) < MIN(PARTITION_MIN_CELL_SIZE, CELL_SIZE)) {
+        shift++;
+    }
+    while (TRUE) {
+        gPartitionGrid.cellShift = shift;
+        gPartitionGrid.originX = (minX >> shift) << shift;
+        gPartitionGrid.originZ = (minZ >> shift) << shift;
+        gPartitionGrid.numCellsX = ((maxX - gPartitionGrid.originX) >> shift) + 1;
+        gPartitionGrid.numCellsZ = ((maxZ - gPartitionGrid.originZ) >> shift) + 1;
+
+        if ((1 << shift) >= CELL_SIZE || gPartitionGrid.numCellsX * gPartitionGrid.numCellsZ <= NUM_CELLS * NUM_CELLS) {
+            break;
+        }
+        shift++;
+    }
+}
+
+/**
+ * Allocate the spatial partitions of the level and the dynamic surface pool for object collision.
  */
 void alloc_surface_pools(void) {
+    init_partition_grid();
+    u32 partitionSize = gPartitionGrid.numCellsX * gPartitionGrid.numCellsZ * sizeof(SpatialPartitionCell);
+    gStaticSurfacePartition = main_pool_alloc(partitionSize, MEMORY_POOL_LEFT);
+    gDynamicSurfacePartition = main_pool_alloc(partitionSize, MEMORY_POOL_LEFT);
+    bzero(gStaticSurfacePartition, partitionSize);
+    bzero(gDynamicSurfacePartition, partitionSize);
+
     gDynamicSurfacePool = main_pool_alloc(DYNAMIC_SURFACE_POOL_SIZE, MEMORY_POOL_LEFT);
     gDynamicSurfacePoolEnd = gDynamicSurfacePool;
 
@@ -414,6 +671,22 @@ void alloc_surface_pools(void) {
     reset_red_coins_collected();
 }
 
+/**
+ * Point the partitions back at an empty cell, since the level memory they were allocated from is freed.
+ */
+void clear_surface_partitions(void) {
+    gPartitionGrid.originX = 0;
+    gPartitionGrid.originZ = 0;
+    gPartitionGrid.numCellsX = 1;
+    gPartitionGrid.numCellsZ = 1;
+    gPartitionGrid.cellShift = 0;
+    gStaticSurfacePartition = &sEmptyPartitions[0];
+    gDynamicSurfacePartition = &sEmptyPartitions[1];
+    bzero(sEmptyPartitions, sizeof(sEmptyPartitions));
+    sNumCellsUsed = 0;
+    sClearAllCells = TRUE;
+}
+
 #ifdef NO_SEGMENTED_MEMORY
 /**
  * Get the size of the terrain data, to get the correct size when copying later.
@@ -476,7 +749,6 @@ u32 get_area_terrain_size(TerrainData *data) {
  * boxes (water, gas, JRB fog).
  */
 void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, s16 *macroObjects) {
-    u32 mask = __osDisableInt();
     PUPPYPRINT_GET_SNAPSHOT();
     s32 terrainLoadType;
     TerrainData *vertexData = NULL;
@@ -491,13 +763,27 @@ void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, s16
     sClearAllCells = TRUE;
 
     // Clear the static (level) surface partitions for new use.
-    bzero(gStaticSurfacePartition, sizeof(gStaticSurfacePartition));
+    bzero(gStaticSurfacePartition, gPartitionGrid.numCellsX * gPartitionGrid.numCellsZ * sizeof(SpatialPartitionCell));
     gTotalStaticSurfaceData = 0;
 
     // Initialise a new surface pool for this block of static surface data
-    gCurrStaticSurfacePool = main_pool_alloc(main_pool_available() - 0x10, MEMORY_POOL_LEFT);
+    u32 surfacePoolSize = main_pool_available() - 0x10;
+    gCurrStaticSurfacePool = main_pool_alloc(surfacePoolSize, MEMORY_POOL_LEFT);
     gCurrStaticSurfacePoolEnd = gCurrStaticSurfacePool;
 
+#ifdef BAKED_TERRAIN
+    // Loaded before disabling interrupts, since the DMA waits for its completion message.
+    // When the surfaces are baked, the data is only read for objects and environment regions.
+    s32 surfacesLoaded = load_baked_terrain(data, surfaceRooms, surfacePoolSize);
+    if (surfacesLoaded) {
+        gBakedTerrainHits++;
+    } else {
+        gBakedTerrainMisses++;
+    }
+#endif
+
+    u32 mask = __osDisableInt();
+
     // A while loop iterating through each section of the level data. Sections of data
     // are prefixed by a terrain "type." This type is reused for surfaces as the surface
     // type.
@@ -505,6 +791,12 @@ void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, s16
         terrainLoadType = *data++;
 
         if (TERRAIN_LOAD_IS_SURFACE_TYPE_LOW(terrainLoadType)) {
+#ifdef BAKED_TERRAIN
+            if (surfacesLoaded) {
+                data += 1 + *data * get_surface_data_length(terrainLoadType);
+                continue;
+            }
+#endif
             load_static_surfaces(&data, vertexData, terrainLoadType, &surfaceRooms);
         } else if (terrainLoadType == TERRAIN_LOAD_VERTICES) {
             vertexData = read_vertex_data(&data);
@@ -517,6 +809,12 @@ void load_area_terrain(s32 index, TerrainData *data, RoomData *surfaceRooms, s16
         } else if (terrainLoadType == TERRAIN_LOAD_END) {
             break;
         } else if (TERRAIN_LOAD_IS_SURFACE_TYPE_HIGH(terrainLoadType)) {
+#ifdef BAKED_TERRAIN
+            if (surfacesLoaded) {
+                data += 1 + *data * get_surface_data_length(terrainLoadType);
+                continue;
+            }
+#endif
             load_static_surfaces(&data, vertexData, terrainLoadType, &surfaceRooms);
             continue;
         }
@@ -557,10 +855,10 @@ void clear_dynamic_surfaces(void) {
         gSurfaceNodesAllocated = gNumStaticSurfaceNodes;
         gDynamicSurfacePoolEnd = gDynamicSurfacePool;
         if (sClearAllCells) {
-            bzero(gDynamicSurfacePartition, sizeof(gDynamicSurfacePartition));
+            bzero(gDynamicSurfacePartition, gPartitionGrid.numCellsX * gPartitionGrid.numCellsZ * sizeof(SpatialPartitionCell));
         } else {
             for (u32 i = 0; i < sNumCellsUsed; i++) {
-                gDynamicSurfacePartition[sCellsUsed[i].z][sCellsUsed[i].x][sCellsUsed[i].partition] = NULL;
+                gDynamicSurfacePartition[sCellsUsed[i].cell][sCellsUsed[i].partition] = NULL;
             }
         }
         sNumCellsUsed = 0;
@@ -31,15 +31,49 @@ enum SpatialPartitions {
 
 typedef struct SurfaceNode *SpatialPartitionCell[NUM_SPATIAL_PARTITIONS];
 
-extern SpatialPartitionCell gStaticSurfacePartition[NUM_CELLS][NUM_CELLS];
-extern SpatialPartitionCell gDynamicSurfacePartition[NUM_CELLS][NUM_CELLS];
+/**
+ * The grid of the current level's spatial partition, fitted to the bounds of its static surfaces.
+ * Its cells are (1 << cellShift) units wide, starting at (originX, originZ).
+ */
+struct PartitionGrid {
+    s32 originX;
+    s32 originZ;
+    s32 numCellsX;
+    s32 numCellsZ;
+    s32 cellShift;
+};
+
+extern struct PartitionGrid gPartitionGrid;
+extern SpatialPartitionCell *gStaticSurfacePartition;
+extern SpatialPartitionCell *gDynamicSurfacePartition;
 extern void *gCurrStaticSurfacePool;
 extern void *gDynamicSurfacePool;
 extern void *gCurrStaticSurfacePoolEnd;
 extern void *gDynamicSurfacePoolEnd;
 extern u32 gTotalStaticSurfaceData;
+#ifdef BAKED_TERRAIN
+extern u16 gBakedTerrainHits;
+extern u16 gBakedTerrainMisses;
+#endif
+
+/**
+ * Converts a position to a cell coordinate of the partition grid.
+ * Positions outside of the grid use the cells at its edges, which is also where surfaces outside of it are added.
+ */
+static inline s32 get_cell_coord(s32 pos, s32 origin, s32 numCells) {
+    s32 cell = ((pos - origin) >> gPartitionGrid.cellShift);
+
+    if (cell < 0) return 0;
+    if (cell >= numCells) return (numCells - 1);
+    return cell;
+}
+
+#define GET_CELL_X(x) get_cell_coord((s32)(x), gPartitionGrid.originX, gPartitionGrid.numCellsX)
+#define GET_CELL_Z(z) get_cell_coord((s32)(z), gPartitionGrid.originZ, gPartitionGrid.numCellsZ)
+#define PARTITION_CELL(cellX, cellZ) (((cellZ) * gPartitionGrid.numCellsX) + (cellX))
 
 void alloc_surface_pools(void);
+void clear_surface_partitions(void);
 #ifdef NO_SEGMENTED_MEMORY
 u32 get_area_terrain_size(TerrainData *data);
 #endif
@@ -205,19 +205,19 @@ void iterate_surfaces_visual(s32 x, s32 z, Vtx *verts) {
 
     if (is_outside_level_bounds(x, z)) return;
 
-    s32 cellX = GET_CELL_COORD(x);
-    s32 cellZ = GET_CELL_COORD(z);
+    s32 cellX = GET_CELL_X(x);
+    s32 cellZ = GET_CELL_Z(z);
 
     for (i = 0; i < (2 * NUM_SPATIAL_PARTITIONS); i++) {
         switch (i) {
-            case 0: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_GREEN ); break;
-            case 1: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_GREEN ); break;
-            case 2: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_BLUE  ); break;
-            case 3: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_BLUE  ); break;
-            case 4: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_RED   ); break;
-            case 5: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_RED   ); break;
-            case 6: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_YELLOW); break;
-            case 7: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_YELLOW); break;
+            case 0: node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WALLS ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_GREEN ); break;
+            case 1: node =  gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WALLS ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_GREEN ); break;
+            case 2: node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_FLOORS]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_BLUE  ); break;
+            case 3: node =  gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_FLOORS]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_BLUE  ); break;
+            case 4: node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_CEILS ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_RED   ); break;
+            case 5: node =  gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_CEILS ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_RED   ); break;
+            case 6: node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WATER ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_YELLOW); break;
+            case 7: node =  gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WATER ]; colorRGB_copy(col, (ColorRGB)COLOR_RGB_YELLOW); break;
         }
 
         while (node != NULL) {
@@ -313,19 +313,19 @@ s32 iterate_surface_count(s32 x, s32 z) {
 
     if (is_outside_level_bounds(x, z)) return 0;
 
-    s32 cellX = GET_CELL_COORD(x);
-    s32 cellZ = GET_CELL_COORD(z);
+    s32 cellX = GET_CELL_X(x);
+    s32 cellZ = GET_CELL_Z(z);
 
     for (i = 0; i < (2 * NUM_SPATIAL_PARTITIONS); i++) {
         switch (i) {
-            case 0: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ]; break;
-            case 1: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ]; break;
-            case 2: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS]; break;
-            case 3: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS]; break;
-            case 4: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ]; break;
-            case 5: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ]; break;
-            case 6: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER ]; break;
-            case 7: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER ]; break;
+            case 0: node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WALLS ]; break;
+            case 1: node =  gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WALLS ]; break;
+            case 2: node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_FLOORS]; break;
+            case 3: node =  gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_FLOORS]; break;
+            case 4: node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_CEILS ]; break;
+            case 5: node =  gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_CEILS ]; break;
+            case 6: node = gDynamicSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WATER ]; break;
+            case 7: node =  gStaticSurfacePartition[PARTITION_CELL(cellX, cellZ)][SPATIAL_PARTITION_WATER ]; break;
         }
 
         while (node != NULL) {
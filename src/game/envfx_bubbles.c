@@ -25,6 +25,7 @@ s16 gEnvFxBubbleConfig[10];
 static Gfx *sGfxCursor; // points to end of display list for bubble particles
 static s32 sBubbleParticleCount;
 static s32 sBubbleParticleMaxCount;
+static s32 sBubbleParticleActiveCount; // sBubbleParticleMaxCount clamped to the buffer and gEnvFxParticleLimit
 
 /// Template for a bubble particle triangle
 Vtx_t gBubbleTempVtx[3] = {
@@ -75,7 +76,7 @@ void envfx_update_flower(Vec3s centerPos) {
     s16 centerX = centerPos[0];
     s16 centerZ = centerPos[2];
 
-    for (i = 0; i < sBubbleParticleMaxCount; i++) {
+    for (i = 0; i < sBubbleParticleActiveCount; i++) {
         (gEnvFxBuffer + i)->isAlive = particle_is_laterally_close(i, centerX, centerZ, 3000);
         if (!(gEnvFxBuffer + i)->isAlive) {
             (gEnvFxBuffer + i)->xPos = random_flower_offset() + centerX;
@@ -148,7 +149,7 @@ void envfx_update_lava(Vec3s centerPos) {
     s32 i;
     s32 globalTimer = gGlobalTimer;
 
-    for (i = 0; i < sBubbleParticleMaxCount; i++) {
+    for (i = 0; i < sBubbleParticleActiveCount; i++) {
         if (!(gEnvFxBuffer + i)->isAlive) {
             envfx_set_lava_bubble_position(i, centerPos);
             (gEnvFxBuffer + i)->isAlive = TRUE;
@@ -211,7 +212,7 @@ s32 envfx_is_whirlpool_bubble_alive(s32 index) {
 void envfx_update_whirlpool(void) {
     s32 i;
 
-    for (i = 0; i < sBubbleParticleMaxCount; i++) {
+    for (i = 0; i < sBubbleParticleActiveCount; i++) {
         (gEnvFxBuffer + i)->isAlive = envfx_is_whirlpool_bubble_alive(i);
         if (!(gEnvFxBuffer + i)->isAlive) {
             (gEnvFxBuffer + i)->angleAndDist[1] = random_float() * 1000.0f;
@@ -270,7 +271,7 @@ s32 envfx_is_jestream_bubble_alive(s32 index) {
 void envfx_update_jetstream(void) {
     s32 i;
 
-    for (i = 0; i < sBubbleParticleMaxCount; i++) {
+    for (i = 0; i < sBubbleParticleActiveCount; i++) {
         (gEnvFxBuffer + i)->isAlive = envfx_is_jestream_bubble_alive(i);
         if (!(gEnvFxBuffer + i)->isAlive) {
             (gEnvFxBuffer + i)->angleAndDist[1] = random_float() * 300.0f;
@@ -382,37 +383,41 @@ void envfx_bubbles_update_switch(s32 mode, Vec3s camTo, Vec3s vertex1, Vec3s ver
 }
 
 /**
- * Append 15 vertices to 'gfx', which is enough for 5 bubbles starting at
- * 'index'. The 3 input vertices represent the rotated triangle around (0,0,0)
- * that will be translated to bubble positions to draw the bubble image
+ * Build the vertices of the first 'count' bubbles in a single buffer, three
+ * per bubble. The 3 input vertices represent the rotated triangle around (0,0,0)
+ * that is translated to each bubble position to draw the bubble image.
  */
-void append_bubble_vertex_buffer(Gfx *gfx, s32 index, Vec3s vertex1, Vec3s vertex2, Vec3s vertex3,
-                                 Vtx *template) {
-    s32 i = 0;
-    Vtx *vertBuf = alloc_display_list(15 * sizeof(Vtx));
+static Vtx *envfx_make_bubble_vertices(s32 count, Vec3s vertex1, Vec3s vertex2, Vec3s vertex3, Vtx *template) {
+    s32 i;
+    Vtx *vertBuf = alloc_display_list(count * 3 * sizeof(Vtx));
+    Vtx *vtx = vertBuf;
+    struct EnvFxParticle *particle = gEnvFxBuffer;
 
     if (vertBuf == NULL) {
-        return;
+        return NULL;
     }
 
-    for (i = 0; i < 15; i += 3) {
-        vertBuf[i] = template[0];
-        (vertBuf + i)->v.ob[0] = (gEnvFxBuffer + (index + i / 3))->xPos + vertex1[0];
-        (vertBuf + i)->v.ob[1] = (gEnvFxBuffer + (index + i / 3))->yPos + vertex1[1];
-        (vertBuf + i)->v.ob[2] = (gEnvFxBuffer + (index + i / 3))->zPos + vertex1[2];
-
-        vertBuf[i + 1] = template[1];
-        (vertBuf + i + 1)->v.ob[0] = (gEnvFxBuffer + (index + i / 3))->xPos + vertex2[0];
-        (vertBuf + i + 1)->v.ob[1] = (gEnvFxBuffer + (index + i / 3))->yPos + vertex2[1];
-        (vertBuf + i + 1)->v.ob[2] = (gEnvFxBuffer + (index + i / 3))->zPos + vertex2[2];
-
-        vertBuf[i + 2] = template[2];
-        (vertBuf + i + 2)->v.ob[0] = (gEnvFxBuffer + (index + i / 3))->xPos + vertex3[0];
-        (vertBuf + i + 2)->v.ob[1] = (gEnvFxBuffer + (index + i / 3))->yPos + vertex3[1];
-        (vertBuf + i + 2)->v.ob[2] = (gEnvFxBuffer + (index + i / 3))->zPos + vertex3[2];
+    for (i = 0; i < count; i++) {
+        vtx[0] = template[0];
+        vtx[0].v.ob[0] = particle->xPos + vertex1[0];
+        vtx[0].v.ob[1] = particle->yPos + vertex1[1];
+        vtx[0].v.ob[2] = particle->zPos + vertex1[2];
+
+        vtx[1] = template[1];
+        vtx[1].v.ob[0] = particle->xPos + vertex2[0];
+        vtx[1].v.ob[1] = particle->yPos + vertex2[1];
+        vtx[1].v.ob[2] = particle->zPos + vertex2[2];
+
+        vtx[2] = template[2];
+        vtx[2].v.ob[0] = particle->xPos + vertex3[0];
+        vtx[2].v.ob[1] = particle->yPos + vertex3[1];
+        vtx[2].v.ob[2] = particle->zPos + vertex3[2];
+
+        vtx += 3;
+        particle++;
     }
 
-    gSPVertex(gfx, VIRTUAL_TO_PHYSICAL(vertBuf), 15, 0);
+    return vertBuf;
 }
 
 /**
@@ -453,20 +458,26 @@ void envfx_set_bubble_texture(s32 mode, s16 index) {
  * list drawing them.
  */
 Gfx *envfx_update_bubble_particles(s32 mode, UNUSED Vec3s marioPos, Vec3s camFrom, Vec3s camTo) {
-    s32 i;
+    s32 i, count;
     s16 radius, pitch, yaw;
 
     Vec3s vertex1;
     Vec3s vertex2;
     Vec3s vertex3;
 
-    Gfx *gfxStart = alloc_display_list(((sBubbleParticleMaxCount / 5) * 10 + sBubbleParticleMaxCount + 3)
-                                       * sizeof(Gfx));
+    Gfx *gfxStart;
+    Vtx *vertBuf;
+
+    // Flowers and lava bubbles animate, so their texture is set again for every group of 5,
+    // which takes 7 commands per group. The other bubbles share one texture and need fewer.
+    count = MIN(MIN(sBubbleParticleMaxCount, sBubbleParticleCount), gEnvFxParticleLimit);
+    gfxStart = alloc_display_list((((count + 4) / 5) * 7 + 3) * sizeof(Gfx));
     if (gfxStart == NULL) {
         return NULL;
     }
 
     sGfxCursor = gfxStart;
+    sBubbleParticleActiveCount = count;
 
     orbit_from_positions(camTo, camFrom, &radius, &pitch, &yaw);
     envfx_bubbles_update_switch(mode, camTo, vertex1, vertex2, vertex3);
@@ -474,15 +485,19 @@ Gfx *envfx_update_bubble_particles(s32 mode, UNUSED Vec3s marioPos, Vec3s camFro
 
     gSPDisplayList(sGfxCursor++, &tiny_bubble_dl_0B006D38);
 
-    for (i = 0; i < sBubbleParticleMaxCount; i += 5) {
-        gDPPipeSync(sGfxCursor++);
-        envfx_set_bubble_texture(mode, i);
-        append_bubble_vertex_buffer(sGfxCursor++, i, vertex1, vertex2, vertex3, (Vtx *) gBubbleTempVtx);
-        gSP1Triangle(sGfxCursor++, 0, 1, 2, 0);
-        gSP1Triangle(sGfxCursor++, 3, 4, 5, 0);
-        gSP1Triangle(sGfxCursor++, 6, 7, 8, 0);
-        gSP1Triangle(sGfxCursor++, 9, 10, 11, 0);
-        gSP1Triangle(sGfxCursor++, 12, 13, 14, 0);
+    vertBuf = envfx_make_bubble_vertices(count, vertex1, vertex2, vertex3, (Vtx *) gBubbleTempVtx);
+    if (vertBuf != NULL) {
+        if (mode == ENVFX_FLOWERS || mode == ENVFX_LAVA_BUBBLES) {
+            for (i = 0; i < count; i += 5) {
+                gDPPipeSync(sGfxCursor++);
+                envfx_set_bubble_texture(mode, i);
+                sGfxCursor = envfx_append_particle_triangles(sGfxCursor, vertBuf + i * 3, MIN(count - i, 5));
+            }
+        } else {
+            gDPPipeSync(sGfxCursor++);
+            envfx_set_bubble_texture(mode, 0);
+            sGfxCursor = envfx_append_particle_triangles(sGfxCursor, vertBuf, count);
+        }
     }
 
     gSPDisplayList(sGfxCursor++, &tiny_bubble_dl_0B006AB0);
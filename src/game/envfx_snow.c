@@ -38,6 +38,21 @@ Vec3i gSnowCylinderLastPos;
 s16 gSnowParticleCount;
 s16 gSnowParticleMaxCount;
 
+/**
+ * Upper bound on the number of snowflakes and bubbles drawn each frame.
+ * Lower it at runtime to thin out environment effects on busy scenes.
+ */
+s16 gEnvFxParticleLimit = ENVFX_MAX_PARTICLES;
+
+/**
+ * Snowflake positions. Snow only needs a position per flake, so instead of an
+ * EnvFxParticle each, the buffer holds one array per axis which the update
+ * loops walk through linearly.
+ */
+static s32 *sSnowX;
+static s32 *sSnowY;
+static s32 *sSnowZ;
+
 /* DATA */
 s8 gEnvFxMode = ENVFX_MODE_NONE;
 
@@ -80,13 +95,16 @@ s32 envfx_init_snow(s32 mode) {
             break;
     }
 
-    gEnvFxBuffer = mem_pool_alloc(gEffectsMemoryPool,
-                                  gSnowParticleMaxCount * sizeof(struct EnvFxParticle));
+    // The position arrays share gEnvFxBuffer's allocation, so envfx_cleanup_snow frees them as usual.
+    gEnvFxBuffer = mem_pool_alloc(gEffectsMemoryPool, 3 * gSnowParticleMaxCount * sizeof(s32));
     if (gEnvFxBuffer == NULL) {
         return FALSE;
     }
 
-    bzero(gEnvFxBuffer, gSnowParticleMaxCount * sizeof(struct EnvFxParticle));
+    bzero(gEnvFxBuffer, 3 * gSnowParticleMaxCount * sizeof(s32));
+    sSnowX = (s32 *) gEnvFxBuffer;
+    sSnowY = sSnowX + gSnowParticleMaxCount;
+    sSnowZ = sSnowY + gSnowParticleMaxCount;
 
     gEnvFxMode = mode;
     return TRUE;
@@ -170,15 +188,11 @@ void pos_from_orbit(Vec3s origin, Vec3s result, s16 radius, s16 pitch, s16 yaw)
 }
 
 /**
- * Check whether the snowflake with the given index is inside view, where
- * 'view' is a cylinder of radius 300 and height 400 centered at the input
- * x, y and z.
+ * Check whether a snowflake is inside view, where 'view' is a cylinder of
+ * radius 300 and height 400 centered at the input x, y and z.
  */
-s32 envfx_is_snowflake_alive(s32 index, s32 snowCylinderX, s32 snowCylinderY, s32 snowCylinderZ) {
-    s32 x = (gEnvFxBuffer + index)->xPos;
-    s32 y = (gEnvFxBuffer + index)->yPos;
-    s32 z = (gEnvFxBuffer + index)->zPos;
-
+static ALWAYS_INLINE s32 envfx_is_snowflake_in_view(s32 x, s32 y, s32 z, s32 snowCylinderX, s32 snowCylinderY,
+                                                   s32 snowCylinderZ) {
     if (sqr(x - snowCylinderX) + sqr(z - snowCylinderZ) > sqr(300)) {
         return FALSE;
     }
@@ -190,6 +204,45 @@ s32 envfx_is_snowflake_alive(s32 index, s32 snowCylinderX, s32 snowCylinderY, s3
     return TRUE;
 }
 
+/**
+ * Shared update of normal and blizzard snow. Snowflakes that left the view
+ * respawn at a random height of [respawnMinY, respawnMinY + respawnRangeY[
+ * relative to the snow cylinder, the others drift by the camera motion plus
+ * 'windX' and fall by 'fallSpeed'. Everything that only depends on the camera
+ * motion is computed once instead of per flake.
+ */
+static void envfx_update_snow_drift(s32 snowCylinderX, s32 snowCylinderY, s32 snowCylinderZ,
+                                    f32 respawnMinY, f32 respawnRangeY, f32 windX, s32 fallSpeed) {
+    s32 i;
+    s32 count = MIN(gSnowParticleCount, gEnvFxParticleLimit);
+    s32 deltaX = snowCylinderX - gSnowCylinderLastPos[0];
+    s32 deltaY = snowCylinderY - gSnowCylinderLastPos[1];
+    s32 deltaZ = snowCylinderZ - gSnowCylinderLastPos[2];
+    f32 respawnX = snowCylinderX + (s16)(deltaX * 2) - 200.0f;
+    f32 respawnY = snowCylinderY + respawnMinY;
+    f32 respawnZ = snowCylinderZ + (s16)(deltaZ * 2) - 200.0f;
+    f32 driftX = (s16)(deltaX / 1.2) + windX - 1.0f;
+    f32 driftZ = (s16)(deltaZ / 1.2) - 1.0f;
+    s32 fallY = fallSpeed - (s16)(deltaY * 0.8);
+
+    for (i = 0; i < count; i++) {
+        if (!envfx_is_snowflake_in_view(sSnowX[i], sSnowY[i], sSnowZ[i],
+                                        snowCylinderX, snowCylinderY, snowCylinderZ)) {
+            sSnowX[i] = 400.0f * random_float() + respawnX;
+            sSnowZ[i] = 400.0f * random_float() + respawnZ;
+            sSnowY[i] = respawnRangeY * random_float() + respawnY;
+        } else {
+            sSnowX[i] += random_float() * 2 + driftX;
+            sSnowY[i] -= fallY;
+            sSnowZ[i] += random_float() * 2 + driftZ;
+        }
+    }
+
+    gSnowCylinderLastPos[0] = snowCylinderX;
+    gSnowCylinderLastPos[1] = snowCylinderY;
+    gSnowCylinderLastPos[2] = snowCylinderZ;
+}
+
 /**
  * Update the position of each snowflake. Snowflakes wiggle by having a
  * random value added to their position each frame. If snowflakes get out
@@ -205,65 +258,17 @@ s32 envfx_is_snowflake_alive(s32 index, s32 snowCylinderX, s32 snowCylinderY, s3
  * by level geometry, wasting many particles.
  */
 void envfx_update_snow_normal(s32 snowCylinderX, s32 snowCylinderY, s32 snowCylinderZ) {
-    s32 i;
-    s32 deltaX = snowCylinderX - gSnowCylinderLastPos[0];
-    s32 deltaY = snowCylinderY - gSnowCylinderLastPos[1];
-    s32 deltaZ = snowCylinderZ - gSnowCylinderLastPos[2];
-
-    for (i = 0; i < gSnowParticleCount; i++) {
-        (gEnvFxBuffer + i)->isAlive =
-            envfx_is_snowflake_alive(i, snowCylinderX, snowCylinderY, snowCylinderZ);
-        if (!(gEnvFxBuffer + i)->isAlive) {
-            (gEnvFxBuffer + i)->xPos =
-                400.0f * random_float() - 200.0f + snowCylinderX + (s16)(deltaX * 2);
-            (gEnvFxBuffer + i)->zPos =
-                400.0f * random_float() - 200.0f + snowCylinderZ + (s16)(deltaZ * 2);
-            (gEnvFxBuffer + i)->yPos = 200.0f * random_float() + snowCylinderY;
-            (gEnvFxBuffer + i)->isAlive = TRUE;
-        } else {
-            (gEnvFxBuffer + i)->xPos += random_float() * 2 - 1.0f + (s16)(deltaX / 1.2);
-            (gEnvFxBuffer + i)->yPos -= 2 -(s16)(deltaY * 0.8);
-            (gEnvFxBuffer + i)->zPos += random_float() * 2 - 1.0f + (s16)(deltaZ / 1.2);
-        }
-    }
-
-    gSnowCylinderLastPos[0] = snowCylinderX;
-    gSnowCylinderLastPos[1] = snowCylinderY;
-    gSnowCylinderLastPos[2] = snowCylinderZ;
+    envfx_update_snow_drift(snowCylinderX, snowCylinderY, snowCylinderZ, 0.0f, 200.0f, 0.0f, 2);
 }
 
 /**
- * Unused function. Basically a copy-paste of envfx_update_snow_normal,
- * but an extra 20 units is added to each snowflake x and snowflakes can
- * respawn in y-range [-200, 200] instead of [0, 200] relative to snowCylinderY
+ * Unused in vanilla. Like envfx_update_snow_normal, but an extra 20 units is
+ * added to each snowflake x and snowflakes can respawn in y-range [-200, 200]
+ * instead of [0, 200] relative to snowCylinderY.
  * They also fall a bit faster (with vertical speed -5 instead of -2).
  */
 void envfx_update_snow_blizzard(s32 snowCylinderX, s32 snowCylinderY, s32 snowCylinderZ) {
-    s32 i;
-    s32 deltaX = snowCylinderX - gSnowCylinderLastPos[0];
-    s32 deltaY = snowCylinderY - gSnowCylinderLastPos[1];
-    s32 deltaZ = snowCylinderZ - gSnowCylinderLastPos[2];
-
-    for (i = 0; i < gSnowParticleCount; i++) {
-        (gEnvFxBuffer + i)->isAlive =
-            envfx_is_snowflake_alive(i, snowCylinderX, snowCylinderY, snowCylinderZ);
-        if (!(gEnvFxBuffer + i)->isAlive) {
-            (gEnvFxBuffer + i)->xPos =
-                400.0f * random_float() - 200.0f + snowCylinderX + (s16)(deltaX * 2);
-            (gEnvFxBuffer + i)->zPos =
-                400.0f * random_float() - 200.0f + snowCylinderZ + (s16)(deltaZ * 2);
-            (gEnvFxBuffer + i)->yPos = 400.0f * random_float() - 200.0f + snowCylinderY;
-            (gEnvFxBuffer + i)->isAlive = TRUE;
-        } else {
-            (gEnvFxBuffer + i)->xPos += random_float() * 2 - 1.0f + (s16)(deltaX / 1.2) + 20.0f;
-            (gEnvFxBuffer + i)->yPos -= 5 -(s16)(deltaY * 0.8);
-            (gEnvFxBuffer + i)->zPos += random_float() * 2 - 1.0f + (s16)(deltaZ / 1.2);
-        }
-    }
-
-    gSnowCylinderLastPos[0] = snowCylinderX;
-    gSnowCylinderLastPos[1] = snowCylinderY;
-    gSnowCylinderLastPos[2] = snowCylinderZ;
+    envfx_update_snow_drift(snowCylinderX, snowCylinderY, snowCylinderZ, -200.0f, 400.0f, 20.0f, 5);
 }
 
 /*! Unused function. Checks whether a position is laterally within 3000 units
@@ -288,15 +293,17 @@ UNUSED static s32 is_in_mystery_snow_area(s32 x, UNUSED s32 y, s32 z) {
  */
 void envfx_update_snow_water(s32 snowCylinderX, s32 snowCylinderY, s32 snowCylinderZ) {
     s32 i;
-
-    for (i = 0; i < gSnowParticleCount; i++) {
-        (gEnvFxBuffer + i)->isAlive =
-            envfx_is_snowflake_alive(i, snowCylinderX, snowCylinderY, snowCylinderZ);
-        if (!(gEnvFxBuffer + i)->isAlive) {
-            (gEnvFxBuffer + i)->xPos = 400.0f * random_float() - 200.0f + snowCylinderX;
-            (gEnvFxBuffer + i)->zPos = 400.0f * random_float() - 200.0f + snowCylinderZ;
-            (gEnvFxBuffer + i)->yPos = 400.0f * random_float() - 200.0f + snowCylinderY;
-            (gEnvFxBuffer + i)->isAlive = TRUE;
+    s32 count = MIN(gSnowParticleCount, gEnvFxParticleLimit);
+    f32 respawnX = snowCylinderX - 200.0f;
+    f32 respawnY = snowCylinderY - 200.0f;
+    f32 respawnZ = snowCylinderZ - 200.0f;
+
+    for (i = 0; i < count; i++) {
+        if (!envfx_is_snowflake_in_view(sSnowX[i], sSnowY[i], sSnowZ[i],
+                                        snowCylinderX, snowCylinderY, snowCylinderZ)) {
+            sSnowX[i] = 400.0f * random_float() + respawnX;
+            sSnowZ[i] = 400.0f * random_float() + respawnZ;
+            sSnowY[i] = 400.0f * random_float() + respawnY;
         }
     }
 }
@@ -339,37 +346,66 @@ void rotate_triangle_vertices(Vec3s vertex1, Vec3s vertex2, Vec3s vertex3, s16 p
 }
 
 /**
- * Append 15 vertices to 'gfx', which is enough for 5 snowflakes starting at
- * 'index' in the buffer. The 3 input vertices represent the rotated triangle
- * around (0,0,0) that will be translated to snowflake positions to draw the
- * snowflake image.
+ * Build the vertices of 'count' snowflakes in a single buffer, three per
+ * flake. The 3 input vertices represent the rotated triangle around (0,0,0)
+ * that is translated to each snowflake position to draw the snowflake image.
  */
-void append_snowflake_vertex_buffer(Gfx *gfx, s32 index, Vec3s vertex1, Vec3s vertex2, Vec3s vertex3) {
-    s32 i = 0;
-    Vtx *vertBuf = (Vtx *) alloc_display_list(15 * sizeof(Vtx));
+static Vtx *envfx_make_snowflake_vertices(s32 count, Vec3s vertex1, Vec3s vertex2, Vec3s vertex3) {
+    s32 i;
+    Vtx *vertBuf = (Vtx *) alloc_display_list(count * 3 * sizeof(Vtx));
+    Vtx *vtx = vertBuf;
 
     if (vertBuf == NULL) {
-        return;
+        return NULL;
     }
 
-    for (i = 0; i < 15; i += 3) {
-        vertBuf[i] = gSnowTempVtx[0];
-        (vertBuf + i)->v.ob[0] = (gEnvFxBuffer + (index + i / 3))->xPos + vertex1[0];
-        (vertBuf + i)->v.ob[1] = (gEnvFxBuffer + (index + i / 3))->yPos + vertex1[1];
-        (vertBuf + i)->v.ob[2] = (gEnvFxBuffer + (index + i / 3))->zPos + vertex1[2];
-
-        vertBuf[i + 1] = gSnowTempVtx[1];
-        (vertBuf + i + 1)->v.ob[0] = (gEnvFxBuffer + (index + i / 3))->xPos + vertex2[0];
-        (vertBuf + i + 1)->v.ob[1] = (gEnvFxBuffer + (index + i / 3))->yPos + vertex2[1];
-        (vertBuf + i + 1)->v.ob[2] = (gEnvFxBuffer + (index + i / 3))->zPos + vertex2[2];
-
-        vertBuf[i + 2] = gSnowTempVtx[2];
-        (vertBuf + i + 2)->v.ob[0] = (gEnvFxBuffer + (index + i / 3))->xPos + vertex3[0];
-        (vertBuf + i + 2)->v.ob[1] = (gEnvFxBuffer + (index + i / 3))->yPos + vertex3[1];
-        (vertBuf + i + 2)->v.ob[2] = (gEnvFxBuffer + (index + i / 3))->zPos + vertex3[2];
+    for (i = 0; i < count; i++) {
+        s32 x = sSnowX[i];
+        s32 y = sSnowY[i];
+        s32 z = sSnowZ[i];
+
+        vtx[0] = gSnowTempVtx[0];
+        vtx[0].v.ob[0] = x + vertex1[0];
+        vtx[0].v.ob[1] = y + vertex1[1];
+        vtx[0].v.ob[2] = z + vertex1[2];
+
+        vtx[1] = gSnowTempVtx[1];
+        vtx[1].v.ob[0] = x + vertex2[0];
+        vtx[1].v.ob[1] = y + vertex2[1];
+        vtx[1].v.ob[2] = z + vertex2[2];
+
+        vtx[2] = gSnowTempVtx[2];
+        vtx[2].v.ob[0] = x + vertex3[0];
+        vtx[2].v.ob[1] = y + vertex3[1];
+        vtx[2].v.ob[2] = z + vertex3[2];
+
+        vtx += 3;
     }
 
-    gSPVertex(gfx, VIRTUAL_TO_PHYSICAL(vertBuf), 15, 0);
+    return vertBuf;
+}
+
+/**
+ * Append the triangles of 'count' particles whose vertices are stored three
+ * per particle in 'vertBuf', loading as many at once as the vertex cache fits.
+ */
+Gfx *envfx_append_particle_triangles(Gfx *gfx, Vtx *vertBuf, s32 count) {
+    s32 i, j, batch;
+
+    for (i = 0; i < count; i += ENVFX_PARTICLES_PER_VTX_LOAD) {
+        batch = MIN(count - i, ENVFX_PARTICLES_PER_VTX_LOAD);
+
+        gSPVertex(gfx++, VIRTUAL_TO_PHYSICAL(vertBuf + i * 3), batch * 3, 0);
+        for (j = 0; j + 1 < batch; j += 2) {
+            gSP2Triangles(gfx++, (j * 3) + 0, (j * 3) + 1, (j * 3) + 2, 0,
+                                 (j * 3) + 3, (j * 3) + 4, (j * 3) + 5, 0);
+        }
+        if (j < batch) {
+            gSP1Triangle(gfx++, (j * 3) + 0, (j * 3) + 1, (j * 3) + 2, 0);
+        }
+    }
+
+    return gfx;
 }
 
 /**
@@ -377,26 +413,28 @@ void append_snowflake_vertex_buffer(Gfx *gfx, s32 index, Vec3s vertex1, Vec3s ve
  * drawing all snowflakes.
  */
 Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo) {
-    s32 i;
+    s32 count;
     s16 radius, pitch, yaw;
     Vec3s snowCylinderPos;
     struct SnowFlakeVertex vertex1, vertex2, vertex3;
     Gfx *gfxStart;
     Gfx *gfx;
+    Vtx *vertBuf;
 
     vertex1 = gSnowFlakeVertex1;
     vertex2 = gSnowFlakeVertex2;
     vertex3 = gSnowFlakeVertex3;
 
-    gfxStart = (Gfx *) alloc_display_list((gSnowParticleCount * 6 + 3) * sizeof(Gfx));
+    envfx_update_snowflake_count(snowMode, marioPos);
+    count = MIN(gSnowParticleCount, gEnvFxParticleLimit);
+
+    gfxStart = (Gfx *) alloc_display_list(ENVFX_PARTICLE_GFX_COUNT(count) * sizeof(Gfx));
     gfx = gfxStart;
 
     if (gfxStart == NULL) {
         return NULL;
     }
 
-    envfx_update_snowflake_count(snowMode, marioPos);
-
     // Note: to and from are inverted here, so the resulting vector goes towards the camera
     orbit_from_positions(camTo, camFrom, &radius, &pitch, &yaw);
 
@@ -444,17 +482,13 @@ Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo)
         gSPDisplayList(gfx++, &tiny_bubble_dl_0B006CD8); // snowflake with blue edge
     }
 
-    for (i = 0; i < gSnowParticleCount; i += 5) {
-        append_snowflake_vertex_buffer(gfx++, i, (s16 *) &vertex1, (s16 *) &vertex2, (s16 *) &vertex3);
-
-        gSP1Triangle(gfx++, 0, 1, 2, 0);
-        gSP1Triangle(gfx++, 3, 4, 5, 0);
-        gSP1Triangle(gfx++, 6, 7, 8, 0);
-        gSP1Triangle(gfx++, 9, 10, 11, 0);
-        gSP1Triangle(gfx++, 12, 13, 14, 0);
+    vertBuf = envfx_make_snowflake_vertices(count, (s16 *) &vertex1, (s16 *) &vertex2, (s16 *) &vertex3);
+    if (vertBuf != NULL) {
+        gfx = envfx_append_particle_triangles(gfx, vertBuf, count);
     }
 
-    gSPDisplayList(gfx++, &tiny_bubble_dl_0B006AB0) gSPEndDisplayList(gfx++);
+    gSPDisplayList(gfx++, &tiny_bubble_dl_0B006AB0);
+    gSPEndDisplayList(gfx++);
 
     return gfxStart;
 }
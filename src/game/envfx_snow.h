@@ -13,17 +13,29 @@ struct EnvFxParticle {
     s32 angleAndDist[2]; // for whirpools, [0] = angle from center, [1] = distance from center
     s32 unusedBubbleVar; // set to zero for bubbles when respawning, never used elsewhere
     s32 bubbleY; // for Bubbles, yPos is always set to this
-    u8 filler[24];
 };
 
+// Highest particle count any environment effect uses, and the default of gEnvFxParticleLimit.
+#define ENVFX_MAX_PARTICLES 140
+
+// Particles whose vertices fit in the RSP vertex cache at once, at three vertices each.
+#define ENVFX_PARTICLES_PER_VTX_LOAD 10
+
+// Upper bound of the commands envfx_append_particle_triangles writes for n particles,
+// plus the three the callers add around them.
+#define ENVFX_PARTICLE_GFX_COUNT(n) \
+    ((((n) + ENVFX_PARTICLES_PER_VTX_LOAD - 1) / ENVFX_PARTICLES_PER_VTX_LOAD) + (((n) + 1) / 2) + 3)
+
 extern s8 gEnvFxMode;
 
 extern struct EnvFxParticle *gEnvFxBuffer;
 extern Vec3i gSnowCylinderLastPos;
 extern s16 gSnowParticleCount;
+extern s16 gEnvFxParticleLimit;
 
 Gfx *envfx_update_particles(s32 mode, Vec3s marioPos, Vec3s camTo, Vec3s camFrom);
 void orbit_from_positions(Vec3s from, Vec3s to, s16 *radius, s16 *pitch, s16 *yaw);
+Gfx *envfx_append_particle_triangles(Gfx *gfx, Vtx *vertBuf, s32 count);
 void rotate_triangle_vertices(Vec3s vertex1, Vec3s vertex2, Vec3s vertex3, s16 pitch, s16 yaw);
 
 #endif // ENVFX_SNOW_H
@@ -3,6 +3,7 @@
 #include "frame_lerp.h"
 #include "main.h"
 #include "game_init.h"
+#include "object_list_processor.h"
 #include <PR/os_internal_reg.h>
 
 u32 gFrameLerpRenderFrame;
@@ -65,6 +66,24 @@ void frameLerp_cache_pos(f32 * realPosPtr, f32 * cachePosPtr, f32 * cachePosVide
     sCachedPosCt++;
 }
 
+struct ShadowFloor * sCachedShadowUpdateRealList[OBJECT_POOL_CAPACITY];
+struct ShadowFloor * sCachedShadowUpdateCacheList[OBJECT_POOL_CAPACITY];
+struct ShadowFloor * sCachedShadowUpdateCacheVideoList[OBJECT_POOL_CAPACITY];
+int sCachedShadowCt = 0;
+int sCacheShadowTotal = 0;
+
+// Shadow floors go through the same caches as positions, so the render path reads the ones
+// from the same game frame as the positions it interpolates.
+void frameLerp_cache_shadow(struct ShadowFloor * realPtr, struct ShadowFloor * cachePtr, struct ShadowFloor * cacheVideoPtr) {
+    if (sCachedShadowCt >= OBJECT_POOL_CAPACITY) {
+        return;
+    }
+    sCachedShadowUpdateRealList[sCachedShadowCt] = realPtr;
+    sCachedShadowUpdateCacheList[sCachedShadowCt] = cachePtr;
+    sCachedShadowUpdateCacheVideoList[sCachedShadowCt] = cacheVideoPtr;
+    sCachedShadowCt++;
+}
+
 void frameLerp_update_pos_cache(void) {
     u32 mask = __osDisableInt();
     for (int i = 0; i < sCachedPosCt; i++) {
@@ -72,6 +91,11 @@ void frameLerp_update_pos_cache(void) {
     }
     sCachePosTotal = sCachedPosCt;
     sCachedPosCt = 0;
+    for (int i = 0; i < sCachedShadowCt; i++) {
+        *sCachedShadowUpdateCacheList[i] = *sCachedShadowUpdateRealList[i];
+    }
+    sCacheShadowTotal = sCachedShadowCt;
+    sCachedShadowCt = 0;
     __osRestoreInt(mask);
 }
 
@@ -80,5 +104,8 @@ void frameLerp_update_pos_video_cache(void) {
     for (int i = 0; i < sCachePosTotal; i++) {
         vec3f_copy( sCachedPosUpdateCacheVideoList[i], sCachedPosUpdateCacheList[i] );
     }
+    for (int i = 0; i < sCacheShadowTotal; i++) {
+        *sCachedShadowUpdateCacheVideoList[i] = *sCachedShadowUpdateCacheList[i];
+    }
     __osRestoreInt(mask);
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ f32 * frameLerpRot(Quat rot, Quat rotValue);
 f32 frameLerpFloat(f32 f, f32 lerpValue);
 
 void frameLerp_cache_pos(f32 * realPosPtr, f32 * cachePosPtr, f32 * cachePosVideoPtr);
+void frameLerp_cache_shadow(struct ShadowFloor * realPtr, struct ShadowFloor * cachePtr, struct ShadowFloor * cacheVideoPtr);
 void frameLerp_update_pos_cache(void);
 void frameLerp_update_pos_video_cache(void);
 
@@ -30,6 +30,8 @@
 #include "debug_box.h"
 #include "vc_ultra.h"
 #include "profiling.h"
+#include "map_parser.h"
+#include "telemetry.h"
 #include "emutest.h"
 #include "frame_lerp.h"
 #include "level_update.h"
@@ -383,6 +385,7 @@ void end_master_display_list(void) {
 
     gDPFullSync(gDisplayListHead++);
     gSPEndDisplayList(gDisplayListHead++);
+    telemetry_record_gfx_pool();
 
     create_gfx_task_structure();
 }
@@ -768,6 +771,10 @@ void setup_game_memory(void) {
     load_segment(SEGMENT_LEVEL_ENTRY, _entrySegmentRomStart, _entrySegmentRomEnd, MEMORY_POOL_LEFT, NULL, NULL);
     // Setup Segment 2 (Fonts, Text, etc)
     load_segment_decompress(SEGMENT_SEGMENT2, _segment2_mio0SegmentRomStart, _segment2_mio0SegmentRomEnd);
+#ifdef PROFILER_SAMPLING
+    // Loaded before any pool state is pushed, so a level unload can never free it.
+    map_data_load();
+#endif
 }
 
 /**
@@ -809,6 +816,7 @@ void thread5_game_loop(UNUSED void *arg) {
                 draw_reset_bars();
                 continue;
             }
+            telemetry_send_frame();
 #ifdef PUPPYPRINT_DEBUG
         bzero(&gPuppyCallCounter, sizeof(gPuppyCallCounter));
 #endif
@@ -81,6 +81,7 @@ extern u8 gDemoInputs[];
 
 extern u16 sRenderingFramebuffer;
 extern u32 gGlobalTimer;
+extern u32 gGraphicsTimer;
 extern u8 gLevelChangeSpinlockState;
 
 void setup_game_memory(void);
@@ -247,7 +247,6 @@ void spawn_special_objects(s32 areaIndex, TerrainData **specialObjList) {
     }
 }
 
-#ifdef NO_SEGMENTED_MEMORY
 u32 get_special_objects_size(s16 *data) {
     s16 *startPos = data;
     s32 i;
@@ -290,4 +289,3 @@ u32 get_special_objects_size(s16 *data) {
 
     return data - startPos;
 }
-#endif
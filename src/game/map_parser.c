@@ -3,19 +3,40 @@
 #include <stdarg.h>
 #include <string.h>
 #include "segments.h"
+#include "memory.h"
+#include "map_parser.h"
 
 #define STACK_TRAVERSAL_LIMIT 100
 
+// Where the map data segment is linked, and where the crash screen loads it.
+#define MAP_DATA_ADDRESS (RAM_END - 0x100000)
+
 struct MapEntry {
 	u32 addr;
 	u32 nm_offset;
-	u32 nm_len;
-	u32 pad;
 };
+
+// Bucket table written by tools/mapPacker.py. firstEntry[i] is the first entry
+// at or above base + (i << shift), for count + 1 buckets.
+struct MapIndex {
+	u32 base;
+	u32 shift;
+	u32 count;
+	u16 firstEntry[];
+};
+
 extern u8 gMapStrings[];
 extern struct MapEntry gMapEntries[];
 extern u32 gMapEntrySize;
+extern struct MapIndex gMapIndex;
 extern u8 _mapDataSegmentRomStart[];
+extern u8 _mapDataSegmentRomEnd[];
+
+// Where the map data currently is in RAM, or NULL while it isn't loaded.
+static u8 *sMapData = NULL;
+
+// The map symbols are linked at MAP_DATA_ADDRESS; this finds them wherever the data was loaded.
+#define MAP_PTR(type, sym) ((type)((u32)(sym) - MAP_DATA_ADDRESS + (u32)sMapData))
 
 
 // code provided by Wiseguy
@@ -37,24 +58,131 @@ static u32 headless_pi_status(void)
 
 
 void map_data_init(void) {
-	headless_dma((u32)_mapDataSegmentRomStart, (u32*)(RAM_END - 0x100000), 0x100000);
+	headless_dma((u32)_mapDataSegmentRomStart, (u32*)MAP_DATA_ADDRESS, 0x100000);
 	while (headless_pi_status() & (PI_STATUS_DMA_BUSY | PI_STATUS_ERROR));
+	sMapData = (u8 *) MAP_DATA_ADDRESS;
 }
 
-char *parse_map(u32 pc) {
-	u32 i;
+/**
+ * Load the map data into the main pool so symbols can be looked up while the game runs.
+ * This has to be called at boot, before the level scripts push any pool state, since popping
+ * that state would free the map while sMapData still points at it.
+ * The crash screen loads it on its own, on top of whatever is at the end of RAM.
+ * Returns whether the map is available.
+ */
+s32 map_data_load(void) {
+	u32 size = _mapDataSegmentRomEnd - _mapDataSegmentRomStart;
+	u8 *data;
+
+	if (sMapData != NULL) {
+		return TRUE;
+	}
+
+	if (size == 0) {
+		return FALSE;
+	}
+
+	data = main_pool_alloc(ALIGN16(size), MEMORY_POOL_RIGHT);
+	if (data == NULL) {
+		return FALSE;
+	}
+
+	dma_read(data, _mapDataSegmentRomStart, _mapDataSegmentRomEnd);
+	sMapData = data;
+	return TRUE;
+}
 
-	for (i = 0; i < gMapEntrySize; i++) {
-		if (gMapEntries[i].addr >= pc) break;
+s32 map_data_is_loaded(void) {
+	return (sMapData != NULL);
+}
+
+/**
+ * Find the function containing addr, as an index into the map.
+ * The bucket table narrows the search down to the functions starting in addr's
+ * 4KB page, which are then binary searched. Returns -1 if addr isn't in any function.
+ */
+s32 map_symbol_index(u32 addr) {
+	struct MapEntry *entries;
+	struct MapIndex *index;
+	s32 lo, hi, mid, result;
+	u32 bucket;
+
+	if (sMapData == NULL) {
+		return -1;
 	}
 
-	if (i == gMapEntrySize - 1) {
+	entries = MAP_PTR(struct MapEntry *, gMapEntries);
+	index = MAP_PTR(struct MapIndex *, &gMapIndex);
+
+	if (index->count == 0 || addr < index->base) {
+		return -1;
+	}
+
+	bucket = (addr - index->base) >> index->shift;
+	if (bucket >= index->count) {
+		return index->firstEntry[index->count] - 1;
+	}
+
+	// Every entry before the bucket starts below addr, so the last of them is the fallback.
+	lo = index->firstEntry[bucket];
+	hi = index->firstEntry[bucket + 1];
+	result = lo - 1;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (entries[mid].addr <= addr) {
+			result = mid;
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Name and start address of the function with the given map index.
+ */
+const char *map_symbol_name(s32 symbol) {
+	if (sMapData == NULL || symbol < 0 || (u32) symbol >= *MAP_PTR(u32 *, &gMapEntrySize)) {
 		return NULL;
-	} else {
-		return (char*) ((u32)gMapStrings + gMapEntries[i - 1].nm_offset);
 	}
+
+	return MAP_PTR(const char *, gMapStrings) + MAP_PTR(struct MapEntry *, gMapEntries)[symbol].nm_offset;
 }
 
+u32 map_symbol_address(s32 symbol) {
+	if (sMapData == NULL || symbol < 0 || (u32) symbol >= *MAP_PTR(u32 *, &gMapEntrySize)) {
+		return 0;
+	}
+
+	return MAP_PTR(struct MapEntry *, gMapEntries)[symbol].addr;
+}
+
+/**
+ * Name of the function containing addr, or NULL. If offset isn't NULL,
+ * it is set to the distance of addr from the start of the function.
+ */
+const char *map_symbol_lookup(u32 addr, u32 *offset) {
+	s32 symbol = map_symbol_index(addr);
+
+	if (symbol < 0) {
+		return NULL;
+	}
+
+	if (offset != NULL) {
+		*offset = addr - map_symbol_address(symbol);
+	}
+
+	return map_symbol_name(symbol);
+}
+
+char *parse_map(u32 pc) {
+	return (char *) map_symbol_lookup(pc, NULL);
+}
+
+
 extern u8 _mainSegmentStart[];
 extern u8 _mainSegmentTextEnd[];
 extern u8 _engineSegmentStart[];
@@ -0,0 +1,21 @@
+#ifndef MAP_PARSER_H
+#define MAP_PARSER_H
+
+#include <PR/ultratypes.h>
+
+// Symbol lookups against the function map packed into the ROM by tools/mapPacker.py.
+// The map has to be loaded first, with map_data_load() at boot (or by the crash screen).
+
+void map_data_init(void);
+s32 map_data_load(void);
+s32 map_data_is_loaded(void);
+
+s32 map_symbol_index(u32 addr);
+const char *map_symbol_name(s32 symbol);
+u32 map_symbol_address(s32 symbol);
+const char *map_symbol_lookup(u32 addr, u32 *offset);
+
+char *parse_map(u32 pc);
+char *find_function_in_stack(u32 *sp);
+
+#endif // MAP_PARSER_H
@@ -604,6 +604,8 @@ Gfx *geo_render_mirror_mario(s32 callContext, struct GraphNode *node, UNUSED Mat
                 vec3f_copy(gMirrorMario.scale, mario->header.gfx.scale);
 
                 gMirrorMario.animInfo = mario->header.gfx.animInfo;
+                // The mirror room floor is flat, so Mario's shadow floor works for his reflection too.
+                gMirrorMario.shadowFloorVideoCache = mario->header.gfx.shadowFloorVideoCache;
                 mirroredX = CASTLE_MIRROR_X - gMirrorMario.pos[0];
                 gMirrorMario.pos[0] = mirroredX + CASTLE_MIRROR_X;
                 gMirrorMario.angle[1] = -gMirrorMario.angle[1];
@@ -274,20 +274,22 @@ s32 stationary_ground_step(struct MarioState *m) {
 }
 
 static s32 perform_ground_quarter_step(struct MarioState *m, Vec3f nextPos) {
-    struct WallCollisionData lowerWall, upperWall;
-    struct Surface *ceil, *floor;
+    struct CollisionProbe probe;
+    struct WallCollisionData *upperWall = &probe.walls[1];
 
     s16 i;
     s16 wallDYaw;
     s32 oldWallDYaw;
 
-    resolve_and_return_wall_collisions(nextPos, 30.0f, 24.0f, &lowerWall);
-    resolve_and_return_wall_collisions(nextPos, 60.0f, 50.0f, &upperWall);
+    collision_probe_init(&probe, (PROBE_FIND_FLOOR | PROBE_FIND_CEIL | PROBE_FIND_WATER));
+    collision_probe_add_wall_check(&probe, 30.0f, 24.0f);
+    collision_probe_add_wall_check(&probe, 60.0f, 50.0f);
+    find_collision_probe(nextPos, &probe);
 
-    f32 floorHeight = find_floor(nextPos[0], nextPos[1], nextPos[2], &floor);
-    f32 ceilHeight = find_mario_ceil(nextPos, floorHeight, &ceil);
-
-    f32 waterLevel = find_water_level(nextPos[0], nextPos[2]);
+    struct Surface *floor = probe.floor;
+    f32 floorHeight = probe.floorHeight;
+    f32 ceilHeight = probe.ceilHeight;
+    f32 waterLevel = probe.waterLevel;
 
     if (floor == NULL) {
         return GROUND_STEP_HIT_WALL_STOP_QSTEPS;
@@ -327,11 +329,11 @@ static s32 perform_ground_quarter_step(struct MarioState *m, Vec3f nextPos) {
     } else {
         oldWallDYaw = 0x0;
     }
-    for (i = 0; i < upperWall.numWalls; i++) {
-        wallDYaw = abs_angle_diff(SURFACE_YAW(upperWall.walls[i]), m->faceAngle[1]);
+    for (i = 0; i < upperWall->numWalls; i++) {
+        wallDYaw = abs_angle_diff(SURFACE_YAW(upperWall->walls[i]), m->faceAngle[1]);
         if (wallDYaw > oldWallDYaw) {
             oldWallDYaw = wallDYaw;
-            set_mario_wall(m, upperWall.walls[i]);
+            set_mario_wall(m, upperWall->walls[i]);
         }
 
         if (wallDYaw >= DEGREES(60) && wallDYaw <= DEGREES(120)) {
@@ -459,19 +461,24 @@ s32 perform_air_quarter_step(struct MarioState *m, Vec3f intendedPos, u32 stepAr
     s32 stepResult = AIR_STEP_NONE;
 
     Vec3f nextPos, ledgePos;
-    struct WallCollisionData upperWall, lowerWall;
-    struct Surface *ceil, *floor, *ledgeFloor;
+    struct CollisionProbe probe;
+    struct WallCollisionData *upperWall = &probe.walls[0];
+    struct WallCollisionData *lowerWall = &probe.walls[1];
+    struct Surface *ledgeFloor;
     struct Surface *grabbedWall = NULL;
 
     vec3f_copy(nextPos, intendedPos);
 
-    resolve_and_return_wall_collisions(nextPos, 150.0f, 50.0f, &upperWall);
-    resolve_and_return_wall_collisions(nextPos, 30.0f, 50.0f, &lowerWall);
-
-    f32 floorHeight = find_floor(nextPos[0], nextPos[1], nextPos[2], &floor);
-    f32 ceilHeight = find_mario_ceil(nextPos, floorHeight, &ceil);
+    collision_probe_init(&probe, (PROBE_FIND_FLOOR | PROBE_FIND_CEIL | PROBE_FIND_WATER));
+    collision_probe_add_wall_check(&probe, 150.0f, 50.0f);
+    collision_probe_add_wall_check(&probe, 30.0f, 50.0f);
+    find_collision_probe(nextPos, &probe);
 
-    f32 waterLevel = find_water_level(nextPos[0], nextPos[2]);
+    struct Surface *ceil = probe.ceil;
+    struct Surface *floor = probe.floor;
+    f32 floorHeight = probe.floorHeight;
+    f32 ceilHeight = probe.ceilHeight;
+    f32 waterLevel = probe.waterLevel;
 
     //! The water pseudo floor is not referenced when your intended qstep is
     // out of bounds, so it won't detect you as landing.
@@ -536,9 +543,9 @@ s32 perform_air_quarter_step(struct MarioState *m, Vec3f intendedPos, u32 stepAr
     //! When the wall is not completely vertical or there is a slight wall
     // misalignment, you can activate these conditions in unexpected situations
 
-    if ((stepArg & AIR_STEP_CHECK_LEDGE_GRAB) && upperWall.numWalls == 0 && lowerWall.numWalls != 0) {
-        for (i = 0; i < lowerWall.numWalls; i++) {
-            grabbedWall = check_ledge_grab(m, grabbedWall, lowerWall.walls[i], intendedPos, nextPos, ledgePos, &ledgeFloor);
+    if ((stepArg & AIR_STEP_CHECK_LEDGE_GRAB) && upperWall->numWalls == 0 && lowerWall->numWalls != 0) {
+        for (i = 0; i < lowerWall->numWalls; i++) {
+            grabbedWall = check_ledge_grab(m, grabbedWall, lowerWall->walls[i], intendedPos, nextPos, ledgePos, &ledgeFloor);
             if (grabbedWall != NULL) {
                 stepResult = AIR_STEP_GRABBED_LEDGE;
             }
@@ -559,14 +566,14 @@ s32 perform_air_quarter_step(struct MarioState *m, Vec3f intendedPos, u32 stepAr
     vec3f_copy(m->pos, nextPos);
     set_mario_floor(m, floor, floorHeight);
 
-    if (upperWall.numWalls > 0) {
-        stepResult  = bonk_or_hit_lava_wall(m, &upperWall);
+    if (upperWall->numWalls > 0) {
+        stepResult  = bonk_or_hit_lava_wall(m, upperWall);
         if (stepResult != AIR_STEP_NONE) {
             return stepResult;
         }
     }
 
-    return (lowerWall.numWalls > 0) ? bonk_or_hit_lava_wall(m, &lowerWall) : AIR_STEP_NONE;
+    return (lowerWall->numWalls > 0) ? bonk_or_hit_lava_wall(m, lowerWall) : AIR_STEP_NONE;
 }
 
 void apply_twirl_gravity(struct MarioState *m) {
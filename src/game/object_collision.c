@@ -80,7 +80,8 @@ s32 detect_object_hurtbox_overlap(struct Object *a, struct Object *b) {
     return FALSE;
 }
 
-void clear_object_collision(struct Object *a) {
+void clear_object_collision(s32 listIndex) {
+    struct Object *a = (struct Object *) &gObjectLists[listIndex];
     struct Object *nextObj = (struct Object *) a->header.next;
 
     while (nextObj != a) {
@@ -91,45 +92,69 @@ void clear_object_collision(struct Object *a) {
         }
         nextObj = (struct Object *) nextObj->header.next;
     }
+
+    capture_object_hot_data(listIndex);
 }
 
-void check_collision_in_list(struct Object *a, struct Object *b, struct Object *c) {
-    if (a->oIntangibleTimer == 0) {
-        while (b != c) {
-            if (b->oIntangibleTimer == 0) {
-                if (detect_object_hitbox_overlap(a, b) && b->hurtboxRadius != 0.0f) {
-                    detect_object_hurtbox_overlap(a, b);
+/**
+ * Check a against the objects at positions [first, end) of gObjectHotData.order.
+ * Pairs are rejected from the hot data mirror first, so only objects whose hitbox
+ * cylinders overlap are touched.
+ */
+void check_collision_in_list(struct Object *a, s32 first, s32 end) {
+    struct ObjectHotData *hot = &gObjectHotData;
+    s32 aSlot = OBJECT_POOL_SLOT(a);
+
+    if (hot->intangibleTimer[aSlot] == 0) {
+        f32 ax = hot->posX[aSlot];
+        f32 az = hot->posZ[aSlot];
+        f32 aRadius = hot->hitboxRadius[aSlot];
+        f32 aBottom = hot->hitboxBottom[aSlot];
+        f32 aTop = hot->hitboxHeight[aSlot] + aBottom;
+
+        for (s32 i = first; i < end; i++) {
+            s32 bSlot = hot->order[i];
+
+            if (hot->intangibleTimer[bSlot] == 0) {
+                f32 dx = ax - hot->posX[bSlot];
+                f32 dz = az - hot->posZ[bSlot];
+                f32 collisionRadius = aRadius + hot->hitboxRadius[bSlot];
+                f32 bBottom = hot->hitboxBottom[bSlot];
+
+                if (sqr(collisionRadius) > (sqr(dx) + sqr(dz))
+                    && aBottom <= (hot->hitboxHeight[bSlot] + bBottom)
+                    && aTop >= bBottom) {
+                    struct Object *b = &gObjectPool[bSlot];
+
+                    if (detect_object_hitbox_overlap(a, b) && b->hurtboxRadius != 0.0f) {
+                        detect_object_hurtbox_overlap(a, b);
+                    }
                 }
             }
-            b = (struct Object *) b->header.next;
         }
     }
 }
 
+// Check a against every object of the given list.
+#define check_collision_with_list(a, listIndex) \
+    check_collision_in_list((a), gObjectHotData.listStart[listIndex], gObjectHotData.listEnd[listIndex])
+
+// Check a against the objects that follow it in its own list.
+#define check_collision_with_rest_of_list(a, listIndex) \
+    check_collision_in_list((a), gObjectHotData.listPos[OBJECT_POOL_SLOT(a)] + 1, gObjectHotData.listEnd[listIndex])
+
 void check_player_object_collision(void) {
     struct Object *playerObj = (struct Object *) &gObjectLists[OBJ_LIST_PLAYER];
     struct Object   *nextObj = (struct Object *) playerObj->header.next;
 
     while (nextObj != playerObj) {
-        check_collision_in_list(nextObj, (struct Object *) nextObj->header.next, playerObj);
-        check_collision_in_list(nextObj,
-                      (struct Object *)  gObjectLists[OBJ_LIST_POLELIKE].next,
-                      (struct Object *) &gObjectLists[OBJ_LIST_POLELIKE]);
-        check_collision_in_list(nextObj,
-                      (struct Object *)  gObjectLists[OBJ_LIST_LEVEL].next,
-                      (struct Object *) &gObjectLists[OBJ_LIST_LEVEL]);
-        check_collision_in_list(nextObj,
-                      (struct Object *)  gObjectLists[OBJ_LIST_GENACTOR].next,
-                      (struct Object *) &gObjectLists[OBJ_LIST_GENACTOR]);
-        check_collision_in_list(nextObj,
-                      (struct Object *)  gObjectLists[OBJ_LIST_PUSHABLE].next,
-                      (struct Object *) &gObjectLists[OBJ_LIST_PUSHABLE]);
-        check_collision_in_list(nextObj,
-                      (struct Object *)  gObjectLists[OBJ_LIST_SURFACE].next,
-                      (struct Object *) &gObjectLists[OBJ_LIST_SURFACE]);
-        check_collision_in_list(nextObj,
-                      (struct Object *)  gObjectLists[OBJ_LIST_DESTRUCTIVE].next,
-                      (struct Object *) &gObjectLists[OBJ_LIST_DESTRUCTIVE]);
+        check_collision_with_rest_of_list(nextObj, OBJ_LIST_PLAYER);
+        check_collision_with_list(nextObj, OBJ_LIST_POLELIKE);
+        check_collision_with_list(nextObj, OBJ_LIST_LEVEL);
+        check_collision_with_list(nextObj, OBJ_LIST_GENACTOR);
+        check_collision_with_list(nextObj, OBJ_LIST_PUSHABLE);
+        check_collision_with_list(nextObj, OBJ_LIST_SURFACE);
+        check_collision_with_list(nextObj, OBJ_LIST_DESTRUCTIVE);
         nextObj = (struct Object *) nextObj->header.next;
     }
 }
@@ -139,7 +164,7 @@ void check_pushable_object_collision(void) {
     struct Object *nextObj = (struct Object *) pushableObj->header.next;
 
     while (nextObj != pushableObj) {
-        check_collision_in_list(nextObj, (struct Object *) nextObj->header.next, pushableObj);
+        check_collision_with_rest_of_list(nextObj, OBJ_LIST_PUSHABLE);
         nextObj = (struct Object *) nextObj->header.next;
     }
 }
@@ -150,26 +175,24 @@ void check_destructive_object_collision(void) {
 
     while (nextObj != destructiveObj) {
         if (nextObj->oDistanceToMario < 2000.0f && !(nextObj->activeFlags & ACTIVE_FLAG_DESTRUCTIVE_OBJ_DONT_DESTROY)) {
-            check_collision_in_list(nextObj, (struct Object *) nextObj->header.next, destructiveObj);
-            check_collision_in_list(nextObj, (struct Object *) gObjectLists[OBJ_LIST_GENACTOR].next,
-                          (struct Object *) &gObjectLists[OBJ_LIST_GENACTOR]);
-            check_collision_in_list(nextObj, (struct Object *) gObjectLists[OBJ_LIST_PUSHABLE].next,
-                          (struct Object *) &gObjectLists[OBJ_LIST_PUSHABLE]);
-            check_collision_in_list(nextObj, (struct Object *) gObjectLists[OBJ_LIST_SURFACE].next,
-                          (struct Object *) &gObjectLists[OBJ_LIST_SURFACE]);
+            check_collision_with_rest_of_list(nextObj, OBJ_LIST_DESTRUCTIVE);
+            check_collision_with_list(nextObj, OBJ_LIST_GENACTOR);
+            check_collision_with_list(nextObj, OBJ_LIST_PUSHABLE);
+            check_collision_with_list(nextObj, OBJ_LIST_SURFACE);
         }
         nextObj = (struct Object *) nextObj->header.next;
     }
 }
 
 void detect_object_collisions(void) {
-    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_POLELIKE]);
-    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_PLAYER]);
-    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_PUSHABLE]);
-    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_GENACTOR]);
-    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_LEVEL]);
-    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_SURFACE]);
-    clear_object_collision((struct Object *) &gObjectLists[OBJ_LIST_DESTRUCTIVE]);
+    gObjectHotData.count = 0;
+    clear_object_collision(OBJ_LIST_POLELIKE);
+    clear_object_collision(OBJ_LIST_PLAYER);
+    clear_object_collision(OBJ_LIST_PUSHABLE);
+    clear_object_collision(OBJ_LIST_GENACTOR);
+    clear_object_collision(OBJ_LIST_LEVEL);
+    clear_object_collision(OBJ_LIST_SURFACE);
+    clear_object_collision(OBJ_LIST_DESTRUCTIVE);
     check_player_object_collision();
     check_destructive_object_collision();
     check_pushable_object_collision();
@@ -23,6 +23,7 @@
 #include "obj_behaviors.h"
 #include "object_helpers.h"
 #include "object_list_processor.h"
+#include "puppyprint.h"
 #include "rendering_graph_node.h"
 #include "spawn_object.h"
 #include "spawn_sound.h"
@@ -591,16 +592,16 @@ f32 cur_obj_dist_to_nearest_object_with_behavior(const BehaviorScript *behavior)
 
 struct Object *cur_obj_find_nearest_object_with_behavior(const BehaviorScript *behavior, f32 *dist) {
     uintptr_t *behaviorAddr = segmented_to_virtual(behavior);
-    struct ObjectNode *listHead = &gObjectLists[get_object_list_from_behavior(behaviorAddr)];
-    struct Object *obj = (struct Object *) listHead->next;
     struct Object *closestObj = NULL;
     f32 minDist = 0x20000;
+    s32 slot = bhv_registry_first(behaviorAddr);
 
-    while (obj != (struct Object *) listHead) {
-        if (obj->behavior == behaviorAddr
-            && obj->activeFlags != ACTIVE_FLAG_DEACTIVATED
-            && obj != o
-        ) {
+    PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.object_scans_avoided);
+
+    while (slot >= 0) {
+        struct Object *obj = &gObjectPool[slot];
+
+        if (obj->activeFlags != ACTIVE_FLAG_DEACTIVATED && obj != o) {
             f32 objDist = dist_between_objects(o, obj);
             if (objDist < minDist) {
                 closestObj = obj;
@@ -608,7 +609,7 @@ struct Object *cur_obj_find_nearest_object_with_behavior(const BehaviorScript *b
             }
         }
 
-        obj = (struct Object *) obj->header.next;
+        slot = gBhvRegistryNext[slot];
     }
 
     *dist = minDist;
@@ -640,20 +641,8 @@ s32 count_unimportant_objects(void) {
 }
 
 s32 count_objects_with_behavior(const BehaviorScript *behavior) {
-    uintptr_t *behaviorAddr = segmented_to_virtual(behavior);
-    struct ObjectNode *listHead = &gObjectLists[get_object_list_from_behavior(behaviorAddr)];
-    struct ObjectNode *obj = listHead->next;
-    s32 count = 0;
-
-    while (listHead != obj) {
-        if (((struct Object *) obj)->behavior == behaviorAddr) {
-            count++;
-        }
-
-        obj = obj->next;
-    }
-
-    return count;
+    PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.object_scans_avoided);
+    return bhv_registry_count(segmented_to_virtual(behavior));
 }
 
 struct Object *cur_obj_find_nearby_held_actor(const BehaviorScript *behavior, f32 maxDist) {
@@ -1167,11 +1156,13 @@ s32 obj_check_if_collided_with_object(struct Object *obj1, struct Object *obj2)
 }
 
 void cur_obj_set_behavior(const BehaviorScript *behavior) {
-    o->behavior = segmented_to_virtual(behavior);
+    obj_set_behavior(o, behavior);
 }
 
 void obj_set_behavior(struct Object *obj, const BehaviorScript *behavior) {
+    bhv_registry_remove(obj);
     obj->behavior = segmented_to_virtual(behavior);
+    bhv_registry_add(obj);
 }
 
 s32 cur_obj_has_behavior(const BehaviorScript *behavior) {
@@ -1363,8 +1354,7 @@ s32 cur_obj_resolve_wall_collisions(void) {
     return FALSE;
 }
 
-static void cur_obj_update_floor(void) {
-    struct Surface *floor = cur_obj_update_floor_height_and_get_floor();
+static void cur_obj_set_floor(struct Surface *floor) {
     o->oFloor = floor;
 
     if (floor != NULL) {
@@ -1377,6 +1367,45 @@ static void cur_obj_update_floor(void) {
     }
 }
 
+static void cur_obj_update_floor(void) {
+    cur_obj_set_floor(cur_obj_update_floor_height_and_get_floor());
+}
+
+/**
+ * Same as cur_obj_resolve_wall_collisions followed by cur_obj_update_floor,
+ * with a single collision probe.
+ */
+static s32 cur_obj_resolve_wall_collisions_and_update_floor(void) {
+    struct CollisionProbe probe;
+    struct WallCollisionData *wallData = &probe.walls[0];
+    f32 radius = o->oWallHitboxRadius;
+    s32 hitWall = FALSE;
+    Vec3f pos;
+
+    collision_probe_init(&probe, PROBE_FIND_FLOOR);
+
+    if (radius > 0.1f) {
+        // Walls are checked from the truncated position, which find_floor would truncate to anyway.
+        vec3f_set(pos, (s16) o->oPosX, (s16) o->oPosY, (s16) o->oPosZ);
+        collision_probe_add_wall_check(&probe, 10.0f, radius);
+    } else {
+        vec3f_copy(pos, &o->oPosVec);
+    }
+
+    find_collision_probe(pos, &probe);
+
+    if (probe.numWallChecks != 0 && wallData->numWalls != 0) {
+        vec3f_copy(&o->oPosVec, pos);
+        o->oWallAngle = SURFACE_YAW(wallData->walls[wallData->numWalls - 1]);
+        hitWall = (abs_angle_diff(o->oWallAngle, o->oMoveAngleYaw) > 0x4000);
+    }
+
+    o->oFloorHeight = probe.floorHeight;
+    cur_obj_set_floor(probe.floor);
+
+    return hitWall;
+}
+
 static void cur_obj_update_floor_and_resolve_wall_collisions(s16 steepSlopeDegrees) {
     if (o->activeFlags & (ACTIVE_FLAG_FAR_AWAY | ACTIVE_FLAG_IN_DIFFERENT_ROOM)) {
         cur_obj_update_floor();
@@ -1387,12 +1416,10 @@ static void cur_obj_update_floor_and_resolve_wall_collisions(s16 steepSlopeDegre
         }
     } else {
         o->oMoveFlags &= ~OBJ_MOVE_HIT_WALL;
-        if (cur_obj_resolve_wall_collisions()) {
+        if (cur_obj_resolve_wall_collisions_and_update_floor()) {
             o->oMoveFlags |= OBJ_MOVE_HIT_WALL;
         }
 
-        cur_obj_update_floor();
-
         if (o->oPosY > o->oFloorHeight) {
             o->oMoveFlags |= OBJ_MOVE_IN_AIR;
         }
@@ -20,6 +20,9 @@
 #include "platform_displacement.h"
 #include "spawn_object.h"
 #include "puppyprint.h"
+#include "frame_lerp.h"
+#include "shadow.h"
+#include "game_init.h"
 #include "profiling.h"
 
 
@@ -282,18 +285,117 @@ void bhv_mario_update(void) {
     }
 }
 
+#ifdef DISTANCE_BASED_UPDATE_RATES
+/**
+ * Return how many frames ago the object last ran its behavior, if it opted into
+ * reduced update rates and is far enough from both Mario and the camera to skip
+ * it this frame, or 0 if it should update now. Objects with the same period are
+ * staggered across frames by their pool slot.
+ */
+static u32 obj_skipped_update_phase(struct Object *obj, u32 *period) {
+    f32 distSq, camDistSq;
+
+    if (!(obj->oFlags & OBJ_FLAG_REDUCED_UPDATE_RATE)
+        || obj->oHeldState != HELD_FREE
+        || obj->collisionData != NULL
+        || gMarioObject == NULL) {
+        return 0;
+    }
+
+    vec3f_get_dist_squared(&obj->oPosVec, &gMarioObject->oPosVec, &distSq);
+    vec3f_get_dist_squared(&obj->oPosVec, gLakituState.curPos, &camDistSq);
+    distSq = MIN(distSq, camDistSq);
+
+    if (distSq > sqr(UPDATE_RATE_QUARTER_DIST)) {
+        *period = 4;
+    } else if (distSq > sqr(UPDATE_RATE_HALF_DIST)) {
+        *period = 2;
+    } else {
+        return 0;
+    }
+
+    return (gGlobalTimer + OBJECT_POOL_SLOT(obj)) & (*period - 1);
+}
+
+// Steps longer than this are treated as teleports and are not interpolated on skipped frames.
+#define UPDATE_RATE_MAX_STEP 256.0f
+
+/**
+ * Run an object's behavior and remember how far it moved and turned, so that
+ * frames skipped by obj_skipped_update_phase() can interpolate towards it.
+ */
+static void obj_run_scheduled_update(struct Object *obj) {
+    Vec3f prevPos;
+    Vec3s prevAngle;
+
+    if (!(obj->oFlags & OBJ_FLAG_REDUCED_UPDATE_RATE)) {
+        cur_obj_update();
+        return;
+    }
+
+    vec3f_copy(prevPos, &obj->oPosVec);
+    vec3i_to_vec3s(prevAngle, &obj->oFaceAngleVec);
+
+    cur_obj_update();
+
+    vec3f_diff(obj->reducedUpdatePosStep, &obj->oPosVec, prevPos);
+    if (vec3_sumsq(obj->reducedUpdatePosStep) > sqr(UPDATE_RATE_MAX_STEP)) {
+        vec3_zero(obj->reducedUpdatePosStep);
+    }
+    obj->reducedUpdateAngleStep[0] = (s16)(obj->oFaceAnglePitch - prevAngle[0]);
+    obj->reducedUpdateAngleStep[1] = (s16)(obj->oFaceAngleYaw   - prevAngle[1]);
+    obj->reducedUpdateAngleStep[2] = (s16)(obj->oFaceAngleRoll  - prevAngle[2]);
+}
+
+/**
+ * Move the rendered transform of an object on a frame its behavior was skipped,
+ * phase / period of the way along the movement and rotation of its last update.
+ * The object itself, including its oTimer, only changes when its behavior runs,
+ * and the next update lands where the interpolation would have ended up.
+ */
+static void obj_interpolate_skipped_update(struct Object *obj, u32 phase, u32 period) {
+    f32 t = (f32) phase / (f32) period;
+
+    if (obj->oFlags & OBJ_FLAG_UPDATE_GFX_POS_AND_ANGLE) {
+        obj->header.gfx.pos[0] = obj->oPosX + obj->reducedUpdatePosStep[0] * t;
+        obj->header.gfx.pos[1] = obj->oPosY + obj->reducedUpdatePosStep[1] * t + obj->oGraphYOffset;
+        obj->header.gfx.pos[2] = obj->oPosZ + obj->reducedUpdatePosStep[2] * t;
+
+        obj->header.gfx.angle[0] = (obj->oFaceAnglePitch + (s32)(obj->reducedUpdateAngleStep[0] * t)) & 0xFFFF;
+        obj->header.gfx.angle[1] = (obj->oFaceAngleYaw   + (s32)(obj->reducedUpdateAngleStep[1] * t)) & 0xFFFF;
+        obj->header.gfx.angle[2] = (obj->oFaceAngleRoll  + (s32)(obj->reducedUpdateAngleStep[2] * t)) & 0xFFFF;
+    }
+
+    frameLerp_cache_pos(obj->header.gfx.pos, obj->header.gfx.posCache, obj->header.gfx.posVideoCache);
+}
+#endif
+
 /**
  * Update every object that occurs after firstObj in the given object list,
  * including firstObj itself. Return the number of objects that were updated.
  */
 s32 update_objects_starting_at(struct ObjectNode *objList, struct ObjectNode *firstObj) {
     s32 count = 0;
+#ifdef DISTANCE_BASED_UPDATE_RATES
+    u32 phase, period;
+#endif
 
     while (objList != firstObj) {
         gCurrentObject = (struct Object *) firstObj;
 
         gCurrentObject->header.gfx.node.flags |= GRAPH_RENDER_HAS_ANIMATION;
+#ifdef DISTANCE_BASED_UPDATE_RATES
+        phase = obj_skipped_update_phase(gCurrentObject, &period);
+        if (phase != 0) {
+            obj_interpolate_skipped_update(gCurrentObject, phase, period);
+        } else {
+            obj_run_scheduled_update(gCurrentObject);
+        }
+#else
         cur_obj_update();
+#endif
+        // Also on skipped frames, since the shadow follows the interpolated position.
+        update_shadow_floor(gCurrentObject);
 
         firstObj = firstObj->next;
         count++;
@@ -341,6 +443,7 @@ s32 update_objects_during_time_stop(struct ObjectNode *objList, struct ObjectNod
         if (unfrozen) {
             gCurrentObject->header.gfx.node.flags |= GRAPH_RENDER_HAS_ANIMATION;
             cur_obj_update();
+            update_shadow_floor(gCurrentObject);
         } else {
             gCurrentObject->header.gfx.node.flags &= ~GRAPH_RENDER_HAS_ANIMATION;
         }
@@ -478,7 +581,7 @@ void spawn_objects_from_info(UNUSED s32 unused, struct SpawnInfo *spawnInfo) {
             object->oBehParams2ndByte = GET_BPARAM2(spawnInfo->behaviorArg);
 
             object->behavior = script;
-            object->unused1 = 0;
+            object->nativeLoop = NULL;
 
             // Record death/collection in the SpawnInfo
             object->respawnInfoType = RESPAWN_INFO_TYPE_NORMAL;
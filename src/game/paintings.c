@@ -2,6 +2,7 @@
 
 #include "sm64.h"
 #include "area.h"
+#include "debug.h"
 #include "engine/graph_node.h"
 #include "engine/surface_collision.h"
 #include "engine/math_util.h"
@@ -144,7 +145,7 @@ f32 gPaintingMarioYPos;
 f32 gPaintingMarioZPos;
 
 /**
- * When a painting is rippling, this mesh is generated each frame using the Painting's parameters.
+ * When a painting is rippling, this mesh is updated each frame using the Painting's parameters.
  *
  * This mesh only contains the vertex positions and normals.
  * Paintings use an additional array to map textures to the mesh.
@@ -156,6 +157,30 @@ struct PaintingMeshVertex *gPaintingMesh;
  */
 Vec3f *gPaintingTriNorms;
 
+/**
+ * Storage for gPaintingMesh and gPaintingTriNorms, sized for seg2_painting_triangle_mesh.
+ * The mesh is kept between frames, so only the triangles and normals around vertices that
+ * moved since the last frame have to be recalculated.
+ */
+static struct PaintingMeshVertex sPaintingMeshBuffer[PAINTING_MESH_MAX_VTX];
+static Vec3f sPaintingTriNormsBuffer[PAINTING_MESH_MAX_TRIS];
+static u8 sPaintingVtxMoved[PAINTING_MESH_MAX_VTX];
+static u8 sPaintingTriMoved[PAINTING_MESH_MAX_TRIS];
+static u8 sPaintingMeshInitialized = FALSE;
+
+/**
+ * Each vertex's distance to the ripple origin divided by the dispersion factor, which only
+ * changes when a new ripple starts. sPaintingRippleDistKey holds the parameters it was computed from.
+ */
+static f32 sPaintingRippleDist[PAINTING_MESH_MAX_VTX];
+static struct {
+    struct Painting *painting;
+    f32 rippleX;
+    f32 rippleY;
+    f32 size;
+    f32 dispersionFactor;
+} sPaintingRippleDistKey;
+
 /**
  * The painting that is currently rippling. Only one painting can be rippling at once.
  */
@@ -659,8 +684,38 @@ s16 ripple_if_movable(struct Painting *painting, s16 movable, s16 posX, s16 posY
 }
 
 /**
- * Allocates and generates a mesh for the rippling painting effect by modifying the passed in `mesh`
- * based on the painting's current ripple state.
+ * Computes the distance of every mesh vertex to the painting's ripple origin, scaled the same way as
+ * in calculate_ripple_at_point, unless they were already computed for the same ripple.
+ */
+static void painting_cache_ripple_distances(struct Painting *painting, s16 *mesh, s16 numVtx) {
+    f32 sizeRatio = painting->size / PAINTING_SIZE;
+    s16 i;
+
+    if (sPaintingRippleDistKey.painting == painting
+        && sPaintingRippleDistKey.rippleX == painting->rippleX
+        && sPaintingRippleDistKey.rippleY == painting->rippleY
+        && sPaintingRippleDistKey.size == painting->size
+        && sPaintingRippleDistKey.dispersionFactor == painting->dispersionFactor) {
+        return;
+    }
+
+    for (i = 0; i < numVtx; i++) {
+        f32 dx = mesh[i * 3 + 1] * sizeRatio - painting->rippleX;
+        f32 dy = mesh[i * 3 + 2] * sizeRatio - painting->rippleY;
+
+        sPaintingRippleDist[i] = sqrtf(dx * dx + dy * dy) / painting->dispersionFactor;
+    }
+
+    sPaintingRippleDistKey.painting = painting;
+    sPaintingRippleDistKey.rippleX = painting->rippleX;
+    sPaintingRippleDistKey.rippleY = painting->rippleY;
+    sPaintingRippleDistKey.size = painting->size;
+    sPaintingRippleDistKey.dispersionFactor = painting->dispersionFactor;
+}
+
+/**
+ * Updates the mesh for the rippling painting effect by modifying the passed in `mesh`
+ * based on the painting's current ripple state, and marks the vertices that moved since the last frame.
  *
  * The `mesh` table describes the location of mesh vertices, whether they move when rippling, and what
  * triangles they belong to.
@@ -677,24 +732,38 @@ s16 ripple_if_movable(struct Painting *painting, s16 movable, s16 posX, s16 posY
  *
  * The mesh used in game, seg2_painting_triangle_mesh, is in bin/segment2.c.
  */
-void painting_generate_mesh(struct Painting *painting, s16 *mesh, s16 numTris) {
+void painting_generate_mesh(struct Painting *painting, s16 *mesh, s16 numVtx) {
+    f32 rippleMag = painting->currRippleMag;
+    f32 rippleRate = painting->currRippleRate * (2 * M_PI);
+    f32 rippleTimer = painting->rippleTimer;
+    // If the peaks are below 0.5, every vertex would round to 0
+    s32 rippleVisible = (absf(rippleMag) >= 0.5f);
     s16 i;
 
-    gPaintingMesh = mem_pool_alloc(gEffectsMemoryPool, numTris * sizeof(struct PaintingMeshVertex));
+    gPaintingMesh = sPaintingMeshBuffer;
+    painting_cache_ripple_distances(painting, mesh, numVtx);
 
     // accesses are off by 1 since the first entry is the number of vertices
-    for (i = 0; i < numTris; i++) {
+    for (i = 0; i < numVtx; i++) {
+        s16 rippleZ = 0;
+
+        // The "z coordinate" of each vertex in the mesh is either 1 or 0. Instead of being an
+        // actual coordinate, it just determines whether the vertex moves.
+        // Vertices the ripple hasn't reached yet stay at 0.
+        if (mesh[i * 3 + 3] && rippleVisible && rippleTimer >= sPaintingRippleDist[i]) {
+            rippleZ = round_float(rippleMag * cosf(rippleRate * (rippleTimer - sPaintingRippleDist[i])));
+        }
+
+        sPaintingVtxMoved[i] = !sPaintingMeshInitialized || gPaintingMesh[i].pos[2] != rippleZ;
         gPaintingMesh[i].pos[0] = mesh[i * 3 + 1];
         gPaintingMesh[i].pos[1] = mesh[i * 3 + 2];
-        // The "z coordinate" of each vertex in the mesh is either 1 or 0. Instead of being an
-        // actual coordinate, it just determines whether the vertex moves
-        gPaintingMesh[i].pos[2] = ripple_if_movable(painting, mesh[i * 3 + 3],
-                                                    gPaintingMesh[i].pos[0], gPaintingMesh[i].pos[1]);
+        gPaintingMesh[i].pos[2] = rippleZ;
     }
 }
 
 /**
- * Calculate the surface normals of each triangle in the generated ripple mesh.
+ * Calculate the surface normals of the triangles in the generated ripple mesh that have a vertex
+ * which moved since the last frame.
  *
  * The static mesh passed in is organized into two lists. This function uses the second list,
  * painting_generate_mesh above uses the first one.
@@ -711,7 +780,7 @@ void painting_generate_mesh(struct Painting *painting, s16 *mesh, s16 numTris) {
 void painting_calculate_triangle_normals(PaintingData *mesh, PaintingData numVtx, PaintingData numTris) {
     s16 i;
 
-    gPaintingTriNorms = mem_pool_alloc(gEffectsMemoryPool, numTris * sizeof(Vec3f));
+    gPaintingTriNorms = sPaintingTriNormsBuffer;
 
     for (i = 0; i < numTris; i++) {
         s16 tri = numVtx * 3 + i * 3 + 2; // Add 2 because of the 2 length entries preceding the list
@@ -719,6 +788,11 @@ void painting_calculate_triangle_normals(PaintingData *mesh, PaintingData numVtx
         s16 v1 = mesh[tri + 1];
         s16 v2 = mesh[tri + 2];
 
+        sPaintingTriMoved[i] = sPaintingVtxMoved[v0] | sPaintingVtxMoved[v1] | sPaintingVtxMoved[v2];
+        if (!sPaintingTriMoved[i]) {
+            continue;
+        }
+
         f32 x0 = gPaintingMesh[v0].pos[0];
         f32 y0 = gPaintingMesh[v0].pos[1];
         f32 z0 = gPaintingMesh[v0].pos[2];
@@ -757,7 +831,7 @@ s8 normalize_component(f32 comp) {
 
 /**
  * Approximates the painting mesh's vertex normals by averaging the normals of all triangles sharing a
- * vertex. Used for Gouraud lighting.
+ * vertex. Used for Gouraud lighting. Vertices whose triangles didn't change keep their last normal.
  *
  * After each triangle's surface normal is calculated, the `neighborTris` table describes which triangles
  * each vertex should use when calculating the average normal vector.
@@ -785,6 +859,18 @@ void painting_average_vertex_normals(PaintingData *neighborTris, PaintingData nu
 
         // The first number of each entry is the number of adjacent tris
         neighbors = neighborTris[entry];
+
+        // Keep the previous normal if none of the adjacent tris changed
+        for (j = 0; j < neighbors; j++) {
+            if (sPaintingTriMoved[neighborTris[entry + j + 1]]) {
+                break;
+            }
+        }
+        if (j == neighbors) {
+            entry += neighbors + 1;
+            continue;
+        }
+
         for (j = 0; j < neighbors; j++) {
             tri = neighborTris[entry + j + 1];
             nx += gPaintingTriNorms[tri][0];
@@ -998,8 +1084,8 @@ Gfx *painting_ripple_env_mapped(struct Painting *painting) {
 }
 
 /**
- * Generates a mesh, calculates vertex normals for lighting, and renders a rippling painting.
- * The mesh and vertex normals are regenerated and freed every frame.
+ * Updates the mesh, calculates vertex normals for lighting, and renders a rippling painting.
+ * The mesh and vertex normals persist between frames, and are only recalculated where the ripple moved.
  */
 Gfx *display_painting_rippling(struct Painting *painting) {
     s16 *mesh = segmented_to_virtual(seg2_painting_triangle_mesh);
@@ -1008,10 +1094,13 @@ Gfx *display_painting_rippling(struct Painting *painting) {
     s16 numTris = mesh[numVtx * 3 + 1];
     Gfx *dlist = NULL;
 
+    assert(numVtx <= PAINTING_MESH_MAX_VTX && numTris <= PAINTING_MESH_MAX_TRIS, "Painting mesh is too large");
+
     // Generate the mesh and its lighting data
     painting_generate_mesh(painting, mesh, numVtx);
     painting_calculate_triangle_normals(mesh, numVtx, numTris);
     painting_average_vertex_normals(neighborTris, numVtx);
+    sPaintingMeshInitialized = TRUE;
 
     // Map the painting's texture depending on the painting's texture type.
     switch (painting->textureType) {
@@ -1023,9 +1112,6 @@ Gfx *display_painting_rippling(struct Painting *painting) {
             break;
     }
 
-    // The mesh data is freed every frame.
-    mem_pool_free(gEffectsMemoryPool, gPaintingMesh);
-    mem_pool_free(gEffectsMemoryPool, gPaintingTriNorms);
     return dlist;
 }
 
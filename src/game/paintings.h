@@ -13,6 +13,10 @@
 /// The default painting side length
 #define PAINTING_SIZE 614.0f
 
+/// Number of vertices and triangles in seg2_painting_triangle_mesh.
+#define PAINTING_MESH_MAX_VTX  157
+#define PAINTING_MESH_MAX_TRIS 264
+
 #define PAINTING_ID_DDD 0x7
 
 #define BOARD_BOWSERS_SUB (1 << 0)
@@ -1,6 +1,13 @@
 #include <ultra64.h>
 #include <PR/os_internal_reg.h>
+#include <PR/os_internal_thread.h>
 #include "game_init.h"
+#include "main.h"
+#include "map_parser.h"
+#ifdef UNF
+#include "usb/usb.h"
+#include "usb/debug.h"
+#endif
 
 #include "profiling.h"
 #include "fasttext.h"
@@ -229,6 +236,26 @@ u32 profiler_get_rdp_microseconds() {
     return RDP_CYCLE_CONV(rdp_max_cycles / PROFILING_BUFFER_SIZE);
 }
 
+static ALWAYS_INLINE u32 last_frame_count(enum ProfilerTime which, int buffer_index) {
+    return all_profiling_data[which].counts[(buffer_index + PROFILING_BUFFER_SIZE - 1) % PROFILING_BUFFER_SIZE];
+}
+
+/**
+ * Get the times of the last frame that was completely measured, rather than the averages.
+ */
+void profiler_get_frame_microseconds(u32 *cpu, u32 *rsp, u32 *rdp) {
+    u32 tmem = last_frame_count(PROFILER_TIME_TMEM, profile_buffer_index);
+    u32 cmd = last_frame_count(PROFILER_TIME_CMD, profile_buffer_index);
+    u32 pipe = last_frame_count(PROFILER_TIME_PIPE, profile_buffer_index);
+
+    // Audio runs twice per frame, like in profiler_print_times.
+    *cpu = OS_CYCLES_TO_USEC(last_frame_count(PROFILER_TIME_TOTAL, profile_buffer_index)
+                             + last_frame_count(PROFILER_TIME_AUDIO, audio_buffer_index) * 2);
+    *rsp = OS_CYCLES_TO_USEC(last_frame_count(PROFILER_TIME_RSP_GFX, rsp_buffer_indices[PROFILER_RSP_GFX])
+                             + last_frame_count(PROFILER_TIME_RSP_AUDIO, rsp_buffer_indices[PROFILER_RSP_AUDIO]) * 2);
+    *rdp = RDP_CYCLE_CONV(MAX(MAX(tmem, cmd), pipe));
+}
+
 void profiler_print_times() {
     u32 microseconds[PROFILER_TIME_COUNT];
     char text_buffer[196];
@@ -333,6 +360,193 @@ void profiler_frame_setup() {
     }
 
     prev_time = cur_start = osGetCount();
+
+    profiler_sampler_update();
+}
+
+#ifdef PROFILER_SAMPLING
+
+/**
+ * The sampling profiler. A periodic OS timer wakes a thread that outranks every game thread,
+ * so whenever it runs, the thread it preempted is the highest priority runnable one, with its
+ * registers saved in its context. Its PC goes into a ring buffer, which the game thread drains
+ * once per frame: samples are counted per function through the map, and streamed over USB.
+ * Each sample costs an interrupt, two context switches and a walk over the active threads.
+ * That overhead hasn't been measured, so compare frame times with the sampler off before
+ * trusting small differences.
+ */
+
+// Above every game thread, below the crash screen and the UNF threads.
+#define PROFILER_SAMPLER_PRIORITY 120
+
+static OSThread sSamplerThread;
+ALIGNED8 static u8 sSamplerStack[THREAD11_STACK];
+static OSMesgQueue sSamplerMesgQueue;
+static OSMesg sSamplerMesg;
+static OSTimer sSamplerTimer;
+
+static struct ProfilerSample sSamples[PROFILER_SAMPLE_BUFFER_SIZE];
+static volatile u32 sSampleWriteIndex = 0;
+static u32 sSampleReadIndex = 0;
+
+// Sorted by count, so the hottest functions are found first and the view needs no sorting.
+static struct ProfilerFunctionSamples sFunctions[PROFILER_SAMPLE_FUNCTIONS];
+static s32 sFunctionCount = 0;
+static u32 sFunctionSampleTotal = 0;
+
+#ifdef UNF
+u8 gProfilerSampleStreaming = TRUE;
+static u32 sSampleUSBIndex = 0;
+#else
+u8 gProfilerSampleStreaming = FALSE;
+#endif
+
+static OSThread *find_preempted_thread(void) {
+    OSThread *best = NULL;
+    OSThread *thread;
+
+    for (thread = __osGetActiveQueue(); thread->priority != -1; thread = thread->tlnext) {
+        if (thread->state == OS_STATE_RUNNABLE && (best == NULL || thread->priority > best->priority)) {
+            best = thread;
+        }
+    }
+
+    return best;
 }
 
+static void profiler_sampler_thread(UNUSED void *arg) {
+    OSMesg msg;
+
+    while (TRUE) {
+        osRecvMesg(&sSamplerMesgQueue, &msg, OS_MESG_BLOCK);
+
+        u32 saved = __osDisableInt();
+        OSThread *thread = find_preempted_thread();
+        if (thread != NULL) {
+            struct ProfilerSample *sample = &sSamples[sSampleWriteIndex & (PROFILER_SAMPLE_BUFFER_SIZE - 1)];
+            sample->pc = thread->context.pc;
+            sample->ra = (u32) thread->context.ra;
+            sample->thread = thread->id;
+            sSampleWriteIndex++;
+        }
+        __osRestoreInt(saved);
+    }
+}
+
+void profiler_sampler_init(void) {
+    OSTime period = OS_USEC_TO_CYCLES(1000000 / PROFILER_SAMPLE_RATE);
+
+    osCreateMesgQueue(&sSamplerMesgQueue, &sSamplerMesg, 1);
+    osCreateThread(&sSamplerThread, THREAD_11_PROFILER_SAMPLER, profiler_sampler_thread, NULL,
+                   sSamplerStack + THREAD11_STACK, PROFILER_SAMPLER_PRIORITY);
+    osStartThread(&sSamplerThread);
+    // Timer messages that arrive while the queue is full are dropped, so a stalled sampler can't pile up work.
+    osSetTimer(&sSamplerTimer, period, period, &sSamplerMesgQueue, NULL);
+}
+
+static void profiler_sampler_count(s32 symbol) {
+    s32 i;
+
+    for (i = 0; i < sFunctionCount; i++) {
+        if (sFunctions[i].symbol == symbol) {
+            break;
+        }
+    }
+
+    if (i == sFunctionCount) {
+        // Replace the coldest function once the list is full.
+        if (sFunctionCount < PROFILER_SAMPLE_FUNCTIONS) {
+            sFunctionCount++;
+        } else {
+            i--;
+        }
+        sFunctions[i].symbol = symbol;
+        sFunctions[i].count = 0;
+    }
+
+    sFunctions[i].count++;
+    while (i > 0 && sFunctions[i].count > sFunctions[i - 1].count) {
+        struct ProfilerFunctionSamples temp = sFunctions[i];
+        sFunctions[i] = sFunctions[i - 1];
+        sFunctions[i - 1] = temp;
+        i--;
+    }
+
+    // Halve every count once the window is full, so the view follows what the game is doing now.
+    if (++sFunctionSampleTotal >= PROFILER_SAMPLE_WINDOW) {
+        sFunctionSampleTotal /= 2;
+        for (i = 0; i < sFunctionCount; i++) {
+            sFunctions[i].count /= 2;
+        }
+        while (sFunctionCount > 0 && sFunctions[sFunctionCount - 1].count == 0) {
+            sFunctionCount--;
+        }
+    }
+}
+
+#ifdef UNF
+static void profiler_sampler_stream(u32 end) {
+    if (!gProfilerSampleStreaming || (end - sSampleUSBIndex) > PROFILER_SAMPLE_BUFFER_SIZE) {
+        sSampleUSBIndex = end;
+        return;
+    }
+
+    if ((end - sSampleUSBIndex) < PROFILER_SAMPLE_USB_BATCH) {
+        return;
+    }
+
+    u32 start = sSampleUSBIndex & (PROFILER_SAMPLE_BUFFER_SIZE - 1);
+    u32 count = end - sSampleUSBIndex;
+
+    if (start + count > PROFILER_SAMPLE_BUFFER_SIZE) {
+        usb_write(DATATYPE_RAWBINARY, &sSamples[start], (PROFILER_SAMPLE_BUFFER_SIZE - start) * sizeof(struct ProfilerSample));
+        count -= PROFILER_SAMPLE_BUFFER_SIZE - start;
+        start = 0;
+    }
+    usb_write(DATATYPE_RAWBINARY, &sSamples[start], count * sizeof(struct ProfilerSample));
+    sSampleUSBIndex = end;
+}
+#endif
+
+/**
+ * Consume the samples taken since the last call. Samples are only counted if the map
+ * was loaded, which setup_game_memory does at boot.
+ */
+void profiler_sampler_update(void) {
+    u32 end = sSampleWriteIndex;
+
+    // If the buffer wrapped around, the oldest samples are gone.
+    if (end - sSampleReadIndex > PROFILER_SAMPLE_BUFFER_SIZE) {
+        sSampleReadIndex = end - PROFILER_SAMPLE_BUFFER_SIZE;
+    }
+
+    if (map_data_is_loaded()) {
+        for (; sSampleReadIndex != end; sSampleReadIndex++) {
+            profiler_sampler_count(map_symbol_index(sSamples[sSampleReadIndex & (PROFILER_SAMPLE_BUFFER_SIZE - 1)].pc));
+        }
+    }
+    sSampleReadIndex = end;
+
+#ifdef UNF
+    profiler_sampler_stream(end);
+#endif
+}
+
+void profiler_sampler_reset(void) {
+    sFunctionCount = 0;
+    sFunctionSampleTotal = 0;
+}
+
+/**
+ * Get the functions sampled the most, sorted by sample count. Returns how many there are,
+ * and the amount of samples they were taken out of in total.
+ */
+s32 profiler_sampler_get_functions(struct ProfilerFunctionSamples **functions, u32 *total) {
+    *functions = sFunctions;
+    *total = sFunctionSampleTotal;
+    return sFunctionCount;
+}
+
+#endif // PROFILER_SAMPLING
+
 #endif
@@ -110,6 +110,7 @@ u32 profiler_get_delta(enum ProfilerDeltaTime which);
 u32 profiler_get_cpu_microseconds();
 u32 profiler_get_rsp_microseconds();
 u32 profiler_get_rdp_microseconds();
+void profiler_get_frame_microseconds(u32 *cpu, u32 *rsp, u32 *rdp);
 // See profiling.c to see why profiler_rsp_yielded isn't its own function
 static ALWAYS_INLINE void profiler_rsp_yielded() {
     profiler_rsp_resumed();
@@ -135,6 +136,38 @@ static ALWAYS_INLINE void profiler_rsp_yielded() {
 #define profiler_get_cpu_microseconds() 0
 #define profiler_get_rsp_microseconds() 0
 #define profiler_get_rdp_microseconds() 0
+#define profiler_get_frame_microseconds(cpu, rsp, rdp) (*(cpu) = *(rsp) = *(rdp) = 0)
+#endif
+
+#ifdef PROFILER_SAMPLING
+#define PROFILER_SAMPLE_RATE        1000 // Samples per second
+#define PROFILER_SAMPLE_BUFFER_SIZE 512  // Must be a power of two
+#define PROFILER_SAMPLE_FUNCTIONS   48   // Functions tracked by the top functions view
+#define PROFILER_SAMPLE_WINDOW      2048 // Function counts halve every time this many samples were taken
+#define PROFILER_SAMPLE_USB_BATCH   256  // Samples sent over USB at once
+
+// Sent over USB as is, so the layout is read by tools/profiler_samples.py.
+struct ProfilerSample {
+    /*0x00*/ u32 pc;
+    /*0x04*/ u32 ra; // Only the caller when pc is in a leaf function
+    /*0x08*/ u32 thread;
+};
+
+struct ProfilerFunctionSamples {
+    s32 symbol; // Map symbol index, or -1 if the address is not in the map
+    u32 count;
+};
+
+extern u8 gProfilerSampleStreaming;
+
+void profiler_sampler_init(void);
+void profiler_sampler_update(void);
+void profiler_sampler_reset(void);
+s32 profiler_sampler_get_functions(struct ProfilerFunctionSamples **functions, u32 *total);
+#else
+#define profiler_sampler_init()
+#define profiler_sampler_update()
+#define profiler_sampler_reset()
 #endif
 
 #ifdef AUDIO_PROFILING
@@ -50,6 +50,7 @@ a modern game engine's developer's console.
 #include "color_presets.h"
 #include "buffers/buffers.h"
 #include "profiling.h"
+#include "map_parser.h"
 #include "segment_symbols.h"
 
 #ifdef PUPPYPRINT
@@ -466,14 +467,23 @@ extern s16 gVisualSurfaceCount;
 #endif
 
 void puppyprint_render_collision(void) {
-    char textBytes[128];
-    sprintf(textBytes, "Static Pool Size: 0x%X\nDynamic Pool Size: 0x%X\nDynamic Pool Used: 0x%X\nSurfaces Allocated: %d\nNodes Allocated: %d", 
+    char textBytes[256];
+    sprintf(textBytes, "Static Pool Size: 0x%X\nDynamic Pool Size: 0x%X\nDynamic Pool Used: 0x%X\nSurfaces Allocated: %d\nNodes Allocated: %d"
+    "\nPartition: %dx%d, Cell Size %d\nPartition Size: 0x%X\nSurfaces Tested: %d", 
     gTotalStaticSurfaceData,
     DYNAMIC_SURFACE_POOL_SIZE,
     (uintptr_t)gDynamicSurfacePoolEnd - (uintptr_t)gDynamicSurfacePool,
-    gSurfacesAllocated, gSurfaceNodesAllocated);
+    gSurfacesAllocated, gSurfaceNodesAllocated,
+    gPartitionGrid.numCellsX, gPartitionGrid.numCellsZ, (1 << gPartitionGrid.cellShift),
+    (2 * gPartitionGrid.numCellsX * gPartitionGrid.numCellsZ * sizeof(SpatialPartitionCell)),
+    gPuppyCallCounter.collision_surfaces);
     print_small_text_light(SCREEN_WIDTH-16, 60, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, 1);
 
+#ifdef BAKED_TERRAIN
+    sprintf(textBytes, "Baked Areas Loaded: %d\nBaked Areas Missed: %d", gBakedTerrainHits, gBakedTerrainMisses);
+    print_small_text_light(SCREEN_WIDTH-16, 160, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, 1);
+#endif
+
 #ifdef VISUAL_DEBUG
     print_small_text_light(160, (SCREEN_HEIGHT - 42), "Use the dpad to toggle visual collision modes", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
     switch (viewCycle) {
@@ -504,10 +514,11 @@ void print_basic_profiling(void) {
 }
 
 void puppyprint_render_standard(void) {
-    char textBytes[128];
+    char textBytes[160];
 
-    sprintf(textBytes, "Matrix Muls: %d\n\nCollision Checks\nFloors: %d\nWalls: %d\nCeilings: %d\n Water: %d\nRaycasts: %d",
+    sprintf(textBytes, "Matrix Muls: %d\nObject Scans Avoided: %d\n\nCollision Checks\nFloors: %d\nWalls: %d\nCeilings: %d\n Water: %d\nRaycasts: %d",
             gPuppyCallCounter.matrix,
+            gPuppyCallCounter.object_scans_avoided,
             gPuppyCallCounter.collision_floor,
             gPuppyCallCounter.collision_wall,
             gPuppyCallCounter.collision_ceil,
@@ -521,6 +532,44 @@ void puppyprint_render_minimal(void) {
     print_basic_profiling();
 }
 
+#ifdef PROFILER_SAMPLING
+#define SAMPLED_FUNCTIONS_SHOWN 14
+
+void print_sampled_functions(void) {
+    struct ProfilerFunctionSamples *functions;
+    u32 total;
+    s32 count = profiler_sampler_get_functions(&functions, &total);
+    char textBytes[64];
+
+    prepare_blank_box();
+    render_blank_box(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 0, 96);
+    finish_blank_box();
+
+    if (!map_data_is_loaded()) {
+        print_small_text_light(160, (SCREEN_HEIGHT / 2), "Could not load the map data.", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+        return;
+    }
+
+    sprintf(textBytes, "Samples: %d (%dHz)%s", total, PROFILER_SAMPLE_RATE, (gProfilerSampleStreaming ? ", streaming over USB" : ""));
+    print_small_text_light(16, 16, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+
+    for (s32 i = 0; i < MIN(count, SAMPLED_FUNCTIONS_SHOWN); i++) {
+        const char *name = map_symbol_name(functions[i].symbol);
+        u32 permille = (functions[i].count * 1000) / total;
+
+        sprintf(textBytes, "%d.%d%%", (permille / 10), (permille % 10));
+        print_small_text_light(56, (32 + (i * 12)), textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_DEFAULT);
+        print_small_text_light(64, (32 + (i * 12)), ((name != NULL) ? name : "???"), PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_DEFAULT);
+    }
+
+#ifdef UNF
+    print_small_text_light(160, (SCREEN_HEIGHT - 24), "A: Reset   B: Toggle USB streaming", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+#else
+    print_small_text_light(160, (SCREEN_HEIGHT - 24), "A: Reset", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+#endif
+}
+#endif
+
 void render_coverage_map(void) {
     Gfx *tempGfxHead = gDisplayListHead;
 
@@ -1032,6 +1081,9 @@ struct PuppyPrintPage ppPages[] = {
 #ifdef USE_PROFILER
     [PUPPYPRINT_PAGE_PROFILER]      = {&puppyprint_render_standard,     "Profiler"},
     [PUPPYPRINT_PAGE_MINIMAL]       = {&puppyprint_render_minimal,      "Minimal"},
+#endif
+#ifdef PROFILER_SAMPLING
+    [PUPPYPRINT_PAGE_FUNCTIONS]     = {&print_sampled_functions,        "Functions"},
 #endif
     [PUPPYPRINT_PAGE_GENERAL]       = {&puppyprint_render_general_vars, "General"},
     [PUPPYPRINT_PAGE_AUDIO]         = {&print_audio_overview,           "Audio"},
@@ -1185,6 +1237,18 @@ void puppyprint_profiler_process(void) {
             if (viewCycle == 255)
                 viewCycle = 3;
         }
+#endif
+#ifdef PROFILER_SAMPLING
+        if (sPPDebugPage == PUPPYPRINT_PAGE_FUNCTIONS) {
+            if (gPlayer1Controller->buttonPressed & A_BUTTON) {
+                profiler_sampler_reset();
+            }
+#ifdef UNF
+            if (gPlayer1Controller->buttonPressed & B_BUTTON) {
+                gProfilerSampleStreaming ^= TRUE;
+            }
+#endif
+        }
 #endif
         if (sPPDebugPage == PUPPYPRINT_PAGE_RAM) {
             if (gPlayer1Controller->buttonDown & U_JPAD && gPPSegScroll > 0)  {
@@ -1763,6 +1827,122 @@ void print_small_text_light(s32 x, s32 y, const char *str, s32 align, s32 amount
     gCurrEnvCol[0] = 255; gCurrEnvCol[1] = 255; gCurrEnvCol[2] = 255; gCurrEnvCol[3] = 255;
 }
 
+#ifdef PUPPYPRINT_DEBUG
+// A string whose display list is kept between frames. Each entry owns two display lists,
+// so a rebuilt one never overwrites what the RDP may still be drawing from the previous frame.
+struct PuppyprintCachedText {
+    Gfx gfx[2][PUPPYPRINT_TEXT_CACHE_GFX];
+    // Text takes at most 3 commands per character, plus 16 for the setup and end display lists.
+    char str[(PUPPYPRINT_TEXT_CACHE_GFX - 16) / 3];
+    u32 lastUsed; // gGraphicsTimer of the last frame this was drawn on
+    f32 size;
+    s16 x;
+    s16 y;
+    s16 amount;
+    ColorRGBA envCol;
+    u8 align;
+    u8 font;
+    u8 monoSpace;
+    u8 buffer; // Which of the display lists is current
+    u8 valid;
+};
+
+static struct PuppyprintCachedText sCachedText[PUPPYPRINT_TEXT_CACHE_SIZE];
+
+/**
+ * Whether the output of a string only depends on its parameters.
+ * Effects that animate over time need to be rebuilt every frame.
+ */
+static s32 text_is_cacheable(const char *str, s32 strLen) {
+    if (strLen >= (s32) sizeof(sCachedText[0].str)) {
+        return FALSE;
+    }
+
+    for (s32 i = 0; i < strLen; i++) {
+        if (str[i] == '<' && (strncmp(&str[i], "<FADE_", 6) == 0 || strncmp(&str[i], "<RAINBOW>", 9) == 0
+                           || strncmp(&str[i], "<SHAKE>", 7) == 0 || strncmp(&str[i], "<WAVE>", 6) == 0)) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static s32 cached_text_matches(struct PuppyprintCachedText *entry, const char *str, s32 strLen, s32 align, s32 amount) {
+    return (entry->valid && entry->amount == amount && entry->align == align && entry->size == textSize
+            && entry->monoSpace == gMonoSpace && entry->envCol[0] == gCurrEnvCol[0] && entry->envCol[1] == gCurrEnvCol[1]
+            && entry->envCol[2] == gCurrEnvCol[2] && entry->envCol[3] == gCurrEnvCol[3] && memcmp(entry->str, str, strLen + 1) == 0);
+}
+
+/**
+ * Same as print_small_text, but keeps the display list it builds, keyed by screen position and font.
+ * When the same text is printed there again on the next frame, the string isn't parsed again,
+ * the previous display list is called instead. Text with time based effects is always printed directly.
+ */
+void print_small_text_cached(s32 x, s32 y, const char *str, s32 align, s32 amount, u8 font) {
+    struct PuppyprintCachedText *entry = NULL;
+    struct PuppyprintCachedText *oldest = NULL;
+    s32 strLen = strlen(str);
+    Gfx *savedHead;
+
+    if (!text_is_cacheable(str, strLen)) {
+        print_small_text(x, y, str, align, amount, font);
+        return;
+    }
+
+    for (s32 i = 0; i < PUPPYPRINT_TEXT_CACHE_SIZE; i++) {
+        struct PuppyprintCachedText *cur = &sCachedText[i];
+
+        if (cur->valid && cur->x == x && cur->y == y && cur->font == font) {
+            entry = cur;
+            break;
+        }
+        // Entries drawn this frame are still referenced by it and can't be replaced.
+        if (cur->lastUsed != gGraphicsTimer && (oldest == NULL || cur->lastUsed < oldest->lastUsed)) {
+            oldest = cur;
+        }
+    }
+
+    if (entry != NULL && entry->lastUsed == gGraphicsTimer && !cached_text_matches(entry, str, strLen, align, amount)) {
+        entry = NULL; // Printed over itself this frame; don't touch the list already in use.
+        oldest = NULL;
+    } else if (entry == NULL) {
+        entry = oldest;
+    }
+
+    if (entry == NULL) {
+        print_small_text(x, y, str, align, amount, font);
+        return;
+    }
+
+    if (!cached_text_matches(entry, str, strLen, align, amount) || entry->x != x || entry->y != y || entry->font != font) {
+        entry->buffer ^= 1;
+        entry->valid = TRUE;
+        entry->x = x;
+        entry->y = y;
+        entry->font = font;
+        entry->align = align;
+        entry->amount = amount;
+        entry->size = textSize;
+        entry->monoSpace = gMonoSpace;
+        vec4_copy(entry->envCol, gCurrEnvCol);
+        bcopy(str, entry->str, strLen + 1);
+
+        savedHead = gDisplayListHead;
+        gDisplayListHead = entry->gfx[entry->buffer];
+        print_small_text(x, y, str, align, amount, font);
+        gSPEndDisplayList(gDisplayListHead++);
+        gDisplayListHead = savedHead;
+    } else {
+        // print_small_text leaves the color white, which the cached list does too.
+        gCurrEnvCol[0] = 255; gCurrEnvCol[1] = 255; gCurrEnvCol[2] = 255; gCurrEnvCol[3] = 255;
+    }
+
+    entry->lastUsed = gGraphicsTimer;
+    gSPDisplayList(gDisplayListHead++, entry->gfx[entry->buffer]);
+}
+#endif
+
 // Return color hex nibble
 s32 get_hex_value_at_offset(const char *str, s32 primaryOffset, u32 nibbleOffset, u32 garbageReturnsEnv) {
     s32 val = str[primaryOffset + nibbleOffset];
@@ -2003,7 +2183,11 @@ void puppyprint_print_deferred(void) {
         if (header.isLightText) {
             print_small_text_light(x, y, text, header.alignment, header.textBufferLength, header.font);
         } else {
+#ifdef PUPPYPRINT_DEBUG
+            print_small_text_cached(x, y, text, header.alignment, header.textBufferLength, header.font);
+#else
             print_small_text(x, y, text, header.alignment, header.textBufferLength, header.font);
+#endif
         }
 
         print_set_envcolour(originalEnvCol[0], originalEnvCol[1], originalEnvCol[2], originalEnvCol[3]);
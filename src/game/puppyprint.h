@@ -8,12 +8,16 @@
 #define PERF_TOTAL NUM_PERF_ITERATIONS + 1
 #define LOG_BUFFER_SIZE       16
 #define PUPPYPRINT_DEFERRED_BUFFER_SIZE 0x1000
+// Number of deferred strings whose display lists are kept between frames, and the commands kept for each.
+#define PUPPYPRINT_TEXT_CACHE_SIZE 12
+#define PUPPYPRINT_TEXT_CACHE_GFX  160
 
 #ifdef PUPPYPRINT_DEBUG
 #define PUPPYPRINT_ADD_COUNTER(x) x++
 #define PUPPYPRINT_GET_SNAPSHOT() u32 first = osGetCount()
 #define PUPPYPRINT_GET_SNAPSHOT_TYPE(type) u32 first = profiler_get_delta(type)
 void append_puppyprint_log(const char *str, ...);
+void print_small_text_cached(s32 x, s32 y, const char *str, s32 align, s32 amount, u8 font);
 #else
 #define PUPPYPRINT_ADD_COUNTER(x)
 #define PUPPYPRINT_GET_SNAPSHOT()
@@ -50,6 +54,8 @@ struct CallCounter {
     u16 collision_water;
     u16 collision_raycast;
     u16 matrix;
+    u16 object_scans_avoided;
+    u32 collision_surfaces;
 };
 
 struct PuppyPrintPage{
@@ -87,6 +93,9 @@ enum PPPages {
 #ifdef USE_PROFILER
     PUPPYPRINT_PAGE_PROFILER,
     PUPPYPRINT_PAGE_MINIMAL,
+#endif
+#ifdef PROFILER_SAMPLING
+    PUPPYPRINT_PAGE_FUNCTIONS,
 #endif
     PUPPYPRINT_PAGE_GENERAL,
     PUPPYPRINT_PAGE_AUDIO,
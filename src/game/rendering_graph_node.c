@@ -24,6 +24,7 @@
 #include "config.h"
 #include "config/config_world.h"
 #include "frame_lerp.h"
+#include "buffers/buffers.h"
 
 #include <PR/os_internal_reg.h>
 
@@ -400,6 +401,24 @@ static void inc_mat_stack() {
     gMatStackFixed[gMatStackIndex] = mtx;
 }
 
+/**
+ * Like inc_mat_stack, but for the matrix of an object node. The fixed point matrix goes in the object's own buffer
+ * for the current gfx pool instead of being allocated from it, and is only converted again when the object's
+ * interpolated transform changed since the buffer was written. The buffer isn't touched again until this gfx pool is
+ * reused, at which point the RCP is done with it.
+ */
+static void inc_object_mat_stack(struct GraphNodeObject *node) {
+    s32 buffer = (gGfxPool - gGfxPools);
+    Mtx *mtx = &node->lerpMtx[buffer];
+
+    gMatStackIndex++;
+    if (node->lerpMtxBufGen[buffer] != node->lerpMtxGen) {
+        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+        node->lerpMtxBufGen[buffer] = node->lerpMtxGen;
+    }
+    gMatStackFixed[gMatStackIndex] = mtx;
+}
+
 static void append_dl_and_return(struct GraphNodeDisplayList *node) {
     if (node->displayList != NULL) {
         geo_append_display_list(node->displayList, GET_GRAPH_NODE_LAYER(node->node.flags));
@@ -1134,14 +1153,40 @@ void visualise_object_hitbox(struct Object *node) {
 }
 #endif
 
+/**
+ * Whether the interpolated transform of an object node differs from the given one from before this frame.
+ */
+static s32 obj_lerp_transform_changed(struct GraphNodeObject *node, Vec3f pos, Vec3f scale, Quat rot) {
+    s32 i;
+
+    for (i = 0; i < 3; i++) {
+        if (node->posLerp[i] != pos[i] || node->scaleLerp[i] != scale[i]) {
+            return TRUE;
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        if (node->rotLerp[i] != rot[i]) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 /**
  * Process an object node.
  */
 void geo_process_object(struct Object *node) {
     if (node->header.gfx.areaIndex == gCurGraphNodeRoot->areaIndex) {
         s32 isInvisible = (node->header.gfx.node.flags & GRAPH_RENDER_INVISIBLE);
+        s32 isBillboard = (node->header.gfx.node.flags & GRAPH_RENDER_BILLBOARD);
+        Vec3f prevPos, prevScale;
+        Quat prevRot;
         // Maintain throw matrix pointer if the game is paused as it won't be updated.
 
+        vec3f_copy(prevPos, node->header.gfx.posLerp);
+        vec3f_copy(prevScale, node->header.gfx.scaleLerp);
+        quat_copy(prevRot, node->header.gfx.rotLerp);
+
         frameLerpPos(node->header.gfx.posVideoCache,node->header.gfx.posLerp);
         frameLerpPos(node->header.gfx.scale,node->header.gfx.scaleLerp);
 
@@ -1152,7 +1197,7 @@ void geo_process_object(struct Object *node) {
             mtxf_translate(gMatStack[gMatStackIndex + 1], node->header.gfx.posVideoCache);
         }
         else{
-            if (node->header.gfx.node.flags & GRAPH_RENDER_BILLBOARD) {
+            if (isBillboard) {
                 mtxf_billboard(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex],
                             node->header.gfx.posLerp, node->header.gfx.scaleLerp, gCurGraphNodeCamera->roll);
             } else {
@@ -1187,9 +1232,18 @@ void geo_process_object(struct Object *node) {
             geo_set_animation_globals(&node->header.gfx.animInfo, (node->header.gfx.node.flags & GRAPH_RENDER_HAS_ANIMATION) != 0, node);
         }
 
+        // Billboards depend on the camera, so they still allocate their matrix every frame.
+        if (isBillboard || obj_lerp_transform_changed(&node->header.gfx, prevPos, prevScale, prevRot)) {
+            node->header.gfx.lerpMtxGen++;
+        }
+
         if (!isInvisible && obj_is_in_view(&node->header.gfx)) {
             gMatStackIndex--;
-            inc_mat_stack();
+            if (isBillboard) {
+                inc_mat_stack();
+            } else {
+                inc_object_mat_stack(&node->header.gfx);
+            }
 
             if (node->header.gfx.sharedChild != NULL) {
 #ifdef VISUAL_DEBUG
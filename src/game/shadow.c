@@ -4,6 +4,7 @@
 #include "engine/math_util.h"
 #include "engine/surface_collision.h"
 #include "behavior_data.h"
+#include "frame_lerp.h"
 #include "geo_misc.h"
 #include "level_table.h"
 #include "memory.h"
@@ -179,6 +180,84 @@ static void add_shadow_to_display_list(Gfx *displayListHead, s8 shadowType) {
     gSPEndDisplayList(displayListHead);
 }
 
+/**
+ * Find the floor and water under an object with a shadow, during the game update.
+ * The render path only reads the result (through the frame lerp caches), so it
+ * never queries collision itself or races the update for the object's floor.
+ */
+/**
+ * Get where the shadow of an object will be drawn, which is its graphics position
+ * moved by the lateral translation of its animation, like in geo_process_shadow.
+ * Mario's animations are only loaded on the render side, so his shadow is found
+ * at his graphics position.
+ */
+static void get_shadow_floor_pos(struct Object *obj, Vec3f pos) {
+    struct AnimInfo *animInfo = &obj->header.gfx.animInfo;
+    struct Animation *anim = animInfo->curAnim;
+
+    vec3f_copy(pos, obj->header.gfx.pos);
+
+    if (obj == gMarioObject || anim == NULL
+        || !(obj->header.gfx.node.flags & GRAPH_RENDER_HAS_ANIMATION)
+        || (anim->flags & (ANIM_FLAG_DISABLED | ANIM_FLAG_HOR_TRANS | ANIM_FLAG_NO_TRANS))) {
+        return;
+    }
+
+    u16 *attribute = segmented_to_virtual((void *) anim->index);
+    s16 *values = segmented_to_virtual((void *) anim->values);
+    s32 frame = MAX(animInfo->animFrame, 0);
+    f32 animScale = (anim->animYTransDivisor == 0) ? 1.0f : ((f32) animInfo->animYTrans / (f32) anim->animYTransDivisor);
+
+    f32 offsetX = values[retrieve_animation_index(frame, &attribute)] * animScale;
+    attribute += 2;
+    f32 offsetZ = values[retrieve_animation_index(frame, &attribute)] * animScale;
+
+    f32 sinAng = sins(obj->header.gfx.angle[1]);
+    f32 cosAng = coss(obj->header.gfx.angle[1]);
+
+    pos[0] +=  offsetX * cosAng + offsetZ * sinAng;
+    pos[2] += -offsetX * sinAng + offsetZ * cosAng;
+}
+
+void update_shadow_floor(struct Object *obj) {
+    struct ShadowFloor *shadowFloor = &obj->header.gfx.shadowFloor;
+    Vec3f pos;
+
+    // Only objects that drew a shadow before need one.
+    if (!obj->header.gfx.hasShadow || obj->activeFlags == ACTIVE_FLAG_DEACTIVATED) {
+        return;
+    }
+
+    get_shadow_floor_pos(obj, pos);
+    f32 x = pos[0];
+    f32 y = pos[1];
+    f32 z = pos[2];
+
+    shadowFloor->found = FALSE;
+
+    // Attempt to use existing floors before finding a new one.
+    if (obj == gMarioObject && gMarioState->floor) {
+        // The object is Mario and has a referenced floor.
+        shadowFloor->floor       = gMarioState->floor;
+        shadowFloor->floorHeight = gMarioState->floorHeight;
+    } else if (obj != gMarioObject && obj->oFloor) {
+        // The object is not Mario but has a referenced floor.
+        //! Some objects only get their oFloor from bhv_init_room, which skips dynamic floors.
+        shadowFloor->floor       = obj->oFloor;
+        shadowFloor->floorHeight = obj->oFloorHeight;
+    } else {
+        // The object has no referenced floor, so find a new one.
+        shadowFloor->floorHeight = find_floor(x, y, z, &shadowFloor->floor);
+        shadowFloor->found = TRUE;
+    }
+
+    // Check for water under the shadow.
+    shadowFloor->waterFloor = NULL;
+    shadowFloor->waterLevel = find_water_level_and_floor(x, y, z, &shadowFloor->waterFloor);
+
+    frameLerp_cache_shadow(shadowFloor, &obj->header.gfx.shadowFloorCache, &obj->header.gfx.shadowFloorVideoCache);
+}
+
 //! TODO:
 //      - Breakout create_shadow_below_xyz into multiple functions
 /**
@@ -192,46 +271,39 @@ Gfx *create_shadow_below_xyz(Vec3f pos, s16 shadowScale, u8 shadowSolidity, s8 s
         return NULL;
     }
 
-    // The floor underneath the object.
-    struct Surface *floor = NULL;
-    // The y-position of the floor (or water or lava) underneath the object.
-    f32 floorHeight = FLOOR_LOWER_LIMIT_MISC;
+    // Have the game update find the floor under this object from now on.
+    gCurGraphNodeObject->hasShadow = TRUE;
+
+    // The floor and water under the object, found by update_shadow_floor.
+    struct ShadowFloor *shadowFloor = &gCurGraphNodeObject->shadowFloorVideoCache;
     f32 x = pos[0];
     f32 y = pos[1];
     f32 z = pos[2];
     s8 isPlayer   = (obj == gMarioObject);
     s8 notHeldObj = (gCurGraphNodeHeldObject == NULL);
 
-    // Attempt to use existing floors before finding a new one.
-    if (notHeldObj && isPlayer && gMarioState->floor) {
-        // The object is Mario and has a referenced floor.
-        floor       = gMarioState->floor;
-        floorHeight = gMarioState->floorHeight;
-    } else if (notHeldObj && (gCurGraphNodeObject != &gMirrorMario) && obj->oFloor) {
-        // The object is not Mario but has a referenced floor.
-        //! Some objects only get their oFloor from bhv_init_room, which skips dynamic floors.
-        floor       = obj->oFloor;
-        floorHeight = obj->oFloorHeight;
-    } else {
-        // The object has no referenced floor, so find a new one.
-        // gCollisionFlags |= COLLISION_FLAG_RETURN_FIRST;
-        floorHeight = find_floor(x, y, z, &floor);
+    // The floor underneath the object.
+    struct Surface *floor = shadowFloor->floor;
+    // The y-position of the floor (or water or lava) underneath the object.
+    f32 floorHeight = shadowFloor->floorHeight;
 
-        // No shadow if the position is OOB.
-        if (floor == NULL) {
-            return NULL;
-        }
+    // No shadow if the position is OOB.
+    if (floor == NULL) {
+        return NULL;
+    }
 
-        // Skip shifting the shadow height later, since the find_floor call above uses the already shifted position.
-        shifted = FALSE;
+    // Floors found under the object and floors under held objects are where the object was during
+    // the last update, so move their height to where the shadow is drawn, like for animations.
+    if (!notHeldObj || shadowFloor->found) {
+        shifted = TRUE;
     }
 
     // The shadow is a decal by default.
     s->isDecal = TRUE;
 
     // Check for water under the shadow.
-    struct Surface *waterFloor = NULL;
-    f32 waterLevel = find_water_level_and_floor(x, y, z, &waterFloor);
+    struct Surface *waterFloor = shadowFloor->waterFloor;
+    f32 waterLevel = shadowFloor->waterLevel;
 
     // Whether the floor is an environment box rather than an actual surface.
     s32 isEnvBox = FALSE;
@@ -239,7 +311,7 @@ Gfx *create_shadow_below_xyz(Vec3f pos, s16 shadowScale, u8 shadowSolidity, s8 s
     if (waterLevel > FLOOR_LOWER_LIMIT_MISC
         && y >= waterLevel
         && floorHeight <= waterLevel) {
-        // Skip shifting the shadow height later, since the find_water_level_and_floor call above uses the already shifted position.
+        // Water is level, so there is no height to shift.
         shifted = FALSE;
 
         // If there is water under the shadow, put the shadow on the water.
@@ -102,4 +102,9 @@ extern struct Shadow gCurrShadow;
  */
 Gfx *create_shadow_below_xyz(Vec3f pos, s16 shadowScale, u8 shadowSolidity, s8 shadowType, s8 shifted);
 
+/**
+ * Find the floor and water under an object for its shadow. Called by the game update.
+ */
+void update_shadow_floor(struct Object *obj);
+
 #endif // SHADOW_H
@@ -13,6 +13,144 @@
 #include "spawn_object.h"
 #include "types.h"
 
+struct ObjectHotData gObjectHotData;
+
+STATIC_ASSERT(BHV_REGISTRY_SIZE > OBJECT_POOL_CAPACITY, "The behavior registry must be larger than the object pool, or probing it can loop forever.");
+
+static struct BhvRegistryEntry sBhvRegistry[BHV_REGISTRY_SIZE];
+static const BehaviorScript *sBhvRegistryKey[OBJECT_POOL_CAPACITY];
+static s16 sBhvRegistryPrev[OBJECT_POOL_CAPACITY];
+static u8 sObjectListIndex[OBJECT_POOL_CAPACITY];
+s16 gBhvRegistryNext[OBJECT_POOL_CAPACITY];
+
+static s32 bhv_registry_hash(const BehaviorScript *behavior) {
+    return (((u32)(uintptr_t) behavior >> 2) * 0x9E3779B1) >> (32 - BHV_REGISTRY_BITS);
+}
+
+/**
+ * Return the index of the registry entry for the given behavior, or of the
+ * empty entry where it would be inserted.
+ */
+static s32 bhv_registry_find(const BehaviorScript *behavior) {
+    s32 i = bhv_registry_hash(behavior);
+
+    while (sBhvRegistry[i].behavior != NULL && sBhvRegistry[i].behavior != behavior) {
+        i = (i + 1) & (BHV_REGISTRY_SIZE - 1);
+    }
+
+    return i;
+}
+
+/**
+ * Empty the given registry entry, shifting back the entries that probed past
+ * it so that every behavior stays reachable from its hash.
+ */
+static void bhv_registry_remove_entry(s32 i) {
+    s32 j = i;
+
+    while (TRUE) {
+        j = (j + 1) & (BHV_REGISTRY_SIZE - 1);
+        if (sBhvRegistry[j].behavior == NULL) {
+            break;
+        }
+
+        s32 home = bhv_registry_hash(sBhvRegistry[j].behavior);
+        if (((j - home) & (BHV_REGISTRY_SIZE - 1)) >= ((j - i) & (BHV_REGISTRY_SIZE - 1))) {
+            sBhvRegistry[i] = sBhvRegistry[j];
+            i = j;
+        }
+    }
+
+    sBhvRegistry[i].behavior = NULL;
+}
+
+/**
+ * Return the pool slot of the first allocated object with the given virtual
+ * behavior address, or -1 if there is none.
+ */
+s32 bhv_registry_first(const BehaviorScript *behavior) {
+    struct BhvRegistryEntry *entry = &sBhvRegistry[bhv_registry_find(behavior)];
+
+    return (entry->behavior != NULL) ? entry->head : -1;
+}
+
+/**
+ * Return the number of allocated objects with the given virtual behavior address.
+ */
+s32 bhv_registry_count(const BehaviorScript *behavior) {
+    struct BhvRegistryEntry *entry = &sBhvRegistry[bhv_registry_find(behavior)];
+
+    return (entry->behavior != NULL) ? entry->count : 0;
+}
+
+/**
+ * Append the object to the list of its current behavior. Objects that were
+ * switched to a behavior of another object list are left out, since lookups
+ * by behavior only ever searched that behavior's own list.
+ */
+void bhv_registry_add(struct Object *obj) {
+    s32 slot = OBJECT_POOL_SLOT(obj);
+    struct BhvRegistryEntry *entry;
+
+    if (sObjectListIndex[slot] != get_object_list_from_behavior(obj->behavior)) {
+        return;
+    }
+
+    entry = &sBhvRegistry[bhv_registry_find(obj->behavior)];
+
+    if (entry->behavior == NULL) {
+        entry->behavior = obj->behavior;
+        entry->head = -1;
+        entry->tail = -1;
+        entry->count = 0;
+    }
+
+    sBhvRegistryPrev[slot] = entry->tail;
+    gBhvRegistryNext[slot] = -1;
+    if (entry->tail >= 0) {
+        gBhvRegistryNext[entry->tail] = slot;
+    } else {
+        entry->head = slot;
+    }
+    entry->tail = slot;
+    entry->count++;
+
+    sBhvRegistryKey[slot] = obj->behavior;
+}
+
+/**
+ * Unlink the object from the list of the behavior it was registered with.
+ */
+void bhv_registry_remove(struct Object *obj) {
+    s32 slot = OBJECT_POOL_SLOT(obj);
+    s32 index;
+    struct BhvRegistryEntry *entry;
+
+    if (sBhvRegistryKey[slot] == NULL) {
+        return;
+    }
+
+    index = bhv_registry_find(sBhvRegistryKey[slot]);
+    entry = &sBhvRegistry[index];
+
+    if (sBhvRegistryPrev[slot] >= 0) {
+        gBhvRegistryNext[sBhvRegistryPrev[slot]] = gBhvRegistryNext[slot];
+    } else {
+        entry->head = gBhvRegistryNext[slot];
+    }
+    if (gBhvRegistryNext[slot] >= 0) {
+        sBhvRegistryPrev[gBhvRegistryNext[slot]] = sBhvRegistryPrev[slot];
+    } else {
+        entry->tail = sBhvRegistryPrev[slot];
+    }
+
+    if (--entry->count == 0) {
+        bhv_registry_remove_entry(index);
+    }
+
+    sBhvRegistryKey[slot] = NULL;
+}
+
 /**
  * Attempt to allocate an object from freeList (singly linked) and append it
  * to the end of destList (doubly linked). Return the object, or NULL if
@@ -73,6 +211,10 @@ void init_free_object_list(void) {
 
     // End the list
     obj->header.next = NULL;
+
+    // Nothing is allocated anymore, so forget every behavior
+    bzero(sBhvRegistry, sizeof(sBhvRegistry));
+    bzero(sBhvRegistryKey, sizeof(sBhvRegistryKey));
 }
 
 /**
@@ -87,6 +229,38 @@ void clear_object_lists(struct ObjectNode *objLists) {
     }
 }
 
+/**
+ * Append the objects of the given list to the hot data mirror. Lists must be
+ * captured one after the other, starting from gObjectHotData.count = 0.
+ */
+void capture_object_hot_data(s32 listIndex) {
+    struct ObjectHotData *hot = &gObjectHotData;
+    struct ObjectNode *listHead = &gObjectLists[listIndex];
+    struct ObjectNode *node = listHead->next;
+    s32 pos = hot->count;
+
+    hot->listStart[listIndex] = pos;
+
+    while (node != listHead) {
+        struct Object *obj = (struct Object *) node;
+        s32 slot = OBJECT_POOL_SLOT(obj);
+
+        hot->posX[slot] = obj->oPosX;
+        hot->posZ[slot] = obj->oPosZ;
+        hot->hitboxBottom[slot] = obj->oPosY - obj->hitboxDownOffset;
+        hot->hitboxRadius[slot] = obj->hitboxRadius;
+        hot->hitboxHeight[slot] = obj->hitboxHeight;
+        hot->intangibleTimer[slot] = obj->oIntangibleTimer;
+        hot->listPos[slot] = pos;
+        hot->order[pos++] = slot;
+
+        node = node->next;
+    }
+
+    hot->listEnd[listIndex] = pos;
+    hot->count = pos;
+}
+
 /**
  * Free the given object.
  */
@@ -101,6 +275,7 @@ void unload_object(struct Object *obj) {
 
     obj->header.gfx.node.flags &= ~(GRAPH_RENDER_BILLBOARD | GRAPH_RENDER_ACTIVE);
 
+    bhv_registry_remove(obj);
     deallocate_object(&gFreeObjectList, &obj->header);
 }
 
@@ -157,7 +332,7 @@ struct Object *allocate_object(struct ObjectNode *objList) {
     }
 #endif
 
-    obj->unused1 = 0;
+    obj->nativeLoop = NULL;
     obj->bhvStackIndex = 0;
     obj->bhvDelayTimer = 0;
 
@@ -212,6 +387,8 @@ struct Object *create_object(const BehaviorScript *bhvScript) {
 
     obj->curBhvCommand = bhvScript;
     obj->behavior = bhvScript;
+    sObjectListIndex[OBJECT_POOL_SLOT(obj)] = objListIndex;
+    bhv_registry_add(obj);
 
     if (objListIndex == OBJ_LIST_UNIMPORTANT) {
         obj->activeFlags |= ACTIVE_FLAG_UNIMPORTANT;
@@ -2,10 +2,59 @@
 #define SPAWN_OBJECT_H
 
 #include "types.h"
+#include "object_list_processor.h"
+
+/**
+ * Parallel arrays mirroring the fields read by the pairwise object collision checks,
+ * indexed by the object's slot in gObjectPool. The object lists are captured in list
+ * order into order[], with listStart/listEnd giving each list's range in it.
+ * Refreshed at the start of detect_object_collisions(), while no object can move.
+ */
+struct ObjectHotData {
+    f32 posX[OBJECT_POOL_CAPACITY];
+    f32 posZ[OBJECT_POOL_CAPACITY];
+    f32 hitboxBottom[OBJECT_POOL_CAPACITY];
+    f32 hitboxRadius[OBJECT_POOL_CAPACITY];
+    f32 hitboxHeight[OBJECT_POOL_CAPACITY];
+    s32 intangibleTimer[OBJECT_POOL_CAPACITY];
+    u16 listPos[OBJECT_POOL_CAPACITY];
+    u16 order[OBJECT_POOL_CAPACITY];
+    u16 listStart[NUM_OBJ_LISTS];
+    u16 listEnd[NUM_OBJ_LISTS];
+    u16 count;
+};
+
+extern struct ObjectHotData gObjectHotData;
+
+#define OBJECT_POOL_SLOT(obj) ((obj) - gObjectPool)
+
+/**
+ * Every allocated object that lives in its behavior's own object list is linked into
+ * a list of the objects sharing its behavior, so lookups by behavior only visit those
+ * instead of walking that whole object list. The lists are found through a hash table
+ * keyed by behavior script address, which has to be larger than the pool so that it
+ * can never fill up.
+ */
+#define BHV_REGISTRY_BITS 8
+#define BHV_REGISTRY_SIZE (1 << BHV_REGISTRY_BITS)
+
+struct BhvRegistryEntry {
+    const BehaviorScript *behavior;
+    s16 head;
+    s16 tail;
+    s16 count;
+};
+
+extern s16 gBhvRegistryNext[OBJECT_POOL_CAPACITY];
 
 void init_free_object_list(void);
 void clear_object_lists(struct ObjectNode *objLists);
 void unload_object(struct Object *obj);
 struct Object *create_object(const BehaviorScript *bhvScript);
+void capture_object_hot_data(s32 listIndex);
+s32 bhv_registry_first(const BehaviorScript *behavior);
+s32 bhv_registry_count(const BehaviorScript *behavior);
+void bhv_registry_add(struct Object *obj);
+void bhv_registry_remove(struct Object *obj);
 
 #endif // SPAWN_OBJECT_H
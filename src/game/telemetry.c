@@ -0,0 +1,112 @@
+#include <ultra64.h>
+
+#include "game_init.h"
+#include "object_list_processor.h"
+#include "profiling.h"
+#include "puppyprint.h"
+#include "audio/heap.h"
+#ifdef UNF
+#include "usb/usb.h"
+#include "usb/debug.h"
+#endif
+#include "telemetry.h"
+
+/**
+ * @file telemetry.c
+ *
+ * Streams a TelemetryFrame for every game frame, so long soak runs can be captured and
+ * graphed on the host with tools/telemetry.py.
+ *
+ * With UNF, records are batched and sent as raw binaries over USB. Otherwise (ISVPRINT),
+ * every record is printed as a line of hex to the IS-Viewer, which emulators such as
+ * cen64 and ares write to their log, so the same records can be captured without a flashcart.
+ */
+
+#ifdef TELEMETRY
+
+#ifdef UNF
+static struct TelemetryFrame sTelemetryBatch[TELEMETRY_BATCH_FRAMES];
+static s32 sTelemetryBatchCount = 0;
+#endif
+static u32 sGfxPoolPeak = 0;
+
+static u16 saturate_u16(u32 value) {
+    return ((value > 0xFFFF) ? 0xFFFF : value);
+}
+
+/**
+ * Call once the master display list is complete, to track how much of the gfx pool was used.
+ */
+void telemetry_record_gfx_pool(void) {
+    u32 used = (sizeof(gGfxPool->buffer) - (gGfxPoolEnd - (u8 *) gDisplayListHead));
+
+    if (used > sGfxPoolPeak) {
+        sGfxPoolPeak = used;
+    }
+}
+
+static void telemetry_fill_frame(struct TelemetryFrame *frame) {
+    u32 cpu, rsp, rdp;
+
+    profiler_get_frame_microseconds(&cpu, &rsp, &rdp);
+
+    frame->magic = TELEMETRY_MAGIC;
+    frame->version = TELEMETRY_VERSION;
+    frame->size = sizeof(struct TelemetryFrame);
+    frame->frame = gGlobalTimer;
+    frame->cpuTime = saturate_u16(cpu);
+    frame->rspTime = saturate_u16(rsp);
+    frame->rdpTime = saturate_u16(rdp);
+    frame->objects = gObjectCounter;
+#ifdef PUPPYPRINT_DEBUG
+    frame->floorChecks = gPuppyCallCounter.collision_floor;
+    frame->wallChecks = gPuppyCallCounter.collision_wall;
+    frame->ceilChecks = gPuppyCallCounter.collision_ceil;
+    frame->waterChecks = gPuppyCallCounter.collision_water;
+    frame->raycasts = gPuppyCallCounter.collision_raycast;
+    frame->matrixMuls = gPuppyCallCounter.matrix;
+#else
+    frame->floorChecks = 0;
+    frame->wallChecks = 0;
+    frame->ceilChecks = 0;
+    frame->waterChecks = 0;
+    frame->raycasts = 0;
+    frame->matrixMuls = 0;
+#endif
+    frame->gfxPoolUsed = sGfxPoolPeak;
+    frame->audioHeapUsed = audio_heap_get_used();
+
+    sGfxPoolPeak = 0;
+}
+
+/**
+ * Send the record of the frame that just finished. Call before the call counters are reset.
+ */
+void telemetry_send_frame(void) {
+#ifdef UNF
+    telemetry_fill_frame(&sTelemetryBatch[sTelemetryBatchCount]);
+
+    if (++sTelemetryBatchCount == TELEMETRY_BATCH_FRAMES) {
+        usb_write(DATATYPE_RAWBINARY, sTelemetryBatch, sizeof(sTelemetryBatch));
+        sTelemetryBatchCount = 0;
+    }
+#else
+    static const char hexDigits[] = "0123456789ABCDEF";
+    struct TelemetryFrame frame;
+    char line[(sizeof(frame) * 2) + 1];
+    u8 *bytes = (u8 *) &frame;
+    u32 i;
+
+    telemetry_fill_frame(&frame);
+
+    for (i = 0; i < sizeof(frame); i++) {
+        line[(i * 2) + 0] = hexDigits[bytes[i] >> 4];
+        line[(i * 2) + 1] = hexDigits[bytes[i] & 0xF];
+    }
+    line[sizeof(frame) * 2] = '\0';
+
+    osSyncPrintf("TLM %s\n", line);
+#endif
+}
+
+#endif // TELEMETRY
@@ -0,0 +1,46 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <PR/ultratypes.h>
+
+#include "config.h"
+
+#define TELEMETRY_MAGIC   0x5446 // 'TF'
+#define TELEMETRY_VERSION 1
+
+// Records sent over USB at once. Printed records are sent one at a time.
+#define TELEMETRY_BATCH_FRAMES 16
+
+/**
+ * One frame of telemetry, sent as is (big endian, no padding), so tools/telemetry.py has to
+ * be updated along with it. Bump TELEMETRY_VERSION when changing the layout.
+ * Times are in microseconds and saturate at 0xFFFF.
+ */
+struct TelemetryFrame {
+    /*0x00*/ u16 magic;
+    /*0x02*/ u8 version;
+    /*0x03*/ u8 size;
+    /*0x04*/ u32 frame;
+    /*0x08*/ u16 cpuTime;
+    /*0x0A*/ u16 rspTime;
+    /*0x0C*/ u16 rdpTime;
+    /*0x0E*/ u16 objects;
+    /*0x10*/ u16 floorChecks;
+    /*0x12*/ u16 wallChecks;
+    /*0x14*/ u16 ceilChecks;
+    /*0x16*/ u16 waterChecks;
+    /*0x18*/ u16 raycasts;
+    /*0x1A*/ u16 matrixMuls;
+    /*0x1C*/ u32 gfxPoolUsed;   // Bytes, the most any frame since the last record used
+    /*0x20*/ u32 audioHeapUsed; // Bytes
+}; /*0x24*/
+
+#ifdef TELEMETRY
+void telemetry_record_gfx_pool(void);
+void telemetry_send_frame(void);
+#else
+#define telemetry_record_gfx_pool()
+#define telemetry_send_frame()
+#endif
+
+#endif // TELEMETRY_H
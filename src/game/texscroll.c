@@ -4,6 +4,8 @@
 #include "engine/math_util.h"
 #include "src/engine/behavior_script.h"
 #include "tile_scroll.h"
+#include "area.h"
+#include "level_table.h"
 #include "texscroll.h"
 
 #ifdef TARGET_N64
@@ -12,17 +14,103 @@
 #define SCROLL_CONDITION(condition) 1
 #endif
 
+struct LevelTexScrolls {
+    s16 levelNum;
+    uintptr_t segment7Start;
+    const struct TexScroll *scrolls;
+    struct TexScrollState *states;
+    s32 count;
+};
+
+#define LEVEL_TEXSCROLLS(levelNum, level) \
+    { (levelNum), (uintptr_t) _##level##_segment_7SegmentRomStart, level##_texscrolls, level##_texscroll_states, ARRAY_COUNT(level##_texscrolls) }
+
+// Built from levels/*/texscroll.inc.c by tools/texscroll_tables.py.
+#include "src/game/texscroll_tables.inc.c"
+
+static s16 sCachedLevelNum = LEVEL_NONE;
+static uintptr_t sCachedSegment7 = 0;
+static const struct LevelTexScrolls *sCachedLevelTexScrolls = NULL;
+
+static void scroll_vtx(const struct TexScroll *scroll, struct TexScrollState *state) {
+    Vtx *vertices = segmented_to_virtual(scroll->data);
+    s32 deltaS = scroll->speedS % scroll->width;
+    s32 deltaT = scroll->speedT % scroll->height;
+    s32 i;
+
+    if (absi(state->currentS) > scroll->width) {
+        deltaS -= (s32)(absi(state->currentS) / scroll->width) * scroll->width * signum_positive(deltaS);
+    }
+    if (absi(state->currentT) > scroll->height) {
+        deltaT -= (s32)(absi(state->currentT) / scroll->height) * scroll->height * signum_positive(deltaT);
+    }
+
+    for (i = 0; i < scroll->index; i++) {
+        vertices[i].n.tc[0] += deltaS;
+        vertices[i].n.tc[1] += deltaT;
+    }
+
+    state->currentS += deltaS;
+    state->currentT += deltaT;
+}
+
+static void scroll_tile(const struct TexScroll *scroll, struct TexScrollState *state) {
+    Gfx *dl = segmented_to_virtual(scroll->data);
+    s32 s = state->currentS + scroll->speedS;
+    s32 t = state->currentT + scroll->speedT;
+
+    // The tile moves in 1/4 texels, so slower speeds carry their remainder over to the next frame.
+    shift_s(dl, scroll->index, (s >> 3) - (state->currentS >> 3));
+    shift_t(dl, scroll->index, (t >> 3) - (state->currentT >> 3));
+
+    // The 12 bit tile coordinates wrap on their own, which is seamless for any power of two texture,
+    // so the position only has to be kept within that range too.
+    state->currentS = s & ((0x1000 << 3) - 1);
+    state->currentT = t & ((0x1000 << 3) - 1);
+}
+
+/**
+ * Find the scroll table of the current level, or NULL if it has none or its segment 7 isn't loaded.
+ */
+static const struct LevelTexScrolls *find_level_texscrolls(void) {
+    s32 i;
+
+    for (i = 0; i < (s32) ARRAY_COUNT(sLevelTexScrolls); i++) {
+        if (sLevelTexScrolls[i].levelNum == gCurrLevelNum
+            && SCROLL_CONDITION(sSegmentROMTable[0x7] == sLevelTexScrolls[i].segment7Start)) {
+            return &sLevelTexScrolls[i];
+        }
+    }
+
+    return NULL;
+}
 
-#include "src/game/texscroll/wf_texscroll.inc.c"
-#include "src/game/texscroll/jrb_texscroll.inc.c"
 void scroll_textures() {
+    const struct LevelTexScrolls *level;
+    s32 i;
+
+    // Only search the table again when another level or another level's data was loaded.
+    if (sCachedLevelNum != gCurrLevelNum || sCachedSegment7 != sSegmentROMTable[0x7]) {
+        sCachedLevelNum = gCurrLevelNum;
+        sCachedSegment7 = sSegmentROMTable[0x7];
+        sCachedLevelTexScrolls = find_level_texscrolls();
+    }
 
-	if(SCROLL_CONDITION(sSegmentROMTable[0x7] == (uintptr_t)_wf_segment_7SegmentRomStart)) {
-		scroll_textures_wf();
-	}
+    if ((level = sCachedLevelTexScrolls) == NULL) {
+        return;
+    }
 
-	if(SCROLL_CONDITION(sSegmentROMTable[0x7] == (uintptr_t)_jrb_segment_7SegmentRomStart)) {
-		scroll_textures_jrb();
-	}
+    for (i = 0; i < level->count; i++) {
+        const struct TexScroll *scroll = &level->scrolls[i];
 
+        if (scroll->type == TEXSCROLL_TYPE_FUNC) {
+            ((void (*)(void)) scroll->data)();
+        } else if (scroll->speedS == 0 && scroll->speedT == 0) {
+            continue;
+        } else if (scroll->type == TEXSCROLL_TYPE_TILE) {
+            scroll_tile(scroll, &level->states[i]);
+        } else {
+            scroll_vtx(scroll, &level->states[i]);
+        }
+    }
 }
@@ -1,9 +1,47 @@
 #ifndef TEXSCROLL_H
 #define TEXSCROLL_H
 
+#include "types.h"
+
+enum TexScrollType {
+    TEXSCROLL_TYPE_VTX,  // Offsets the texture coordinates of every vertex in a Vtx array.
+    TEXSCROLL_TYPE_TILE, // Shifts a single G_SETTILESIZE command, at a constant cost.
+    TEXSCROLL_TYPE_FUNC, // Calls a scroll function that has no descriptor form.
+};
+
+/**
+ * Describes one scrolling texture of a level. The tables are generated from the Fast64 exports
+ * of each level by tools/texscroll_tables.py.
+ * Speeds are in texture coordinate units (1/32 of a texel). For TEXSCROLL_TYPE_VTX, so are the sizes,
+ * for TEXSCROLL_TYPE_TILE, the size is unused and the command moves whenever a whole 1/4 texel is reached.
+ */
+struct TexScroll {
+    /*0x00*/ void *data;  // Segmented Vtx array or display list, or the scroll function
+    /*0x04*/ u16 index;   // Vertex count, or the G_SETTILESIZE command's index in the display list
+    /*0x06*/ u8 type;
+    /*0x08*/ s16 speedS;
+    /*0x0A*/ s16 speedT;
+    /*0x0C*/ s16 width;
+    /*0x0E*/ s16 height;
+};
+
+struct TexScrollState {
+    s32 currentS;
+    s32 currentT;
+};
+
+// Scroll the texture coordinates of the first count vertices of vtx, with speeds and texture size in texels.
+#define TEXSCROLL_VTX(vtx, count, speedS, speedT, width, height) \
+    { (void *) (vtx), (count), TEXSCROLL_TYPE_VTX, (s16) ((speedS) * 0x20), (s16) ((speedT) * 0x20), (width) * 0x20, (height) * 0x20 }
+
+// Scroll the tile of the cmd'th command of dl, which must be a G_SETTILESIZE, with speeds in 1/4 texels.
+#define TEXSCROLL_TILE(dl, cmd, speedS, speedT) \
+    { (void *) (dl), (cmd), TEXSCROLL_TYPE_TILE, (s16) ((speedS) * 8), (s16) ((speedT) * 8), 0, 0 }
+
+// Call func every frame.
+#define TEXSCROLL_FUNC(func) \
+    { (void *) (func), 0, TEXSCROLL_TYPE_FUNC, 0, 0, 0, 0 }
 
-#include "src/game/texscroll/wf_texscroll.inc.h"
-#include "src/game/texscroll/jrb_texscroll.inc.h"
 extern void scroll_textures();
 
 #endif
@@ -1,7 +0,0 @@
-#include "levels/jrb/header.h"
-
-#include "levels/jrb/texscroll.inc.c"
-
-void scroll_textures_jrb() {
-	scroll_jrb();
-}
@@ -1,3 +0,0 @@
-#include "levels/jrb/texscroll.inc.h"
-
-extern void scroll_textures_jrb();
@@ -1,7 +0,0 @@
-#include "levels/wf/header.h"
-
-#include "levels/wf/texscroll.inc.c"
-
-void scroll_textures_wf() {
-	scroll_wf();
-}
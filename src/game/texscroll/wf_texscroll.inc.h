@@ -1,3 +0,0 @@
-#include "levels/wf/texscroll.inc.h"
-
-extern void scroll_textures_wf();
@@ -1,4 +1,5 @@
 #include <PR/ultratypes.h>
+#include <math.h>
 
 #include "debug_utils.h"
 #include "gd_macros.h"
@@ -9,11 +10,13 @@
 #include "renderer.h"
 
 /**
- * Finds the square root of a float by treating
- * it as a double and finding the square root from there.
+ * Finds the square root of a float, rounding numbers near 0 down to 0.
  */
 f32 gd_sqrt_f(f32 val) {
-    return (f32) gd_sqrt_d(val);
+    if (val < 1.0e-7f) {
+        return 0.0f;
+    }
+    return sqrtf(val);
 }
 
 /**
@@ -173,8 +176,8 @@ void gd_create_origin_lookat(Mat4f *mtx, struct GdVec3f *vec, f32 roll) {
     hMag = gd_sqrt_f(SQ(unit.x) + SQ(unit.z));
 
     roll *= radPerDeg; // convert roll from degrees to radians
-    s = gd_sin_d(roll);
-    c = gd_cos_d(roll);
+    s = gd_sin_f(roll);
+    c = gd_cos_f(roll);
 
     gd_set_identity_mat4(mtx);
     if (hMag != 0.0f) {
@@ -263,11 +266,12 @@ void gd_clamp_vec3f(struct GdVec3f *vec, f32 limit) {
 void gd_rot_2d_vec(f32 deg, f32 *x, f32 *y) {
     f32 xP;
     f32 yP;
-    f32 rad;
+    f32 rad = deg / DEG_PER_RAD;
+    f32 s = gd_sin_f(rad);
+    f32 c = gd_cos_f(rad);
 
-    rad = deg / DEG_PER_RAD;
-    xP = (*x * gd_cos_d(rad)) - (*y * gd_sin_d(rad));
-    yP = (*x * gd_sin_d(rad)) + (*y * gd_cos_d(rad));
+    xP = (*x * c) - (*y * s);
+    yP = (*x * s) + (*y * c);
     *x = xP;
     *y = yP;
 }
@@ -744,8 +748,8 @@ void gd_create_rot_mat_angular(Mat4f *mtx, struct GdVec3f *vec, f32 ang) {
     f32 s;
     f32 c;
 
-    s = gd_sin_d(ang / (DEG_PER_RAD / 2.0));
-    c = gd_cos_d(ang / (DEG_PER_RAD / 2.0));
+    s = gd_sin_f(ang / (DEG_PER_RAD / 2.0f));
+    c = gd_cos_f(ang / (DEG_PER_RAD / 2.0f));
 
     gd_create_rot_matrix(mtx, vec, s, c);
 }
@@ -28,6 +28,7 @@ f32 gd_3x3_det(f32 r0c0, f32 r0c1, f32 r0c2,
                f32 r2c0, f32 r2c1, f32 r2c2);
 f32 gd_2x2_det(f32 a, f32 b, f32 c, f32 d);
 
+f32 gd_sqrt_f(f32 val);
 void gd_mat4f_lookat(Mat4f *mtx, f32 xFrom, f32 yFrom, f32 zFrom, f32 xTo, f32 yTo, f32 zTo,
                      f32 zColY, f32 yColY, f32 xColY);
 void gd_scale_mat4f_by_vec3f(Mat4f *mtx, struct GdVec3f *vec);
@@ -1,5 +1,6 @@
 #include <PR/ultratypes.h>
 
+#include "macros.h"
 #include "debug_utils.h"
 #include "gd_memory.h"
 #include "renderer.h"
@@ -10,136 +11,91 @@
  * This file contains the functions need to manage allocation in
  * goddard's heap. However, the actual, useable allocation functions
  * are `gd_malloc()`, `gd_malloc_perm()`, and `gd_malloc_temp()`, as
- * well as `gd_free()`. This file is for managing the underlying memory
- * block lists.
+ * well as `gd_free()`. This file is for managing the underlying arenas.
+ *
+ * Every region added to the heap becomes an arena that is allocated from
+ * linearly. Goddard builds its whole scene once when the head is loaded and
+ * mostly frees temporary buffers afterwards, so most frees are of the most
+ * recent allocation and just rewind the arena. Other frees go on the arena's
+ * free list, where they are merged with their free neighbours and reused by
+ * later allocations. A free block that ends up at the end of the arena is given
+ * back to it, and an arena resets completely once nothing in it is alive anymore.
  */
 
 /* bss */
-static struct GMemBlock *sFreeBlockListHead;
-static struct GMemBlock *sUsedBlockListHead;
-static struct GMemBlock *sEmptyBlockListHead;
+static struct GdArena sArenas[GD_MAX_ARENAS];
+static s32 sArenaCount;
+
+/// Smallest block that can be split off a free block.
+#define GD_MIN_FREE_BLOCK (sizeof(struct GdAllocHeader) + GD_MIN_ALLOC_SIZE)
 
-/* Forward Declarations */
-void empty_mem_block(struct GMemBlock *);
-struct GMemBlock *into_free_memblock(struct GMemBlock *);
-struct GMemBlock *make_mem_block(u32, u8);
-u32 print_list_stats(struct GMemBlock *, s32, s32);
+static u8 *block_end(struct GdFreeBlock *block) {
+    return (u8 *) &block->header + sizeof(struct GdAllocHeader) + block->header.size;
+}
 
 /**
- * Empty a `GMemBlock` into a default state. This empty block
- * doesn't point to any data, nor does it have any size. The
- * block is removed from whatever list is was in, and is added
- * to the empty block list.
+ * Put a freed block on its arena's free list, merging it with the free blocks
+ * next to it, and give it back to the arena if it ends up at the end.
  */
-void empty_mem_block(struct GMemBlock *block) {
-    if (block->next != NULL) {
-        block->next->prev = block->prev;
-    }
+static void release_block(struct GdArena *arena, struct GdFreeBlock *block) {
+    struct GdFreeBlock **prevLink = NULL;
+    struct GdFreeBlock **link = &arena->freeList;
 
-    if (block->prev != NULL) {
-        block->prev->next = block->next;
-    }
+    block->header.arenaIndex = GD_FREE_BLOCK;
 
-    switch (block->blockType) {
-        case G_MEM_BLOCK_FREE:
-            if (block->prev == NULL) {
-                sFreeBlockListHead = block->next;
-            }
-            break;
-        case G_MEM_BLOCK_USED:
-            if (block->prev == NULL) {
-                sUsedBlockListHead = block->next;
-            }
-            break;
+    while (*link != NULL && *link < block) {
+        prevLink = link;
+        link = &(*link)->next;
     }
+    block->next = *link;
+    *link = block;
 
-    block->next = sEmptyBlockListHead;
-    if (block->next != NULL) {
-        sEmptyBlockListHead->prev = block;
+    if (block->next != NULL && block_end(block) == (u8 *) block->next) {
+        block->header.size += sizeof(struct GdAllocHeader) + block->next->header.size;
+        block->next = block->next->next;
+    }
+    if (prevLink != NULL && block_end(*prevLink) == (u8 *) block) {
+        (*prevLink)->header.size += sizeof(struct GdAllocHeader) + block->header.size;
+        (*prevLink)->next = block->next;
+        block = *prevLink;
+        link = prevLink;
     }
 
-    sEmptyBlockListHead = block;
-    block->prev = NULL;
-    block->ptr = NULL;
-    block->size = 0;
-}
-
-/**
- * Transform a `GMemBlock` into a free block that points to memory available
- * for allocation.
- *
- * @returns pointer to the free `GMemBlock` */
-struct GMemBlock *into_free_memblock(struct GMemBlock *block) {
-    struct GMemBlock *freeBlock;
-    void *ptr;
-    u8 permanence;
-    u32 space;
-
-    ptr = block->ptr;
-    space = block->size;
-    permanence = block->permFlag;
-
-    empty_mem_block(block);
-    freeBlock = make_mem_block(G_MEM_BLOCK_FREE, permanence);
-    freeBlock->ptr = ptr;
-    freeBlock->size = space;
-    freeBlock->permFlag = permanence;
-
-    return freeBlock;
+    if (block->next == NULL && block_end(block) == arena->base + arena->used) {
+        arena->used = (u8 *) block - arena->base;
+        *link = NULL;
+    }
 }
 
 /**
- * Allocate a new `GMemBlock` structure of the given type and permanence.
- * It does not assign any heap space to the new block.
+ * Take a block of exactly `size` bytes from the arena's free list, splitting
+ * larger blocks when the rest can still hold a free block.
  *
- * @param blockType either `G_MEM_BLOCK_FREE` or `G_MEM_BLOCK_USED`
- * @param permFlag  some sort of permanence value, where setting one the upper
- *                  four bits imply a permanent block, while setting one the lower
- *                  four bits imply a temporary block
- * @returns a pointer to the new `GMemBlock`
+ * @retval NULL no free block fits
  */
-struct GMemBlock *make_mem_block(u32 blockType, u8 permFlag) {
-    struct GMemBlock *newMemBlock;
+static struct GdAllocHeader *reuse_block(struct GdArena *arena, u32 size) {
+    struct GdFreeBlock **link;
 
-    if (sEmptyBlockListHead == NULL) {
-        sEmptyBlockListHead = (struct GMemBlock *) gd_allocblock(sizeof(struct GMemBlock));
+    for (link = &arena->freeList; *link != NULL; link = &(*link)->next) {
+        struct GdFreeBlock *block = *link;
 
-        if (sEmptyBlockListHead == NULL) {
-            fatal_printf("MakeMemBlock() unable to allocate");
+        if (block->header.size == size) {
+            *link = block->next;
+            return &block->header;
         }
 
-        sEmptyBlockListHead->next = NULL;
-        sEmptyBlockListHead->prev = NULL;
-    }
-
-    newMemBlock = sEmptyBlockListHead;
-    if ((sEmptyBlockListHead = newMemBlock->next) != NULL) {
-        newMemBlock->next->prev = NULL;
-    }
+        if (block->header.size >= size + GD_MIN_FREE_BLOCK) {
+            struct GdFreeBlock *rest = (struct GdFreeBlock *) ((u8 *) block + sizeof(struct GdAllocHeader) + size);
 
-    switch (blockType) {
-        case G_MEM_BLOCK_FREE:
-            newMemBlock->next = sFreeBlockListHead;
-            if (newMemBlock->next != NULL) {
-                sFreeBlockListHead->prev = newMemBlock;
-            }
-            sFreeBlockListHead = newMemBlock;
-            break;
-        case G_MEM_BLOCK_USED:
-            newMemBlock->next = sUsedBlockListHead;
-            if (newMemBlock->next != NULL) {
-                sUsedBlockListHead->prev = newMemBlock;
-            }
-            sUsedBlockListHead = newMemBlock;
-            break;
-        default:
-            fatal_printf("unkown memblock type");
+            rest->header.size = block->header.size - sizeof(struct GdAllocHeader) - size;
+            rest->header.arenaIndex = GD_FREE_BLOCK;
+            rest->next = block->next;
+            *link = rest;
+            return &block->header;
+        }
     }
-    newMemBlock->prev = NULL;
-    newMemBlock->blockType = (u8) blockType;
-    newMemBlock->permFlag = permFlag;
 
-    return newMemBlock;
+    return NULL;
 }
 
 /**
@@ -150,165 +106,134 @@ struct GMemBlock *make_mem_block(u32 blockType, u8 permFlag) {
  * @retval  0    `ptr` did not point to a valid memory block
  */
 u32 gd_free_mem(void *ptr) {
-    register struct GMemBlock *curBlock;
-    u32 bytesFreed;
-    register u8 *targetBlock = ptr;
-
-    for (curBlock = sUsedBlockListHead; curBlock != NULL; curBlock = curBlock->next) {
-        if (targetBlock == curBlock->ptr) {
-            bytesFreed = curBlock->size;
-            into_free_memblock(curBlock);
-            return bytesFreed;
-        }
+    struct GdAllocHeader *header = (struct GdAllocHeader *) ptr - 1;
+    struct GdArena *arena;
+    u32 size;
+
+    if (header->arenaIndex >= (u32) sArenaCount) {
+        fatal_printf("Free() Not a valid memory block");
+        return 0;
+    }
+
+    arena = &sArenas[header->arenaIndex];
+    if ((u8 *) header < arena->base || (u8 *) ptr + header->size > arena->base + arena->used) {
+        fatal_printf("Free() Not a valid memory block");
+        return 0;
     }
 
-    fatal_printf("Free() Not a valid memory block");
-    return 0;
+    size = header->size;
+    if (--arena->liveAllocs == 0) {
+        arena->used = 0;
+        arena->freeList = NULL;
+    } else {
+        release_block(arena, (struct GdFreeBlock *) header);
+    }
+
+    return size;
 }
 
 /**
- * Request a pointer to goddard heap memory of at least `size` and
- * of the same `permanence`.
+ * Request a pointer to goddard heap memory of `size` and of the same
+ * `permanence`. `size` has to be at least `GD_MIN_ALLOC_SIZE`, so that
+ * `gd_free_mem()` gives back the size that was requested.
  *
  * @return pointer to heap
  * @retval NULL could not fulfill the request
  */
 void *gd_request_mem(u32 size, u8 permanence) {
-    struct GMemBlock *foundBlock = NULL;
-    struct GMemBlock *curBlock;
-    struct GMemBlock *newBlock;
-
-    newBlock = make_mem_block(G_MEM_BLOCK_USED, permanence);
-    curBlock = sFreeBlockListHead;
-
-    while (curBlock != NULL) {
-        if (curBlock->permFlag & permanence) {
-            if (curBlock->size == size) {
-                foundBlock = curBlock;
-                break;
-            } else {
-                if (curBlock->size > size) {
-                    if (foundBlock != NULL) { /* find closest sized block */
-                        if (curBlock->size < foundBlock->size) {
-                            foundBlock = curBlock;
-                        }
-                    } else {
-                        foundBlock = curBlock;
-                    }
-                }
-            }
-        }
-        curBlock = curBlock->next;
-    }
+    u32 needed;
+    s32 i;
 
-    if (foundBlock == NULL) {
+    if (size < GD_MIN_ALLOC_SIZE) {
+        fatal_printf("gd_request_mem(): %d bytes is below the minimum allocation", size);
         return NULL;
     }
+    needed = sizeof(struct GdAllocHeader) + size;
 
-    if (foundBlock->size > size) { /* split free block */
-        newBlock->ptr = foundBlock->ptr;
-        newBlock->size = size;
+    for (i = 0; i < sArenaCount; i++) {
+        struct GdArena *arena = &sArenas[i];
+        struct GdAllocHeader *header;
+
+        if (!(arena->permFlag & permanence)) {
+            continue;
+        }
 
-        foundBlock->size -= size;
-        foundBlock->ptr += size;
-    } else if (foundBlock->size == size) { /* recycle whole free block */
-        newBlock->ptr = foundBlock->ptr;
-        newBlock->size = size;
-        empty_mem_block(foundBlock);
+        if ((header = reuse_block(arena, size)) == NULL) {
+            if (arena->size - arena->used < needed) {
+                continue;
+            }
+
+            header = (struct GdAllocHeader *) (arena->base + arena->used);
+            arena->used += needed;
+            if (arena->used > arena->peak) {
+                arena->peak = arena->used;
+            }
+        }
+
+        header->size = size;
+        header->arenaIndex = i;
+        arena->liveAllocs++;
+
+        return header + 1;
     }
 
-    return newBlock->ptr;
+    return NULL;
 }
 
 /**
  * Add memory of `size` at `addr` to the goddard heap for later allocation.
- *
- * @returns `GMemBlock` that contains info about the new heap memory
  */
-struct GMemBlock *gd_add_mem_to_heap(u32 size, void *addr, u8 permanence) {
-    struct GMemBlock *newBlock;
-    /* eight-byte align the new block's data stats */
-    size = (size - 8) & ~7;
-    addr = (void *)(((uintptr_t) addr + 8) & ~7);
+void gd_add_mem_to_heap(u32 size, void *addr, u8 permanence) {
+    struct GdArena *arena;
 
-    newBlock = make_mem_block(G_MEM_BLOCK_FREE, permanence);
-    newBlock->ptr = addr;
-    newBlock->size = size;
+    if (sArenaCount >= GD_MAX_ARENAS) {
+        fatal_printf("gd_add_mem_to_heap(): too many arenas");
+        return;
+    }
 
-    return newBlock;
+    arena = &sArenas[sArenaCount++];
+    /* eight-byte align the new arena's data stats */
+    arena->size = (size - 8) & ~7;
+    arena->base = (u8 *) (((uintptr_t) addr + 8) & ~7);
+    arena->used = 0;
+    arena->peak = 0;
+    arena->liveAllocs = 0;
+    arena->freeList = NULL;
+    arena->permFlag = permanence;
 }
 
 /**
- * NULL the various `GMemBlock` list heads
+ * Remove every arena from the heap.
  */
-void init_mem_block_lists(void) {
-    sFreeBlockListHead = NULL;
-    sUsedBlockListHead = NULL;
-    sEmptyBlockListHead = NULL;
+void init_mem_arenas(void) {
+    sArenaCount = 0;
 }
 
 /**
- * Print information (size, entries) about the `GMemBlock` list. It can print
- * information for individual blocks as well as summary info for the entry list.
- *
- * @param block          `GMemBlock` to start reading the list
- * @param printBlockInfo If `TRUE`, print information about every block
- *                       in the list
- * @param permanence     Limit info printed to blocks with this permanence
- * @returns number of entries
+ * Print information (size, usage, live allocations) about every arena
+ * with the given permanence.
  */
-u32 print_list_stats(struct GMemBlock *block, s32 printBlockInfo, s32 permanence) {
-    u32 entries = 0;
-    u32 totalSize = 0;
-
-    while (block != NULL) {
-        if (block->permFlag & permanence) {
-            entries++;
-            if (printBlockInfo) {
-                gd_printf("     %6.2fk (%d bytes)\n",
-                          (f32) block->size / 1024.0, //? 1024.0f
-                          block->size);
-            }
-            totalSize += block->size;
-        }
-        block = block->next;
-    }
+static void print_arena_stats(s32 permanence) {
+    s32 i;
 
-    gd_printf("Total %6.2fk (%d bytes) in %d entries\n",
-              (f32) totalSize / 1024.0, //? 1024.0f
-              totalSize, entries);
+    for (i = 0; i < sArenaCount; i++) {
+        struct GdArena *arena = &sArenas[i];
 
-    return entries;
+        if (arena->permFlag & permanence) {
+            gd_printf("     %dk / %dk used (peak %dk) in %d entries\n",
+                      arena->used / 1024, arena->size / 1024, arena->peak / 1024, arena->liveAllocs);
+        }
+    }
 }
 
 /**
- * Print summary information about all used, free, and empty
- * `GMemBlock`s.
+ * Print summary information about all permanent and temporary arenas.
  */
 void mem_stats(void) {
-    struct GMemBlock *list;
-
-    gd_printf("Perm Used blocks:\n");
-    list = sUsedBlockListHead;
-    print_list_stats(list, FALSE, PERM_G_MEM_BLOCK);
-    gd_printf("\n");
-
-    gd_printf("Perm Free blocks:\n");
-    list = sFreeBlockListHead;
-    print_list_stats(list, FALSE, PERM_G_MEM_BLOCK);
-    gd_printf("\n");
-
-    gd_printf("Temp Used blocks:\n");
-    list = sUsedBlockListHead;
-    print_list_stats(list, FALSE, TEMP_G_MEM_BLOCK);
-    gd_printf("\n");
-
-    gd_printf("Temp Free blocks:\n");
-    list = sFreeBlockListHead;
-    print_list_stats(list, FALSE, TEMP_G_MEM_BLOCK);
+    gd_printf("Perm arenas:\n");
+    print_arena_stats(PERM_G_MEM_BLOCK);
     gd_printf("\n");
 
-    gd_printf("Empty blocks:\n");
-    list = sEmptyBlockListHead;
-    print_list_stats(list, FALSE, PERM_G_MEM_BLOCK | TEMP_G_MEM_BLOCK);
+    gd_printf("Temp arenas:\n");
+    print_arena_stats(TEMP_G_MEM_BLOCK);
 }
@@ -3,23 +3,40 @@
 
 #include <PR/ultratypes.h>
 
-/// A structure that holds information about memory allocation on goddard's heap.
-struct GMemBlock {
-    /* 0x00 */ u8 *ptr;
-    /* 0x04 */ u32 size;
-    /* 0x08 */ u8 blockType;
-    /* 0x09 */ u8 permFlag; ///< Permanent (upper four bits) or Temporary (lower four bits)
-    /* 0x0C */ struct GMemBlock *next;
-    /* 0x10 */ struct GMemBlock *prev;
+#include "macros.h"
+
+/// Header placed in front of every allocation, padded to keep allocations eight-byte aligned.
+struct GdAllocHeader {
+    /* 0x00 */ u32 size;
+    /* 0x04 */ u32 arenaIndex; ///< `GD_FREE_BLOCK` while the block is on a free list
 };
 
-/// Block list types for `GMemBlock.blockType`. Note that Empty Blocks don't have
-/// a specific value.
-enum GMemBlockTypes {
-    G_MEM_BLOCK_FREE = 1,
-    G_MEM_BLOCK_USED = 2
+/// A freed block that isn't at the end of its arena, kept until it can be reused or merged.
+struct GdFreeBlock {
+    /* 0x00 */ struct GdAllocHeader header;
+    /* 0x08 */ struct GdFreeBlock *next;
+};
+
+/// A region of goddard's heap that is allocated from linearly, reusing freed blocks first.
+struct GdArena {
+    /* 0x00 */ u8 *base;
+    /* 0x04 */ u32 size;
+    /* 0x08 */ u32 used;
+    /* 0x0C */ u32 peak;
+    /* 0x10 */ u32 liveAllocs;
+    /* 0x14 */ struct GdFreeBlock *freeList; ///< Sorted by address, with no two blocks adjacent
+    /* 0x18 */ u8 permFlag; ///< Permanent (upper four bits) or Temporary (lower four bits)
 };
-/* Block Permanence Defines */
+
+#define GD_FREE_BLOCK 0xFFFFFFFF
+
+/// Smallest allocation size, since every block has to be able to hold a `GdFreeBlock` once it is freed.
+#define GD_MIN_ALLOC_SIZE (ALIGN8(sizeof(struct GdFreeBlock)) - sizeof(struct GdAllocHeader))
+
+/// Maximum number of regions that can be added to the heap with `gd_add_mem_to_heap()`.
+#define GD_MAX_ARENAS 4
+
+/* Arena Permanence Defines */
 /* This may be collections of certain allocation types
  * eg. 0x10 = Object; 0x20 = Color Buffer; 0x40 = Z Buf; 0x01 = basic; etc. */
 #define PERM_G_MEM_BLOCK 0xF0
@@ -28,8 +45,8 @@ enum GMemBlockTypes {
 // functions
 extern u32 gd_free_mem(void *ptr);
 extern void *gd_request_mem(u32 size, u8 permanence);
-extern struct GMemBlock *gd_add_mem_to_heap(u32 size, void *addr, u8 permanence);
-extern void init_mem_block_lists(void);
+extern void gd_add_mem_to_heap(u32 size, void *addr, u8 permanence);
+extern void init_mem_arenas(void);
 extern void mem_stats(void);
 
 #endif // GD_MEMORY_H
@@ -843,23 +843,15 @@ static Vp *next_vp(void) {
 }
 
 /* 249AAC -> 249AEC */
-f64 gd_sin_d(f64 x) {
+f32 gd_sin_f(f32 x) {
     return sinf(x);
 }
 
 /* 249AEC -> 249B2C */
-f64 gd_cos_d(f64 x) {
+f32 gd_cos_f(f32 x) {
     return cosf(x);
 }
 
-/* 249B2C -> 249BA4 */
-f64 gd_sqrt_d(f64 x) {
-    if (x < 1.0e-7) {
-        return 0.0;
-    }
-    return sqrtf(x);
-}
-
 
 #if defined(ISVPRINT) || defined(UNF)
 #define stubbed_printf osSyncPrintf
@@ -1005,7 +997,7 @@ void *gd_allocblock(u32 size) {
 /* 24A318 -> 24A3E8 */
 void *gd_malloc(u32 size, u8 perm) {
     void *ptr; // 1c
-    size = ALIGN8(size);
+    size = ALIGN8(MAX(size, GD_MIN_ALLOC_SIZE));
     ptr = gd_request_mem(size, perm);
 
     if (ptr == NULL) {
@@ -1166,7 +1158,7 @@ void gdm_init(void *blockpool, u32 size) {
     sMemBlockPoolSize = size;
     sMemBlockPoolUsed = 0;
     sAllocMemory = 0;
-    init_mem_block_lists();
+    init_mem_arenas();
     gd_reset_sfx();
     imout();
 }
@@ -1828,7 +1820,7 @@ void gd_dl_lookat(struct ObjCamera *cam, f32 arg1, f32 arg2, f32 arg3, f32 arg4,
 
     arg7 *= RAD_PER_DEG;
 
-    gd_mat4f_lookat(&cam->unkE8, arg1, arg2, arg3, arg4, arg5, arg6, gd_sin_d(arg7), gd_cos_d(arg7),
+    gd_mat4f_lookat(&cam->unkE8, arg1, arg2, arg3, arg4, arg5, arg6, gd_sin_f(arg7), gd_cos_f(arg7),
                   0.0f);
 
     mat4_to_mtx(&cam->unkE8, &DL_CURRENT_MTX(sCurrentGdDl));
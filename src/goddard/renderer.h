@@ -40,9 +40,8 @@ extern s32 gGdFrameBufNum;
 u32 get_alloc_mem_amt(void);
 s32 gd_get_ostime(void);
 f32 get_time_scale(void);
-f64 gd_sin_d(f64 x);
-f64 gd_cos_d(f64 x);
-f64 gd_sqrt_d(f64 x);
+f32 gd_sin_f(f32 x);
+f32 gd_cos_f(f32 x);
 
 #if defined(ISVPRINT) || defined(UNF)
 #define gd_printf osSyncPrintf
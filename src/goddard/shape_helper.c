@@ -564,7 +564,7 @@ void Unknown80198444(struct ObjVertex *vtx) {
     distance = vtx->pos.x * vtx->pos.x + vtx->pos.y * vtx->pos.y + vtx->pos.z * vtx->pos.z;
 
     if (distance != 0.0) {
-        distance = gd_sqrt_d(distance); // sqrtd?
+        distance = gd_sqrt_f(distance);
 
         if (distance > D_801A8668) {
             D_801A8668 = distance;
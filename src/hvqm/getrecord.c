@@ -11,67 +11,213 @@
 
 #include <ultra64.h>
 #include <HVQM2File.h>
+#include "game/debug.h"
 #include "hvqm.h"
 
 /*
- * u8 *get_record(HVQM2Record *headerbuf, void *bodybuf, 
- *                u16 type, u8 *stream, OSIoMesg *mb, OSMesgQueue *mq)
+ * Read-ahead record queue
  *
- * Arguments
- *     headerbuf Buffer storing the record header (HVQM2Record structure)
- *     bodybuf   Buffer storing the record's data (record body)
- *     type      The requested record type
- *     stream    The current HVQM2 record address
- *     mb        I/O message block request sent to PI manager
- *     mq        Message queue receiving notice of DMA end from PI manager
- *  
- * Explanation:
- *   Finds the next record of the specified "type" from the HVQM2 data
- * address "stream" in ROM, and reads the record header into "headerbuf"
- * and the data body into "bodybuf."  Specify HVQM2_AUDIO for "type" to
- * read an audio record, and specify HVQM2_VIDEO to read a video record.
+ *   Audio and video records are read by separate threads (the timekeeper
+ * and the HVQM thread), each through its own queue.  A queue looks up the
+ * upcoming records of its type in the index built by tools/hvqm_index.py,
+ * so it never has to read the headers of the other type to skip them, and
+ * keeps up to HVQM_QUEUE_SLOTS of them in flight, DMAing them into its ring
+ * buffer while the current record is being decoded.  Audio records are
+ * read with a higher priority than video records, as before.
  *
- *   This function assumes that the reading of audio records and video 
- * records is performed in parallel by separate threads.  Accordingly, 
- * you must prepare in advance a separate mb (I/O message block request
- * sent to PI manager) and separate mq (message queue receiving notice
- * of DMA end from PI manager) for audio records and video records.
+ *   Records are returned one at a time by record_queue_next(), and stay
+ * valid until the next call.  The header is immediately followed by the
+ * body, which is 16 byte aligned to conform with the R4300 data cache
+ * line size.
+ */
+
+/* The header goes 8 bytes into the allocation, so that the body is 16 byte aligned */
+#define SLOT_HEADER_OFFSET  (16 - sizeof(HVQM2Record))
+#define SLOT_ALLOC_SIZE(size)  (((size) + SLOT_HEADER_OFFSET + 15) & ~15)
+
+/*
+ * Reserves "size" bytes in the ring, or returns -1 if they don't fit yet.
+ */
+static s32
+ring_alloc( HVQMRecordQueue *q, u32 size )
+{
+  u32 pos;
+
+  if ( q->first == q->issued ) {
+    q->ring_head = q->ring_tail = 0;
+  } else if ( q->ring_head == q->ring_tail ) {
+    return -1;
+  }
+
+  if ( q->ring_head >= q->ring_tail ) {
+    if ( q->ring_size - q->ring_head >= size ) {
+      pos = q->ring_head;
+    } else if ( q->ring_tail >= size ) {
+      pos = 0;
+    } else {
+      return -1;
+    }
+  } else if ( q->ring_tail - q->ring_head >= size ) {
+    pos = q->ring_head;
+  } else {
+    return -1;
+  }
+
+  q->ring_head = pos + size;
+  return pos;
+}
+
+static HVQMIndexEntry *
+next_entry( HVQMRecordQueue *q )
+{
+  if ( q->entry_pos == q->entry_count ) {
+    u32 count = ( q->remain < HVQM_INDEX_CHUNK ) ? q->remain : HVQM_INDEX_CHUNK;
+
+    romcpy( q->entries, q->index_rom, count * sizeof(HVQMIndexEntry), q->pri, &q->index_mb, &q->index_mq );
+    q->index_rom += count * sizeof(HVQMIndexEntry);
+    q->entry_pos = 0;
+    q->entry_count = count;
+  }
+  return &q->entries[q->entry_pos];
+}
+
+/*
+ * Starts reading as many upcoming records as there is room for.
+ */
+static void
+record_queue_fill( HVQMRecordQueue *q )
+{
+  while ( q->remain > 0 && q->issued - q->first < HVQM_QUEUE_SLOTS ) {
+    HVQMIndexEntry *entry = next_entry( q );
+    u32 size = HVQM_INDEX_SIZE( entry );
+    HVQMQueueSlot *slot = &q->slots[q->issued % HVQM_QUEUE_SLOTS];
+    s32 pos = ring_alloc( q, SLOT_ALLOC_SIZE(size) );
+
+    if ( pos < 0 ) break;
+
+    slot->record = (HVQM2Record *)(q->ring + pos + SLOT_HEADER_OFFSET);
+    slot->start = pos;
+    slot->end = pos + SLOT_ALLOC_SIZE(size);
+    slot->format = HVQM_INDEX_FORMAT( entry );
+
+    osInvalDCache( slot->record, (s32)size );
+    while ( osPiStartDma( &q->mb[q->issued % HVQM_QUEUE_SLOTS], q->pri, OS_READ,
+                          (u32)q->stream + entry->offset, slot->record, size, &q->mq ) == -1 ) {}
+
+    q->entry_pos++;
+    q->remain--;
+    q->issued++;
+  }
+}
+
+/*
+ * void record_queue_create(HVQMRecordQueue *q, void *ring, u32 ring_size, s32 pri)
  *
- *   The reading of audio records has priority over the reading of 
- * video records.
+ *   Sets up a queue that reads records into "ring" with the DMA priority
+ * "pri".  "ring" must have 16 byte alignment.
+ */
+void
+record_queue_create( HVQMRecordQueue *q, void *ring, u32 ring_size, s32 pri )
+{
+  q->ring = ring;
+  q->ring_size = ring_size;
+  q->pri = pri;
+  q->first = q->read = q->issued = q->done = 0;
+  q->remain = 0;
+  osCreateMesgQueue( &q->mq, q->mesg, HVQM_QUEUE_SLOTS );
+  osCreateMesgQueue( &q->index_mq, &q->index_mesg, 1 );
+}
+
+/*
+ * void record_queue_start(HVQMRecordQueue *q, u8 *stream, u8 *index_rom, u32 records)
  *
- *   "stream" must have 2byte alignment.  Please give headerbuf and
- * bodybuf 16byte alignment to conform with the R4300 data cache line
- * size.
+ *   (Re)starts the queue at the first of the "records" index entries at
+ * "index_rom", for the movie at "stream".  Records still being read are
+ * waited for first.
+ */
+void
+record_queue_start( HVQMRecordQueue *q, u8 *stream, u8 *index_rom, u32 records )
+{
+  for ( ; q->done != q->issued; q->done++ ) {
+    osRecvMesg( &q->mq, (OSMesg *)NULL, OS_MESG_BLOCK );
+  }
+
+  q->first = q->read = q->issued = q->done = 0;
+  q->stream = stream;
+  q->index_rom = index_rom;
+  q->remain = records;
+  q->entry_pos = q->entry_count = 0;
+  record_queue_fill( q );
+}
+
+/*
+ * HVQM2Record *record_queue_next(HVQMRecordQueue *q)
  *
- *   Please be sure to reserve sufficient space for bodybuf.
- * 
+ *   Releases the record returned last time, and returns the next one,
+ * waiting for it to be read if it isn't yet.  Returns NULL at the end
+ * of the stream.
+ */
+HVQM2Record *
+record_queue_next( HVQMRecordQueue *q )
+{
+  HVQMQueueSlot *slot;
+
+  if ( q->first != q->read ) {
+    q->first++;
+    if ( q->first != q->issued ) {
+      q->ring_tail = q->slots[q->first % HVQM_QUEUE_SLOTS].start;
+    }
+  }
+
+  record_queue_fill( q );
+  if ( q->read == q->issued ) {
+    /* Nothing is in flight, so the ring is empty and only a record larger than it can't be read */
+    assert( q->remain == 0, "HVQM record larger than its read-ahead buffer" );
+    return NULL;
+  }
+
+  for ( ; q->done <= q->read; q->done++ ) {
+    osRecvMesg( &q->mq, (OSMesg *)NULL, OS_MESG_BLOCK );
+  }
+
+  slot = &q->slots[q->read % HVQM_QUEUE_SLOTS];
+  q->read++;
+
+  /* Keep the PI busy with the records after this one while it's being decoded */
+  record_queue_fill( q );
+  return slot->record;
+}
+
+/*
+ * u16 record_queue_peek_format(HVQMRecordQueue *q)
+ *
+ *   Returns the format of the record record_queue_next() would return,
+ * without reading it, or HVQM_NO_RECORD at the end of the stream.
+ */
+u16
+record_queue_peek_format( HVQMRecordQueue *q )
+{
+  if ( q->read != q->issued ) return q->slots[q->read % HVQM_QUEUE_SLOTS].format;
+  if ( q->remain == 0 ) return HVQM_NO_RECORD;
+  return HVQM_INDEX_FORMAT( next_entry( q ) );
+}
+
+/*
+ * void record_queue_skip(HVQMRecordQueue *q)
  *
- * Returned value:
- *     The address of the next record
+ *   Drops the record record_queue_next() would return.  Records that
+ * haven't been requested yet are skipped without reading them.
  */
-u8 *
-get_record( HVQM2Record *headerbuf, void *bodybuf, u16 type, u8 *stream, OSIoMesg *mb, OSMesgQueue *mq )
+void
+record_queue_skip( HVQMRecordQueue *q )
 {
-  u16 record_type;
-  u32 record_size;
-  s32 pri;
-
-  pri = (type == HVQM2_AUDIO) ? OS_MESG_PRI_HIGH : OS_MESG_PRI_NORMAL;
-  for ( ; ; ) {
-    romcpy( headerbuf, stream, sizeof(HVQM2Record), pri, mb, mq );
-    stream += sizeof(HVQM2Record);
-    record_type = load16( headerbuf->type );
-    record_size = load32( headerbuf->size );
-    if ( record_type == type ) break;
-    stream += record_size;
-  } 
-
-  if ( record_size > 0 ) {
-    romcpy( bodybuf, stream, record_size, pri, mb, mq );
-    stream += record_size;
+  if ( q->read != q->issued ) {
+    record_queue_next( q );
+  } else if ( q->remain > 0 ) {
+    next_entry( q );
+    q->entry_pos++;
+    q->remain--;
   }
-  return stream;
 }
 
 /* end */
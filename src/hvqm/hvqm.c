@@ -6,21 +6,21 @@
 #include <adpcmdec.h>
 #include "hvqm.h"
 
-#define AUDIO_DMA_MSG_SIZE 1
-static OSIoMesg     audioDmaMesgBlock;
-static OSMesgQueue  audioDmaMessageQ;
-static OSMesg       audioDmaMessages[AUDIO_DMA_MSG_SIZE];
-
 /***********************************************************************
  *    Message queue for receiving message blocks and end of DMA 
- * notifications when requesting that video records be read from 
- * the HVQM2 data (ROM).
+ * notifications when reading the HVQM2 header and record index (ROM).
  ***********************************************************************/
 #define  VIDEO_DMA_MSG_SIZE  1
 static OSIoMesg     videoDmaMesgBlock;
 static OSMesgQueue  videoDmaMessageQ;
 static OSMesg       videoDmaMessages[VIDEO_DMA_MSG_SIZE];
 
+/***********************************************************************
+ * Read-ahead queues for audio and video records
+ ***********************************************************************/
+static HVQMRecordQueue audioQueue;
+static HVQMRecordQueue videoQueue;
+
 /***********************************************************************
  * SP event (SP task end) message queue
  ***********************************************************************/
@@ -37,13 +37,18 @@ HVQM2Arg hvq_sparg;		/* Parameter for the HVQM2 microcode */
  * Buffer for the HVQM2 header ***********************************************************************/
 u8 hvqm_headerBuf[sizeof(HVQM2Header) + 16];
 
+/***********************************************************************
+ * Buffer for the header of the record index
+ ***********************************************************************/
+static u8 hvqm_indexHeaderBuf[sizeof(HVQMIndexHeader) + 16];
+static HVQMIndexHeader *hvqm_index;
+static u8 *hvqm_indexRom;
+
 /***********************************************************************
  * Other data
  ***********************************************************************/
 static u32 total_frames;	/* Total number of video records (frames) */
 static u32 total_audio_records;	/* Total number of audio records */
-static void *video_streamP;	/* Video record read-in pointer */
-static void *audio_streamP;	/* Audio record read-in pointer */
 static u32 audio_remain;	/* Counter for remaining number of audio records to read */
 static u32 video_remain;	/* Counter for remaining number of video records to read */
 static u64 disptime;		/* Counter for scheduled display time of next video frame */
@@ -59,18 +64,17 @@ extern u8 _capcomSegmentRomStart[];
 extern u8 _seinSegmentRomStart[];
 
 static u32 next_audio_record( void *pcmbuf ) {
-  ALIGNED16 u8 header_buffer[sizeof(HVQM2Record)+16];
   HVQM2Record *record_header;
   HVQM2Audio *audio_headerP;
   u32 samples;
 
   if ( audio_remain == 0 ) return 0;
 
-  record_header = OS_DCACHE_ROUNDUP_ADDR(header_buffer);
-  audio_streamP = get_record(record_header, adpcmbuf, HVQM2_AUDIO, audio_streamP, &audioDmaMesgBlock, &audioDmaMessageQ);
+  record_header = record_queue_next( &audioQueue );
+  if ( record_header == NULL ) return 0;
   --audio_remain;
 
-  audio_headerP = (HVQM2Audio *)adpcmbuf;
+  audio_headerP = (HVQM2Audio *)&record_header[1];
   samples = load32(audio_headerP->samples);
   adpcmDecode(&audio_headerP[1], (u32)load16(record_header->format), samples, pcmbuf, 1, &adpcm_state);
 
@@ -78,7 +82,8 @@ static u32 next_audio_record( void *pcmbuf ) {
 }
 
 static tkAudioProc rewind( void ) {
-  video_streamP = audio_streamP = (u32)_capcomSegmentRomStart + sizeof(HVQM2Header);
+  record_queue_start( &videoQueue, _capcomSegmentRomStart, hvqm_indexRom + hvqm_index->video_entries, total_frames );
+  record_queue_start( &audioQueue, _capcomSegmentRomStart, hvqm_indexRom + hvqm_index->audio_entries, total_audio_records );
   audio_remain = total_audio_records;
   video_remain = total_frames;
   disptime = 0;
@@ -105,8 +110,9 @@ void hvqm_main_proc() {
     osCreateMesgQueue( &spMesgQ, &spMesgBuf, 1 );
     osSetEventMesg( OS_EVENT_SP, &spMesgQ, NULL );
     
-    osCreateMesgQueue( &audioDmaMessageQ, audioDmaMessages, AUDIO_DMA_MSG_SIZE );
     osCreateMesgQueue( &videoDmaMessageQ, videoDmaMessages, VIDEO_DMA_MSG_SIZE );
+    record_queue_create( &audioQueue, adpcmbuf, AUDIO_READAHEAD_SIZE, OS_MESG_PRI_HIGH );
+    record_queue_create( &videoQueue, hvqbuf, HVQ_READAHEAD_SIZE, OS_MESG_PRI_NORMAL );
     createTimekeeper();
     
     hvqm2InitSP1(0xff);
@@ -130,6 +136,11 @@ void hvqm_main_proc() {
     total_frames = load32(hvqm_header->total_frames);
     usec_per_frame = load32(hvqm_header->usec_per_frame);
     total_audio_records = load32(hvqm_header->total_audio_records);
+
+    hvqm_index = OS_DCACHE_ROUNDUP_ADDR( hvqm_indexHeaderBuf );
+    hvqm_indexRom = _capcomSegmentRomStart + HVQM_INDEX_OFFSET(load32(hvqm_header->file_size));
+    romcpy(hvqm_index, hvqm_indexRom, sizeof(HVQMIndexHeader), OS_MESG_PRI_NORMAL, &videoDmaMesgBlock, &videoDmaMessageQ);
+    if ( hvqm_index->magic != HVQM_INDEX_MAGIC ) return;
     
     hvqm2SetupSP1(hvqm_header, SCREEN_WD);
     
@@ -139,7 +150,6 @@ void hvqm_main_proc() {
     for ( ; ; ) {
 
         //while ( video_remain > 0 ) {
-            u8 header_buffer[sizeof(HVQM2Record)+16];
             HVQM2Record *record_header;
             u16 frame_format;
             int bufno;
@@ -153,25 +163,28 @@ void hvqm_main_proc() {
                 }
             }
             
-            record_header = OS_DCACHE_ROUNDUP_ADDR( header_buffer );
-            
-            video_streamP = get_record(record_header, hvqbuf, 
-                        HVQM2_VIDEO, video_streamP, 
-                        &videoDmaMesgBlock, &videoDmaMessageQ);
+            record_header = record_queue_next( &videoQueue );
+            if ( record_header == NULL ) break;
                         
             //! SYNC VIDEO code
 
             if ( disptime > 0 && tkGetTime() > 0) {
                 if ( tkGetTime() > (disptime + (usec_per_frame * 2)) ) {
                   release_all_cfb();
-                  do {
+                  /*
+                   * Drop frames up to the next keyframe that is still on time.
+                   * The index tells their formats, so dropped frames that
+                   * weren't read ahead yet are never read at all.
+                   */
+                  for ( ; ; ) {
                     disptime += usec_per_frame;
                     if ( --video_remain == 0 ) break;
-                    video_streamP = get_record( record_header, hvqbuf, 
-				    HVQM2_VIDEO, video_streamP, 
-				    &videoDmaMesgBlock, &videoDmaMessageQ );
-                  } while (load16( record_header->format ) != HVQM2_VIDEO_KEYFRAME || tkGetTime() > disptime );
+                    if ( record_queue_peek_format( &videoQueue ) == HVQM2_VIDEO_KEYFRAME && tkGetTime() <= disptime ) break;
+                    record_queue_skip( &videoQueue );
+                  }
                   if ( video_remain == 0 ) break;
+                  record_header = record_queue_next( &videoQueue );
+                  if ( record_header == NULL ) break;
                 }
             }
             
@@ -194,7 +207,7 @@ void hvqm_main_proc() {
                  * Process first half in the CPU
                  */
                 hvqtask.t.flags = 0;
-                status = hvqm2DecodeSP1( hvqbuf, frame_format, 
+                status = hvqm2DecodeSP1( &record_header[1], frame_format, 
                            &gFramebuffers[bufno][screen_offset], 
                            &gFramebuffers[prev_bufno][screen_offset], 
                            hvqwork, &hvq_sparg, hvq_spfifo );
@@ -8,15 +8,22 @@
 #define HVQ_SPFIFO_SIZE   30000
 
 /*
- * Size of buffer for video records 
+ * Maximum size of a video record
  */
 #define HVQ_DATASIZE_MAX  40000
 
 /*
- * Size of buffer for audio records
+ * Maximum size of an audio record
  */
 #define AUDIO_RECORD_SIZE_MAX  5000
 
+/*
+ * Size of the ring buffers that video and audio records are read ahead into.
+ * Each must fit at least one record of the maximum size, plus its header.
+ */
+#define HVQ_READAHEAD_SIZE    0x10000
+#define AUDIO_READAHEAD_SIZE  0x2000
+
 #define MAXWIDTH  320
 #define MAXHEIGHT 240
 
@@ -95,10 +102,76 @@ void createHvqmThread(void);
  */
 void romcpy(void *dest, void *src, u32 len, s32 pri, OSIoMesg *mb, OSMesgQueue *mq);
 
+/*
+ * Record index appended to the movie by tools/hvqm_index.py
+ */
+#define HVQM_INDEX_MAGIC 0x48565149 /* 'HVQI' */
+#define HVQM_INDEX_OFFSET(file_size) (((file_size) + 7) & ~7)
+
+typedef struct {
+  u32 magic;
+  u32 audio_records;	/* Number of audio entries */
+  u32 video_records;	/* Number of video entries */
+  u32 audio_entries;	/* Offset of the audio entries from the start of the index */
+  u32 video_entries;	/* Offset of the video entries from the start of the index */
+  u32 pad;
+} HVQMIndexHeader;
+
+typedef struct {
+  u32 offset;		/* Offset of the record header from the start of the movie */
+  u32 size_format;	/* Record size including the header (low 24 bits), record format (high 8 bits) */
+} HVQMIndexEntry;
+
+#define HVQM_INDEX_SIZE(entry)   ((entry)->size_format & 0xFFFFFF)
+#define HVQM_INDEX_FORMAT(entry) ((entry)->size_format >> 24)
+
+/*
+ * Read-ahead record queue
+ */
+#define HVQM_QUEUE_SLOTS	8	/* Records that can be read ahead */
+#define HVQM_INDEX_CHUNK	32	/* Index entries loaded at once */
+#define HVQM_NO_RECORD		0xFFFF	/* Format returned when the stream has ended */
+
+typedef struct {
+  HVQM2Record *record;	/* Record header, followed by the body (16 byte aligned) */
+  u32 start;		/* Position of the allocation in the ring */
+  u32 end;
+  u16 format;
+} HVQMQueueSlot;
+
+typedef struct {
+  u8 *ring;		/* Ring buffer the records are read into */
+  u32 ring_size;
+  u32 ring_head;	/* Where the next record is allocated */
+  u32 ring_tail;	/* Start of the oldest record still in use */
+  HVQMQueueSlot slots[HVQM_QUEUE_SLOTS];
+  u32 first;		/* Oldest slot in use (the record last returned, if it's still held) */
+  u32 read;		/* Next slot to return */
+  u32 issued;		/* Next slot to read */
+  u32 done;		/* Slots whose DMA has completed */
+  u8 *stream;		/* ROM address of the movie */
+  u8 *index_rom;	/* ROM address of the next index entries to load */
+  u32 remain;		/* Records left to read */
+  u32 entry_pos;	/* Next entry to read in entries[] */
+  u32 entry_count;	/* Entries loaded in entries[] */
+  s32 pri;
+  OSIoMesg mb[HVQM_QUEUE_SLOTS];
+  OSMesgQueue mq;
+  OSMesg mesg[HVQM_QUEUE_SLOTS];
+  OSIoMesg index_mb;
+  OSMesgQueue index_mq;
+  OSMesg index_mesg;
+  HVQMIndexEntry entries[HVQM_INDEX_CHUNK] __attribute__((aligned(16)));
+} HVQMRecordQueue;
+
 /*
  * in getrecord.c
  */
-u8 *get_record(HVQM2Record *headerbuf, void *bodybuf, u16 type, u8 *stream, OSIoMesg *mb, OSMesgQueue *mq);
+void record_queue_create(HVQMRecordQueue *q, void *ring, u32 ring_size, s32 pri);
+void record_queue_start(HVQMRecordQueue *q, u8 *stream, u8 *index_rom, u32 records);
+HVQM2Record *record_queue_next(HVQMRecordQueue *q);
+u16 record_queue_peek_format(HVQMRecordQueue *q);
+void record_queue_skip(HVQMRecordQueue *q);
 
 /*
  * in cfbkeep.c
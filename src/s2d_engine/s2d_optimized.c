@@ -15,38 +15,20 @@
 
 static int s2d_width(const char *str, int line, int len);
 static void s2d_snprint(int x, int y, int align, const char *str, int len);
+void draw_all_glyphs(void);
 
-extern void *s2d_calloc(size_t);
+static S2DGlyphBatch s2d_batch;
 
-void insert_el_char(S2DList *s, S2DListNode *n) {
-    if (n == NULL) return;
+static void reset_glyph_batch(void) {
+    int i;
 
-    S2DListNode *pt = s->head;
-
-    while (pt->next != NULL) {
-        if (pt->next == NULL) {
-            pt->next = n;
-            n->prev = pt;
-            return;
-        }
-
-        if (n->glyph >= pt->glyph
-            && n->glyph < pt->next->glyph)
-        {
-            S2DListNode *prev = pt;
-            S2DListNode *next = pt->next;
-
-            n->next = next;
-            prev->next = n;
-            next->prev = n;
-            n->prev = prev;
-            s->len++;
-            return;
-        }
-        pt = pt->next;
+    for (i = 0; i < s2d_batch.usedCount; i++) {
+        s2d_batch.head[s2d_batch.used[i]] = 0;
     }
 
-    pt->next = n;
+    s2d_batch.count = 0;
+    s2d_batch.usedCount = 0;
+    s2d_batch.shadowCount = 0;
 }
 
 #define FTOFIX16(x) (long)((x) * (float)(1 << 2))
@@ -60,84 +42,131 @@ void mtx_pipeline_op(uObjSubMtx *m, int x, int y, float scale) {
     m->m.Y = FTOFIX16((float)(y));
 }
 
-void make_glyph(S2DList *s, int x, int y,
+// Queues a glyph in its bucket, keeping instances of the same glyph in string order.
+void make_glyph(int x, int y,
                 int glyph,
                 int r, int g, int b, int a,
                 float scl,
                 int d, int dx, int dy
 ) {
-    S2DListNode *t = (S2DListNode *) s2d_calloc(sizeof(S2DListNode));
+    S2DGlyph *t;
+    int idx;
+
+    if (glyph < 0 || glyph >= S2D_GLYPH_BUCKETS) return;
+
+    // Long strings are drawn in several batches rather than losing the glyphs past the limit.
+    if (s2d_batch.count >= S2D_MAX_GLYPHS) {
+        draw_all_glyphs();
+    }
+    idx = s2d_batch.count;
 
-    t->mtx = (uObjSubMtx *) s2d_calloc(sizeof(uObjSubMtx));
+    t = &s2d_batch.glyphs[idx];
+    s2d_batch.count++;
 
-    mtx_pipeline_op(t->mtx, x, y, scl);
+    t->x = x;
+    t->y = y;
+    t->scale = scl;
 
     t->envR = r;
     t->envG = g;
     t->envB = b;
     t->envA = a;
 
-    t->glyph = glyph;
-
-    if (d == 1) {
-        t->dropshadow = (uObjSubMtx *) s2d_calloc(sizeof(uObjSubMtx));
-        // mtx_pipeline_op(t->dropshadow, x + dx, y + dy, scl);
-        mtx_pipeline_op(t->dropshadow, dx, dy, scl);
+    t->dropshadow = (d == 1);
+    t->dropX = dx;
+    t->dropY = dy;
+    if (t->dropshadow) {
+        s2d_batch.shadowCount++;
     }
 
-    if (s->head == NULL) {
-        s->head = t;
-        s->len = 1;
-        return;
+    t->next = 0;
+    if (s2d_batch.head[glyph] == 0) {
+        s2d_batch.head[glyph] = idx + 1;
+        s2d_batch.used[s2d_batch.usedCount++] = glyph;
+    } else {
+        s2d_batch.glyphs[s2d_batch.tail[glyph] - 1].next = idx + 1;
     }
+    s2d_batch.tail[glyph] = idx + 1;
+}
+
+#define CLAMP_0(x) ((x < 0) ? 0 : x)
+#define PACK_ENV(r, g, b, a) (((u32)(r) << 24) | ((u32)(g) << 16) | ((u32)(b) << 8) | (u32)(a))
+
+// Sets the env color, skipping the sync when it is already set.
+static void set_glyph_env(u32 *cur, int r, int g, int b, int a) {
+    u32 env = PACK_ENV(r, g, b, a);
 
-    insert_el_char(s, t);
+    if (*cur == env) return;
+    *cur = env;
 
+    gDPPipeSync(gdl_head++);
+    gDPSetEnvColor(gdl_head++, r, g, b, a);
 }
 
-#define CLAMP_0(x) ((x < 0) ? 0 : x)
+// Draws every queued glyph, loading each glyph's texture once.
+// All sub matrices come from a single allocation.
+void draw_all_glyphs(void) {
+    uObjSubMtx *mtx;
+    S2DGlyph *tmp;
+    u32 env;
+    int i, j;
 
-void draw_all_glyphs(S2DList *s) {
-    S2DListNode *tmp = s->head;
+    if (s2d_batch.count == 0) return;
+
+    mtx = (uObjSubMtx *) alloc((s2d_batch.count + s2d_batch.shadowCount) * sizeof(uObjSubMtx));
+    if (mtx == NULL) {
+        reset_glyph_batch();
+        return;
+    }
 
     gDPPipeSync(gdl_head++);
     gDPSetCycleType(gdl_head++, G_CYC_COPY);
     gDPSetRenderMode(gdl_head++, G_RM_SPRITE, G_RM_SPRITE2);
 
-    while (tmp != NULL) {
-        gDPPipeSync(gdl_head++);
-        gDPSetEnvColor(gdl_head++, tmp->envR, tmp->envG, tmp->envB, tmp->envA);
-
-        if (tmp->prev == NULL) {
-            gSPObjLoadTxtr(gdl_head++, &s2d_tex[tmp->glyph]);
-            gDPLoadSync(gdl_head++);
-        }
-        else if (tmp->prev->glyph != tmp->glyph) {
-            gSPObjLoadTxtr(gdl_head++, &s2d_tex[tmp->glyph]);
-            gDPLoadSync(gdl_head++);
-        }
-
-        if (tmp->dropshadow) {
-            gDPPipeSync(gdl_head++);
-            gDPSetEnvColor(gdl_head++,
-                       CLAMP_0(tmp->envR - 100),
-                       CLAMP_0(tmp->envG - 100),
-                       CLAMP_0(tmp->envB - 100),
-                       tmp->envA);
-            gSPObjSubMatrix(gdl_head++, &tmp->dropshadow);
-            gSPObjSprite(gdl_head++, &s2d_dropshadow);
-            gDPPipeSync(gdl_head++);
-            gDPSetEnvColor(gdl_head++, tmp->envR, tmp->envG, tmp->envB, tmp->envA);
+    // The first glyph always sets the color, whatever it is.
+    gDPPipeSync(gdl_head++);
+    gDPSetEnvColor(gdl_head++, 255, 255, 255, 255);
+    env = PACK_ENV(255, 255, 255, 255);
+
+    for (i = 0; i < s2d_batch.usedCount; i++) {
+        int glyph = s2d_batch.used[i];
+
+        gSPObjLoadTxtr(gdl_head++, &s2d_tex[glyph]);
+        gDPLoadSync(gdl_head++);
+
+        // Shadows go first so they never cover an instance of the same glyph.
+        if (s2d_batch.shadowCount != 0) {
+            for (j = s2d_batch.head[glyph]; j != 0; j = tmp->next) {
+                tmp = &s2d_batch.glyphs[j - 1];
+                if (!tmp->dropshadow) continue;
+
+                set_glyph_env(&env,
+                              CLAMP_0(tmp->envR - 100),
+                              CLAMP_0(tmp->envG - 100),
+                              CLAMP_0(tmp->envB - 100),
+                              tmp->envA);
+                mtx_pipeline_op(mtx, tmp->x + tmp->dropX, tmp->y + tmp->dropY, tmp->scale);
+                gSPObjSubMatrix(gdl_head++, mtx);
+                gSPObjSprite(gdl_head++, &s2d_dropshadow);
+                mtx++;
+            }
         }
 
-        gSPObjSubMatrix(gdl_head++, tmp->mtx);
-        gSPObjRectangleR(gdl_head++, &s2d_font);
+        for (j = s2d_batch.head[glyph]; j != 0; j = tmp->next) {
+            tmp = &s2d_batch.glyphs[j - 1];
 
-        tmp = tmp->next;
+            set_glyph_env(&env, tmp->envR, tmp->envG, tmp->envB, tmp->envA);
+            mtx_pipeline_op(mtx, tmp->x, tmp->y, tmp->scale);
+            gSPObjSubMatrix(gdl_head++, mtx);
+            gSPObjRectangleR(gdl_head++, &s2d_font);
+            mtx++;
+        }
     }
 
     gDPPipeSync(gdl_head++);
     gDPSetCycleType(gdl_head++, G_CYC_1CYCLE);
+
+    reset_glyph_batch();
 }
 
 
@@ -166,8 +195,6 @@ static void s2d_snprint(int x, int y, int align, const char *str, int len) {
             x = orig_x - s2d_width(str, line, len);
     }
 
-    S2DList *s2d_list = (S2DList *) s2d_calloc(sizeof(S2DList));
-
     do {
         char current_char = *p;
 
@@ -253,7 +280,7 @@ static void s2d_snprint(int x, int y, int align, const char *str, int len) {
                     char *tbl = segmented_to_virtual(s2d_kerning_table);
 
                     if (current_char != ' ') {
-                        make_glyph(s2d_list, x, y,
+                        make_glyph(x, y,
                                    current_char,
                                    s2d_red, s2d_green, s2d_blue, s2d_alpha,
                                    myScale,
@@ -274,7 +301,7 @@ static void s2d_snprint(int x, int y, int align, const char *str, int len) {
     drop_x = 0;
     drop_y = 0;
 
-    draw_all_glyphs(s2d_list);
+    draw_all_glyphs();
 }
 
 void s2d_print_optimized(int x, int y, const char *str) {
@@ -1,23 +1,39 @@
 #ifndef S2D_OPTIMIZE_H
 #define S2D_OPTIMIZE_H
 
-struct s2d_optimized_linkedlist {
-    struct s2d_optimized_linkedlist *next;
-    struct s2d_optimized_linkedlist *prev;
+// Glyph indices that can be batched; everything above is a control code.
+#define S2D_GLYPH_BUCKETS 128
+
+// Maximum number of glyphs queued at once; longer strings are drawn in several batches.
+#define S2D_MAX_GLYPHS 256
+
+// One queued instance of a glyph. Instances of the same glyph are chained
+// through 'next' so all of them can be drawn after a single texture load.
+// Links hold the instance's index + 1, so 0 ends a chain.
+struct s2d_glyph_instance {
+    s16 x;
+    s16 y;
+    s16 dropX;
+    s16 dropY;
+    f32 scale;
     u8 envR;
     u8 envG;
     u8 envB;
     u8 envA;
-    int glyph;
-    uObjSubMtx *mtx;
-    uObjSubMtx *dropshadow;
+    s16 next;
+    u8 dropshadow;
 };
-typedef struct s2d_optimized_linkedlist S2DListNode;
+typedef struct s2d_glyph_instance S2DGlyph;
 
-struct s2dlist {
-	S2DListNode *head;
-	int len;
+struct s2d_glyph_batch {
+    S2DGlyph glyphs[S2D_MAX_GLYPHS];
+    s16 head[S2D_GLYPH_BUCKETS];
+    s16 tail[S2D_GLYPH_BUCKETS];
+    u8 used[S2D_GLYPH_BUCKETS]; // glyphs in the order they were first queued
+    int count;
+    int usedCount;
+    int shadowCount;
 };
-typedef struct s2dlist S2DList;
+typedef struct s2d_glyph_batch S2DGlyphBatch;
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,2893 @@
+/*
+ * Native version of assemble_sound.py. It takes the same arguments and writes
+ * byte-identical sound_data.ctl/.tbl, sequences.bin and bank set files.
+ *
+ * With --cache <file>, the layout of every sample bank and every serialized
+ * sound bank is kept between runs. A sample bank is only read and laid out
+ * again when one of its AIFC files changes size or timestamp (the same test
+ * make uses) or when the set of samples used from it changes, and a sound
+ * bank is only serialized again when its JSON or the layout of its sample
+ * bank changes.
+ *
+ * With --heap-report, the memory every sound bank takes up once loaded is
+ * listed against the bank pools of the audio heap, along with the bank sets
+ * of the sequences. Banks are loaded into the persistent bank pool, and into
+ * the temporary one once that is full (see alloc_bank_or_seq in heap.c).
+ */
+
+#include <dirent.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if defined(_MSC_VER) || defined(__MINGW32__)
+  #include <direct.h>
+  #define mkdir(DIR_, PERM_) _mkdir(DIR_)
+#endif
+
+#define ARRAY_COUNT(arr) (sizeof(arr) / sizeof(arr[0]))
+#define ALIGN(val, al) (((val) + ((al) - 1)) & ~((size_t)(al) - 1))
+
+#define TYPE_CTL 1
+#define TYPE_TBL 2
+#define TYPE_SEQ 3
+
+#define CACHE_MAGIC 0x534E4443 // 'SNDC'
+#define CACHE_VERSION 1
+
+static int sBigEndian = 1;
+static int sWordBytes = 4;
+static int sIsShindou = 0;
+static int sDumpIndividualBins = 0;
+
+// Prefix of validation errors, e.g. "failed to parse bank <file>: "
+static char sErrorContext[1024];
+
+static void fatal_error(const char *msgfmt, ...)
+{
+    va_list args;
+
+    va_start(args, msgfmt);
+    vfprintf(stderr, msgfmt, args);
+    va_end(args);
+
+    fputc('\n', stderr);
+
+    exit(1);
+}
+
+// Same as fatal_error, but prefixed with what was being parsed
+static void validation_error(const char *msgfmt, ...)
+{
+    va_list args;
+
+    fputs(sErrorContext, stderr);
+
+    va_start(args, msgfmt);
+    vfprintf(stderr, msgfmt, args);
+    va_end(args);
+
+    fputc('\n', stderr);
+
+    exit(1);
+}
+
+static void *xmalloc(size_t size)
+{
+    void *ptr = malloc(size ? size : 1);
+
+    if (ptr == NULL)
+        fatal_error("out of memory");
+    return ptr;
+}
+
+static void *xrealloc(void *ptr, size_t size)
+{
+    ptr = realloc(ptr, size ? size : 1);
+    if (ptr == NULL)
+        fatal_error("out of memory");
+    return ptr;
+}
+
+static char *xstrdup(const char *str)
+{
+    return strcpy(xmalloc(strlen(str) + 1), str);
+}
+
+static char *xstrndup(const char *str, size_t length)
+{
+    char *ret = xmalloc(length + 1);
+
+    memcpy(ret, str, length);
+    ret[length] = '\0';
+    return ret;
+}
+
+static int str_ends_with(const char *str, const char *suffix)
+{
+    size_t strLength = strlen(str);
+    size_t suffixLength = strlen(suffix);
+
+    return strLength >= suffixLength && strcmp(str + strLength - suffixLength, suffix) == 0;
+}
+
+// Same as Python's os.path.join for two components
+static char *path_join(const char *dir, const char *name)
+{
+    size_t dirLength = strlen(dir);
+    int slash = (dirLength > 0 && dir[dirLength - 1] != '/');
+    char *ret = xmalloc(dirLength + slash + strlen(name) + 1);
+
+    sprintf(ret, "%s%s%s", dir, slash ? "/" : "", name);
+    return ret;
+}
+
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t length)
+{
+    const uint8_t *bytes = data;
+    size_t i;
+
+    // FNV-1a
+    for (i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static uint64_t hash_u64(uint64_t hash, uint64_t value)
+{
+    return hash_bytes(hash, &value, sizeof(value));
+}
+
+static uint64_t hash_string(uint64_t hash, const char *str)
+{
+    return hash_bytes(hash, str, strlen(str) + 1);
+}
+
+#define HASH_INIT 0xCBF29CE484222325ULL
+
+static uint8_t *read_whole_file(const char *filename, size_t *size)
+{
+    FILE *file = fopen(filename, "rb");
+    uint8_t *data;
+    long length;
+
+    if (file == NULL)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data = xmalloc(length + 1);
+    if (length < 0 || fread(data, 1, length, file) != (size_t)length)
+        fatal_error("failed to read %s", filename);
+    fclose(file);
+    data[length] = '\0';
+    *size = length;
+    return data;
+}
+
+static void write_whole_file(const char *filename, const uint8_t *data, size_t size)
+{
+    FILE *file = fopen(filename, "wb");
+
+    if (file == NULL || fwrite(data, 1, size, file) != size || fclose(file) != 0)
+        fatal_error("failed to write %s", filename);
+}
+
+static int string_cmp(const void *a, const void *b)
+{
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+// Sorted names of the directory entries, like sorted(os.listdir(dir))
+static char **list_dir(const char *dirname, int *count)
+{
+    DIR *dir = opendir(dirname);
+    struct dirent *ent;
+    char **names = NULL;
+    int capacity = 0;
+
+    *count = 0;
+    if (dir == NULL)
+        fatal_error("failed to open directory %s", dirname);
+    while ((ent = readdir(dir)) != NULL)
+    {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+            continue;
+        if (*count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            names = xrealloc(names, capacity * sizeof(*names));
+        }
+        names[(*count)++] = xstrdup(ent->d_name);
+    }
+    closedir(dir);
+    qsort(names, *count, sizeof(*names), string_cmp);
+    return names;
+}
+
+static int is_dir(const char *path)
+{
+    struct stat st;
+
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/*
+ * Binary output
+ */
+
+struct Buffer
+{
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+};
+
+static void buf_grow(struct Buffer *buf, size_t size)
+{
+    if (buf->size + size > buf->capacity)
+    {
+        buf->capacity = buf->capacity * 2 + size + 256;
+        buf->data = xrealloc(buf->data, buf->capacity);
+    }
+}
+
+static void buf_add(struct Buffer *buf, const void *data, size_t size)
+{
+    buf_grow(buf, size);
+    memcpy(buf->data + buf->size, data, size);
+    buf->size += size;
+}
+
+static void buf_add_zeros(struct Buffer *buf, size_t size)
+{
+    buf_grow(buf, size);
+    memset(buf->data + buf->size, 0, size);
+    buf->size += size;
+}
+
+static void buf_align(struct Buffer *buf, size_t alignment)
+{
+    buf_add_zeros(buf, ALIGN(buf->size, alignment) - buf->size);
+}
+
+static void put_uint_at(uint8_t *dest, uint64_t value, int size, int bigEndian)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        dest[bigEndian ? (size - 1 - i) : i] = (value >> (i * 8)) & 0xFF;
+}
+
+// Integers in the output byte order, for the struct.pack formats B, H/h, I/i
+static void buf_put(struct Buffer *buf, uint64_t value, int size)
+{
+    buf_grow(buf, size);
+    put_uint_at(buf->data + buf->size, value, size, sBigEndian);
+    buf->size += size;
+}
+
+// Pointer sized words (format P)
+static void buf_put_word(struct Buffer *buf, uint64_t value)
+{
+    buf_put(buf, value, sWordBytes);
+}
+
+// Padding after 32-bit fields that precede pointers on 64-bit targets (format X)
+static void buf_put_pad(struct Buffer *buf)
+{
+    if (sWordBytes == 8)
+        buf_add_zeros(buf, 4);
+}
+
+static void buf_put_f32(struct Buffer *buf, double value)
+{
+    float f = (float)value;
+    uint32_t bits;
+
+    memcpy(&bits, &f, sizeof(bits));
+    buf_put(buf, bits, 4);
+}
+
+// Reserves a word to be filled in later with buf_patch_word
+static size_t buf_reserve_word(struct Buffer *buf)
+{
+    size_t offset = buf->size;
+
+    buf_add_zeros(buf, sWordBytes);
+    return offset;
+}
+
+static void buf_patch_word(struct Buffer *buf, size_t offset, uint64_t value)
+{
+    put_uint_at(buf->data + offset, value, sWordBytes, sBigEndian);
+}
+
+/*
+ * Output that gets aligned with leftover data instead of zeroes, as the
+ * original tools did: the padding repeats the byte 0x10000 bytes back from
+ * the write position, which is reset at the start of every entry.
+ */
+struct GarbageBuffer
+{
+    struct Buffer buf;
+    size_t *segments; // start of every entry, i.e. where the write position was reset
+    int numSegments;
+};
+
+static void garbage_init(struct GarbageBuffer *ser)
+{
+    memset(ser, 0, sizeof(*ser));
+    ser->segments = xmalloc(sizeof(*ser->segments));
+    ser->segments[0] = 0;
+    ser->numSegments = 1;
+}
+
+static void garbage_reset_pos(struct GarbageBuffer *ser)
+{
+    ser->segments = xrealloc(ser->segments, (ser->numSegments + 1) * sizeof(*ser->segments));
+    ser->segments[ser->numSegments++] = ser->buf.size;
+}
+
+static uint8_t garbage_at(const struct GarbageBuffer *ser, size_t pos)
+{
+    int i;
+
+    // Find the last write to pos & 0xFFFF, looking back through the entries
+    // if the current one hasn't gotten that far yet.
+    pos &= 0xFFFF;
+    for (i = ser->numSegments - 1; i >= 0; i--)
+    {
+        size_t start = ser->segments[i];
+        size_t end = (i == ser->numSegments - 1) ? ser->buf.size : ser->segments[i + 1];
+        size_t length = end - start;
+
+        if (length > pos)
+            return ser->buf.data[start + pos + ((length - 1 - pos) & ~(size_t)0xFFFF)];
+    }
+    return 0;
+}
+
+static void garbage_align(struct GarbageBuffer *ser, size_t alignment)
+{
+    while (ser->buf.size % alignment != 0)
+    {
+        uint8_t byte = garbage_at(ser, ser->buf.size - ser->segments[ser->numSegments - 1]);
+
+        buf_add(&ser->buf, &byte, 1);
+    }
+}
+
+/*
+ * JSON
+ */
+
+enum JsonType
+{
+    JSON_NULL,
+    JSON_INT, // true and false are parsed as 1 and 0, as Python's bool is an int
+    JSON_FLOAT,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT,
+};
+
+struct Json
+{
+    enum JsonType type;
+    long long intValue;
+    double floatValue;
+    char *string;
+    int count;
+    int capacity;
+    char **keys; // objects only, in file order
+    struct Json **items;
+};
+
+struct JsonParser
+{
+    const char *text;
+    const char *pos;
+};
+
+static void json_error(struct JsonParser *parser, const char *msg)
+{
+    const char *p;
+    int line = 1;
+    int column = 1;
+
+    for (p = parser->text; p < parser->pos; p++)
+    {
+        if (*p == '\n')
+        {
+            line++;
+            column = 1;
+        }
+        else
+        {
+            column++;
+        }
+    }
+    validation_error("%s: line %d column %d (char %d)", msg, line, column, (int)(parser->pos - parser->text));
+}
+
+static struct Json *json_new(enum JsonType type)
+{
+    struct Json *json = xmalloc(sizeof(*json));
+
+    memset(json, 0, sizeof(*json));
+    json->type = type;
+    return json;
+}
+
+static struct Json *json_get(const struct Json *json, const char *key)
+{
+    int i;
+
+    if (json == NULL || json->type != JSON_OBJECT)
+        return NULL;
+    for (i = 0; i < json->count; i++)
+    {
+        if (strcmp(json->keys[i], key) == 0)
+            return json->items[i];
+    }
+    return NULL;
+}
+
+static void json_append(struct Json *json, char *key, struct Json *value)
+{
+    if (json->count == json->capacity)
+    {
+        json->capacity = json->capacity ? json->capacity * 2 : 8;
+        json->items = xrealloc(json->items, json->capacity * sizeof(*json->items));
+        if (json->type == JSON_OBJECT)
+            json->keys = xrealloc(json->keys, json->capacity * sizeof(*json->keys));
+    }
+    if (json->type == JSON_OBJECT)
+        json->keys[json->count] = key;
+    json->items[json->count++] = value;
+}
+
+// Sets a key, keeping its position if it already exists
+static void json_set(struct Json *json, const char *key, struct Json *value)
+{
+    int i;
+
+    for (i = 0; i < json->count; i++)
+    {
+        if (strcmp(json->keys[i], key) == 0)
+        {
+            json->items[i] = value;
+            return;
+        }
+    }
+    json_append(json, xstrdup(key), value);
+}
+
+static void json_remove_at(struct Json *json, int index)
+{
+    memmove(&json->items[index], &json->items[index + 1], (json->count - index - 1) * sizeof(*json->items));
+    if (json->type == JSON_OBJECT)
+        memmove(&json->keys[index], &json->keys[index + 1], (json->count - index - 1) * sizeof(*json->keys));
+    json->count--;
+}
+
+static void json_remove(struct Json *json, const char *key)
+{
+    int i;
+
+    for (i = 0; i < json->count; i++)
+    {
+        if (strcmp(json->keys[i], key) == 0)
+        {
+            json_remove_at(json, i);
+            return;
+        }
+    }
+}
+
+static void json_skip_whitespace(struct JsonParser *parser)
+{
+    while (*parser->pos == ' ' || *parser->pos == '\t' || *parser->pos == '\n' || *parser->pos == '\r')
+        parser->pos++;
+}
+
+static void utf8_append(struct Buffer *buf, uint32_t codepoint)
+{
+    uint8_t bytes[4];
+    int length;
+
+    if (codepoint < 0x80)
+    {
+        bytes[0] = codepoint;
+        length = 1;
+    }
+    else if (codepoint < 0x800)
+    {
+        bytes[0] = 0xC0 | (codepoint >> 6);
+        bytes[1] = 0x80 | (codepoint & 0x3F);
+        length = 2;
+    }
+    else if (codepoint < 0x10000)
+    {
+        bytes[0] = 0xE0 | (codepoint >> 12);
+        bytes[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+        bytes[2] = 0x80 | (codepoint & 0x3F);
+        length = 3;
+    }
+    else
+    {
+        bytes[0] = 0xF0 | (codepoint >> 18);
+        bytes[1] = 0x80 | ((codepoint >> 12) & 0x3F);
+        bytes[2] = 0x80 | ((codepoint >> 6) & 0x3F);
+        bytes[3] = 0x80 | (codepoint & 0x3F);
+        length = 4;
+    }
+    buf_add(buf, bytes, length);
+}
+
+static uint32_t json_parse_hex4(struct JsonParser *parser)
+{
+    uint32_t value = 0;
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        char c = parser->pos[i];
+
+        value <<= 4;
+        if (c >= '0' && c <= '9')
+            value |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            value |= c - 'A' + 10;
+        else
+            json_error(parser, "Invalid \\uXXXX escape");
+    }
+    parser->pos += 4;
+    return value;
+}
+
+static char *json_parse_string(struct JsonParser *parser)
+{
+    struct Buffer buf = {0};
+
+    parser->pos++; // opening quote
+    for (;;)
+    {
+        char c = *parser->pos;
+
+        if (c == '"')
+        {
+            parser->pos++;
+            break;
+        }
+        if (c == '\0')
+            json_error(parser, "Unterminated string starting at");
+        if ((unsigned char)c < 0x20)
+            json_error(parser, "Invalid control character at");
+        if (c != '\\')
+        {
+            const char *start = parser->pos;
+
+            while (*parser->pos != '"' && *parser->pos != '\\' && (unsigned char)*parser->pos >= 0x20)
+                parser->pos++;
+            buf_add(&buf, start, parser->pos - start);
+            continue;
+        }
+        parser->pos++;
+        c = *parser->pos++;
+        switch (c)
+        {
+        case '"': case '\\': case '/':
+            buf_add(&buf, &c, 1);
+            break;
+        case 'b': buf_add(&buf, "\b", 1); break;
+        case 'f': buf_add(&buf, "\f", 1); break;
+        case 'n': buf_add(&buf, "\n", 1); break;
+        case 'r': buf_add(&buf, "\r", 1); break;
+        case 't': buf_add(&buf, "\t", 1); break;
+        case 'u':
+        {
+            uint32_t codepoint = json_parse_hex4(parser);
+
+            if (codepoint >= 0xD800 && codepoint < 0xDC00 && parser->pos[0] == '\\' && parser->pos[1] == 'u')
+            {
+                const char *save = parser->pos;
+                uint32_t low;
+
+                parser->pos += 2;
+                low = json_parse_hex4(parser);
+                if (low >= 0xDC00 && low < 0xE000)
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                else
+                    parser->pos = save;
+            }
+            utf8_append(&buf, codepoint);
+            break;
+        }
+        default:
+            parser->pos -= 2;
+            json_error(parser, "Invalid \\escape");
+        }
+    }
+    buf_add(&buf, "", 1);
+    return (char *)buf.data;
+}
+
+static struct Json *json_parse_value(struct JsonParser *parser);
+
+static struct Json *json_parse_number(struct JsonParser *parser)
+{
+    const char *start = parser->pos;
+    const char *p = start;
+    int isFloat = 0;
+    struct Json *json;
+    char *str;
+
+    if (*p == '-')
+        p++;
+    if (*p == '0')
+        p++;
+    else if (*p >= '1' && *p <= '9')
+        while (*p >= '0' && *p <= '9')
+            p++;
+    else
+        json_error(parser, "Expecting value");
+    if (*p == '.' && p[1] >= '0' && p[1] <= '9')
+    {
+        isFloat = 1;
+        p++;
+        while (*p >= '0' && *p <= '9')
+            p++;
+    }
+    if ((*p == 'e' || *p == 'E') &&
+        ((p[1] >= '0' && p[1] <= '9') || ((p[1] == '+' || p[1] == '-') && p[2] >= '0' && p[2] <= '9')))
+    {
+        isFloat = 1;
+        p += 2;
+        while (*p >= '0' && *p <= '9')
+            p++;
+    }
+    str = xstrndup(start, p - start);
+    if (isFloat)
+    {
+        json = json_new(JSON_FLOAT);
+        json->floatValue = strtod(str, NULL);
+    }
+    else
+    {
+        json = json_new(JSON_INT);
+        json->intValue = strtoll(str, NULL, 10);
+    }
+    free(str);
+    parser->pos = p;
+    return json;
+}
+
+static struct Json *json_parse_value(struct JsonParser *parser)
+{
+    struct Json *json;
+
+    json_skip_whitespace(parser);
+    switch (*parser->pos)
+    {
+    case '{':
+        json = json_new(JSON_OBJECT);
+        parser->pos++;
+        json_skip_whitespace(parser);
+        if (*parser->pos == '}')
+        {
+            parser->pos++;
+            return json;
+        }
+        for (;;)
+        {
+            char *key;
+
+            json_skip_whitespace(parser);
+            if (*parser->pos != '"')
+                json_error(parser, "Expecting property name enclosed in double quotes");
+            key = json_parse_string(parser);
+            json_skip_whitespace(parser);
+            if (*parser->pos != ':')
+                json_error(parser, "Expecting ':' delimiter");
+            parser->pos++;
+            // A repeated key replaces the earlier value but keeps its position
+            if (json_get(json, key) != NULL)
+                json_set(json, key, json_parse_value(parser));
+            else
+                json_append(json, key, json_parse_value(parser));
+            json_skip_whitespace(parser);
+            if (*parser->pos == '}')
+            {
+                parser->pos++;
+                return json;
+            }
+            if (*parser->pos != ',')
+                json_error(parser, "Expecting ',' delimiter");
+            parser->pos++;
+        }
+    case '[':
+        json = json_new(JSON_ARRAY);
+        parser->pos++;
+        json_skip_whitespace(parser);
+        if (*parser->pos == ']')
+        {
+            parser->pos++;
+            return json;
+        }
+        for (;;)
+        {
+            json_append(json, NULL, json_parse_value(parser));
+            json_skip_whitespace(parser);
+            if (*parser->pos == ']')
+            {
+                parser->pos++;
+                return json;
+            }
+            if (*parser->pos != ',')
+                json_error(parser, "Expecting ',' delimiter");
+            parser->pos++;
+        }
+    case '"':
+        json = json_new(JSON_STRING);
+        json->string = json_parse_string(parser);
+        return json;
+    default:
+        if (strncmp(parser->pos, "null", 4) == 0)
+        {
+            parser->pos += 4;
+            return json_new(JSON_NULL);
+        }
+        if (strncmp(parser->pos, "true", 4) == 0 || strncmp(parser->pos, "false", 5) == 0)
+        {
+            json = json_new(JSON_INT);
+            json->intValue = (*parser->pos == 't');
+            parser->pos += json->intValue ? 4 : 5;
+            return json;
+        }
+        return json_parse_number(parser);
+    }
+}
+
+static struct Json *json_parse(const char *text)
+{
+    struct JsonParser parser = {text, text};
+    struct Json *json = json_parse_value(&parser);
+
+    json_skip_whitespace(&parser);
+    if (*parser.pos != '\0')
+        json_error(&parser, "Extra data");
+    return json;
+}
+
+// Removes /* */ comments, then // comments along with their newline
+static char *strip_comments(const char *text)
+{
+    struct Buffer pass1 = {0};
+    struct Buffer pass2 = {0};
+    const char *p = text;
+
+    while (*p != '\0')
+    {
+        const char *slash = strchr(p + 1, '/');
+        const char *end;
+
+        if (p[0] == '/' && p[1] == '*' && (end = strstr(p + 2, "*/")) != NULL)
+        {
+            p = end + 2;
+            continue;
+        }
+        if (slash == NULL)
+            slash = p + strlen(p);
+        buf_add(&pass1, p, slash - p);
+        p = slash;
+    }
+    buf_add(&pass1, "", 1);
+
+    p = (const char *)pass1.data;
+    while (*p != '\0')
+    {
+        const char *slash = strchr(p + 1, '/');
+        const char *end;
+
+        if (p[0] == '/' && p[1] == '/' && (end = strchr(p + 2, '\n')) != NULL)
+        {
+            p = end + 1;
+            continue;
+        }
+        if (slash == NULL)
+            slash = p + strlen(p);
+        buf_add(&pass2, p, slash - p);
+        p = slash;
+    }
+    buf_add(&pass2, "", 1);
+    free(pass1.data);
+    return (char *)pass2.data;
+}
+
+/*
+ * Validation, with the same messages as assemble_sound.py
+ */
+
+static void validate(int cond, const char *forstr, const char *msgfmt, ...)
+{
+    va_list args;
+
+    if (cond)
+        return;
+    fputs(sErrorContext, stderr);
+    va_start(args, msgfmt);
+    vfprintf(stderr, msgfmt, args);
+    va_end(args);
+    if (forstr != NULL && forstr[0] != '\0')
+        fprintf(stderr, " for %s", forstr);
+    fputc('\n', stderr);
+    exit(1);
+}
+
+static void validate_int_in_range(const struct Json *val, long long lo, long long hi, const char *msg, const char *forstr)
+{
+    validate(val != NULL && val->type == JSON_INT, forstr, "%s must be an integer", msg);
+    validate(val->intValue >= lo && val->intValue <= hi, forstr, "%s must be in range %lld to %lld", msg, lo, hi);
+}
+
+enum FormatType
+{
+    FORMAT_STRING,
+    FORMAT_OBJECT,
+    FORMAT_FLOAT,
+    FORMAT_ARRAY,
+    FORMAT_RANGE,
+};
+
+struct FormatEntry
+{
+    const char *key;
+    enum FormatType type;
+    int lo, hi;
+};
+
+static void validate_json_format(const struct Json *json, const struct FormatEntry *format, int count, const char *forstr)
+{
+    static const char *typeNames[] = {"a string", "an object", "a floating point number", "an array"};
+    static const enum JsonType jsonTypes[] = {JSON_STRING, JSON_OBJECT, JSON_FLOAT, JSON_ARRAY};
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        const struct Json *value = json_get(json, format[i].key);
+        char quoted[64];
+
+        validate(value != NULL, forstr, "missing key \"%s\"", format[i].key);
+        snprintf(quoted, sizeof(quoted), "\"%s\"", format[i].key);
+        if (format[i].type == FORMAT_RANGE)
+        {
+            validate_int_in_range(value, format[i].lo, format[i].hi, quoted, forstr);
+        }
+        else
+        {
+            validate(value->type == jsonTypes[format[i].type] || (format[i].type == FORMAT_FLOAT && value->type == JSON_INT),
+                     forstr, "%s must be %s", quoted, typeNames[format[i].type]);
+        }
+    }
+}
+
+static int is_string(const struct Json *json, const char *str)
+{
+    return json != NULL && json->type == JSON_STRING && strcmp(json->string, str) == 0;
+}
+
+static int all_strings(const struct Json *json)
+{
+    int i;
+
+    for (i = 0; i < json->count; i++)
+    {
+        if (json->items[i]->type != JSON_STRING)
+            return 0;
+    }
+    return 1;
+}
+
+struct Defines
+{
+    char **names; // without their values
+    int count;
+};
+
+static int has_define_str(const struct Defines *defines, const char *name)
+{
+    int i;
+
+    for (i = 0; i < defines->count; i++)
+    {
+        if (strcmp(defines->names[i], name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+static int has_define(const struct Defines *defines, const struct Json *name)
+{
+    return name->type == JSON_STRING && has_define_str(defines, name->string);
+}
+
+static int any_defined(const struct Defines *defines, const struct Json *list)
+{
+    int i;
+
+    for (i = 0; i < list->count; i++)
+    {
+        if (has_define(defines, list->items[i]))
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Samples
+ */
+
+struct Aifc
+{
+    char *name;
+    char *fname;
+    uint8_t *data; // NULL when the sample bank layout came from the cache
+    uint32_t dataSize;
+    double sampleRate;
+    int16_t bookOrder;
+    int16_t bookPredictors;
+    int16_t *book;
+    int bookCount;
+    int hasLoop;
+    uint32_t loopStart;
+    uint32_t loopEnd;
+    int32_t loopCount;
+    int16_t loopState[16];
+    int used;
+    uint32_t offset;
+};
+
+struct SampleBank
+{
+    char *name;
+    char *dir;
+    struct Aifc *entries;
+    int count;
+    uint64_t signature; // of the AIFC files' names, sizes and timestamps
+    int index;
+    struct Bank **uses;
+    int numUses;
+    uint8_t *blob; // the used samples as laid out in the .tbl, before the final alignment
+    size_t blobSize;
+    uint64_t usedKey;
+    uint64_t layoutHash;
+};
+
+static double parse_f80(const uint8_t *data)
+{
+    uint16_t expBits = (data[0] << 8) | data[1];
+    uint64_t mantissaBits = 0;
+    double sign;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        mantissaBits = (mantissaBits << 8) | data[2 + i];
+    sign = (expBits & 0x8000) ? -1.0 : 1.0;
+    expBits &= 0x7FFF;
+    if (expBits == 0 && mantissaBits == 0)
+        return sign * 0.0;
+    validate(expBits != 0, NULL, "sample rate is a denormal");
+    validate(expBits != 0x7FFF, NULL, "sample rate is infinity/nan");
+    return sign * ((double)mantissaBits / 9223372036854775808.0) * ldexp(1.0, expBits - 0x3FFF);
+}
+
+static uint32_t read_u32(const uint8_t *data)
+{
+    return ((uint32_t)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+static int16_t read_s16(const uint8_t *data)
+{
+    return (int16_t)((data[0] << 8) | data[1]);
+}
+
+static void parse_aifc(struct Aifc *aifc, const uint8_t *data, size_t size)
+{
+    const uint8_t *codes = NULL;
+    const uint8_t *loops = NULL;
+    const uint8_t *audio = NULL;
+    size_t codesSize = 0;
+    size_t loopsSize = 0;
+    size_t audioSize = 0;
+    int hasComm = 0;
+    size_t i = 12;
+    int j;
+
+    validate(size >= 4 && memcmp(data, "FORM", 4) == 0, NULL, "must start with FORM");
+    validate(size >= 12 && memcmp(data + 8, "AIFC", 4) == 0, NULL, "format must be AIFC");
+    while (i < size)
+    {
+        const uint8_t *tp = data + i;
+        const uint8_t *chunk;
+        size_t length;
+
+        validate(i + 8 <= size, NULL, "truncated chunk header");
+        length = read_u32(data + i + 4);
+        i += 8;
+        chunk = data + i;
+        // Python slices clamp to the end of the file
+        if (length > size - i)
+            length = size - i;
+        if (memcmp(tp, "APPL", 4) == 0 && length >= 5 && memcmp(chunk, "stoc", 4) == 0)
+        {
+            size_t plen = chunk[4];
+            size_t skip = ALIGN(5 + plen, 2);
+
+            if (skip <= length)
+            {
+                if (plen == 11 && memcmp(chunk + 5, "VADPCMCODES", 11) == 0)
+                {
+                    codes = chunk + skip;
+                    codesSize = length - skip;
+                }
+                else if (plen == 11 && memcmp(chunk + 5, "VADPCMLOOPS", 11) == 0)
+                {
+                    loops = chunk + skip;
+                    loopsSize = length - skip;
+                }
+            }
+        }
+        else if (memcmp(tp, "SSND", 4) == 0)
+        {
+            audio = chunk + (length < 8 ? length : 8);
+            audioSize = length < 8 ? 0 : length - 8;
+        }
+        else if (memcmp(tp, "COMM", 4) == 0)
+        {
+            validate(length >= 18, NULL, "COMM section is too short");
+            aifc->sampleRate = parse_f80(chunk + 8);
+            hasComm = 1;
+        }
+        i = ALIGN(i + length, 2);
+    }
+
+    validate(hasComm, NULL, "no COMM section");
+    validate(audio != NULL, NULL, "no SSND section");
+    validate(codes != NULL, NULL, "no VADPCM table");
+
+    validate(codesSize >= 6 && read_s16(codes) == 1, NULL, "codebook version doesn't match");
+    aifc->bookOrder = read_s16(codes + 2);
+    aifc->bookPredictors = read_s16(codes + 4);
+    validate((long)codesSize == 6 + 16 * aifc->bookOrder * aifc->bookPredictors, NULL,
+             "predictor book chunk size doesn't match");
+    aifc->bookCount = (codesSize - 6) / 2;
+    aifc->book = xmalloc(aifc->bookCount * sizeof(*aifc->book));
+    for (j = 0; j < aifc->bookCount; j++)
+        aifc->book[j] = read_s16(codes + 6 + j * 2);
+
+    aifc->hasLoop = (loops != NULL);
+    if (loops != NULL)
+    {
+        validate(loopsSize == 48, NULL, "loop chunk size should be 48");
+        validate(((loops[0] << 8) | loops[1]) == 1, NULL, "loop version doesn't match");
+        validate(((loops[2] << 8) | loops[3]) == 1, NULL, "only one loop is supported");
+        aifc->loopStart = read_u32(loops + 4);
+        aifc->loopEnd = read_u32(loops + 8);
+        aifc->loopCount = (int32_t)read_u32(loops + 12);
+        for (j = 0; j < 16; j++)
+            aifc->loopState[j] = read_s16(loops + 16 + j * 2);
+    }
+
+    aifc->dataSize = audioSize;
+    aifc->data = xmalloc(audioSize);
+    memcpy(aifc->data, audio, audioSize);
+}
+
+static void load_aifc(struct Aifc *aifc, const char *dir, const char *filename)
+{
+    uint8_t *data;
+    size_t size;
+
+    memset(aifc, 0, sizeof(*aifc));
+    aifc->name = xstrndup(filename, strlen(filename) - 5);
+    aifc->fname = path_join(dir, filename);
+    data = read_whole_file(aifc->fname, &size);
+    if (data == NULL)
+        fatal_error("failed to open %s", aifc->fname);
+    snprintf(sErrorContext, sizeof(sErrorContext), "malformed AIFC file %s: ", aifc->fname);
+    parse_aifc(aifc, data, size);
+    free(data);
+}
+
+static uint64_t file_signature(uint64_t hash, const char *path)
+{
+    struct stat st;
+
+    if (stat(path, &st) != 0)
+        fatal_error("failed to stat %s", path);
+    hash = hash_string(hash, path);
+    hash = hash_u64(hash, st.st_size);
+    hash = hash_u64(hash, st.st_mtime);
+#if defined(__APPLE__)
+    hash = hash_u64(hash, st.st_mtimespec.tv_nsec);
+#elif defined(__linux__)
+    hash = hash_u64(hash, st.st_mtim.tv_nsec);
+#endif
+    return hash;
+}
+
+static uint64_t hash_aifc_layout(uint64_t hash, const struct Aifc *aifc)
+{
+    hash = hash_string(hash, aifc->name);
+    hash = hash_u64(hash, aifc->used);
+    hash = hash_u64(hash, aifc->offset);
+    hash = hash_u64(hash, aifc->dataSize);
+    hash = hash_bytes(hash, &aifc->sampleRate, sizeof(aifc->sampleRate));
+    hash = hash_u64(hash, aifc->bookOrder);
+    hash = hash_u64(hash, aifc->bookPredictors);
+    hash = hash_bytes(hash, aifc->book, aifc->bookCount * sizeof(*aifc->book));
+    hash = hash_u64(hash, aifc->hasLoop);
+    hash = hash_u64(hash, aifc->loopStart);
+    hash = hash_u64(hash, aifc->loopEnd);
+    hash = hash_u64(hash, (uint32_t)aifc->loopCount);
+    return hash_bytes(hash, aifc->loopState, sizeof(aifc->loopState));
+}
+
+static struct Aifc *find_aifc(const struct SampleBank *sampleBank, const char *name)
+{
+    int i;
+
+    for (i = 0; i < sampleBank->count; i++)
+    {
+        if (strcmp(sampleBank->entries[i].name, name) == 0)
+            return &sampleBank->entries[i];
+    }
+    return NULL;
+}
+
+/*
+ * Sound banks
+ */
+
+struct Bank
+{
+    char *name;
+    char *text;
+    struct Json *json;
+    struct SampleBank *sampleBank;
+    const char **usedSamples; // in order of first use
+    int numUsedSamples;
+    uint64_t key;
+    // serialized entry of the .ctl and its Shindou header meta
+    struct Buffer ctl;
+    uint8_t meta[4];
+};
+
+static void validate_sound(const struct Json *sound, const struct SampleBank *sampleBank, const char *forstr)
+{
+    static const struct FormatEntry sampleFormat[] = {{"sample", FORMAT_STRING}};
+    static const struct FormatEntry tuningFormat[] = {{"tuning", FORMAT_FLOAT}};
+    const char *sample;
+
+    validate_json_format(sound, sampleFormat, ARRAY_COUNT(sampleFormat), forstr);
+    if (json_get(sound, "tuning") != NULL)
+        validate_json_format(sound, tuningFormat, ARRAY_COUNT(tuningFormat), forstr);
+    sample = json_get(sound, "sample")->string;
+    validate(find_aifc(sampleBank, sample) != NULL, forstr, "reference to sound %s which isn't found in sample bank %s",
+             sample, sampleBank->name);
+}
+
+static void validate_bank_toplevel(const struct Json *json)
+{
+    static const struct FormatEntry format[] = {
+        {"envelopes", FORMAT_OBJECT},
+        {"sample_bank", FORMAT_STRING},
+        {"instruments", FORMAT_OBJECT},
+        {"instrument_list", FORMAT_ARRAY},
+    };
+
+    validate(json->type == JSON_OBJECT, NULL, "must have a top-level object");
+    validate_json_format(json, format, ARRAY_COUNT(format), NULL);
+}
+
+static struct Json *sound_object(struct Json *sample)
+{
+    struct Json *sound = json_new(JSON_OBJECT);
+
+    json_append(sound, xstrdup("sample"), sample);
+    return sound;
+}
+
+// Converts {"sound": "str"} into {"sound": {"sample": "str"}}
+static void normalize_sound_json(struct Json *json)
+{
+    static const char *keys[] = {"sound_lo", "sound", "sound_hi"};
+    struct Json *instruments = json_get(json, "instruments");
+    int i, j;
+
+    for (i = 0; i < instruments->count; i++)
+    {
+        struct Json *inst = instruments->items[i];
+
+        if (inst->type == JSON_ARRAY)
+        {
+            for (j = 0; j < inst->count; j++)
+            {
+                struct Json *drum = inst->items[j];
+                struct Json *sound = json_get(drum, "sound");
+
+                if (sound != NULL && sound->type == JSON_STRING)
+                    json_set(drum, "sound", sound_object(sound));
+            }
+        }
+        else
+        {
+            for (j = 0; j < (int)ARRAY_COUNT(keys); j++)
+            {
+                struct Json *sound = json_get(inst, keys[j]);
+
+                if (sound != NULL && sound->type == JSON_STRING)
+                    json_set(inst, keys[j], sound_object(sound));
+            }
+        }
+    }
+}
+
+static int is_date(const char *str)
+{
+    static const char pattern[] = "dddd-dd-dd";
+    int i;
+
+    for (i = 0; pattern[i] != '\0'; i++)
+    {
+        if (pattern[i] == 'd' ? !(str[i] >= '0' && str[i] <= '9') : str[i] != pattern[i])
+            return 0;
+    }
+    return str[i] == '\0';
+}
+
+static void validate_bank(struct Json *json, const struct SampleBank *sampleBank)
+{
+    static const struct FormatEntry drumFormat[] = {
+        {"release_rate", FORMAT_RANGE, 0, 255},
+        {"pan", FORMAT_RANGE, 0, 128},
+        {"envelope", FORMAT_STRING},
+        {"sound", FORMAT_OBJECT},
+    };
+    static const struct FormatEntry instFormat[] = {
+        {"release_rate", FORMAT_RANGE, 0, 255},
+        {"envelope", FORMAT_STRING},
+        {"normal_range_lo", FORMAT_RANGE, 0, 127},
+        {"normal_range_hi", FORMAT_RANGE, 0, 127},
+        {"sound_lo", FORMAT_OBJECT},
+        {"sound", FORMAT_OBJECT},
+        {"sound_hi", FORMAT_OBJECT},
+    };
+    struct Json *date = json_get(json, "date");
+    struct Json *envelopes = json_get(json, "envelopes");
+    struct Json *instruments = json_get(json, "instruments");
+    struct Json *instList = json_get(json, "instrument_list");
+    struct Json *drums = NULL;
+    int i, j, k;
+
+    if (date != NULL)
+        validate(date->type == JSON_STRING && is_date(date->string), NULL, "date must have format yyyy-mm-dd");
+
+    for (i = 0; i < envelopes->count; i++)
+    {
+        const char *key = envelopes->keys[i];
+        struct Json *env = envelopes->items[i];
+        int lastFine = 0;
+
+        validate(env->type == JSON_ARRAY, NULL, "envelope \"%s\" must be an array", key);
+        for (j = 0; j < env->count; j++)
+        {
+            struct Json *entry = env->items[j];
+
+            if (is_string(entry, "stop") || is_string(entry, "hang") || is_string(entry, "restart"))
+            {
+                lastFine = 1;
+                continue;
+            }
+            validate(entry->type == JSON_ARRAY && entry->count == 2, NULL,
+                     "envelope entry in \"%s\" must be a list of length 2, or one of stop/hang/restart", key);
+            if (is_string(entry->items[0], "goto"))
+            {
+                validate_int_in_range(entry->items[1], 0, env->count - 2, "envelope goto target out of range:", NULL);
+                lastFine = 1;
+            }
+            else
+            {
+                validate_int_in_range(entry->items[0], 0, 0x7FFF, "envelope entry's first part", NULL);
+                validate_int_in_range(entry->items[1], 0, 0x7FFF, "envelope entry's second part", NULL);
+                lastFine = 0;
+            }
+        }
+        validate(lastFine, NULL, "envelope \"%s\" must end with stop/hang/restart/goto", key);
+    }
+
+    for (i = 0; i < instruments->count; i++)
+    {
+        if (strcmp(instruments->keys[i], "percussion") == 0)
+        {
+            validate(instruments->items[i]->type == JSON_ARRAY, NULL, "drums entry must be a list");
+            drums = instruments->items[i];
+        }
+        else
+        {
+            validate(instruments->items[i]->type == JSON_OBJECT, NULL, "instrument entry must be an object");
+        }
+    }
+
+    for (i = 0; drums != NULL && i < drums->count; i++)
+    {
+        struct Json *drum = drums->items[i];
+
+        validate(drum->type == JSON_OBJECT, NULL, "drum entry must be an object");
+        validate_json_format(drum, drumFormat, ARRAY_COUNT(drumFormat), NULL);
+        validate_sound(json_get(drum, "sound"), sampleBank, NULL);
+        validate(json_get(envelopes, json_get(drum, "envelope")->string) != NULL, "drum",
+                 "reference to non-existent envelope %s", json_get(drum, "envelope")->string);
+    }
+
+    for (i = 0; i < instruments->count; i++)
+    {
+        struct Json *inst = instruments->items[i];
+        struct Json *ifdef = json_get(inst, "ifdef");
+        char forstr[1024];
+        int hasLo, hasHi;
+        const char *envelope;
+
+        if (strcmp(instruments->keys[i], "percussion") == 0)
+            continue;
+        snprintf(forstr, sizeof(forstr), "instrument %s", instruments->keys[i]);
+        validate(json_get(inst, "normal_range_lo") == NULL || json_get(inst, "sound_lo") != NULL, forstr,
+                 "normal_range_lo is specified, but not sound_lo");
+        validate(json_get(inst, "sound_lo") == NULL || json_get(inst, "normal_range_lo") != NULL, forstr,
+                 "sound_lo is specified, but not normal_range_lo");
+        validate(json_get(inst, "normal_range_hi") == NULL || json_get(inst, "sound_hi") != NULL, forstr,
+                 "normal_range_hi is specified, but not sound_hi");
+        validate(json_get(inst, "sound_hi") == NULL || json_get(inst, "normal_range_hi") != NULL, forstr,
+                 "sound_hi is specified, but not normal_range_hi");
+        hasLo = (json_get(inst, "sound_lo") != NULL);
+        hasHi = (json_get(inst, "sound_hi") != NULL);
+
+        // Missing ranges default to the full range, and missing sounds are skipped
+        for (k = 0; k < (int)ARRAY_COUNT(instFormat); k++)
+        {
+            if ((strcmp(instFormat[k].key, "normal_range_lo") == 0 && !hasLo) ||
+                (strcmp(instFormat[k].key, "normal_range_hi") == 0 && !hasHi) ||
+                (strcmp(instFormat[k].key, "sound_lo") == 0 && !hasLo) ||
+                (strcmp(instFormat[k].key, "sound_hi") == 0 && !hasHi))
+                continue;
+            validate_json_format(inst, &instFormat[k], 1, forstr);
+        }
+
+        if (ifdef != NULL)
+            validate(ifdef->type == JSON_ARRAY && all_strings(ifdef), NULL, "\"ifdef\" must be an array of strings");
+
+        validate((hasLo ? json_get(inst, "normal_range_lo")->intValue : 0) <=
+                 (hasHi ? json_get(inst, "normal_range_hi")->intValue : 127), forstr, "normal_range_lo > normal_range_hi");
+        envelope = json_get(inst, "envelope")->string;
+        validate(json_get(envelopes, envelope) != NULL, forstr, "reference to non-existent envelope %s", envelope);
+        if (hasLo)
+            validate_sound(json_get(inst, "sound_lo"), sampleBank, forstr);
+        validate_sound(json_get(inst, "sound"), sampleBank, forstr);
+        if (hasHi)
+            validate_sound(json_get(inst, "sound_hi"), sampleBank, forstr);
+    }
+
+    for (i = 0; i < instList->count; i++)
+    {
+        struct Json *name = instList->items[i];
+
+        if (name->type == JSON_NULL)
+            continue;
+        validate(name->type == JSON_STRING, NULL, "instrument list should contain only strings and nulls");
+        validate(strcmp(name->string, "percussion") != 0 && json_get(instruments, name->string) != NULL, NULL,
+                 "reference to non-existent instrument %s", name->string);
+        for (j = 0; j < i; j++)
+            validate(!is_string(instList->items[j], name->string), NULL, "%s occurs twice in the instrument list", name->string);
+    }
+
+    for (i = 0; i < instruments->count; i++)
+    {
+        int found = 0;
+
+        if (strcmp(instruments->keys[i], "percussion") == 0)
+            continue;
+        for (j = 0; j < instList->count; j++)
+            found |= is_string(instList->items[j], instruments->keys[i]);
+        validate(found, NULL, "unreferenced instrument %s", instruments->keys[i]);
+    }
+}
+
+static struct Json *apply_ifs(struct Json *json, const struct Defines *defines)
+{
+    int i;
+
+    if (json->type == JSON_OBJECT && json_get(json, "ifdef") != NULL && json_get(json, "then") != NULL &&
+        json_get(json, "else") != NULL)
+    {
+        static const struct FormatEntry format[] = {{"ifdef", FORMAT_ARRAY}};
+
+        validate_json_format(json, format, ARRAY_COUNT(format), NULL);
+        return apply_ifs(json_get(json, any_defined(defines, json_get(json, "ifdef")) ? "then" : "else"), defines);
+    }
+    if (json->type == JSON_ARRAY || json->type == JSON_OBJECT)
+    {
+        for (i = 0; i < json->count; i++)
+            json->items[i] = apply_ifs(json->items[i], defines);
+    }
+    return json;
+}
+
+static void apply_version_diffs(struct Json *json, const struct Defines *defines)
+{
+    struct Json *date = json_get(json, "date");
+    struct Json *instruments = json_get(json, "instruments");
+    struct Json *instList = json_get(json, "instrument_list");
+    int i, j;
+
+    if (has_define_str(defines, "VERSION_EU") && date != NULL && date->type == JSON_STRING)
+    {
+        char *found;
+
+        while ((found = strstr(date->string, "1996-03-19")) != NULL)
+            memcpy(found, "1996-06-24", 10);
+    }
+
+    for (i = 0; i < instruments->count; i++)
+    {
+        struct Json *inst = instruments->items[i];
+        struct Json *ifdef = json_get(inst, "ifdef");
+        const char *key = instruments->keys[i];
+
+        if (ifdef == NULL || ifdef->type != JSON_ARRAY || any_defined(defines, ifdef))
+            continue;
+        json_remove_at(instruments, i--);
+        for (j = 0; j < instList->count; j++)
+        {
+            if (is_string(instList->items[j], key))
+                break;
+        }
+        validate(j < instList->count, NULL, "list.remove(x): x not in list");
+        json_remove_at(instList, j);
+    }
+}
+
+static void add_used_sample(struct Bank *bank, const struct Json *sound)
+{
+    const char *name = json_get(sound, "sample")->string;
+    int i;
+
+    find_aifc(bank->sampleBank, name)->used = 1;
+    for (i = 0; i < bank->numUsedSamples; i++)
+    {
+        if (strcmp(bank->usedSamples[i], name) == 0)
+            return;
+    }
+    bank->usedSamples = xrealloc(bank->usedSamples, (bank->numUsedSamples + 1) * sizeof(*bank->usedSamples));
+    bank->usedSamples[bank->numUsedSamples++] = name;
+}
+
+static void mark_sample_bank_uses(struct Bank *bank)
+{
+    struct SampleBank *sampleBank = bank->sampleBank;
+    struct Json *instruments = json_get(bank->json, "instruments");
+    int i, j;
+
+    sampleBank->uses = xrealloc(sampleBank->uses, (sampleBank->numUses + 1) * sizeof(*sampleBank->uses));
+    sampleBank->uses[sampleBank->numUses++] = bank;
+
+    for (i = 0; i < instruments->count; i++)
+    {
+        struct Json *inst = instruments->items[i];
+
+        if (inst->type == JSON_ARRAY)
+        {
+            for (j = 0; j < inst->count; j++)
+                add_used_sample(bank, json_get(inst->items[j], "sound"));
+        }
+        else
+        {
+            if (json_get(inst, "sound_lo") != NULL)
+                add_used_sample(bank, json_get(inst, "sound_lo"));
+            add_used_sample(bank, json_get(inst, "sound"));
+            if (json_get(inst, "sound_hi") != NULL)
+                add_used_sample(bank, json_get(inst, "sound_hi"));
+        }
+    }
+}
+
+static uint32_t to_bcd(uint32_t num)
+{
+    uint32_t ret = 0;
+    int shift = 0;
+
+    while (num != 0)
+    {
+        ret |= (num % 10) << shift;
+        shift += 4;
+        num /= 10;
+    }
+    return ret;
+}
+
+static void ser_sound(struct Buffer *ser, const struct Bank *bank, const struct Json *sound,
+                      const size_t *sampleAddrs)
+{
+    const struct Json *tuning;
+    const char *name;
+    int i;
+
+    if (sound == NULL)
+    {
+        buf_put_word(ser, 0);
+        buf_put_f32(ser, 0.0);
+        buf_put_pad(ser);
+        return;
+    }
+    name = json_get(sound, "sample")->string;
+    for (i = 0; strcmp(bank->usedSamples[i], name) != 0; i++)
+        ;
+    buf_put_word(ser, sampleAddrs[i]);
+    tuning = json_get(sound, "tuning");
+    if (tuning != NULL)
+        buf_put_f32(ser, tuning->type == JSON_FLOAT ? tuning->floatValue : (double)tuning->intValue);
+    else
+        buf_put_f32(ser, find_aifc(bank->sampleBank, name)->sampleRate / 32000);
+    buf_put_pad(ser);
+}
+
+static void serialize_ctl(struct Bank *bank)
+{
+    struct Json *json = bank->json;
+    struct Json *instruments = json_get(json, "instruments");
+    struct Json *instList = json_get(json, "instrument_list");
+    struct Json *envelopes = json_get(json, "envelopes");
+    struct Json *drums = NULL;
+    struct Buffer ser = {0};
+    size_t *sampleAddrs = xmalloc(bank->numUsedSamples * sizeof(*sampleAddrs));
+    size_t *envAddrs = xmalloc(envelopes->count * sizeof(*envAddrs));
+    size_t *instPoses = xmalloc(instruments->count * sizeof(*instPoses));
+    size_t drumPosBuf = 0;
+    size_t instPosBuf;
+    int numDrums;
+    int i, j;
+
+    for (i = 0; i < instruments->count; i++)
+    {
+        if (instruments->items[i]->type == JSON_ARRAY)
+            drums = instruments->items[i];
+    }
+    numDrums = drums ? drums->count : 0;
+
+    bank->ctl.size = 0;
+    if (!sIsShindou)
+    {
+        struct Json *date = json_get(json, "date");
+        int y = 0, m = 0, d = 0;
+
+        if (date != NULL)
+            sscanf(date->string, "%d-%d-%d", &y, &m, &d);
+        buf_put(&bank->ctl, instList->count, 4);
+        buf_put(&bank->ctl, numDrums, 4);
+        buf_put(&bank->ctl, bank->sampleBank->numUses > 1 ? 1 : 0, 4);
+        buf_put(&bank->ctl, to_bcd(y * 10000 + m * 100 + d), 4);
+    }
+
+    if (drums != NULL)
+        drumPosBuf = buf_reserve_word(&ser);
+    else
+        buf_add_zeros(&ser, sWordBytes);
+    instPosBuf = ser.size;
+    buf_add_zeros(&ser, sWordBytes * instList->count);
+    buf_align(&ser, 16);
+
+    for (i = 0; i < bank->numUsedSamples; i++)
+    {
+        struct Aifc *aifc = find_aifc(bank->sampleBank, bank->usedSamples[i]);
+        uint32_t sampleLen = aifc->dataSize;
+        size_t loopAddrBuf, bookAddrBuf;
+
+        sampleAddrs[i] = ser.size;
+
+        // Sample
+        buf_put(&ser, sIsShindou ? ALIGN(sampleLen, 2) : 0, 4);
+        buf_put_pad(&ser);
+        buf_put_word(&ser, aifc->offset);
+        loopAddrBuf = buf_reserve_word(&ser);
+        bookAddrBuf = buf_reserve_word(&ser);
+        if (!sIsShindou)
+            buf_put(&ser, ALIGN(sampleLen, 2), 4);
+        buf_align(&ser, 16);
+
+        // Book
+        buf_patch_word(&ser, bookAddrBuf, ser.size);
+        buf_put(&ser, (uint32_t)(int32_t)aifc->bookOrder, 4);
+        buf_put(&ser, (uint32_t)(int32_t)aifc->bookPredictors, 4);
+        for (j = 0; j < aifc->bookCount; j++)
+            buf_put(&ser, (uint16_t)aifc->book[j], 2);
+        buf_align(&ser, 16);
+
+        // Loop
+        buf_patch_word(&ser, loopAddrBuf, ser.size);
+        if (!aifc->hasLoop)
+        {
+            if (sampleLen % 9 != 0 && sampleLen % 9 != 1)
+                fatal_error("sample %s has a partial frame", aifc->fname);
+            buf_put(&ser, 0, 4);
+            buf_put(&ser, sampleLen / 9 * 16 + (sampleLen % 2) + (sampleLen % 9), 4);
+            buf_put(&ser, 0, 4);
+            buf_put(&ser, 0, 4);
+        }
+        else
+        {
+            if (aifc->loopCount == 0)
+                fatal_error("sample %s has a loop count of 0", aifc->fname);
+            buf_put(&ser, aifc->loopStart, 4);
+            buf_put(&ser, aifc->loopEnd, 4);
+            buf_put(&ser, (uint32_t)aifc->loopCount, 4);
+            buf_put(&ser, 0, 4);
+            for (j = 0; j < 16; j++)
+                buf_put(&ser, (uint16_t)aifc->loopState[j], 2);
+        }
+        buf_align(&ser, 16);
+    }
+
+    for (i = 0; i < envelopes->count; i++)
+    {
+        struct Json *env = envelopes->items[i];
+
+        envAddrs[i] = ser.size;
+        for (j = 0; j < env->count; j++)
+        {
+            struct Json *entry = env->items[j];
+            uint16_t values[2] = {0, 0};
+            uint8_t bytes[4];
+
+            if (is_string(entry, "stop"))
+                values[0] = 0xFFFC;
+            else if (is_string(entry, "hang"))
+                values[0] = 0xFFFF;
+            else if (is_string(entry, "restart"))
+                values[0] = 0xFFFD;
+            else
+            {
+                values[0] = is_string(entry->items[0], "goto") ? 0xFFFE : entry->items[0]->intValue;
+                values[1] = entry->items[1]->intValue;
+            }
+            // Envelopes are always written as big endian, to match sequence files
+            // which are byte blobs and can embed envelopes.
+            put_uint_at(bytes, values[0], 2, 1);
+            put_uint_at(bytes + 2, values[1], 2, 1);
+            buf_add(&ser, bytes, 4);
+        }
+        buf_align(&ser, 16);
+    }
+
+    for (i = 0; i < instruments->count; i++)
+    {
+        struct Json *inst = instruments->items[i];
+        struct Json *lo = json_get(inst, "normal_range_lo");
+        struct Json *hi = json_get(inst, "normal_range_hi");
+
+        if (inst->type == JSON_ARRAY)
+            continue;
+        instPoses[i] = ser.size;
+        for (j = 0; strcmp(envelopes->keys[j], json_get(inst, "envelope")->string) != 0; j++)
+            ;
+        buf_put(&ser, 0, 1);
+        buf_put(&ser, lo ? lo->intValue : 0, 1);
+        buf_put(&ser, hi ? hi->intValue : 127, 1);
+        buf_put(&ser, json_get(inst, "release_rate")->intValue, 1);
+        buf_put_pad(&ser);
+        buf_put_word(&ser, envAddrs[j]);
+        ser_sound(&ser, bank, json_get(inst, "sound_lo"), sampleAddrs);
+        ser_sound(&ser, bank, json_get(inst, "sound"), sampleAddrs);
+        ser_sound(&ser, bank, json_get(inst, "sound_hi"), sampleAddrs);
+    }
+    buf_align(&ser, 16);
+
+    for (i = 0; i < instList->count; i++)
+    {
+        size_t pos = 0;
+
+        if (instList->items[i]->type == JSON_STRING)
+        {
+            for (j = 0; strcmp(instruments->keys[j], instList->items[i]->string) != 0; j++)
+                ;
+            pos = instPoses[j];
+        }
+        buf_patch_word(&ser, instPosBuf + i * sWordBytes, pos);
+    }
+
+    if (drums != NULL)
+    {
+        size_t *drumPoses = xmalloc(drums->count * sizeof(*drumPoses));
+
+        for (i = 0; i < drums->count; i++)
+        {
+            struct Json *drum = drums->items[i];
+
+            drumPoses[i] = ser.size;
+            buf_put(&ser, json_get(drum, "release_rate")->intValue, 1);
+            buf_put(&ser, json_get(drum, "pan")->intValue, 1);
+            buf_put(&ser, 0, 1);
+            buf_put(&ser, 0, 1);
+            buf_put_pad(&ser);
+            ser_sound(&ser, bank, json_get(drum, "sound"), sampleAddrs);
+            for (j = 0; strcmp(envelopes->keys[j], json_get(drum, "envelope")->string) != 0; j++)
+                ;
+            buf_put_word(&ser, envAddrs[j]);
+        }
+        buf_align(&ser, 16);
+
+        buf_patch_word(&ser, drumPosBuf, ser.size);
+        for (i = 0; i < drums->count; i++)
+            buf_put_word(&ser, drumPoses[i]);
+        buf_align(&ser, 16);
+        free(drumPoses);
+    }
+
+    buf_add(&bank->ctl, ser.data, ser.size);
+    put_uint_at(bank->meta, (bank->sampleBank->index << 8) | 0xFF, 2, sBigEndian);
+    put_uint_at(bank->meta + 2, (instList->count << 8) | numDrums, 2, sBigEndian);
+
+    free(ser.data);
+    free(sampleAddrs);
+    free(envAddrs);
+    free(instPoses);
+}
+
+/*
+ * Sequence files
+ */
+
+struct SeqFile
+{
+    struct GarbageBuffer ser;
+    size_t *offsets;
+    size_t *lengths;
+    uint8_t (*meta)[4];
+    int count;
+};
+
+static void seqfile_begin_entry(struct SeqFile *file)
+{
+    file->offsets = xrealloc(file->offsets, (file->count + 1) * sizeof(*file->offsets));
+    file->lengths = xrealloc(file->lengths, (file->count + 1) * sizeof(*file->lengths));
+    file->meta = xrealloc(file->meta, (file->count + 1) * sizeof(*file->meta));
+    file->offsets[file->count] = file->ser.buf.size;
+    memset(file->meta[file->count], 0, sizeof(*file->meta));
+}
+
+static void seqfile_end_entry(struct SeqFile *file)
+{
+    file->lengths[file->count] = file->ser.buf.size - file->offsets[file->count];
+    file->count++;
+}
+
+static void write_seqfile(const struct SeqFile *file, const char *outFilename, const char *outHeaderFilename,
+                          const int *entryList, int entryListCount, int magic, int extraPadding)
+{
+    struct Buffer ser = {0};
+    int i;
+
+    if (sIsShindou)
+    {
+        // Ignore entryList and use all entries instead. This makes a
+        // difference for sample banks, where US/JP/EU doesn't use a normal
+        // header for sample banks but instead has a mapping from sound bank to
+        // sample bank offset/length. Shindou uses a normal header and makes the
+        // mapping part of the sound bank header instead (part of the meta).
+        buf_put(&ser, file->count, 2);
+        buf_align(&ser, 16);
+        for (i = 0; i < file->count; i++)
+        {
+            buf_put_word(&ser, file->offsets[i]);
+            buf_put(&ser, file->lengths[i], 4);
+            buf_put(&ser, 0x02, 1); // cartridge
+            buf_put(&ser, magic == TYPE_TBL ? 0x04 : 0x03, 1);
+            buf_add(&ser, file->meta[i], 4);
+            buf_align(&ser, sWordBytes);
+        }
+        if (outHeaderFilename != NULL && outHeaderFilename[0] != '\0')
+            write_whole_file(outHeaderFilename, ser.data, ser.size);
+        write_whole_file(outFilename, file->ser.buf.data, file->ser.buf.size);
+    }
+    else
+    {
+        size_t table, dataStart;
+
+        buf_put(&ser, magic, 2);
+        buf_put(&ser, entryListCount, 2);
+        buf_put_pad(&ser);
+        table = ser.size;
+        buf_add_zeros(&ser, entryListCount * 2 * sWordBytes);
+        buf_align(&ser, 16);
+        dataStart = ser.size;
+
+        buf_add(&ser, file->ser.buf.data, file->ser.buf.size);
+        if (extraPadding)
+            buf_add_zeros(&ser, 1);
+        buf_align(&ser, 64);
+
+        for (i = 0; i < entryListCount; i++)
+        {
+            int index = entryList[i];
+
+            buf_patch_word(&ser, table, file->offsets[index] + dataStart);
+            put_uint_at(ser.data + table + sWordBytes, file->lengths[index], 4, sBigEndian);
+            table += 2 * sWordBytes;
+        }
+        write_whole_file(outFilename, ser.data, ser.size);
+    }
+    free(ser.data);
+}
+
+/*
+ * Sequences
+ */
+
+static char *splitext_basename(const char *path)
+{
+    const char *base = strrchr(path, '/');
+    const char *p;
+    const char *dot;
+
+    base = base ? base + 1 : path;
+    // Leading dots don't start an extension
+    for (p = base; *p == '.'; p++)
+        ;
+    dot = strrchr(p, '.');
+    return dot ? xstrndup(base, dot - base) : xstrdup(base);
+}
+
+static const char *basename_of(const char *path)
+{
+    const char *base = strrchr(path, '/');
+
+    return base ? base + 1 : path;
+}
+
+static int basename_cmp(const void *a, const void *b)
+{
+    int cmp = strcmp(basename_of(*(const char **)a), basename_of(*(const char **)b));
+
+    // Keep the sort stable, like Python's
+    if (cmp == 0)
+        cmp = (*(const char **)a > *(const char **)b) - (*(const char **)a < *(const char **)b);
+    return cmp;
+}
+
+static char **list_bank_names(const char *soundBankDir, int *count)
+{
+    int numFiles, i;
+    char **files = list_dir(soundBankDir, &numFiles);
+    char **names = xmalloc(numFiles * sizeof(*names));
+
+    *count = 0;
+    for (i = 0; i < numFiles; i++)
+    {
+        if (str_ends_with(files[i], ".json"))
+            names[(*count)++] = splitext_basename(files[i]);
+    }
+    return names;
+}
+
+static int find_name(char **names, int count, const char *name)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (strcmp(names[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// Parses sequences.json, replacing every entry by its list of banks or null
+static struct Json *read_sequence_json(const char *seqJson, char **bankNames, int numBankNames, const struct Defines *defines)
+{
+    struct Json *json;
+    char *text;
+    char *data;
+    size_t size;
+    int i, j;
+
+    snprintf(sErrorContext, sizeof(sErrorContext), "failed to parse %s: ", seqJson);
+    text = (char *)read_whole_file(seqJson, &size);
+    if (text == NULL)
+        validation_error("No such file or directory");
+    data = strip_comments(text);
+    json = json_parse(data);
+    free(text);
+    free(data);
+
+    validate(json->type == JSON_OBJECT, NULL, "must have a top-level object");
+    json_remove(json, "comment");
+    for (i = 0; i < json->count; i++)
+    {
+        const char *key = json->keys[i];
+        struct Json *seq = json->items[i];
+
+        if (seq->type == JSON_OBJECT)
+        {
+            static const struct FormatEntry format[] = {{"ifdef", FORMAT_ARRAY}, {"banks", FORMAT_ARRAY}};
+
+            validate_json_format(seq, format, ARRAY_COUNT(format), key);
+            validate(all_strings(json_get(seq, "ifdef")), key, "\"ifdef\" must be an array of strings");
+            seq = any_defined(defines, json_get(seq, "ifdef")) ? json_get(seq, "banks") : json_new(JSON_NULL);
+            json->items[i] = seq;
+        }
+        if (seq->type == JSON_ARRAY)
+        {
+            for (j = 0; j < seq->count; j++)
+            {
+                validate(seq->items[j]->type == JSON_STRING, key, "bank list must be an array of strings");
+                validate(find_name(bankNames, numBankNames, seq->items[j]->string) >= 0, key,
+                         "reference to non-existing sound bank %s", seq->items[j]->string);
+            }
+        }
+        else
+        {
+            validate(seq->type == JSON_NULL, key, "bad JSON type, expected null, array or object");
+        }
+    }
+    return json;
+}
+
+static int sequence_index(const char *key)
+{
+    char *end;
+    long ind = strtol(key, &end, 16);
+
+    if (end == key || (*end != '_' && *end != '\0') || ind < 0)
+        fatal_error("invalid literal for int() with base 16 in sequence name %s", key);
+    return ind;
+}
+
+static void write_sequences(char **inputs, int numInputs, const char *outFilename, const char *outHeaderFilename,
+                            const char *outBankSets, const char *soundBankDir, const char *seqJson,
+                            const struct Defines *defines)
+{
+    int numBankNames, numNames = 0;
+    char **bankNames = list_bank_names(soundBankDir, &numBankNames);
+    struct Json *json = read_sequence_json(seqJson, bankNames, numBankNames, defines);
+    char **names = xmalloc((numInputs + 1) * sizeof(*names));
+    const char **indToName = NULL;
+    int *entryList;
+    struct SeqFile file = {0};
+    struct Buffer ser = {0};
+    size_t table;
+    int i, j;
+
+    qsort(inputs, numInputs, sizeof(*inputs), basename_cmp);
+    for (i = 0; i < numInputs; i++)
+    {
+        names[i] = splitext_basename(inputs[i]);
+        for (j = 0; j < i; j++)
+        {
+            if (strcmp(names[j], names[i]) == 0)
+                fatal_error("Files %s and %s conflict. Remove one of them.", inputs[i], inputs[j]);
+        }
+        if (json_get(json, names[i]) == NULL)
+            fatal_error("Sequence file %s is not mentioned in sequences.json. "
+                        "Either assign it a list of sound banks, or set it to null to "
+                        "explicitly leave it out from the build.", inputs[i]);
+    }
+
+    for (i = 0; i < json->count; i++)
+    {
+        if (find_name(names, numInputs, json->keys[i]) < 0 && json->items[i]->type != JSON_NULL)
+            fatal_error("sequences.json assigns sound banks to %s, but there is no such sequence file. "
+                        "Either remove the entry (or set it to null), or create sound/sequences/%s.m64.",
+                        json->keys[i], json->keys[i]);
+    }
+
+    for (i = 0; i < json->count; i++)
+    {
+        int ind = sequence_index(json->keys[i]);
+
+        if (ind >= numNames)
+        {
+            indToName = xrealloc(indToName, (ind + 1) * sizeof(*indToName));
+            for (j = numNames; j <= ind; j++)
+                indToName[j] = NULL;
+            numNames = ind + 1;
+        }
+        if (indToName[ind] != NULL)
+            fatal_error("Sequence files %s and %s have the same index. Renumber or delete one of them.",
+                        json->keys[i], indToName[ind]);
+        indToName[ind] = json->keys[i];
+    }
+
+    while (numNames > 0 && (indToName[numNames - 1] == NULL || json_get(json, indToName[numNames - 1])->type == JSON_NULL))
+        numNames--;
+
+    for (i = 0; i < numNames; i++)
+    {
+        if (indToName[i] == NULL)
+            fatal_error("Sequence file index jump detected. Please make sure your sequence files are labeled correctly "
+                        "in incremental hexadecimal order.");
+    }
+
+    garbage_init(&file.ser);
+    entryList = xmalloc((numNames + 1) * sizeof(*entryList));
+    for (i = 0; i < numNames; i++)
+    {
+        const char *name = indToName[i];
+
+        entryList[i] = i;
+        seqfile_begin_entry(&file);
+        if (json_get(json, name)->type != JSON_NULL)
+        {
+            const char *fname = inputs[find_name(names, numInputs, name)];
+            size_t size;
+            uint8_t *data = read_whole_file(fname, &size);
+
+            if (data == NULL)
+                fatal_error("failed to open %s", fname);
+            garbage_reset_pos(&file.ser);
+            buf_add(&file.ser.buf, data, size);
+            if (sIsShindou && strncmp(name, "17", 2) == 0)
+                buf_align(&file.ser.buf, 16);
+            else
+                garbage_align(&file.ser, 16);
+            free(data);
+        }
+        seqfile_end_entry(&file);
+    }
+
+    write_seqfile(&file, outFilename, outHeaderFilename, entryList, numNames, TYPE_SEQ, 0);
+
+    table = ser.size;
+    buf_add_zeros(&ser, numNames * 2);
+    for (i = 0; i < numNames; i++)
+    {
+        struct Json *bankSet = json_get(json, indToName[i]);
+        int count = (bankSet->type == JSON_ARRAY) ? bankSet->count : 0;
+        uint8_t byte = count;
+
+        put_uint_at(ser.data + table + i * 2, ser.size, 2, sBigEndian);
+        buf_add(&ser, &byte, 1);
+        for (j = count - 1; j >= 0; j--)
+        {
+            byte = find_name(bankNames, numBankNames, bankSet->items[j]->string);
+            buf_add(&ser, &byte, 1);
+        }
+    }
+    buf_align(&ser, 16);
+    write_whole_file(outBankSets, ser.data, ser.size);
+}
+
+/*
+ * Cache of the sample bank layouts and serialized banks
+ */
+
+struct CacheReader
+{
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    int error;
+};
+
+static const uint8_t *cache_read(struct CacheReader *reader, size_t size)
+{
+    const uint8_t *ret = reader->data + reader->pos;
+
+    if (reader->error || size > reader->size - reader->pos)
+    {
+        reader->error = 1;
+        return NULL;
+    }
+    reader->pos += size;
+    return ret;
+}
+
+static uint64_t cache_read_u64(struct CacheReader *reader)
+{
+    const uint8_t *data = cache_read(reader, 8);
+    uint64_t value = 0;
+
+    if (data != NULL)
+        memcpy(&value, data, 8);
+    return value;
+}
+
+static char *cache_read_string(struct CacheReader *reader)
+{
+    uint64_t length = cache_read_u64(reader);
+    const uint8_t *data = cache_read(reader, length);
+
+    return data ? xstrndup((const char *)data, length) : NULL;
+}
+
+static void cache_write_u64(FILE *file, uint64_t value)
+{
+    fwrite(&value, 8, 1, file);
+}
+
+static void cache_write_bytes(FILE *file, const void *data, size_t size)
+{
+    cache_write_u64(file, size);
+    fwrite(data, 1, size, file);
+}
+
+static void cache_write_string(FILE *file, const char *str)
+{
+    cache_write_bytes(file, str, strlen(str));
+}
+
+struct Cache
+{
+    struct SampleBank *sampleBanks;
+    int numSampleBanks;
+    char **bankNames;
+    uint64_t *bankKeys;
+    struct Buffer *bankCtls;
+    uint8_t (*bankMetas)[4];
+    int numBanks;
+};
+
+static void read_cache(const char *filename, uint64_t optionsKey, struct Cache *cache)
+{
+    struct CacheReader reader = {0};
+    uint64_t i, j, count;
+
+    memset(cache, 0, sizeof(*cache));
+    if (filename == NULL || (reader.data = read_whole_file(filename, &reader.size)) == NULL)
+        return;
+    if (cache_read_u64(&reader) != CACHE_MAGIC || cache_read_u64(&reader) != CACHE_VERSION ||
+        cache_read_u64(&reader) != optionsKey)
+        goto invalid;
+
+    count = cache_read_u64(&reader);
+    if (reader.error || count > reader.size)
+        goto invalid;
+    cache->sampleBanks = xmalloc(count * sizeof(*cache->sampleBanks));
+    for (i = 0; i < count && !reader.error; i++)
+    {
+        struct SampleBank *sampleBank = &cache->sampleBanks[cache->numSampleBanks++];
+
+        memset(sampleBank, 0, sizeof(*sampleBank));
+        sampleBank->name = cache_read_string(&reader);
+        sampleBank->signature = cache_read_u64(&reader);
+        sampleBank->usedKey = cache_read_u64(&reader);
+        sampleBank->count = cache_read_u64(&reader);
+        if (reader.error || (uint64_t)sampleBank->count > reader.size)
+            goto invalid;
+        sampleBank->entries = xmalloc(sampleBank->count * sizeof(*sampleBank->entries));
+        for (j = 0; j < (uint64_t)sampleBank->count && !reader.error; j++)
+        {
+            struct Aifc *aifc = &sampleBank->entries[j];
+            const uint8_t *data;
+
+            memset(aifc, 0, sizeof(*aifc));
+            aifc->name = cache_read_string(&reader);
+            aifc->dataSize = cache_read_u64(&reader);
+            data = cache_read(&reader, sizeof(aifc->sampleRate));
+            if (data != NULL)
+                memcpy(&aifc->sampleRate, data, sizeof(aifc->sampleRate));
+            aifc->bookOrder = cache_read_u64(&reader);
+            aifc->bookPredictors = cache_read_u64(&reader);
+            aifc->bookCount = cache_read_u64(&reader);
+            data = cache_read(&reader, aifc->bookCount * sizeof(*aifc->book));
+            if (data == NULL)
+                goto invalid;
+            aifc->book = xmalloc(aifc->bookCount * sizeof(*aifc->book));
+            memcpy(aifc->book, data, aifc->bookCount * sizeof(*aifc->book));
+            aifc->hasLoop = cache_read_u64(&reader);
+            aifc->loopStart = cache_read_u64(&reader);
+            aifc->loopEnd = cache_read_u64(&reader);
+            aifc->loopCount = (int32_t)cache_read_u64(&reader);
+            data = cache_read(&reader, sizeof(aifc->loopState));
+            if (data != NULL)
+                memcpy(aifc->loopState, data, sizeof(aifc->loopState));
+        }
+        sampleBank->blobSize = cache_read_u64(&reader);
+        if (cache_read(&reader, sampleBank->blobSize) == NULL)
+            goto invalid;
+        sampleBank->blob = (uint8_t *)reader.data + reader.pos - sampleBank->blobSize;
+    }
+
+    count = cache_read_u64(&reader);
+    if (reader.error || count > reader.size)
+        goto invalid;
+    cache->bankNames = xmalloc(count * sizeof(*cache->bankNames));
+    cache->bankKeys = xmalloc(count * sizeof(*cache->bankKeys));
+    cache->bankCtls = xmalloc(count * sizeof(*cache->bankCtls));
+    cache->bankMetas = xmalloc(count * sizeof(*cache->bankMetas));
+    for (i = 0; i < count && !reader.error; i++)
+    {
+        struct Buffer *ctl = &cache->bankCtls[cache->numBanks];
+        const uint8_t *data;
+
+        cache->bankNames[cache->numBanks] = cache_read_string(&reader);
+        cache->bankKeys[cache->numBanks] = cache_read_u64(&reader);
+        memset(ctl, 0, sizeof(*ctl));
+        ctl->size = cache_read_u64(&reader);
+        ctl->data = (uint8_t *)cache_read(&reader, ctl->size);
+        data = cache_read(&reader, 4);
+        if (data != NULL)
+            memcpy(cache->bankMetas[cache->numBanks], data, 4);
+        cache->numBanks++;
+    }
+    if (!reader.error && reader.pos == reader.size)
+        return;
+
+invalid:
+    // Start over rather than trusting any of it
+    memset(cache, 0, sizeof(*cache));
+}
+
+static void write_cache(const char *filename, uint64_t optionsKey, struct SampleBank *sampleBanks, int numSampleBanks,
+                        struct Bank *banks, int numBanks)
+{
+    char *tmpFilename = xmalloc(strlen(filename) + 5);
+    FILE *file;
+    int i, j;
+
+    sprintf(tmpFilename, "%s.tmp", filename);
+    file = fopen(tmpFilename, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "warning: failed to write %s\n", tmpFilename);
+        free(tmpFilename);
+        return;
+    }
+    cache_write_u64(file, CACHE_MAGIC);
+    cache_write_u64(file, CACHE_VERSION);
+    cache_write_u64(file, optionsKey);
+
+    cache_write_u64(file, numSampleBanks);
+    for (i = 0; i < numSampleBanks; i++)
+    {
+        const struct SampleBank *sampleBank = &sampleBanks[i];
+
+        cache_write_string(file, sampleBank->name);
+        cache_write_u64(file, sampleBank->signature);
+        cache_write_u64(file, sampleBank->usedKey);
+        cache_write_u64(file, sampleBank->count);
+        for (j = 0; j < sampleBank->count; j++)
+        {
+            const struct Aifc *aifc = &sampleBank->entries[j];
+
+            cache_write_string(file, aifc->name);
+            cache_write_u64(file, aifc->dataSize);
+            fwrite(&aifc->sampleRate, sizeof(aifc->sampleRate), 1, file);
+            cache_write_u64(file, aifc->bookOrder);
+            cache_write_u64(file, aifc->bookPredictors);
+            cache_write_u64(file, aifc->bookCount);
+            fwrite(aifc->book, sizeof(*aifc->book), aifc->bookCount, file);
+            cache_write_u64(file, aifc->hasLoop);
+            cache_write_u64(file, aifc->loopStart);
+            cache_write_u64(file, aifc->loopEnd);
+            cache_write_u64(file, (uint32_t)aifc->loopCount);
+            fwrite(aifc->loopState, sizeof(aifc->loopState), 1, file);
+        }
+        cache_write_bytes(file, sampleBank->blob, sampleBank->blobSize);
+    }
+
+    cache_write_u64(file, numBanks);
+    for (i = 0; i < numBanks; i++)
+    {
+        cache_write_string(file, banks[i].name);
+        cache_write_u64(file, banks[i].key);
+        cache_write_bytes(file, banks[i].ctl.data, banks[i].ctl.size);
+        fwrite(banks[i].meta, 4, 1, file);
+    }
+
+    if (fclose(file) != 0 || rename(tmpFilename, filename) != 0)
+        fprintf(stderr, "warning: failed to write %s\n", filename);
+    free(tmpFilename);
+}
+
+static const struct SampleBank *find_cached_sample_bank(const struct Cache *cache, const char *name, uint64_t signature)
+{
+    int i;
+
+    for (i = 0; i < cache->numSampleBanks; i++)
+    {
+        if (strcmp(cache->sampleBanks[i].name, name) == 0 && cache->sampleBanks[i].signature == signature)
+            return &cache->sampleBanks[i];
+    }
+    return NULL;
+}
+
+/*
+ * Sound banks and sample banks
+ */
+
+static void load_sample_bank(struct SampleBank *sampleBank, char **files, int numFiles)
+{
+    int i;
+
+    sampleBank->entries = xmalloc(numFiles * sizeof(*sampleBank->entries));
+    sampleBank->count = 0;
+    for (i = 0; i < numFiles; i++)
+    {
+        if (str_ends_with(files[i], ".aifc"))
+            load_aifc(&sampleBank->entries[sampleBank->count++], sampleBank->dir, files[i]);
+    }
+}
+
+// Assigns the offsets of the used samples in the .tbl, and puts them together if they aren't cached.
+// Returns whether the cached layout could be used.
+static int layout_sample_bank(struct SampleBank *sampleBank, const struct Cache *cache)
+{
+    const struct SampleBank *cached = find_cached_sample_bank(cache, sampleBank->name, sampleBank->signature);
+    uint64_t usedKey = HASH_INIT;
+    uint64_t layoutHash = HASH_INIT;
+    size_t pos = 0;
+    int i;
+
+    for (i = 0; i < sampleBank->count; i++)
+        usedKey = hash_u64(usedKey, sampleBank->entries[i].used);
+
+    for (i = 0; i < sampleBank->count; i++)
+    {
+        struct Aifc *aifc = &sampleBank->entries[i];
+
+        if (!aifc->used)
+            continue;
+        pos = ALIGN(pos, 16);
+        aifc->offset = pos;
+        pos += aifc->dataSize;
+    }
+    sampleBank->blobSize = ALIGN(pos, 2);
+    sampleBank->usedKey = usedKey;
+
+    for (i = 0; i < sampleBank->count; i++)
+        layoutHash = hash_aifc_layout(layoutHash, &sampleBank->entries[i]);
+    sampleBank->layoutHash = hash_u64(layoutHash, sampleBank->index);
+
+    if (cached != NULL && cached->usedKey == usedKey && cached->blobSize == sampleBank->blobSize)
+    {
+        sampleBank->blob = cached->blob;
+        return 1;
+    }
+
+    if (sampleBank->count > 0 && sampleBank->entries[0].data == NULL)
+    {
+        // The layout came from the cache, but different samples are used now
+        struct SampleBank loaded = *sampleBank;
+        int numFiles;
+        char **files = list_dir(sampleBank->dir, &numFiles);
+
+        load_sample_bank(&loaded, files, numFiles);
+        for (i = 0; i < sampleBank->count; i++)
+            sampleBank->entries[i].data = loaded.entries[i].data;
+    }
+
+    sampleBank->blob = xmalloc(sampleBank->blobSize);
+    memset(sampleBank->blob, 0, sampleBank->blobSize);
+    for (i = 0; i < sampleBank->count; i++)
+    {
+        struct Aifc *aifc = &sampleBank->entries[i];
+
+        if (aifc->used)
+            memcpy(sampleBank->blob + aifc->offset, aifc->data, aifc->dataSize);
+    }
+    return 0;
+}
+
+static char *read_bank_text(const char *fname, const char *cppCommand, char **defines, int numDefines)
+{
+    struct Buffer buf = {0};
+    char *text;
+    size_t size;
+    FILE *pipe;
+    int i;
+
+    if (cppCommand == NULL)
+    {
+        char *data = (char *)read_whole_file(fname, &size);
+
+        if (data == NULL)
+            validation_error("No such file or directory");
+        text = strip_comments(data);
+        free(data);
+        return text;
+    }
+
+    buf_add(&buf, cppCommand, strlen(cppCommand));
+    buf_add(&buf, " '", 2);
+    buf_add(&buf, fname, strlen(fname));
+    buf_add(&buf, "'", 1);
+    for (i = 0; i < numDefines; i++)
+    {
+        buf_add(&buf, " '-D", 4);
+        buf_add(&buf, defines[i], strlen(defines[i]));
+        buf_add(&buf, "'", 1);
+    }
+    buf_add(&buf, "", 1);
+    pipe = popen((char *)buf.data, "r");
+    if (pipe == NULL)
+        validation_error("failed to run %s", cppCommand);
+    buf.size = 0;
+    while (!feof(pipe))
+    {
+        char chunk[4096];
+
+        buf_add(&buf, chunk, fread(chunk, 1, sizeof(chunk), pipe));
+    }
+    if (pclose(pipe) != 0)
+        validation_error("Command '%s' returned non-zero exit status", cppCommand);
+    buf_add(&buf, "", 1);
+    return (char *)buf.data;
+}
+
+static int sample_bank_cmp(const void *a, const void *b)
+{
+    const struct SampleBank *sa = a;
+    const struct SampleBank *sb = b;
+    int cmp = strcmp(sa->uses[0]->name, sb->uses[0]->name);
+
+    // Stable, like Python's sort
+    if (cmp == 0)
+        cmp = (sa->index > sb->index) - (sa->index < sb->index);
+    return cmp;
+}
+
+static size_t bank_heap_size(size_t ctlLength)
+{
+    // bank_load_immediate/bank_load_async skip the 16 byte header of the entry
+    if (sIsShindou)
+        return ALIGN(ctlLength, 16);
+    return ALIGN(ctlLength + 0xF, 16) - 0x10;
+}
+
+static const char *hex_string(size_t value, char *buf)
+{
+    sprintf(buf, "0x%zX", value);
+    return buf;
+}
+
+static void write_heap_report(const char *filename, const char *seqJson, const char *pools, struct Bank *banks,
+                              int numBanks, const struct SeqFile *ctl, const struct SeqFile *tbl,
+                              const struct Defines *defines)
+{
+    unsigned long persistentPool, temporaryPool;
+    char **bankNames = xmalloc(numBanks * sizeof(*bankNames));
+    size_t *heapSizes = xmalloc(numBanks * sizeof(*heapSizes));
+    int *inSet = xmalloc(numBanks * sizeof(*inSet));
+    struct Json *json;
+    struct Json *soundPlayer = NULL;
+    char sizeBuf[24], sizeBuf2[24];
+    FILE *file;
+    int i, j;
+
+    if (sscanf(pools, "%li %li", &persistentPool, &temporaryPool) != 2 || persistentPool == 0 || temporaryPool == 0)
+    {
+        fprintf(stderr, "warning: bad audio heap pool sizes \"%s\", not writing %s\n", pools, filename);
+        return;
+    }
+    for (i = 0; i < numBanks; i++)
+    {
+        bankNames[i] = banks[i].name;
+        heapSizes[i] = bank_heap_size(ctl->lengths[i]);
+    }
+    json = read_sequence_json(seqJson, bankNames, numBanks, defines);
+
+    file = fopen(filename, "w");
+    if (file == NULL)
+        fatal_error("failed to write %s", filename);
+
+    fprintf(file, "Sound banks, against the persistent bank pool (0x%lX bytes) and the temporary bank pool (0x%lX bytes)\n\n",
+            persistentPool, temporaryPool);
+    fprintf(file, "%-24s %-16s %10s %11s %10s %14s\n", "bank", "sample bank", "heap size", "persistent", "temporary", "samples (ROM)");
+    for (i = 0; i < numBanks; i++)
+    {
+        fprintf(file, "%-24s %-16s %10s %10.1f%% %9.1f%% %14s%s\n", banks[i].name, banks[i].sampleBank->name,
+                hex_string(heapSizes[i], sizeBuf), 100.0 * heapSizes[i] / persistentPool,
+                100.0 * heapSizes[i] / temporaryPool, hex_string(tbl->lengths[banks[i].sampleBank->index], sizeBuf2),
+                heapSizes[i] > temporaryPool ? "  too large for the temporary pool" : "");
+    }
+
+    // Banks stay loaded in the persistent pool, so a sequence's banks share it with the sound player's
+    for (i = 0; i < json->count; i++)
+    {
+        if (json->items[i]->type == JSON_ARRAY && sequence_index(json->keys[i]) == 0)
+            soundPlayer = json->items[i];
+    }
+
+    fprintf(file, "\nSequence bank sets, against the persistent bank pool\n\n");
+    fprintf(file, "%-32s %6s %10s %11s %16s\n", "sequence", "banks", "heap size", "persistent", "with sequence 0");
+    for (i = 0; i < json->count; i++)
+    {
+        struct Json *bankSet = json->items[i];
+        size_t total = 0;
+        size_t withSoundPlayer = 0;
+
+        if (bankSet->type != JSON_ARRAY)
+            continue;
+        memset(inSet, 0, numBanks * sizeof(*inSet));
+        for (j = 0; j < bankSet->count; j++)
+            inSet[find_name(bankNames, numBanks, bankSet->items[j]->string)] = 1;
+        for (j = 0; j < numBanks; j++)
+            total += inSet[j] ? heapSizes[j] : 0;
+        for (j = 0; soundPlayer != NULL && j < soundPlayer->count; j++)
+            inSet[find_name(bankNames, numBanks, soundPlayer->items[j]->string)] = 1;
+        for (j = 0; j < numBanks; j++)
+            withSoundPlayer += inSet[j] ? heapSizes[j] : 0;
+        fprintf(file, "%-32s %6d %10s %10.1f%% %15.1f%%%s\n", json->keys[i], bankSet->count, hex_string(total, sizeBuf),
+                100.0 * total / persistentPool, 100.0 * withSoundPlayer / persistentPool,
+                withSoundPlayer > persistentPool ? "  spills into the temporary pool" : "");
+    }
+    fclose(file);
+    free(bankNames);
+    free(heapSizes);
+    free(inSet);
+}
+
+static void print_usage(const char *progname)
+{
+    printf("Usage: %s <samples dir> <sound bank dir>"
+           " <out .ctl file> <out .ctl Shindou header file>"
+           " <out .tbl file> <out .tbl Shindou header file>"
+           " [--cpp <preprocessor>]"
+           " [-D <symbol>]"
+           " [--cache <cache file>]"
+           " [--heap-report <out report> <sequences.json> \"<persistent bank pool> <temporary bank pool>\"]"
+           " | --sequences <out sequence .bin> <out Shindou sequence header .bin> "
+           "<out bank sets .bin> <sound bank dir> <sequences.json> <inputs...>\n", progname);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *cppCommand = NULL;
+    const char *sequencesOutFile = NULL;
+    const char *sequencesHeaderOutFile = NULL;
+    const char *bankSetsOutFile = NULL;
+    const char *soundBankDir = NULL;
+    const char *sequenceJson = NULL;
+    const char *cacheFile = NULL;
+    const char *heapReportFile = NULL;
+    const char *heapReportSeqJson = NULL;
+    const char *heapReportPools = NULL;
+    int needHelp = 0;
+    int printSamples = 0;
+    char **defines = xmalloc(argc * sizeof(*defines));
+    char **args = xmalloc(argc * sizeof(*args));
+    int numDefines = 0;
+    int numArgs = 0;
+    struct Defines definesSet;
+    uint64_t optionsKey;
+    int i, j;
+
+    for (i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+        int needed = 0;
+
+        if (strcmp(a, "--cpp") == 0 || strcmp(a, "-D") == 0 || strcmp(a, "--endian") == 0 ||
+            strcmp(a, "--bitwidth") == 0 || strcmp(a, "--cache") == 0)
+            needed = 1;
+        else if (strcmp(a, "--heap-report") == 0)
+            needed = 3;
+        else if (strcmp(a, "--sequences") == 0)
+            needed = 5;
+        if (i + needed >= argc)
+            fatal_error("%s needs %d argument%s", a, needed, needed == 1 ? "" : "s");
+
+        if (strcmp(a, "--help") == 0 || strcmp(a, "-h") == 0)
+            needHelp = 1;
+        else if (strcmp(a, "--cpp") == 0)
+            cppCommand = argv[i + 1];
+        else if (strcmp(a, "-D") == 0)
+            defines[numDefines++] = argv[i + 1];
+        else if (strcmp(a, "--endian") == 0)
+        {
+            const char *endian = argv[i + 1];
+            uint16_t probe = 1;
+
+            if (strcmp(endian, "big") == 0)
+                sBigEndian = 1;
+            else if (strcmp(endian, "little") == 0)
+                sBigEndian = 0;
+            else if (strcmp(endian, "native") == 0)
+                sBigEndian = (*(uint8_t *)&probe == 0);
+            else
+                fatal_error("--endian takes argument big, little or native");
+        }
+        else if (strcmp(a, "--bitwidth") == 0)
+        {
+            const char *bitwidth = argv[i + 1];
+
+            if (strcmp(bitwidth, "native") == 0)
+                sWordBytes = sizeof(void *);
+            else if (strcmp(bitwidth, "32") == 0 || strcmp(bitwidth, "64") == 0)
+                sWordBytes = atoi(bitwidth) / 8;
+            else
+                fatal_error("--bitwidth takes argument 32, 64 or native");
+        }
+        else if (strncmp(a, "-D", 2) == 0)
+            defines[numDefines++] = (char *)a + 2;
+        else if (strcmp(a, "--stack-trace") == 0)
+            ; // only meaningful for the Python version
+        else if (strcmp(a, "--dump-individual-bins") == 0)
+            sDumpIndividualBins = 1;
+        else if (strcmp(a, "--print-samples") == 0)
+            printSamples = 1;
+        else if (strcmp(a, "--cache") == 0)
+            cacheFile = argv[i + 1];
+        else if (strcmp(a, "--heap-report") == 0)
+        {
+            heapReportFile = argv[i + 1];
+            heapReportSeqJson = argv[i + 2];
+            heapReportPools = argv[i + 3];
+        }
+        else if (strcmp(a, "--sequences") == 0)
+        {
+            sequencesOutFile = argv[i + 1];
+            sequencesHeaderOutFile = argv[i + 2];
+            bankSetsOutFile = argv[i + 3];
+            soundBankDir = argv[i + 4];
+            sequenceJson = argv[i + 5];
+        }
+        else if (a[0] == '-')
+        {
+            printf("Unrecognized option %s\n", a);
+            return 1;
+        }
+        else
+            args[numArgs++] = argv[i];
+        i += needed;
+    }
+
+    definesSet.names = xmalloc((numDefines + 1) * sizeof(*definesSet.names));
+    definesSet.count = numDefines;
+    for (i = 0; i < numDefines; i++)
+        definesSet.names[i] = xstrndup(defines[i], strcspn(defines[i], "="));
+    sIsShindou = has_define_str(&definesSet, "VERSION_SH");
+
+    if (sequencesOutFile != NULL && !needHelp)
+    {
+        write_sequences(args, numArgs, sequencesOutFile, sequencesHeaderOutFile, bankSetsOutFile, soundBankDir,
+                        sequenceJson, &definesSet);
+        return 0;
+    }
+
+    if (needHelp || numArgs != 6)
+    {
+        print_usage(argv[0]);
+        return needHelp ? 0 : 1;
+    }
+
+    {
+        const char *sampleBankDir = args[0];
+        const char *soundBankDir = args[1];
+        struct SampleBank *sampleBanks = NULL;
+        struct Bank *banks = NULL;
+        int numSampleBanks = 0;
+        int numBanks = 0;
+        int numNames;
+        char **names;
+        struct Cache cache;
+        struct SeqFile tbl = {0};
+        struct SeqFile ctl = {0};
+        int *entryList;
+        int cacheDirty;
+
+        // Everything but the sample data depends on these
+        optionsKey = hash_u64(HASH_INIT, sBigEndian);
+        optionsKey = hash_u64(optionsKey, sWordBytes);
+        for (i = 0; i < definesSet.count; i++)
+        {
+            for (j = 0; j < i && strcmp(definesSet.names[i], definesSet.names[j]) != 0; j++)
+                ;
+            if (j == i)
+                optionsKey ^= hash_string(HASH_INIT, definesSet.names[i]);
+        }
+        optionsKey = hash_string(optionsKey, cppCommand ? cppCommand : "");
+        read_cache(cacheFile, optionsKey, &cache);
+
+        names = list_dir(sampleBankDir, &numNames);
+        sampleBanks = xmalloc((numNames + 1) * sizeof(*sampleBanks));
+        for (i = 0; i < numNames; i++)
+        {
+            struct SampleBank *sampleBank = &sampleBanks[numSampleBanks];
+            const struct SampleBank *cached;
+            int numFiles, numAifcs = 0;
+            char **files;
+
+            memset(sampleBank, 0, sizeof(*sampleBank));
+            sampleBank->dir = path_join(sampleBankDir, names[i]);
+            if (!is_dir(sampleBank->dir))
+                continue;
+            sampleBank->name = names[i];
+            sampleBank->signature = HASH_INIT;
+            files = list_dir(sampleBank->dir, &numFiles);
+            for (j = 0; j < numFiles; j++)
+            {
+                if (str_ends_with(files[j], ".aifc"))
+                {
+                    char *path = path_join(sampleBank->dir, files[j]);
+
+                    sampleBank->signature = file_signature(sampleBank->signature, path);
+                    free(path);
+                    numAifcs++;
+                }
+            }
+            if (numAifcs == 0)
+                continue;
+
+            cached = find_cached_sample_bank(&cache, sampleBank->name, sampleBank->signature);
+            if (cached != NULL)
+            {
+                sampleBank->count = cached->count;
+                sampleBank->entries = xmalloc(cached->count * sizeof(*sampleBank->entries));
+                memcpy(sampleBank->entries, cached->entries, cached->count * sizeof(*sampleBank->entries));
+                for (j = 0; j < sampleBank->count; j++)
+                {
+                    char *filename = xmalloc(strlen(sampleBank->entries[j].name) + 6);
+
+                    sprintf(filename, "%s.aifc", sampleBank->entries[j].name);
+                    sampleBank->entries[j].fname = path_join(sampleBank->dir, filename);
+                    free(filename);
+                }
+            }
+            else
+            {
+                load_sample_bank(sampleBank, files, numFiles);
+            }
+            sampleBank->index = numSampleBanks++;
+        }
+
+        names = list_dir(soundBankDir, &numNames);
+        banks = xmalloc((numNames + 1) * sizeof(*banks));
+        for (i = 0; i < numNames; i++)
+        {
+            struct Bank *bank;
+            struct Json *sampleBankName;
+            char *fname;
+
+            if (!str_ends_with(names[i], ".json"))
+                continue;
+            fname = path_join(soundBankDir, names[i]);
+            snprintf(sErrorContext, sizeof(sErrorContext), "failed to parse bank %s: ", fname);
+
+            bank = &banks[numBanks++];
+            memset(bank, 0, sizeof(*bank));
+            bank->name = xstrndup(names[i], strlen(names[i]) - 5);
+            bank->text = read_bank_text(fname, cppCommand, defines, numDefines);
+            bank->json = json_parse(bank->text);
+            bank->json = apply_ifs(bank->json, &definesSet);
+            validate_bank_toplevel(bank->json);
+            apply_version_diffs(bank->json, &definesSet);
+            normalize_sound_json(bank->json);
+
+            sampleBankName = json_get(bank->json, "sample_bank");
+            for (j = 0; j < numSampleBanks && strcmp(sampleBanks[j].name, sampleBankName->string) != 0; j++)
+                ;
+            validate(j < numSampleBanks, NULL, "sample bank %s not found", sampleBankName->string);
+            bank->sampleBank = &sampleBanks[j];
+
+            validate_bank(bank->json, bank->sampleBank);
+            mark_sample_bank_uses(bank);
+            free(fname);
+        }
+
+        // Drop unused sample banks, and order the rest by the first bank using them
+        for (i = 0, j = 0; i < numSampleBanks; i++)
+        {
+            if (sampleBanks[i].numUses > 0)
+                sampleBanks[j++] = sampleBanks[i];
+        }
+        numSampleBanks = j;
+        qsort(sampleBanks, numSampleBanks, sizeof(*sampleBanks), sample_bank_cmp);
+        for (i = 0; i < numSampleBanks; i++)
+        {
+            sampleBanks[i].index = i;
+            for (j = 0; j < sampleBanks[i].numUses; j++)
+                sampleBanks[i].uses[j]->sampleBank = &sampleBanks[i];
+        }
+
+        // Only write the cache back if something wasn't in it
+        cacheDirty = (numSampleBanks != cache.numSampleBanks || numBanks != cache.numBanks);
+        garbage_init(&tbl.ser);
+        for (i = 0; i < numSampleBanks; i++)
+        {
+            struct SampleBank *sampleBank = &sampleBanks[i];
+
+            if (!layout_sample_bank(sampleBank, &cache))
+                cacheDirty = 1;
+            seqfile_begin_entry(&tbl);
+            garbage_reset_pos(&tbl.ser);
+            buf_add(&tbl.ser.buf, sampleBank->blob, sampleBank->blobSize);
+            if (sIsShindou && sampleBank->index != 4 && sampleBank->index != 10)
+                buf_align(&tbl.ser.buf, 16);
+            else
+                garbage_align(&tbl.ser, 16);
+            seqfile_end_entry(&tbl);
+        }
+        entryList = xmalloc((numBanks + 1) * sizeof(*entryList));
+        for (i = 0; i < numBanks; i++)
+            entryList[i] = banks[i].sampleBank->index;
+        write_seqfile(&tbl, args[4], args[5], entryList, numBanks, TYPE_TBL, 1);
+
+        garbage_init(&ctl.ser);
+        for (i = 0; i < numBanks; i++)
+        {
+            struct Bank *bank = &banks[i];
+
+            bank->key = hash_string(HASH_INIT, bank->text);
+            bank->key = hash_u64(bank->key, bank->sampleBank->layoutHash);
+            bank->key = hash_u64(bank->key, bank->sampleBank->numUses > 1);
+            for (j = 0; j < cache.numBanks; j++)
+            {
+                if (strcmp(cache.bankNames[j], bank->name) == 0 && cache.bankKeys[j] == bank->key)
+                    break;
+            }
+            if (j < cache.numBanks)
+            {
+                bank->ctl = cache.bankCtls[j];
+                memcpy(bank->meta, cache.bankMetas[j], 4);
+            }
+            else
+            {
+                serialize_ctl(bank);
+                cacheDirty = 1;
+            }
+
+            seqfile_begin_entry(&ctl);
+            buf_add(&ctl.ser.buf, bank->ctl.data, bank->ctl.size);
+            memcpy(ctl.meta[ctl.count], bank->meta, 4);
+            seqfile_end_entry(&ctl);
+            entryList[i] = i;
+        }
+
+        if (sDumpIndividualBins)
+        {
+            // Debug logic, may simplify diffing
+            mkdir("ctl", 0777);
+            for (i = 0; i < numBanks; i++)
+            {
+                char *filename = xmalloc(strlen(banks[i].name) + 9);
+
+                sprintf(filename, "ctl/%s.bin", banks[i].name);
+                write_whole_file(filename, banks[i].ctl.data, banks[i].ctl.size);
+                free(filename);
+            }
+            printf("wrote to ctl/\n");
+        }
+
+        write_seqfile(&ctl, args[2], args[3], entryList, numBanks, TYPE_CTL, 1);
+
+        if (printSamples)
+        {
+            for (i = 0; i < numSampleBanks; i++)
+            {
+                for (j = 0; j < sampleBanks[i].count; j++)
+                {
+                    if (sampleBanks[i].entries[j].used)
+                        printf("%s\n", sampleBanks[i].entries[j].fname);
+                }
+            }
+        }
+
+        if (cacheFile != NULL && cacheDirty)
+            write_cache(cacheFile, optionsKey, sampleBanks, numSampleBanks, banks, numBanks);
+
+        if (heapReportFile != NULL)
+            write_heap_report(heapReportFile, heapReportSeqJson, heapReportPools, banks, numBanks, &ctl, &tbl, &definesSet);
+    }
+
+    return 0;
+}
@@ -0,0 +1,654 @@
+#!/usr/bin/env python3
+"""
+Bakes the static surfaces of every level area into blobs that
+load_area_terrain() (src/engine/surface_load.c) can DMA in and relocate,
+instead of reading the collision data and sorting each surface into the
+partition on every area load.
+
+Every array passed to TERRAIN() in a level script is baked, by running the
+same steps as the game: normals and origin offsets are computed with single
+precision rounding, and the partition lists are built in the same order, in
+the partition grid that alloc_surface_pools() picks from the bounds of all of
+the script's areas. Blobs are keyed by a hash of the vertex and surface
+commands of the collision data and of the grid, so stale or unknown data is
+simply loaded the normal way. Surface rooms are not baked, they are applied
+when the blob is loaded.
+
+All values are big endian:
+
+    BakedTerrainHeader: magic 'BKTR', version, area count, sizeof(struct Surface),
+                        flags (ALL_SURFACES_HAVE_FORCE,
+                        ENABLE_VANILLA_LEVEL_SPECIFIC_CHECKS), padding.
+    BakedTerrainEntry:  key, blob offset from the file start, surface count,
+                        node count, partition head count, dropped triangle count.
+                        Entries are sorted by key.
+    Blob:               surfaces, surface nodes, partition heads (cell index,
+                        partition, node offset; cells are numbered along X
+                        first) and the indices of the triangles
+                        that were dropped as degenerate, for the rooms.
+                        Pointers are stored as offsets from the blob start.
+
+Usage:
+    bake_terrain.py --cpp "<cpp command>" [-MF <depfile>] <output.bin> <levels dir>
+"""
+
+import ast
+import bisect
+import math
+import os
+import re
+import shlex
+import struct
+import subprocess
+import sys
+import tempfile
+
+MAGIC = 0x424B5452 # 'BKTR'
+VERSION = 2
+HEADER = struct.Struct(">IHHHBBI") # padded to 16 bytes, so the entries stay 8 byte aligned when DMAed
+ENTRY = struct.Struct(">IIIIII")
+NODE = struct.Struct(">II")
+HEAD = struct.Struct(">HHI")
+
+FLAG_ALL_SURFACES_HAVE_FORCE = 1 << 0
+FLAG_VANILLA_CHECKS = 1 << 1
+
+FNV_OFFSET_BASIS = 0x811C9DC5
+FNV_PRIME = 0x01000193
+
+# enum TerrainLoadCmd in include/surface_terrains.h
+TERRAIN_LOAD_VERTICES = 0x40
+TERRAIN_LOAD_CONTINUE = 0x41
+TERRAIN_LOAD_END = 0x42
+TERRAIN_LOAD_OBJECTS = 0x43
+TERRAIN_LOAD_ENVIRONMENT = 0x44
+
+SPATIAL_PARTITION_FLOORS = 0
+SPATIAL_PARTITION_CEILS = 1
+SPATIAL_PARTITION_WALLS = 2
+SPATIAL_PARTITION_WATER = 3
+NUM_SPATIAL_PARTITIONS = 4
+
+# Extra words per special object, by SPTYPE_*, matching get_special_objects_size()
+SPECIAL_OBJECT_EXTRA_WORDS = {0: 0, 1: 1, 2: 2, 3: 3, 4: 1}
+
+# Surface types of surface_has_force() and surf_has_no_cam_collision()
+FORCE_SURFACE_TYPES = ["SURFACE_0004", "SURFACE_FLOWING_WATER", "SURFACE_DEEP_MOVING_QUICKSAND",
+                       "SURFACE_SHALLOW_MOVING_QUICKSAND", "SURFACE_MOVING_QUICKSAND",
+                       "SURFACE_HORIZONTAL_WIND", "SURFACE_INSTANT_MOVING_QUICKSAND"]
+NO_CAM_COLLISION_SURFACE_TYPES = ["SURFACE_NO_CAM_COLLISION", "SURFACE_NO_CAM_COLLISION_77",
+                                  "SURFACE_NO_CAM_COL_VERY_SLIPPERY", "SURFACE_SWITCH"]
+
+CONFIG_VALUES = ["NUM_CELLS", "CELL_SIZE", "PARTITION_MIN_CELL_SIZE", "LEVEL_BOUNDARY_MAX", "SURFACE_VERTICAL_BUFFER",
+                 "NORMAL_FLOOR_THRESHOLD", "NEAR_ZERO", "COLLISION_DATA_TYPE", "ROOM_DATA_TYPE",
+                 "SURFACE_NEW_WATER", "SURFACE_NEW_WATER_BOTTOM", "SURFACE_FLAG_NO_CAM_COLLISION"]
+CONFIG_FLAGS = ["BAKED_TERRAIN", "ALL_SURFACES_HAVE_FORCE", "ENABLE_VANILLA_LEVEL_SPECIFIC_CHECKS"]
+
+HEADERS = ["config.h", "surface_terrains.h", "level_misc_macros.h", "special_preset_names.h",
+           "special_presets.h", "engine/math_util.h", "engine/surface_load.h"]
+
+TYPE_SIZES = {"s8": 1, "u8": 1, "s16": 2, "u16": 2, "s32": 4, "u32": 4}
+
+TERRAIN_REF = re.compile(r"\bTERRAIN\s*\(\s*(?:/\*.*?\*/\s*)?(\w+)\s*\)")
+COLLISION_DEF = re.compile(r"\bCollision\s+(\w+)\s*\[\s*\]\s*=\s*\{")
+VALUE_MARKER = "__bake_terrain_value__"
+FLAG_MARKER = "__bake_terrain_flag__"
+ARRAY_MARKER = "__bake_terrain_array__"
+
+class BakeError(Exception):
+    pass
+
+def f32(x):
+    return struct.unpack(">f", struct.pack(">f", x))[0]
+
+def wrap(x, bits):
+    x &= (1 << bits) - 1
+    return x - (1 << bits) if x >> (bits - 1) else x
+
+class Evaluator:
+    """Evaluates the C integer expressions left after preprocessing."""
+
+    SUFFIX = re.compile(r"\b(0[xX][0-9a-fA-F]+|\d+)[uUlL]+\b")
+    CAST = re.compile(r"\(\s*(?:const\s+)?(?:[su](?:8|16|32)|signed|unsigned|char|short|int|long|\s)+\)")
+
+    def __init__(self, names):
+        self.names = names
+        self.cache = {}
+
+    def __call__(self, text):
+        text = text.strip()
+        value = self.cache.get(text)
+        if value is None:
+            expr = self.CAST.sub("", self.SUFFIX.sub(r"\1", text))
+            expr = expr.replace("&&", " and ").replace("||", " or ")
+            expr = re.sub(r"!(?!=)", " not ", expr)
+            try:
+                value = self.eval(ast.parse(expr, mode="eval").body)
+            except (SyntaxError, KeyError, ValueError) as e:
+                raise BakeError("cannot evaluate '%s'" % text) from e
+            self.cache[text] = value
+        return value
+
+    def eval(self, node):
+        if isinstance(node, ast.Constant) and isinstance(node.value, int):
+            return node.value
+        if isinstance(node, ast.Name):
+            value = self.names[node.id]
+            if isinstance(value, str):
+                value = self.names[node.id] = self(value)
+            return value
+        if isinstance(node, ast.UnaryOp):
+            value = self.eval(node.operand)
+            if isinstance(node.op, ast.USub):
+                return -value
+            if isinstance(node.op, ast.UAdd):
+                return value
+            if isinstance(node.op, ast.Invert):
+                return ~value
+            if isinstance(node.op, ast.Not):
+                return int(not value)
+        if isinstance(node, ast.BoolOp):
+            values = [self.eval(v) for v in node.values]
+            return int(all(values) if isinstance(node.op, ast.And) else any(values))
+        if isinstance(node, ast.BinOp):
+            a = self.eval(node.left)
+            b = self.eval(node.right)
+            op = node.op
+            if isinstance(op, ast.Add):
+                return a + b
+            if isinstance(op, ast.Sub):
+                return a - b
+            if isinstance(op, ast.Mult):
+                return a * b
+            if isinstance(op, ast.Div):
+                return int(a / b) if abs(a) < (1 << 52) else (abs(a) // abs(b)) * (1 if (a < 0) == (b < 0) else -1)
+            if isinstance(op, ast.Mod):
+                return a - b * int(a / b)
+            if isinstance(op, ast.LShift):
+                return a << b
+            if isinstance(op, ast.RShift):
+                return a >> b
+            if isinstance(op, ast.BitOr):
+                return a | b
+            if isinstance(op, ast.BitAnd):
+                return a & b
+            if isinstance(op, ast.BitXor):
+                return a ^ b
+        raise ValueError(ast.dump(node))
+
+def split_top_level(text, sep=","):
+    parts = []
+    depth = 0
+    start = 0
+    for i, c in enumerate(text):
+        if c in "([":
+            depth += 1
+        elif c in ")]":
+            depth -= 1
+        elif c == sep and depth == 0:
+            parts.append(text[start:i])
+            start = i + 1
+    parts.append(text[start:])
+    return [p for p in (p.strip() for p in parts) if p]
+
+def find_array_body(text, start):
+    """Returns the text between the brace at start and its closing brace."""
+    depth = 0
+    for i in range(start, len(text)):
+        if text[i] == "{":
+            depth += 1
+        elif text[i] == "}":
+            depth -= 1
+            if depth == 0:
+                return text[start + 1:i]
+    raise BakeError("unterminated array")
+
+def scan_levels(levels_dir):
+    """Finds the arrays used by TERRAIN() in each script and the files that define them."""
+    names = set()
+    scripts = {}
+    definitions = {}
+    for root, dirs, files in os.walk(levels_dir):
+        dirs.sort()
+        for name in sorted(files):
+            if not name.endswith(".c"):
+                continue
+            path = os.path.join(root, name)
+            with open(path, encoding="utf-8", errors="replace") as f:
+                text = f.read()
+            if "TERRAIN" in text:
+                refs = TERRAIN_REF.findall(text)
+                if refs:
+                    names.update(refs)
+                    scripts[path] = sorted(set(refs))
+            if "Collision" in text:
+                for match in COLLISION_DEF.finditer(text):
+                    definitions.setdefault(match.group(1), (path, text, match.end() - 1))
+    return names, scripts, definitions
+
+def preprocess(cpp, snippet, depfile):
+    args = shlex.split(cpp) + ["-"]
+    if depfile:
+        args += ["-MD", "-MF", depfile]
+    result = subprocess.run(args, input=snippet.encode("utf-8"), stdout=subprocess.PIPE)
+    if result.returncode != 0:
+        raise BakeError("preprocessing failed")
+    return result.stdout.decode("utf-8", errors="replace")
+
+def read_enums(text, names):
+    """Records every enumerator as an expression, evaluated only if used."""
+    for body in re.findall(r"\benum\b\s*\w*\s*\{(.*?)\}", text, re.S):
+        previous = None
+        for item in split_top_level(body):
+            name, eq, expr = item.partition("=")
+            name = name.strip()
+            if not re.fullmatch(r"\w+", name):
+                break
+            if eq:
+                value = "(%s)" % expr.strip()
+            elif previous is None:
+                value = "0"
+            else:
+                value = "(%s) + 1" % previous
+            names[name] = value
+            previous = name
+
+def read_special_presets(text, evaluate):
+    match = re.search(r"SpecialObjectPresets\s*\[\s*\]\s*=\s*\{(.*?)\}\s*;", text, re.S)
+    if match is None:
+        raise BakeError("SpecialObjectPresets not found")
+    presets = {}
+    for entry in re.findall(r"\{([^{}]*)\}", match.group(1)):
+        fields = split_top_level(entry)
+        presetID = evaluate(fields[0]) & 0xFF
+        # get_special_objects_size() uses the first match
+        presets.setdefault(presetID, evaluate(fields[1]))
+    return presets
+
+class Config:
+    def __init__(self, values, flags, evaluate):
+        self.enabled = "BAKED_TERRAIN" in flags
+        self.allSurfacesHaveForce = "ALL_SURFACES_HAVE_FORCE" in flags
+        self.vanillaChecks = "ENABLE_VANILLA_LEVEL_SPECIFIC_CHECKS" in flags
+        self.numCells = evaluate(values["NUM_CELLS"])
+        self.cellSize = evaluate(values["CELL_SIZE"])
+        self.minCellSize = evaluate(values["PARTITION_MIN_CELL_SIZE"])
+        self.boundary = evaluate(values["LEVEL_BOUNDARY_MAX"])
+        self.verticalBuffer = evaluate(values["SURFACE_VERTICAL_BUFFER"])
+        self.floorThreshold = f32(float(values["NORMAL_FLOOR_THRESHOLD"].rstrip("fF")))
+        self.nearZero = f32(float(values["NEAR_ZERO"].strip("() ").rstrip("fF")))
+        self.waterTypes = {evaluate(values["SURFACE_NEW_WATER"]), evaluate(values["SURFACE_NEW_WATER_BOTTOM"])}
+        self.noCamFlag = evaluate(values["SURFACE_FLAG_NO_CAM_COLLISION"])
+        self.forceTypes = {evaluate(values[t]) for t in FORCE_SURFACE_TYPES}
+        self.noCamTypes = {evaluate(values[t]) for t in NO_CAM_COLLISION_SURFACE_TYPES}
+        self.dataType = values["COLLISION_DATA_TYPE"]
+        self.roomType = values["ROOM_DATA_TYPE"]
+        if self.dataType not in ("s16", "s32") or TYPE_SIZES.get(self.roomType) != 1:
+            raise BakeError("unsupported collision data types %s/%s" % (self.dataType, self.roomType))
+        self.dataBits = TYPE_SIZES[self.dataType] * 8
+        self.surfaceLayout()
+
+    def surfaceLayout(self):
+        """Offsets of the fields of struct Surface (include/types.h)."""
+        size = self.dataBits // 8
+        fields = [("type", size, size), ("force", size, size), ("flags", 1, 1), ("room", 1, 1),
+                  ("lowerY", 2, 2), ("upperY", 2, 2), ("vertex1", size * 3, size),
+                  ("vertex2", size * 3, size), ("vertex3", size * 3, size), ("normal", 12, 4),
+                  ("originOffset", 4, 4), ("object", 4, 4)]
+        offset = 0
+        self.offsets = {}
+        for name, fieldSize, align in fields:
+            offset = (offset + align - 1) & ~(align - 1)
+            self.offsets[name] = offset
+            offset += fieldSize
+        self.surfaceSize = (offset + 3) & ~3
+        self.dataFormat = ">h" if size == 2 else ">i"
+
+    @property
+    def flags(self):
+        return ((FLAG_ALL_SURFACES_HAVE_FORCE if self.allSurfacesHaveForce else 0) |
+                (FLAG_VANILLA_CHECKS if self.vanillaChecks else 0))
+
+class Grid:
+    """The partition grid of a level, matching init_partition_grid()."""
+
+    def __init__(self, config, terrains):
+        boundary = config.boundary
+        minX = minZ = boundary - 1
+        maxX = maxZ = -boundary
+        for terrain in terrains:
+            if terrain.bounds is not None:
+                minX = min(minX, terrain.bounds[0])
+                minZ = min(minZ, terrain.bounds[1])
+                maxX = max(maxX, terrain.bounds[2])
+                maxZ = max(maxZ, terrain.bounds[3])
+        minX = min(max(minX, -boundary), boundary - 1)
+        maxX = min(max(maxX, minX), boundary - 1)
+        minZ = min(max(minZ, -boundary), boundary - 1)
+        maxZ = min(max(maxZ, minZ), boundary - 1)
+
+        shift = 0
+        while (1 << shift) < min(config.minCellSize, config.cellSize):
+            shift += 1
+        while True:
+            self.shift = shift
+            self.originX = (minX >> shift) << shift
+            self.originZ = (minZ >> shift) << shift
+            self.numCellsX = ((maxX - self.originX) >> shift) + 1
+            self.numCellsZ = ((maxZ - self.originZ) >> shift) + 1
+            if (1 << shift) >= config.cellSize or self.numCellsX * self.numCellsZ <= config.numCells * config.numCells:
+                break
+            shift += 1
+
+    @property
+    def words(self):
+        """The grid as get_area_terrain_key() hashes it."""
+        return [self.originX, self.originZ, self.numCellsX, self.numCellsZ, self.shift]
+
+    def cell_x(self, x):
+        return min(max((x - self.originX) >> self.shift, 0), self.numCellsX - 1)
+
+    def cell_z(self, z):
+        return min(max((z - self.originZ) >> self.shift, 0), self.numCellsZ - 1)
+
+class Surface:
+    __slots__ = ("type", "force", "flags", "lowerY", "upperY", "vertices", "normal", "originOffset")
+
+def read_surface(config, vertexData, indices):
+    """Matches read_surface_data(), or returns None for a dropped triangle."""
+    bits = config.dataBits
+    v = []
+    for index in indices:
+        # the offsets are TerrainData, so index * 3 wraps like it does in the game
+        offset = wrap(index * 3, bits)
+        if offset < 0 or offset + 3 > len(vertexData):
+            raise BakeError("vertex index %d out of range" % index)
+        v.append(vertexData[offset:offset + 3])
+    a, b, c = v
+
+    # find_vector_perpendicular_to_plane() works on integers
+    n = [f32(float(wrap(wrap((b[1] - a[1]) * (c[2] - b[2]), 32) - wrap((c[1] - b[1]) * (b[2] - a[2]), 32), 32))),
+         f32(float(wrap(wrap((b[2] - a[2]) * (c[0] - b[0]), 32) - wrap((c[2] - b[2]) * (b[0] - a[0]), 32), 32))),
+         f32(float(wrap(wrap((b[0] - a[0]) * (c[1] - b[1]), 32) - wrap((c[0] - b[0]) * (b[1] - a[1]), 32), 32)))]
+
+    mag = f32(f32(f32(n[0] * n[0]) + f32(n[1] * n[1])) + f32(n[2] * n[2]))
+    if config.vanillaChecks and mag < config.nearZero:
+        return None
+    if mag == 0.0:
+        # the game would divide by zero here, leave it to the runtime loader
+        raise BakeError("degenerate triangle")
+    mag = f32(1.0 / f32(math.sqrt(mag)))
+    n = [f32(x * mag) for x in n]
+
+    surface = Surface()
+    surface.vertices = v
+    surface.normal = n
+    surface.originOffset = -f32(f32(f32(n[0] * a[0]) + f32(n[1] * a[1])) + f32(n[2] * a[2]))
+    surface.lowerY = wrap(min(a[1], b[1], c[1]) - config.verticalBuffer, 16)
+    surface.upperY = wrap(max(a[1], b[1], c[1]) + config.verticalBuffer, 16)
+    return surface
+
+class Terrain:
+    """The static surfaces of one collision array, loaded like load_area_terrain()."""
+
+    def __init__(self, config, presets, data):
+        self.config = config
+        self.surfaces = []
+        self.dropped = []
+        self.bounds = None
+        hashWords = []
+        vertexData = None
+        triangleIndex = 0
+        i = 0
+
+        while True:
+            cmd = data[i]
+            start = i
+            i += 1
+            if cmd < TERRAIN_LOAD_VERTICES or cmd >= 0x65:
+                numSurfaces = data[i]
+                i += 1
+                hasForce = config.allSurfacesHaveForce or cmd in config.forceTypes
+                words = 4 if config.allSurfacesHaveForce else 3 + int(hasForce)
+                flags = config.noCamFlag if cmd in config.noCamTypes else 0
+                if vertexData is None:
+                    raise BakeError("surfaces before vertices")
+                for _ in range(numSurfaces):
+                    surface = read_surface(config, vertexData, data[i:i + 3])
+                    if surface is None:
+                        self.dropped.append(triangleIndex)
+                    else:
+                        surface.type = cmd
+                        surface.flags = flags
+                        surface.force = data[i + 3] if hasForce else 0
+                        self.surfaces.append(surface)
+                    triangleIndex += 1
+                    i += words
+                hashWords += data[start:i]
+            elif cmd == TERRAIN_LOAD_VERTICES:
+                numVertices = data[i]
+                vertexData = data[i + 1:i + 1 + 3 * numVertices]
+                if numVertices > 0:
+                    xs = vertexData[0::3]
+                    zs = vertexData[2::3]
+                    bounds = (min(xs), min(zs), max(xs), max(zs))
+                    if self.bounds is not None:
+                        bounds = (min(bounds[0], self.bounds[0]), min(bounds[1], self.bounds[1]),
+                                  max(bounds[2], self.bounds[2]), max(bounds[3], self.bounds[3]))
+                    self.bounds = bounds
+                i += 1 + 3 * numVertices
+                hashWords += data[start:i]
+            elif cmd == TERRAIN_LOAD_OBJECTS:
+                numObjects = data[i]
+                i += 1
+                for _ in range(numObjects):
+                    presetID = data[i] & 0xFF
+                    if presetID not in presets:
+                        raise BakeError("unknown special object preset 0x%02X" % presetID)
+                    i += 4 + SPECIAL_OBJECT_EXTRA_WORDS.get(presets[presetID], 0)
+            elif cmd == TERRAIN_LOAD_ENVIRONMENT:
+                i += 1 + 6 * data[i]
+            elif cmd == TERRAIN_LOAD_END:
+                break
+
+        self.hashWords = hashWords
+
+    def key(self, grid):
+        key = FNV_OFFSET_BASIS
+        mask = (1 << 32) - 1
+        for word in self.hashWords + grid.words:
+            key = ((key ^ (word & mask)) * FNV_PRIME) & mask
+        return key
+
+    def partition(self, grid):
+        """Matches add_surface(), keeping each list's priorities for binary searches."""
+        config = self.config
+        lists = {}
+        for index, surface in enumerate(self.surfaces):
+            if surface.type in config.waterTypes:
+                listIndex, sortDir = SPATIAL_PARTITION_WATER, 1
+            elif surface.normal[1] > config.floorThreshold:
+                listIndex, sortDir = SPATIAL_PARTITION_FLOORS, 1
+            elif surface.normal[1] < -config.floorThreshold:
+                listIndex, sortDir = SPATIAL_PARTITION_CEILS, -1
+            else:
+                listIndex, sortDir = SPATIAL_PARTITION_WALLS, 0
+            priority = -surface.upperY * sortDir
+
+            xs = [v[0] for v in surface.vertices]
+            zs = [v[2] for v in surface.vertices]
+            for cellZ in range(grid.cell_z(min(zs)), grid.cell_z(max(zs)) + 1):
+                for cellX in range(grid.cell_x(min(xs)), grid.cell_x(max(xs)) + 1):
+                    keys, indices = lists.setdefault((cellZ * grid.numCellsX + cellX, listIndex), ([], []))
+                    # after every surface with the same or a higher priority
+                    pos = bisect.bisect_right(keys, priority)
+                    keys.insert(pos, priority)
+                    indices.insert(pos, index)
+        return [(cell, lists[cell][1]) for cell in sorted(lists)]
+
+    def serialize(self, grid):
+        config = self.config
+        offsets = config.offsets
+        nodesStart = len(self.surfaces) * config.surfaceSize
+        blob = bytearray(nodesStart)
+        pack_data = struct.Struct(config.dataFormat).pack_into
+
+        for index, surface in enumerate(self.surfaces):
+            base = index * config.surfaceSize
+            pack_data(blob, base + offsets["type"], surface.type)
+            pack_data(blob, base + offsets["force"], surface.force)
+            struct.pack_into(">b", blob, base + offsets["flags"], surface.flags)
+            struct.pack_into(">hh", blob, base + offsets["lowerY"], surface.lowerY, surface.upperY)
+            for n, name in enumerate(("vertex1", "vertex2", "vertex3")):
+                for axis in range(3):
+                    pack_data(blob, base + offsets[name] + axis * config.dataBits // 8, surface.vertices[n][axis])
+            struct.pack_into(">ffff", blob, base + offsets["normal"], *surface.normal, surface.originOffset)
+
+        # Each list's nodes are contiguous, in list order
+        heads = []
+        numNodes = 0
+        for (cell, listIndex), indices in self.partition(grid):
+            heads.append(HEAD.pack(cell, listIndex, nodesStart + numNodes * NODE.size))
+            for n, index in enumerate(indices):
+                numNodes += 1
+                nextNode = nodesStart + numNodes * NODE.size if n + 1 < len(indices) else 0
+                blob += NODE.pack(nextNode, index * config.surfaceSize)
+
+        blob += b"".join(heads)
+        blob += b"".join(struct.pack(">H", t) for t in self.dropped)
+        return bytes(blob), (len(self.surfaces), numNodes, len(heads), len(self.dropped))
+
+def build_snippet(names, definitions):
+    lines = ['#include "%s"' % h for h in HEADERS]
+    lines.append(" ".join([VALUE_MARKER] + CONFIG_VALUES + FORCE_SURFACE_TYPES + NO_CAM_COLLISION_SURFACE_TYPES))
+    for flag in CONFIG_FLAGS:
+        lines += ["#ifdef " + flag, '%s "%s"' % (FLAG_MARKER, flag), "#endif"]
+    for name in sorted(names):
+        path, text, brace = definitions[name]
+        lines.append("%s %s {%s};" % (ARRAY_MARKER, name, find_array_body(text, brace)))
+    return "\n".join(lines) + "\n"
+
+def group_values(text):
+    """Splits the preprocessed config values on whitespace outside of parentheses."""
+    values = []
+    depth = 0
+    current = ""
+    for c in text:
+        if c == "(":
+            depth += 1
+        elif c == ")":
+            depth -= 1
+        if c.isspace() and depth == 0:
+            if current:
+                values.append(current)
+            current = ""
+        else:
+            current += c
+    if current:
+        values.append(current)
+    return values
+
+def main():
+    args = sys.argv[1:]
+    cpp = None
+    depfile = None
+    positional = []
+    while args:
+        arg = args.pop(0)
+        if arg == "--cpp" and args:
+            cpp = args.pop(0)
+        elif arg == "-MF" and args:
+            depfile = args.pop(0)
+        else:
+            positional.append(arg)
+    if cpp is None or len(positional) != 2:
+        sys.exit(__doc__)
+    outPath, levelsDir = positional
+
+    try:
+        names, scripts, definitions = scan_levels(levelsDir)
+        missing = sorted(n for n in names if n not in definitions)
+        if missing:
+            raise BakeError("collision data not found: " + ", ".join(missing))
+
+        cppDeps = tempfile.NamedTemporaryFile(suffix=".d", delete=False).name if depfile else None
+        try:
+            text = preprocess(cpp, build_snippet(names, definitions), cppDeps)
+            headers = []
+            if cppDeps:
+                with open(cppDeps) as f:
+                    headers = [h for h in f.read().replace("\\\n", " ").split(":", 1)[1].split() if h != "-"]
+        finally:
+            if cppDeps:
+                os.remove(cppDeps)
+
+        values = {}
+        flags = set()
+        arrays = {}
+        for line in text.split("\n"):
+            if line.startswith(VALUE_MARKER):
+                for name, value in zip(CONFIG_VALUES + FORCE_SURFACE_TYPES + NO_CAM_COLLISION_SURFACE_TYPES,
+                                       group_values(line[len(VALUE_MARKER):])):
+                    values[name] = value
+            elif line.startswith(FLAG_MARKER):
+                flags.add(line.split()[1].strip('"'))
+        for match in re.finditer(ARRAY_MARKER + r"\s+(\w+)\s*\{(.*?)\}\s*;", text, re.S):
+            arrays[match.group(1)] = match.group(2)
+
+        enums = {}
+        read_enums(text, enums)
+        evaluate = Evaluator(enums)
+        config = Config(values, flags, evaluate)
+        presets = read_special_presets(text, evaluate)
+
+        entries = []
+        if config.enabled:
+            terrains = {}
+            for name in sorted(arrays):
+                data = [wrap(evaluate(v), config.dataBits) for v in split_top_level(arrays[name])]
+                try:
+                    terrains[name] = Terrain(config, presets, data)
+                except (BakeError, IndexError) as e:
+                    print("%s: not baking %s: %s" % (sys.argv[0], name, e), file=sys.stderr)
+
+            # Each level's areas share its grid, so an array is baked once per grid it's used in.
+            keys = set()
+            for script in sorted(scripts):
+                # Unbaked arrays are still part of the level's bounds, so the grid can't be known without them.
+                if any(name not in terrains for name in scripts[script]):
+                    continue
+                grid = Grid(config, [terrains[name] for name in scripts[script]])
+                for name in scripts[script]:
+                    key = terrains[name].key(grid)
+                    if key in keys:
+                        continue
+                    keys.add(key)
+                    blob, counts = terrains[name].serialize(grid)
+                    entries.append((key, blob, counts))
+    except BakeError as e:
+        sys.exit("%s: %s" % (sys.argv[0], e))
+
+    # The blobs are 16 byte aligned, since they are DMAed straight into the surface pool
+    entries.sort(key=lambda e: e[0])
+    table = bytearray(HEADER.pack(MAGIC, VERSION, len(entries), config.surfaceSize, config.flags, 0, 0))
+    blobs = bytearray()
+    blobsStart = HEADER.size + ENTRY.size * len(entries)
+    for key, blob, counts in entries:
+        blobs += bytes(-(blobsStart + len(blobs)) & 15)
+        table += ENTRY.pack(key, blobsStart + len(blobs), *counts)
+        blobs += blob
+    out = table + blobs
+    out += bytes(-len(out) & 15)
+
+    with open(outPath, "wb") as f:
+        f.write(out)
+
+    if depfile:
+        deps = sorted(set(scripts) | {definitions[n][0] for n in names}) + headers
+        with open(depfile, "w") as f:
+            f.write("%s: %s\n" % (outPath, " \\\n  ".join(deps)))
+            for dep in deps:
+                f.write("%s:\n" % dep)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""
+Translates the infinite loops of the behavior scripts in data/behavior_data.c
+into native C functions.
+
+Almost every object spends its life inside a BEGIN_LOOP/END_LOOP block, which
+cur_obj_update() would otherwise interpret command by command every frame.
+Each loop whose body only contains straight-line commands (field writes,
+CALL_NATIVE, hitbox/render changes, ...) is turned into a function that runs
+the body once. CALL targets that end in RETURN and are straight-line themselves
+are inlined. Bodies that DELAY, BREAK, jump or spawn fall back to the
+interpreter, as do scripts that contain preprocessor conditionals.
+
+The output is meant to be included at the end of behavior_data.c, where object
+fields expand to their raw field indices (OBJECT_FIELDS_INDEX_DIRECTLY).
+
+Usage:
+    bhv_compile.py data/behavior_data.c > behavior_native.inc.c
+"""
+
+import re
+import sys
+
+# Size in words of each behavior command macro.
+CMD_SIZES = {
+    "BEGIN": 1, "DELAY": 1, "CALL": 2, "RETURN": 1, "GOTO": 2,
+    "BEGIN_REPEAT": 1, "END_REPEAT": 1, "END_REPEAT_CONTINUE": 1,
+    "BEGIN_LOOP": 1, "END_LOOP": 1, "BREAK": 1, "BREAK_UNUSED": 1,
+    "CALL_NATIVE": 1, "ADD_FLOAT": 1, "SET_FLOAT": 1, "ADD_INT": 1, "SET_INT": 1,
+    "OR_INT": 1, "OR_LONG": 2, "BIT_CLEAR": 1, "SET_INT_RAND_RSHIFT": 2,
+    "SET_RANDOM_FLOAT": 2, "SET_RANDOM_INT": 2, "ADD_RANDOM_FLOAT": 2,
+    "ADD_INT_RAND_RSHIFT": 2, "CMD_NOP_1": 1, "CMD_NOP_2": 1, "SET_MODEL": 1,
+    "SPAWN_CHILD": 3, "DEACTIVATE": 1, "DROP_TO_FLOOR": 1, "SUM_FLOAT": 1,
+    "SUM_INT": 1, "BILLBOARD": 1, "HIDE": 1, "SET_HITBOX": 2, "CMD_NOP_4": 1,
+    "DELAY_VAR": 1, "BEGIN_REPEAT_UNUSED": 1, "LOAD_ANIMATIONS": 2, "ANIMATE": 1,
+    "SPAWN_CHILD_WITH_PARAM": 3, "LOAD_COLLISION_DATA": 2, "SET_HITBOX_WITH_OFFSET": 3,
+    "SPAWN_OBJ": 3, "SET_HOME": 1, "SET_HURTBOX": 2, "SET_INTERACT_TYPE": 2,
+    "SET_OBJ_PHYSICS": 5, "SET_INTERACT_SUBTYPE": 2, "SCALE": 1,
+    "PARENT_BIT_CLEAR": 2, "ANIMATE_TEXTURE": 1, "DISABLE_RENDERING": 1,
+    "SET_INT_UNUSED": 2, "SPAWN_WATER_DROPLET": 1,
+}
+
+S32 = "o->rawData.asS32[{}]"
+F32 = "o->rawData.asF32[{}]"
+
+# Native equivalents of the straight-line commands, matching the bhv_cmd_* handlers in behavior_script.c.
+CMD_NATIVE = {
+    "CALL_NATIVE":         lambda a: f"{a[0]}();",
+    "ADD_FLOAT":           lambda a: f"{F32.format(a[0])} += (f32)(s16)({a[1]});",
+    "SET_FLOAT":           lambda a: f"{F32.format(a[0])} = (f32)(s16)({a[1]});",
+    "ADD_INT":             lambda a: f"{S32.format(a[0])} += (s16)({a[1]});",
+    "SET_INT":             lambda a: f"{S32.format(a[0])} = (s16)({a[1]});",
+    "SET_INT_UNUSED":      lambda a: f"{S32.format(a[0])} = (s16)({a[1]});",
+    "OR_INT":              lambda a: f"{S32.format(a[0])} |= (u16)({a[1]});",
+    "OR_LONG":             lambda a: f"{S32.format(a[0])} |= (s32)(u32)({a[1]});",
+    "BIT_CLEAR":           lambda a: f"{S32.format(a[0])} &= (s32)((u16)({a[1]}) ^ 0xFFFF);",
+    "SET_INT_RAND_RSHIFT": lambda a: f"{S32.format(a[0])} = (random_u16() >> (s16)({a[2]})) + (s16)({a[1]});",
+    "SET_RANDOM_FLOAT":    lambda a: f"{F32.format(a[0])} = ((f32)(s16)({a[2]}) * random_float()) + (f32)(s16)({a[1]});",
+    "SET_RANDOM_INT":      lambda a: f"{S32.format(a[0])} = (s32)((s16)({a[2]}) * random_float()) + (s16)({a[1]});",
+    "ADD_RANDOM_FLOAT":    lambda a: f"{F32.format(a[0])} = {F32.format(a[0])} + (f32)(s16)({a[1]}) + ((f32)(s16)({a[2]}) * random_float());",
+    "ADD_INT_RAND_RSHIFT": lambda a: f"{S32.format(a[0])} = ({S32.format(a[0])} + (s16)({a[1]})) + (random_u16() >> (s16)({a[2]}));",
+    "CMD_NOP_1":           lambda a: None,
+    "CMD_NOP_2":           lambda a: None,
+    "CMD_NOP_4":           lambda a: None,
+    "SUM_FLOAT":           lambda a: f"{F32.format(a[0])} = {F32.format(a[1])} + {F32.format(a[2])};",
+    "SUM_INT":             lambda a: f"{S32.format(a[0])} = {S32.format(a[1])} + {S32.format(a[2])};",
+    "BILLBOARD":           lambda a: "o->header.gfx.node.flags |= GRAPH_RENDER_BILLBOARD;",
+    "HIDE":                lambda a: "cur_obj_hide();",
+    "DISABLE_RENDERING":   lambda a: "o->header.gfx.node.flags &= ~GRAPH_RENDER_ACTIVE;",
+    "SET_HITBOX":          lambda a: f"o->hitboxRadius = (s16)({a[0]}); o->hitboxHeight = (s16)({a[1]});",
+    "SET_HURTBOX":         lambda a: f"o->hurtboxRadius = (s16)({a[0]}); o->hurtboxHeight = (s16)({a[1]});",
+    "SET_HITBOX_WITH_OFFSET": lambda a: f"o->hitboxRadius = (s16)({a[0]}); o->hitboxHeight = (s16)({a[1]}); o->hitboxDownOffset = (s16)({a[2]});",
+    "SET_HOME":            lambda a: f"vec3f_copy(&{F32.format('oHomeX')}, &{F32.format('oPosX')});",
+    "SET_INTERACT_TYPE":   lambda a: f"{S32.format('oInteractType')} = (u32)({a[0]});",
+    "SET_INTERACT_SUBTYPE": lambda a: f"{S32.format('oInteractionSubtype')} = (u32)({a[0]});",
+    "SCALE":               lambda a: f"cur_obj_scale((s16)({a[1]}) / 100.0f);",
+    "PARENT_BIT_CLEAR":    lambda a: f"o->parentObj->rawData.asS32[{a[0]}] &= ~(s32)({a[1]});",
+    "ANIMATE_TEXTURE":     lambda a: f"if ((gGlobalTimer % (s16)({a[1]})) == 0) {S32.format(a[0])} += 1;",
+}
+
+MAX_CALL_DEPTH = 4
+
+def strip_comments(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    return re.sub(r"//[^\n]*", "", text)
+
+def split_top_level(text):
+    """Splits on commas that are not nested in parentheses."""
+    parts = []
+    depth = 0
+    cur = ""
+    for c in text:
+        if c == "(":
+            depth += 1
+        elif c == ")":
+            depth -= 1
+        if c == "," and depth == 0:
+            parts.append(cur.strip())
+            cur = ""
+        else:
+            cur += c
+    if cur.strip():
+        parts.append(cur.strip())
+    return parts
+
+def parse_scripts(text):
+    """Returns the commands of every script and the preprocessor conditionals enclosing it."""
+    scripts = {}
+    conds = {}
+    stack = []
+    lines = text.split("\n")
+    i = 0
+    while i < len(lines):
+        line = lines[i].strip()
+        m = re.match(r"const BehaviorScript (\w+)\[\] = \{", line)
+        if line.startswith("#if"):
+            stack.append([line])
+        elif line.startswith("#el"):
+            stack[-1].append(line)
+        elif line.startswith("#endif"):
+            stack.pop()
+        elif m is not None:
+            name = m.group(1)
+            body = []
+            i += 1
+            while lines[i].strip() != "};":
+                body.append(lines[i])
+                i += 1
+            conds[name] = [list(c) for c in stack]
+            scripts[name] = parse_commands("\n".join(body))
+        i += 1
+    return scripts, conds
+
+def parse_commands(body):
+    if re.search(r"^\s*#", body, re.M):
+        return None
+    cmds = []
+    for item in split_top_level(body):
+        cm = re.match(r"(\w+)\((.*)\)$", item, re.S)
+        if cm is None or cm.group(1) not in CMD_SIZES:
+            return None
+        cmds.append((cm.group(1), split_top_level(cm.group(2))))
+    return cmds
+
+def compile_straight_line(cmds, scripts, depth, out):
+    """Appends the native version of cmds to out. Returns False if any command needs the interpreter."""
+    for op, args in cmds:
+        if op == "CALL":
+            target = scripts.get(args[0])
+            if target is None or depth >= MAX_CALL_DEPTH:
+                return False
+            end = next((i for i, (top, _) in enumerate(target) if top == "RETURN"), None)
+            if end is None:
+                return False
+            out.append(f"    // CALL({args[0]})")
+            if not compile_straight_line(target[:end], scripts, depth + 1, out):
+                return False
+        elif op in CMD_NATIVE:
+            line = CMD_NATIVE[op](args)
+            if line is not None:
+                out.append("    " + line)
+        else:
+            return False
+    return True
+
+def compile_loops(scripts):
+    loops = []
+    for name, cmds in scripts.items():
+        if cmds is None:
+            continue
+        offset = 0
+        for i, (op, _) in enumerate(cmds):
+            offset += CMD_SIZES[op]
+            if op != "BEGIN_LOOP":
+                continue
+            end = next((j for j in range(i + 1, len(cmds)) if cmds[j][0] in ("END_LOOP", "BEGIN_LOOP")), None)
+            if end is None or cmds[end][0] != "END_LOOP":
+                continue
+            body = []
+            if compile_straight_line(cmds[i + 1:end], scripts, 0, body):
+                loops.append((name, offset, body))
+    return loops
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    with open(sys.argv[1], "r", encoding="utf-8") as f:
+        scripts, conds = parse_scripts(strip_comments(f.read()))
+    loops = compile_loops(scripts)
+
+    def print_guarded(name, text):
+        for cond in conds[name]:
+            print("\n".join(cond))
+        print(text)
+        for _ in conds[name]:
+            print("#endif")
+
+    print("// Generated by tools/bhv_compile.py from data/behavior_data.c. Do not edit.")
+    print()
+    print('#include "engine/behavior_script.h"')
+    print('#include "engine/graph_node.h"')
+    print('#include "engine/math_util.h"')
+    print('#include "game/game_init.h"')
+    print()
+    for name, offset, body in loops:
+        print_guarded(name, f"static void bhv_native_{name}_{offset}(void) {{\n" + "\n".join(body) + "\n}")
+        print()
+    print("const struct BhvNativeLoop gBhvNativeLoops[] = {")
+    for name, offset, _ in loops:
+        print_guarded(name, f"    {{ &{name}[{offset}], bhv_native_{name}_{offset} }},")
+    print("};")
+    print()
+    print("const s32 gBhvNativeLoopCount = ARRAY_COUNT(gBhvNativeLoops);")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""
+Builds the record index of an HVQM2 movie, which src/hvqm/getrecord.c uses to
+read records ahead without walking the record headers in ROM.
+
+The index is placed right after the movie, at the first 8 byte aligned offset
+past its file size (see data/capcom.s). All values are big endian:
+
+    HVQMIndexHeader: magic 'HVQI', audio record count, video record count,
+                     offsets of the audio and video entries from the index start,
+                     padding.
+    HVQMIndexEntry:  offset of the record header from the start of the movie,
+                     then the record size including its header in the low 24 bits,
+                     and the record format in the upper 8 bits.
+
+Fails if a record is larger than src/hvqm/hvqm.h allows for its type
+(AUDIO_RECORD_SIZE_MAX, HVQ_DATASIZE_MAX), or doesn't fit its read-ahead
+buffer (AUDIO_READAHEAD_SIZE, HVQ_READAHEAD_SIZE).
+
+Usage:
+    hvqm_index.py <movie.hvqm> <index.bin>
+"""
+
+import os
+import re
+import struct
+import sys
+
+HEADER_SIZE = 60 # sizeof(HVQM2Header)
+RECORD = struct.Struct(">HHI")
+INDEX_HEADER = struct.Struct(">IIIIII")
+ENTRY = struct.Struct(">II")
+MAGIC = 0x48565149 # 'HVQI'
+
+HVQM2_AUDIO = 0
+HVQM2_VIDEO = 1
+
+HVQM_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "hvqm", "hvqm.h")
+
+def read_defines(path):
+    defines = {}
+    with open(path) as f:
+        for name, value in re.findall(r"^#define\s+(\w+)\s+(0x[0-9A-Fa-f]+|\d+)\b", f.read(), re.M):
+            defines[name] = int(value, 0)
+    return defines
+
+# Space a record takes in its read-ahead ring, see SLOT_ALLOC_SIZE() in src/hvqm/getrecord.c
+def slot_alloc_size(total):
+    return (total + (16 - RECORD.size) + 15) & ~15
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+
+    defines = read_defines(HVQM_H)
+    # Largest body and read-ahead ring of each record type
+    limits = {
+        HVQM2_AUDIO: ("audio", defines["AUDIO_RECORD_SIZE_MAX"], defines["AUDIO_READAHEAD_SIZE"]),
+        HVQM2_VIDEO: ("video", defines["HVQ_DATASIZE_MAX"], defines["HVQ_READAHEAD_SIZE"]),
+    }
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    fileSize = struct.unpack_from(">I", data, 16)[0]
+    if data[:5] != b"HVQM2" or fileSize != len(data):
+        sys.exit("%s: not an HVQM2 movie" % sys.argv[1])
+
+    entries = {HVQM2_AUDIO: [], HVQM2_VIDEO: []}
+    offset = HEADER_SIZE
+    while offset + RECORD.size <= len(data):
+        recordType, recordFormat, size = RECORD.unpack_from(data, offset)
+        total = RECORD.size + size
+        if recordType not in entries or total >= (1 << 24) or recordFormat >= (1 << 8):
+            sys.exit("%s: bad record at 0x%X" % (sys.argv[1], offset))
+        name, maxSize, ringSize = limits[recordType]
+        if size > maxSize or slot_alloc_size(total) > ringSize:
+            sys.exit("%s: %s record at 0x%X is %d bytes, more than its %d byte limit or %d byte read-ahead buffer"
+                     % (sys.argv[1], name, offset, size, maxSize, ringSize))
+        entries[recordType].append(ENTRY.pack(offset, (recordFormat << 24) | total))
+        offset += total
+
+    audio = b"".join(entries[HVQM2_AUDIO])
+    video = b"".join(entries[HVQM2_VIDEO])
+    header = INDEX_HEADER.pack(MAGIC, len(entries[HVQM2_AUDIO]), len(entries[HVQM2_VIDEO]),
+                               INDEX_HEADER.size, INDEX_HEADER.size + len(audio), 0)
+
+    with open(sys.argv[2], "wb") as f:
+        f.write(header + audio + video)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,341 @@
+#!/usr/bin/env python3
+"""
+Generates reduced-triangle LOD variants of Fast64-exported area geometry.
+
+Every mesh display list referenced by an area geo layout is simplified through
+vertex clustering: vertices are snapped to a grid cell per LOD, the vertex
+closest to each cell's centroid represents the whole cell, and triangles that
+collapse or duplicate another triangle are dropped. Representatives are always
+original vertices, so texture coordinates and colors/normals stay valid.
+
+The geo layout is rewritten so that every mesh display list is wrapped in a
+chain of GEO_RENDER_RANGE nodes, one per LOD. Note that render ranges measure
+the distance to the node's origin, so LOD works best on areas whose geometry
+is split into several objects instead of one huge mesh.
+
+Usage:
+    lodgen.py [options] model.inc.c geo.inc.c [geo.inc.c ...]
+
+Options:
+    --grid a,b,...      Clustering cell size for each generated LOD (default 96,256)
+    --ranges a,b,...    Distance at which each generated LOD starts (default 6000,12000)
+    --max-range n       Far end of the last LOD (default 32767)
+    --vtx-buffer n      Vertices per gsSPVertex load (default 32)
+    --report-only       Print the triangle report without writing any files
+
+Outputs, next to the inputs:
+    lod.inc.c           Vertex and display list data for every generated LOD
+    lod_header.h        Declarations for lod.inc.c
+    geo_lod.inc.c       Copy of each geo.inc.c with render range nodes added
+
+Include lod.inc.c from the level's leveldata.c, lod_header.h from its header.h,
+and geo_lod.inc.c in place of the original area geo layout.
+"""
+
+import os
+import re
+import sys
+
+RE_VTX_ARRAY = re.compile(r"Vtx\s+(\w+)\s*\[\s*\d*\s*\]\s*=\s*\{(.*?)\n\};", re.S)
+RE_VTX = re.compile(r"\{\{\s*\{\s*(-?\d+),\s*(-?\d+),\s*(-?\d+)\s*\},\s*(-?\d+),\s*\{\s*(-?\d+),\s*(-?\d+)\s*\},\s*\{\s*(-?\w+),\s*(-?\w+),\s*(-?\w+),\s*(-?\w+)\s*\}\s*\}\}")
+RE_GFX_ARRAY = re.compile(r"Gfx\s+(\w+)\s*\[\s*\d*\s*\]\s*=\s*\{(.*?)\n\};", re.S)
+RE_GFX_CMD = re.compile(r"(gs\w+)\((.*?)\),?\s*$", re.M)
+RE_GEO_DL = re.compile(r"^(\s*)(GEO_\w+?)(_WITH_DL)?\((.*),\s*(\w+)\),\s*$")
+
+class Mesh:
+    """A Fast64 mesh display list and the triangle lists it calls."""
+    def __init__(self, name):
+        self.name = name
+        self.commands = []
+        self.triLists = {}
+
+def parse_args(argv):
+    opts = {
+        "grid": [96, 256],
+        "ranges": [6000, 12000],
+        "max_range": 32767,
+        "vtx_buffer": 32,
+        "report_only": False,
+    }
+    files = []
+    i = 0
+    while i < len(argv):
+        arg = argv[i]
+        if arg == "--grid":
+            i += 1
+            opts["grid"] = [int(x) for x in argv[i].split(",")]
+        elif arg == "--ranges":
+            i += 1
+            opts["ranges"] = [int(x) for x in argv[i].split(",")]
+        elif arg == "--max-range":
+            i += 1
+            opts["max_range"] = int(argv[i])
+        elif arg == "--vtx-buffer":
+            i += 1
+            opts["vtx_buffer"] = int(argv[i])
+        elif arg == "--report-only":
+            opts["report_only"] = True
+        elif arg.startswith("--"):
+            sys.exit(f"Unknown option {arg}")
+        else:
+            files.append(arg)
+        i += 1
+
+    if len(files) < 2:
+        sys.exit(__doc__)
+    if len(opts["grid"]) != len(opts["ranges"]):
+        sys.exit("--grid and --ranges must have the same number of entries")
+    if opts["ranges"] != sorted(opts["ranges"]) or opts["ranges"][-1] >= opts["max_range"]:
+        sys.exit("--ranges must be increasing and below --max-range")
+    return opts, files[0], files[1:]
+
+def parse_model(text):
+    vtxArrays = {}
+    for m in RE_VTX_ARRAY.finditer(text):
+        vtxArrays[m.group(1)] = [v.groups() for v in RE_VTX.finditer(m.group(2))]
+
+    gfxArrays = {}
+    for m in RE_GFX_ARRAY.finditer(text):
+        gfxArrays[m.group(1)] = [(c.group(1), c.group(2)) for c in RE_GFX_CMD.finditer(m.group(2))]
+    return vtxArrays, gfxArrays
+
+def triangles_of(cmds, vtxArrays):
+    """Resolves a triangle list into triangles of (vtx array, index) tuples."""
+    slots = [None] * 64
+    tris = []
+    for op, args in cmds:
+        a = [x.strip() for x in args.split(",")]
+        if op == "gsSPVertex":
+            base = a[0].split("+")
+            arr = base[0].strip()
+            off = int(base[1]) if len(base) > 1 else 0
+            if arr not in vtxArrays:
+                return None
+            for j in range(int(a[1])):
+                slots[int(a[2]) + j] = (arr, off + j)
+        elif op == "gsSP1Triangle":
+            tris.append(tuple(slots[int(x)] for x in a[0:3]))
+        elif op == "gsSP2Triangles":
+            tris.append(tuple(slots[int(x)] for x in a[0:3]))
+            tris.append(tuple(slots[int(x)] for x in a[4:7]))
+        elif op != "gsSPEndDisplayList":
+            # Anything else (e.g. mid-list state changes) is not safe to reorder.
+            return None
+    return tris
+
+def collect_meshes(gfxArrays, vtxArrays, dlNames):
+    meshes = {}
+    for name in dlNames:
+        if name not in gfxArrays:
+            continue
+        mesh = Mesh(name)
+        mesh.commands = gfxArrays[name]
+        for op, args in mesh.commands:
+            if op != "gsSPDisplayList":
+                continue
+            callee = args.strip()
+            if not re.search(r"_tri_\d+$", callee) or callee not in gfxArrays:
+                continue
+            tris = triangles_of(gfxArrays[callee], vtxArrays)
+            if tris is not None:
+                mesh.triLists[callee] = tris
+        if mesh.triLists:
+            meshes[name] = mesh
+    return meshes
+
+def vtx_pos(vtxArrays, ref):
+    v = vtxArrays[ref[0]][ref[1]]
+    return (int(v[0]), int(v[1]), int(v[2]))
+
+def simplify(tris, vtxArrays, grid):
+    cells = {}
+    for tri in tris:
+        for ref in tri:
+            pos = vtx_pos(vtxArrays, ref)
+            key = (pos[0] // grid, pos[1] // grid, pos[2] // grid)
+            cells.setdefault(key, set()).add(ref)
+
+    rep = {}
+    for refs in cells.values():
+        refs = sorted(refs)
+        n = len(refs)
+        cx = sum(vtx_pos(vtxArrays, r)[0] for r in refs) / n
+        cy = sum(vtx_pos(vtxArrays, r)[1] for r in refs) / n
+        cz = sum(vtx_pos(vtxArrays, r)[2] for r in refs) / n
+        best = min(refs, key=lambda r: (vtx_pos(vtxArrays, r)[0] - cx) ** 2
+                                     + (vtx_pos(vtxArrays, r)[1] - cy) ** 2
+                                     + (vtx_pos(vtxArrays, r)[2] - cz) ** 2)
+        for r in refs:
+            rep[r] = best
+
+    out = []
+    seen = set()
+    for tri in tris:
+        t = tuple(rep[r] for r in tri)
+        if t[0] == t[1] or t[1] == t[2] or t[0] == t[2]:
+            continue
+        # Rotate so that the same winding always gives the same key.
+        k = min(range(3), key=lambda i: t[i])
+        key = t[k:] + t[:k]
+        if key in seen:
+            continue
+        seen.add(key)
+        out.append(t)
+    return out
+
+def emit_tri_list(name, tris, vtxArrays, vtxBuffer):
+    """Emits a batched vertex array and triangle list, returns the C source."""
+    batches = []
+    cur = []
+    curIndex = {}
+    for tri in tris:
+        new = [r for r in dict.fromkeys(tri) if r not in curIndex]
+        if len(curIndex) + len(new) > vtxBuffer:
+            batches.append((cur, curIndex))
+            cur = []
+            curIndex = {}
+            new = list(dict.fromkeys(tri))
+        for r in new:
+            curIndex[r] = len(curIndex)
+        cur.append(tri)
+    if cur:
+        batches.append((cur, curIndex))
+
+    verts = []
+    gfx = []
+    for batchTris, index in batches:
+        start = len(verts)
+        verts.extend(index.keys())
+        gfx.append(f"\tgsSPVertex({name}_vtx + {start}, {len(index)}, 0),")
+        for i in range(0, len(batchTris), 2):
+            a = [index[r] for r in batchTris[i]]
+            if i + 1 < len(batchTris):
+                b = [index[r] for r in batchTris[i + 1]]
+                gfx.append(f"\tgsSP2Triangles({a[0]}, {a[1]}, {a[2]}, 0, {b[0]}, {b[1]}, {b[2]}, 0),")
+            else:
+                gfx.append(f"\tgsSP1Triangle({a[0]}, {a[1]}, {a[2]}, 0),")
+    gfx.append("\tgsSPEndDisplayList(),")
+
+    src = f"Vtx {name}_vtx[{len(verts)}] = {{\n"
+    for ref in verts:
+        v = vtxArrays[ref[0]][ref[1]]
+        src += f"\t{{{{ {{{v[0]}, {v[1]}, {v[2]}}}, {v[3]}, {{{v[4]}, {v[5]}}}, {{{v[6]}, {v[7]}, {v[8]}, {v[9]}}} }}}},\n"
+    src += "};\n\n"
+    src += f"Gfx {name}[] = {{\n" + "\n".join(gfx) + "\n};\n\n"
+    return src
+
+def lod_name(name, lod):
+    return f"{name}_lod{lod}"
+
+def generate_lods(meshes, vtxArrays, opts):
+    """Returns the C source for every LOD and the triangle counts per mesh and LOD."""
+    src = ""
+    header = ""
+    counts = {}
+    for mesh in meshes.values():
+        counts[mesh.name] = [sum(len(t) for t in mesh.triLists.values())]
+        for lod, grid in enumerate(opts["grid"], 1):
+            total = 0
+            for triName, tris in mesh.triLists.items():
+                reduced = simplify(tris, vtxArrays, grid)
+                total += len(reduced)
+                src += emit_tri_list(lod_name(triName, lod), reduced, vtxArrays, opts["vtx_buffer"])
+            counts[mesh.name].append(total)
+
+            src += f"Gfx {lod_name(mesh.name, lod)}[] = {{\n"
+            for op, args in mesh.commands:
+                callee = args.strip()
+                if op == "gsSPDisplayList" and callee in mesh.triLists:
+                    args = lod_name(callee, lod)
+                src += f"\t{op}({args}),\n"
+            src += "};\n\n"
+            header += f"extern Gfx {lod_name(mesh.name, lod)}[];\n"
+    return src, header, counts
+
+def rewrite_geo(text, meshes, opts):
+    """Wraps every mesh display list node of a geo layout in render range nodes."""
+    lines = text.split("\n")
+    out = []
+    used = []
+    bounds = [-opts["max_range"]] + opts["ranges"] + [opts["max_range"]]
+    i = 0
+    while i < len(lines):
+        line = lines[i]
+        m = RE_GEO_DL.match(line)
+        if m is None or m.group(5) not in meshes or (m.group(3) is None and m.group(2) != "GEO_DISPLAY_LIST"):
+            out.append(line)
+            i += 1
+            continue
+
+        indent, cmd, withDl, args, dl = m.groups()
+        used.append(dl)
+        layer = args.split(",")[0].strip()
+        inner = indent + "\t"
+        ranges = []
+        for lod in range(len(bounds) - 1):
+            name = dl if lod == 0 else lod_name(dl, lod)
+            ranges += [
+                f"{inner}GEO_RENDER_RANGE({bounds[lod]}, {bounds[lod + 1]}),",
+                f"{inner}GEO_OPEN_NODE(),",
+                f"{inner}\tGEO_DISPLAY_LIST({layer}, {name}),",
+                f"{inner}GEO_CLOSE_NODE(),",
+            ]
+
+        if withDl is None:
+            # A bare display list node becomes a plain node holding the ranges.
+            out.append(f"{indent}GEO_NODE_START(),")
+            out.append(f"{indent}GEO_OPEN_NODE(),")
+            out += ranges
+            out.append(f"{indent}GEO_CLOSE_NODE(),")
+        else:
+            out.append(f"{indent}{cmd}({args}),")
+            if i + 1 < len(lines) and lines[i + 1].strip() == "GEO_OPEN_NODE(),":
+                out.append(lines[i + 1])
+                out += ranges
+                i += 1
+            else:
+                out.append(f"{indent}GEO_OPEN_NODE(),")
+                out += ranges
+                out.append(f"{indent}GEO_CLOSE_NODE(),")
+        i += 1
+    return "\n".join(out), used
+
+def main():
+    opts, modelPath, geoPaths = parse_args(sys.argv[1:])
+    with open(modelPath, "r", encoding="utf-8") as f:
+        vtxArrays, gfxArrays = parse_model(f.read())
+
+    geoTexts = {}
+    dlNames = []
+    for path in geoPaths:
+        with open(path, "r", encoding="utf-8") as f:
+            geoTexts[path] = f.read()
+        for line in geoTexts[path].split("\n"):
+            m = RE_GEO_DL.match(line)
+            if m is not None:
+                dlNames.append(m.group(5))
+
+    meshes = collect_meshes(gfxArrays, vtxArrays, dict.fromkeys(dlNames))
+    if not meshes:
+        sys.exit("No Fast64 mesh display lists referenced by the given geo layouts.")
+
+    src, header, counts = generate_lods(meshes, vtxArrays, opts)
+
+    print(f"{'area':<40} " + " ".join(f"{'LOD' + str(i):>8}" for i in range(len(opts["grid"]) + 1)))
+    for path in geoPaths:
+        geo, used = rewrite_geo(geoTexts[path], meshes, opts)
+        totals = [sum(counts[dl][lod] for dl in used) for lod in range(len(opts["grid"]) + 1)]
+        print(f"{os.path.dirname(path) or '.':<40} " + " ".join(f"{t:>8}" for t in totals))
+        if not opts["report_only"]:
+            with open(os.path.join(os.path.dirname(path), "geo_lod.inc.c"), "w", encoding="utf-8") as f:
+                f.write(geo)
+
+    if not opts["report_only"]:
+        outDir = os.path.dirname(modelPath)
+        with open(os.path.join(outDir, "lod.inc.c"), "w", encoding="utf-8") as f:
+            f.write(src)
+        with open(os.path.join(outDir, "lod_header.h"), "w", encoding="utf-8") as f:
+            f.write(header)
+
+if __name__ == "__main__":
+    main()
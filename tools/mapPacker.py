@@ -1,9 +1,20 @@
 import sys, struct, subprocess
 
+# Usage: mapPacker.py <elf> <addr.bin> <name.bin> <index.bin>
+#
+# addr.bin:  one (address, name offset) pair per function, sorted by address.
+# name.bin:  the null terminated names, four byte aligned.
+# index.bin: a bucket table for map_parser.c. For every (1 << INDEX_SHIFT) byte bucket
+#            of the text range, the index of the first entry at or above its start.
+#            Lookups only have to binary search the entries of one bucket.
+
+INDEX_SHIFT = 12
+
 class MapEntry():
-	def __init__(self, nm, addr):
+	def __init__(self, nm, addr, isGlobal):
 		self.name = nm
 		self.addr = addr
+		self.isGlobal = isGlobal
 		self.strlen = (len(nm) + 4) & (~3)
 	def __str__(self):
 		return "%s %s %d" % (self.addr, self.name, self.strlen)
@@ -11,7 +22,7 @@ class MapEntry():
 		return "%s %s %d" % (self.addr, self.name, self.strlen)
 
 
-structDef = ">LLLL"
+structDef = ">LL"
 
 symNames = []
 
@@ -27,24 +38,44 @@ for line in symbols:
 	if len(tokens) >= 3 and len(tokens[-2]) == 1:
 		addr = int(tokens[0], 16)
 		if addr & 0x80000000 and tokens[-2].lower() == "t":
-			symNames.append(MapEntry(tokens[-1], addr))
+			symNames.append(MapEntry(tokens[-1], addr, tokens[-2] == "T"))
 
 
+# Several symbols can share an address (aliases, labels); keep one per address, preferring globals.
+symNames.sort(key=lambda x: (x.addr, not x.isGlobal))
+uniqueNames = []
+for x in symNames:
+	if len(uniqueNames) == 0 or uniqueNames[-1].addr != x.addr:
+		uniqueNames.append(x)
+symNames = uniqueNames
+
+if len(symNames) >= 0x10000:
+	sys.exit("mapPacker.py: too many symbols for a 16 bit index")
 
 f1 = open(sys.argv[2], "wb+")
 f2 = open(sys.argv[3], "wb+")
-
-symNames.sort(key=lambda x: x.addr)
+f3 = open(sys.argv[4], "wb+")
 
 off = 0
 for x in symNames:
-	f1.write(struct.pack(structDef, x.addr, off, len(x.name), 0))
+	f1.write(struct.pack(structDef, x.addr, off))
 	f2.write(struct.pack(">%ds" % x.strlen, bytes(x.name, encoding="ascii")))
 	off += x.strlen
 
+# Bucket table: base address, bucket count, then bucket count + 1 entry indices.
+base = (symNames[0].addr >> INDEX_SHIFT) << INDEX_SHIFT if len(symNames) > 0 else 0
+numBuckets = ((symNames[-1].addr - base) >> INDEX_SHIFT) + 1 if len(symNames) > 0 else 0
+f3.write(struct.pack(">LLL", base, INDEX_SHIFT, numBuckets))
+i = 0
+for bucket in range(numBuckets + 1):
+	start = base + (bucket << INDEX_SHIFT)
+	while i < len(symNames) and symNames[i].addr < start:
+		i += 1
+	f3.write(struct.pack(">H", i))
+
 
 f1.close()
 f2.close()
+f3.close()
 
 # print('\n'.join([str(hex(x.addr)) + " " + x.name for x in symNames]))
-
@@ -418,21 +418,12 @@ int ia2png(const char *png_filename, const ia *img, int width, int height)
 // PNG -> internal RGBA/IA
 //---------------------------------------------------------
 
-rgba *png2rgba(const char *png_filename, int *width, int *height)
+// decoded stb_image pixels -> internal RGBA
+static rgba *stbi2rgba(const stbi_uc *data, int w, int h, int channels)
 {
    rgba *img = NULL;
-   int w = 0;
-   int h = 0;
-   int channels = 0;
    int img_size;
 
-   stbi_uc *data = stbi_load(png_filename, &w, &h, &channels, STBI_default);
-   if (!data || w <= 0 || h <= 0) {
-      ERROR("Error loading \"%s\"\n", png_filename);
-      return NULL;
-   }
-   INFO("Read \"%s\" %dx%d channels: %d\n", png_filename, w, h, channels);
-
    img_size = w * h * sizeof(*img);
    img = malloc(img_size);
    if (!img) {
@@ -474,28 +465,15 @@ rgba *png2rgba(const char *png_filename, int *width, int *height)
          img = NULL;
    }
 
-   // cleanup
-   stbi_image_free(data);
-
-   *width = w;
-   *height = h;
    return img;
 }
 
-ia *png2ia(const char *png_filename, int *width, int *height)
+// decoded stb_image pixels -> internal IA
+static ia *stbi2ia(const stbi_uc *data, int w, int h, int channels)
 {
    ia *img = NULL;
-   int w = 0, h = 0;
-   int channels = 0;
    int img_size;
 
-   stbi_uc *data = stbi_load(png_filename, &w, &h, &channels, STBI_default);
-   if (!data || w <= 0 || h <= 0) {
-      ERROR("Error loading \"%s\"\n", png_filename);
-      return NULL;
-   }
-   INFO("Read \"%s\" %dx%d channels: %d\n", png_filename, w, h, channels);
-
    img_size = w * h * sizeof(*img);
    img = malloc(img_size);
    if (!img) {
@@ -535,6 +513,48 @@ ia *png2ia(const char *png_filename, int *width, int *height)
          img = NULL;
    }
 
+   return img;
+}
+
+rgba *png2rgba(const char *png_filename, int *width, int *height)
+{
+   rgba *img = NULL;
+   int w = 0;
+   int h = 0;
+   int channels = 0;
+
+   stbi_uc *data = stbi_load(png_filename, &w, &h, &channels, STBI_default);
+   if (!data || w <= 0 || h <= 0) {
+      ERROR("Error loading \"%s\"\n", png_filename);
+      return NULL;
+   }
+   INFO("Read \"%s\" %dx%d channels: %d\n", png_filename, w, h, channels);
+
+   img = stbi2rgba(data, w, h, channels);
+
+   // cleanup
+   stbi_image_free(data);
+
+   *width = w;
+   *height = h;
+   return img;
+}
+
+ia *png2ia(const char *png_filename, int *width, int *height)
+{
+   ia *img = NULL;
+   int w = 0, h = 0;
+   int channels = 0;
+
+   stbi_uc *data = stbi_load(png_filename, &w, &h, &channels, STBI_default);
+   if (!data || w <= 0 || h <= 0) {
+      ERROR("Error loading \"%s\"\n", png_filename);
+      return NULL;
+   }
+   INFO("Read \"%s\" %dx%d channels: %d\n", png_filename, w, h, channels);
+
+   img = stbi2ia(data, w, h, channels);
+
    // cleanup
    stbi_image_free(data);
 
@@ -618,13 +638,16 @@ const char *n64graphics_get_write_version(void)
 }
 
 #ifdef N64GRAPHICS_STANDALONE
-#define N64GRAPHICS_VERSION "0.4"
+#define N64GRAPHICS_VERSION "0.5"
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 typedef enum
 {
    MODE_EXPORT,
    MODE_IMPORT,
+   MODE_BATCH,
 } tool_mode;
 
 typedef struct
@@ -632,6 +655,9 @@ typedef struct
    char *img_filename;
    char *bin_filename;
    char *pal_filename;
+   char *manifest_filename;
+   char *cache_filename;
+   char *report_filename;
    tool_mode mode;
    write_encoding encoding;
    unsigned int bin_offset;
@@ -643,6 +669,7 @@ typedef struct
    int bin_truncate;
    int pal_truncate;
    int rotate_envmap;
+   int num_jobs;
 } graphics_config;
 
 static const graphics_config default_config =
@@ -650,6 +677,9 @@ static const graphics_config default_config =
    .img_filename = NULL,
    .bin_filename = NULL,
    .pal_filename = NULL,
+   .manifest_filename = NULL,
+   .cache_filename = NULL,
+   .report_filename = NULL,
    .mode = MODE_EXPORT,
    .encoding = ENCODING_RAW,
    .bin_offset = 0,
@@ -661,6 +691,7 @@ static const graphics_config default_config =
    .bin_truncate = 1,
    .pal_truncate = 1,
    .rotate_envmap = 0,
+   .num_jobs = 0,
 };
 
 typedef struct
@@ -744,6 +775,7 @@ static int parse_encoding(write_encoding *encoding, const char *str)
 static void print_usage(void)
 {
    ERROR("Usage: n64graphics -e/-i BIN_FILE -g IMG_FILE [-p PAL_FILE] [-o BIN_OFFSET] [-P PAL_OFFSET] [-f FORMAT] [-c CI_FORMAT] [-w WIDTH] [-h HEIGHT] [-r ROTATE] [-V]\n"
+         "       n64graphics -m MANIFEST [-j JOBS] [-k CACHE_FILE] [-d REPORT_FILE]\n"
          "\n"
          "n64graphics v" N64GRAPHICS_VERSION ": N64 graphics manipulator\n"
          "\n"
@@ -762,6 +794,12 @@ static void print_usage(void)
          " -c CI_FORMAT  CI palette format: rgba16, ia16 (default: %s)\n"
          " -p PAL_FILE   palette binary file to import/export from/to\n"
          " -P PAL_OFFSET starting offset in PAL_FILE (prevents truncation during import)\n"
+         "Batch arguments:\n"
+         " -m MANIFEST   import every texture listed in MANIFEST, one \"FORMAT SCHEME IMG_FILE BIN_FILE\" per line,\n"
+         "               only writing the outputs that changed\n"
+         " -j JOBS       number of threads to convert with (default: number of CPUs)\n"
+         " -k CACHE_FILE skip decoding PNGs that are unchanged since the run that wrote CACHE_FILE\n"
+         " -d REPORT     list textures with identical converted data in REPORT (- for stdout)\n"
          "Other arguments:\n"
          " -v            verbose logging\n"
          " -V            print version information\n",
@@ -792,6 +830,10 @@ static int parse_arguments(int argc, char *argv[], graphics_config *config)
                   return 0;
                }
                break;
+            case 'd':
+               if (++i >= argc) return 0;
+               config->report_filename = argv[i];
+               break;
             case 'e':
                if (++i >= argc) return 0;
                config->bin_filename = argv[i];
@@ -816,6 +858,19 @@ static int parse_arguments(int argc, char *argv[], graphics_config *config)
                config->bin_filename = argv[i];
                config->mode = MODE_IMPORT;
                break;
+            case 'j':
+               if (++i >= argc) return 0;
+               config->num_jobs = strtoul(argv[i], NULL, 0);
+               break;
+            case 'k':
+               if (++i >= argc) return 0;
+               config->cache_filename = argv[i];
+               break;
+            case 'm':
+               if (++i >= argc) return 0;
+               config->manifest_filename = argv[i];
+               config->mode = MODE_BATCH;
+               break;
             case 'o':
                if (++i >= argc) return 0;
                config->bin_offset = strtoul(argv[i], NULL, 0);
@@ -869,6 +924,9 @@ static int parse_arguments(int argc, char *argv[], graphics_config *config)
 // returns 1 if config is valid
 static int valid_config(const graphics_config *config)
 {
+   if (config->mode == MODE_BATCH) {
+      return config->manifest_filename != NULL;
+   }
    if (!config->bin_filename || !config->img_filename) {
       return 0;
    }
@@ -881,6 +939,526 @@ static int valid_config(const graphics_config *config)
    return 1;
 }
 
+//---------------------------------------------------------
+// batch import
+//---------------------------------------------------------
+
+// Converts every texture listed in a manifest with a pool of threads, so a build pays for one process
+// instead of one per texture. Each manifest line is "FORMAT SCHEME IMG_FILE BIN_FILE", '#' starts a comment.
+// An output is only written when its contents change, which leaves its timestamp alone otherwise.
+// With a cache file, textures whose PNG is unchanged since the last run are not decoded at all.
+
+#define BATCH_PATH_MAX 1024
+
+typedef enum
+{
+   BATCH_PENDING,
+   BATCH_CACHED,    // PNG unchanged since the last run, not decoded
+   BATCH_UNCHANGED, // converted, output already up to date
+   BATCH_WRITTEN,
+   BATCH_FAILED,
+} batch_status;
+
+typedef struct
+{
+   char *img_filename;
+   char *bin_filename;
+   img_format format;
+   write_encoding encoding;
+   uint64_t src_hash; // PNG contents and conversion settings
+   uint64_t raw_hash; // converted texture data
+   uint64_t out_hash; // encoded output file
+   int raw_length;
+   batch_status status;
+} batch_job;
+
+typedef struct
+{
+   char *bin_filename;
+   uint64_t src_hash;
+   uint64_t raw_hash;
+   uint64_t out_hash;
+   int raw_length;
+} cache_entry;
+
+typedef struct
+{
+   batch_job *jobs;
+   int count;
+   int next;
+   const cache_entry *cache;
+   int cache_count;
+   pthread_mutex_t lock;
+} batch_queue;
+
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ULL
+#define FNV_PRIME        0x100000001B3ULL
+
+// 64-bit FNV-1a
+static uint64_t hash_bytes(uint64_t hash, const uint8_t *data, long length)
+{
+   for (long i = 0; i < length; i++) {
+      hash ^= data[i];
+      hash *= FNV_PRIME;
+   }
+   return hash;
+}
+
+// returns the hash of a file's contents, or 0 if it can't be read
+static uint64_t hash_file(const char *filename)
+{
+   uint8_t *data;
+   uint64_t hash;
+   long length = read_file(filename, &data);
+   if (length < 0) {
+      return 0;
+   }
+   hash = hash_bytes(FNV_OFFSET_BASIS, data, length);
+   free(data);
+   return hash;
+}
+
+// encode to memory in the same format as fprint_write_output
+// returns the encoded length, or -1 on error
+static int sprint_write_output(uint8_t **out, write_encoding encoding, const uint8_t *raw, int length)
+{
+   static const int bytes_per_val[] = {
+      [ENCODING_RAW] = 0,
+      [ENCODING_U8]  = sizeof(uint8_t),
+      [ENCODING_U16] = sizeof(uint16_t),
+      [ENCODING_U32] = sizeof(uint32_t),
+      [ENCODING_U64] = sizeof(uint64_t),
+   };
+   static const char hex[] = "0123456789abcdef";
+   int bpv = bytes_per_val[encoding];
+   int vals;
+   char *buf;
+   int pos = 0;
+
+   if (encoding == ENCODING_RAW) {
+      *out = malloc(length);
+      if (!*out) {
+         return -1;
+      }
+      memcpy(*out, raw, length);
+      return length;
+   }
+
+   // "0x" + digits + "ULL" + separator per value
+   vals = (length + bpv - 1) / bpv;
+   buf = malloc(vals * (2 + 2*bpv + 3 + 1) + 1);
+   if (!buf) {
+      return -1;
+   }
+   for (int w = 0; w < length; w += bpv) {
+      buf[pos++] = '0';
+      buf[pos++] = 'x';
+      for (int b = 0; b < bpv; b++) {
+         int off = w + b;
+         uint8_t val = off < length ? raw[off] : 0x00;
+         buf[pos++] = hex[val >> 4];
+         buf[pos++] = hex[val & 0xF];
+      }
+      if (encoding == ENCODING_U64) {
+         memcpy(&buf[pos], "ULL", 3);
+         pos += 3;
+      }
+      buf[pos++] = (w < length - bpv) ? ',' : '\n';
+   }
+   *out = (uint8_t *)buf;
+   return pos;
+}
+
+// decoded PNG -> N64 raw texture, returns length or -1 on error
+static int stbi2raw(uint8_t **raw, const img_format *format, const stbi_uc *data, int w, int h, int channels)
+{
+   int raw_size = (w * h * format->depth + 7) / 8;
+   int length = -1;
+
+   *raw = malloc(raw_size);
+   if (!*raw) {
+      ERROR("Error allocating %u bytes\n", raw_size);
+      return -1;
+   }
+   switch (format->format) {
+      case IMG_FORMAT_RGBA:
+      {
+         rgba *imgr = stbi2rgba(data, w, h, channels);
+         if (imgr) {
+            length = rgba2raw(*raw, imgr, w, h, format->depth);
+            free(imgr);
+         }
+         break;
+      }
+      case IMG_FORMAT_IA:
+      case IMG_FORMAT_I:
+      {
+         ia *imgi = stbi2ia(data, w, h, channels);
+         if (imgi) {
+            if (format->format == IMG_FORMAT_IA) {
+               length = ia2raw(*raw, imgi, w, h, format->depth);
+            } else {
+               length = i2raw(*raw, imgi, w, h, format->depth);
+            }
+            free(imgi);
+         }
+         break;
+      }
+      default:
+         break;
+   }
+   if (length <= 0) {
+      free(*raw);
+      *raw = NULL;
+   }
+   return length;
+}
+
+static int cache_entry_cmp(const void *a, const void *b)
+{
+   return strcmp(((const cache_entry *)a)->bin_filename, ((const cache_entry *)b)->bin_filename);
+}
+
+static const cache_entry *find_cache_entry(const batch_queue *queue, const char *bin_filename)
+{
+   cache_entry key = {.bin_filename = (char *)bin_filename};
+   if (queue->cache_count == 0) {
+      return NULL;
+   }
+   return bsearch(&key, queue->cache, queue->cache_count, sizeof(cache_entry), cache_entry_cmp);
+}
+
+static void batch_convert(batch_queue *queue, batch_job *job)
+{
+   uint8_t *png;
+   uint8_t *raw;
+   uint8_t *out;
+   int w, h, channels;
+   int out_length;
+   long png_length;
+   const cache_entry *cached;
+
+   png_length = read_file(job->img_filename, &png);
+   if (png_length <= 0) {
+      ERROR("Error reading \"%s\"\n", job->img_filename);
+      job->status = BATCH_FAILED;
+      return;
+   }
+
+   job->src_hash = hash_bytes(FNV_OFFSET_BASIS, png, png_length);
+   job->src_hash = hash_bytes(job->src_hash, (const uint8_t *)&job->format, sizeof(job->format));
+   job->src_hash = hash_bytes(job->src_hash, (const uint8_t *)&job->encoding, sizeof(job->encoding));
+
+   // the output also has to still be what the last run wrote, in case it was removed or edited
+   cached = find_cache_entry(queue, job->bin_filename);
+   if (cached && cached->src_hash == job->src_hash && hash_file(job->bin_filename) == cached->out_hash) {
+      job->raw_hash = cached->raw_hash;
+      job->out_hash = cached->out_hash;
+      job->raw_length = cached->raw_length;
+      job->status = BATCH_CACHED;
+      free(png);
+      return;
+   }
+
+   stbi_uc *data = stbi_load_from_memory(png, png_length, &w, &h, &channels, STBI_default);
+   free(png);
+   if (!data || w <= 0 || h <= 0) {
+      ERROR("Error loading \"%s\"\n", job->img_filename);
+      job->status = BATCH_FAILED;
+      return;
+   }
+   INFO("Read \"%s\" %dx%d channels: %d\n", job->img_filename, w, h, channels);
+
+   job->raw_length = stbi2raw(&raw, &job->format, data, w, h, channels);
+   stbi_image_free(data);
+   if (job->raw_length <= 0) {
+      ERROR("Error converting \"%s\" to %s\n", job->img_filename, format2str(&job->format));
+      job->status = BATCH_FAILED;
+      return;
+   }
+   job->raw_hash = hash_bytes(FNV_OFFSET_BASIS, raw, job->raw_length);
+
+   out_length = sprint_write_output(&out, job->encoding, raw, job->raw_length);
+   free(raw);
+   if (out_length < 0) {
+      ERROR("Error encoding \"%s\"\n", job->bin_filename);
+      job->status = BATCH_FAILED;
+      return;
+   }
+   job->out_hash = hash_bytes(FNV_OFFSET_BASIS, out, out_length);
+
+   if (hash_file(job->bin_filename) == job->out_hash && filesize(job->bin_filename) == out_length) {
+      job->status = BATCH_UNCHANGED;
+   } else if (write_file(job->bin_filename, out, out_length) == out_length) {
+      INFO("Wrote 0x%X bytes to \"%s\"\n", out_length, job->bin_filename);
+      job->status = BATCH_WRITTEN;
+   } else {
+      ERROR("Error writing %d bytes to \"%s\"\n", out_length, job->bin_filename);
+      job->status = BATCH_FAILED;
+   }
+   free(out);
+}
+
+static void *batch_worker(void *arg)
+{
+   batch_queue *queue = arg;
+
+   for (;;) {
+      int index;
+
+      pthread_mutex_lock(&queue->lock);
+      index = queue->next++;
+      pthread_mutex_unlock(&queue->lock);
+
+      if (index >= queue->count) {
+         break;
+      }
+      batch_convert(queue, &queue->jobs[index]);
+   }
+   return NULL;
+}
+
+// returns number of jobs read, or -1 on error
+static int read_manifest(const char *manifest_filename, batch_job **jobs)
+{
+   FILE *fp;
+   char line[2 * BATCH_PATH_MAX + 64];
+   int count = 0;
+   int capacity = 256;
+   int line_num = 0;
+
+   fp = fopen(manifest_filename, "r");
+   if (!fp) {
+      ERROR("Error opening \"%s\"\n", manifest_filename);
+      return -1;
+   }
+   *jobs = malloc(capacity * sizeof(batch_job));
+
+   while (fgets(line, sizeof(line), fp)) {
+      char fmt[16], scheme[16], img[BATCH_PATH_MAX], bin[BATCH_PATH_MAX];
+      batch_job *job;
+
+      line_num++;
+      if (line[strspn(line, " \t\r\n")] == '\0' || line[strspn(line, " \t")] == '#') {
+         continue;
+      }
+      if (sscanf(line, "%15s %15s %1023s %1023s", fmt, scheme, img, bin) != 4) {
+         ERROR("%s:%d: expected \"FORMAT SCHEME IMG_FILE BIN_FILE\"\n", manifest_filename, line_num);
+         fclose(fp);
+         return -1;
+      }
+      if (count == capacity) {
+         capacity *= 2;
+         *jobs = realloc(*jobs, capacity * sizeof(batch_job));
+      }
+      job = &(*jobs)[count];
+      memset(job, 0, sizeof(*job));
+      if (!parse_format(&job->format, fmt) || job->format.format == IMG_FORMAT_CI) {
+         ERROR("%s:%d: unsupported format \"%s\"\n", manifest_filename, line_num, fmt);
+         fclose(fp);
+         return -1;
+      }
+      if (!parse_encoding(&job->encoding, scheme)) {
+         ERROR("%s:%d: unsupported scheme \"%s\"\n", manifest_filename, line_num, scheme);
+         fclose(fp);
+         return -1;
+      }
+      job->img_filename = strdup(img);
+      job->bin_filename = strdup(bin);
+      job->status = BATCH_PENDING;
+      count++;
+   }
+
+   fclose(fp);
+   return count;
+}
+
+// cache lines are "SRC_HASH RAW_HASH OUT_HASH RAW_LENGTH BIN_FILE"
+// returns number of entries read, a missing cache is empty
+static int read_cache(const char *cache_filename, cache_entry **cache)
+{
+   FILE *fp;
+   char line[BATCH_PATH_MAX + 128];
+   int count = 0;
+   int capacity = 256;
+
+   *cache = NULL;
+   fp = fopen(cache_filename, "r");
+   if (!fp) {
+      return 0;
+   }
+   *cache = malloc(capacity * sizeof(cache_entry));
+
+   while (fgets(line, sizeof(line), fp)) {
+      unsigned long long src, raw, out;
+      char bin[BATCH_PATH_MAX];
+      int raw_length;
+
+      if (sscanf(line, "%llx %llx %llx %d %1023s", &src, &raw, &out, &raw_length, bin) != 5) {
+         continue;
+      }
+      if (count == capacity) {
+         capacity *= 2;
+         *cache = realloc(*cache, capacity * sizeof(cache_entry));
+      }
+      (*cache)[count].bin_filename = strdup(bin);
+      (*cache)[count].src_hash = src;
+      (*cache)[count].raw_hash = raw;
+      (*cache)[count].out_hash = out;
+      (*cache)[count].raw_length = raw_length;
+      count++;
+   }
+
+   fclose(fp);
+   qsort(*cache, count, sizeof(cache_entry), cache_entry_cmp);
+   return count;
+}
+
+static void write_cache(const char *cache_filename, const batch_job *jobs, int count)
+{
+   char tmp_filename[BATCH_PATH_MAX + 8];
+   FILE *fp;
+
+   // write to a temporary file first, so an interrupted run can't leave a truncated cache
+   snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", cache_filename);
+   fp = fopen(tmp_filename, "w");
+   if (!fp) {
+      ERROR("Error opening \"%s\"\n", tmp_filename);
+      return;
+   }
+   for (int i = 0; i < count; i++) {
+      if (jobs[i].status != BATCH_FAILED) {
+         fprintf(fp, "%016llx %016llx %016llx %d %s\n", (unsigned long long)jobs[i].src_hash,
+                 (unsigned long long)jobs[i].raw_hash, (unsigned long long)jobs[i].out_hash,
+                 jobs[i].raw_length, jobs[i].bin_filename);
+      }
+   }
+   fclose(fp);
+   remove(cache_filename);
+   rename(tmp_filename, cache_filename);
+}
+
+static int raw_hash_cmp(const void *a, const void *b)
+{
+   const batch_job *ja = *(const batch_job **)a;
+   const batch_job *jb = *(const batch_job **)b;
+   if (ja->raw_hash != jb->raw_hash) {
+      return ja->raw_hash < jb->raw_hash ? -1 : 1;
+   }
+   if (ja->raw_length != jb->raw_length) {
+      return ja->raw_length - jb->raw_length;
+   }
+   return strcmp(ja->img_filename, jb->img_filename);
+}
+
+// list textures whose converted data is identical, by hash, so they can be shared
+static void write_duplicates(const char *report_filename, batch_job *jobs, int count)
+{
+   batch_job **sorted = malloc(count * sizeof(batch_job *));
+   int sorted_count = 0;
+   int groups = 0;
+   long shareable = 0;
+   FILE *fp;
+
+   if (0 == strcmp("-", report_filename)) {
+      fp = stdout;
+   } else {
+      fp = fopen(report_filename, "w");
+   }
+   if (!fp) {
+      ERROR("Error opening \"%s\"\n", report_filename);
+      free(sorted);
+      return;
+   }
+
+   for (int i = 0; i < count; i++) {
+      if (jobs[i].status != BATCH_FAILED) {
+         sorted[sorted_count++] = &jobs[i];
+      }
+   }
+   qsort(sorted, sorted_count, sizeof(batch_job *), raw_hash_cmp);
+
+   for (int i = 0; i < sorted_count; ) {
+      int j = i + 1;
+      while (j < sorted_count && sorted[j]->raw_hash == sorted[i]->raw_hash
+             && sorted[j]->raw_length == sorted[i]->raw_length) {
+         j++;
+      }
+      if (j - i > 1) {
+         fprintf(fp, "%d textures, 0x%X bytes each:\n", j - i, sorted[i]->raw_length);
+         for (int k = i; k < j; k++) {
+            fprintf(fp, "  %s\n", sorted[k]->img_filename);
+         }
+         groups++;
+         shareable += (long)(j - i - 1) * sorted[i]->raw_length;
+      }
+      i = j;
+   }
+   fprintf(fp, "%d sets of duplicate textures, 0x%lX bytes could be shared\n", groups, shareable);
+
+   if (fp != stdout) {
+      fclose(fp);
+   }
+   free(sorted);
+}
+
+static int default_job_count(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+   long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   if (cpus > 0) {
+      return cpus;
+   }
+#endif
+   return 4;
+}
+
+static int batch_import(const graphics_config *config)
+{
+   batch_queue queue = {0};
+   pthread_t *threads;
+   int num_threads;
+   int counts[BATCH_FAILED + 1] = {0};
+
+   queue.count = read_manifest(config->manifest_filename, &queue.jobs);
+   if (queue.count < 0) {
+      return EXIT_FAILURE;
+   }
+   if (config->cache_filename) {
+      cache_entry *cache;
+      queue.cache_count = read_cache(config->cache_filename, &cache);
+      queue.cache = cache;
+   }
+   pthread_mutex_init(&queue.lock, NULL);
+
+   num_threads = config->num_jobs > 0 ? config->num_jobs : default_job_count();
+   num_threads = MIN(num_threads, MAX(queue.count, 1));
+   threads = malloc(num_threads * sizeof(pthread_t));
+   for (int i = 0; i < num_threads; i++) {
+      pthread_create(&threads[i], NULL, batch_worker, &queue);
+   }
+   for (int i = 0; i < num_threads; i++) {
+      pthread_join(threads[i], NULL);
+   }
+   pthread_mutex_destroy(&queue.lock);
+   free(threads);
+
+   for (int i = 0; i < queue.count; i++) {
+      counts[queue.jobs[i].status]++;
+   }
+   INFO("%d textures: %d written, %d unchanged, %d cached, %d failed\n", queue.count,
+        counts[BATCH_WRITTEN], counts[BATCH_UNCHANGED], counts[BATCH_CACHED], counts[BATCH_FAILED]);
+
+   if (config->cache_filename) {
+      write_cache(config->cache_filename, queue.jobs, queue.count);
+   }
+   if (config->report_filename) {
+      write_duplicates(config->report_filename, queue.jobs, queue.count);
+   }
+
+   return counts[BATCH_FAILED] ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 int main(int argc, char *argv[])
 {
    graphics_config config = default_config;
@@ -899,6 +1477,10 @@ int main(int argc, char *argv[])
       exit(EXIT_FAILURE);
    }
 
+   if (config.mode == MODE_BATCH) {
+      return batch_import(&config);
+   }
+
    if (config.mode == MODE_IMPORT) {
       if (0 == strcmp("-", config.bin_filename)) {
          bin_fp = stdout;
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+Symbolizes the samples streamed over USB by the sampling profiler (PROFILER_SAMPLING).
+
+UNFLoader saves every binary it receives to a file. Pass those files, in order,
+along with the ELF the ROM was built from. Each sample is a big endian
+(pc, ra, thread) triple, matching struct ProfilerSample in src/game/profiling.h.
+
+By default the functions are printed by how often they were sampled. With
+--collapsed, one "thread;caller;function count" line is printed per stack,
+ready for flamegraph.pl. The caller comes from ra, which is only reliable for
+leaf functions, so stacks are at most two deep.
+
+Usage:
+    profiler_samples.py [--collapsed] <elf> <binaryout files...>
+"""
+
+import bisect
+import struct
+import subprocess
+import sys
+from collections import Counter
+
+SAMPLE = struct.Struct(">III")
+
+THREAD_NAMES = {
+    1: "idle",
+    3: "main",
+    4: "sound",
+    5: "game",
+    6: "rumble",
+    7: "hvqm",
+    8: "timekeeper",
+    9: "da_counter",
+    10: "graphics",
+}
+
+def read_symbols(elf):
+    out = subprocess.run(["nm", "-n", elf], stdout=subprocess.PIPE, check=True).stdout.decode("ascii")
+    addrs = []
+    names = []
+    for line in out.split("\n"):
+        tokens = line.split()
+        if len(tokens) == 3 and tokens[1].lower() == "t":
+            addrs.append(int(tokens[0], 16))
+            names.append(tokens[2])
+    return addrs, names
+
+def symbolize(addrs, names, addr):
+    i = bisect.bisect_right(addrs, addr) - 1
+    return names[i] if i >= 0 else "0x%08X" % addr
+
+def read_samples(paths):
+    for path in paths:
+        with open(path, "rb") as f:
+            data = f.read()
+        # Skip the records of tools/telemetry.py, which start with their magic instead of a code address.
+        if data[:2] == b"TF":
+            continue
+        for offset in range(0, len(data) - SAMPLE.size + 1, SAMPLE.size):
+            yield SAMPLE.unpack_from(data, offset)
+
+def main():
+    args = sys.argv[1:]
+    collapsed = "--collapsed" in args
+    args = [a for a in args if a != "--collapsed"]
+    if len(args) < 2:
+        sys.exit(__doc__)
+
+    addrs, names = read_symbols(args[0])
+    counts = Counter()
+    total = 0
+    for pc, ra, thread in read_samples(args[1:]):
+        func = symbolize(addrs, names, pc)
+        if collapsed:
+            threadName = THREAD_NAMES.get(thread, "thread%d" % thread)
+            counts["%s;%s;%s" % (threadName, symbolize(addrs, names, ra), func)] += 1
+        else:
+            counts[func] += 1
+        total += 1
+
+    if total == 0:
+        sys.exit("no samples found")
+
+    if collapsed:
+        for stack, count in counts.items():
+            print("%s %d" % (stack, count))
+    else:
+        print("%d samples" % total)
+        for func, count in counts.most_common():
+            print("%6.2f%% %8d  %s" % (100.0 * count / total, count, func))
+
+if __name__ == "__main__":
+    main()
@@ -110,6 +110,8 @@ s32 clip(s32 ix, s32 llevel, s32 ulevel);
 void vdecodeframe(FILE *ifile, s32 *outp, s32 order, s32 ***coefTable);
 
 // vencode.c
+s32 vfindpredictor(s16 *inBuffer, s32 *state, s32 ***coefTable, s32 order, s32 npredictors);
+void vquantizeframe(u8 *out, s16 *inBuffer, s32 *state, s32 ***coefTable, s32 order, s32 optimalp);
 void vencodeframe(FILE *ofile, s16 *inBuffer, s32 *state, s32 ***coefTable, s32 order, s32 npredictors, s32 nsam);
 
 // util.c
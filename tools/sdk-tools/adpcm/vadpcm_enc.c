@@ -3,9 +3,210 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <getopt.h>
+#ifndef __sgi
+#include <pthread.h>
+#include <unistd.h>
+#endif
 #include "vadpcm.h"
 
-static char usage[] = "[-t -l min_loop_length] -c codebook aifcfile compressedfile";
+static char usage[] = "[-t -l min_loop_length] [-f [-j jobs]] -c codebook aifcfile compressedfile";
+
+/**
+ * Every frame is collected before encoding, in the order the original streaming encoder
+ * visited them (including the repeated loop frames), so the encoder can look at all of them.
+ */
+typedef struct
+{
+    s16 (*samples)[16];
+    s32 count;
+    s32 capacity;
+} FrameQueue;
+
+typedef struct
+{
+    FrameQueue *queue;
+    s32 *predictors;
+    s32 ***coefTable;
+    s32 order;
+    s32 npredictors;
+    s32 first;
+    s32 last;
+} PredictorJob;
+
+static void queue_frame(FrameQueue *queue, s16 *inBuffer, s32 nsam)
+{
+    s32 i;
+
+    if (queue->count == queue->capacity)
+    {
+        queue->capacity = (queue->capacity == 0) ? 1024 : queue->capacity * 2;
+        queue->samples = realloc(queue->samples, queue->capacity * sizeof(queue->samples[0]));
+    }
+
+    // We are only given 'nsam' samples; pad with zeroes to 16.
+    for (i = 0; i < 16; i++)
+    {
+        queue->samples[queue->count][i] = (i < nsam) ? inBuffer[i] : 0;
+    }
+    queue->count++;
+}
+
+/**
+ * Fast mode: choose the predictor of each frame from the previous frame's input samples instead
+ * of its decoded output. The decoded output is only known once every frame before it has been
+ * encoded, while the input is known up front, so the predictor search (the bulk of the work)
+ * can be split across threads. The choice is slightly worse, since the decoder only ever sees
+ * the decoded samples.
+ */
+static void *find_predictors(void *arg)
+{
+    PredictorJob *job = arg;
+    s32 history[16];
+    s32 f;
+    s32 i;
+
+    for (f = job->first; f < job->last; f++)
+    {
+        for (i = 0; i < 16; i++)
+        {
+            history[i] = (f > 0) ? job->queue->samples[f - 1][i] : 0;
+        }
+        job->predictors[f] = vfindpredictor(job->queue->samples[f], history, job->coefTable, job->order, job->npredictors);
+    }
+    return NULL;
+}
+
+static s32 *find_predictors_parallel(FrameQueue *queue, s32 ***coefTable, s32 order, s32 npredictors, s32 njobs)
+{
+    s32 *predictors = malloc(queue->count * sizeof(s32));
+    PredictorJob *jobs;
+    s32 i;
+
+    if (njobs < 1)
+    {
+        njobs = 1;
+    }
+    jobs = malloc(njobs * sizeof(PredictorJob));
+    for (i = 0; i < njobs; i++)
+    {
+        jobs[i].queue = queue;
+        jobs[i].predictors = predictors;
+        jobs[i].coefTable = coefTable;
+        jobs[i].order = order;
+        jobs[i].npredictors = npredictors;
+        jobs[i].first = (s32) ((s64) queue->count * i / njobs);
+        jobs[i].last = (s32) ((s64) queue->count * (i + 1) / njobs);
+    }
+
+#ifndef __sgi
+    {
+        pthread_t *threads = malloc(njobs * sizeof(pthread_t));
+        for (i = 1; i < njobs; i++)
+        {
+            pthread_create(&threads[i], NULL, find_predictors, &jobs[i]);
+        }
+        find_predictors(&jobs[0]);
+        for (i = 1; i < njobs; i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        free(threads);
+    }
+#else
+    for (i = 0; i < njobs; i++)
+    {
+        find_predictors(&jobs[i]);
+    }
+#endif
+
+    free(jobs);
+    return predictors;
+}
+
+static s32 default_job_count(void)
+{
+#if !defined(__sgi) && defined(_SC_NPROCESSORS_ONLN)
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0)
+    {
+        return cpus;
+    }
+#endif
+    return 1;
+}
+
+static void save_loop_state(ALADPCMloop *aloop, s32 *state)
+{
+    s32 j;
+
+    for (j = 0; j < 16; j++)
+    {
+        if (state[j] >= 0x8000)
+        {
+            state[j] = 0x7fff;
+        }
+        if (state[j] < -0x7fff)
+        {
+            state[j] = -0x7fff;
+        }
+        aloop->state[j] = state[j];
+    }
+}
+
+/**
+ * Encode the queued frames in order. loopFrames[i] is the number of frames encoded before the
+ * state of loop i is saved, or -1 if the loop has none.
+ */
+static void encode_frames(FILE *ofile, FrameQueue *queue, s32 ***coefTable, s32 order, s32 npredictors,
+                          ALADPCMloop *aloops, s32 *loopFrames, s32 nloops, s32 fast, s32 njobs)
+{
+    s32 state[16];
+    s32 *predictors = NULL;
+    u8 *out;
+    s32 predictor;
+    s32 f;
+    s32 i;
+
+    for (i = 0; i < 16; i++)
+    {
+        state[i] = 0;
+    }
+
+    if (fast)
+    {
+        predictors = find_predictors_parallel(queue, coefTable, order, npredictors, njobs);
+    }
+
+    out = malloc(queue->count * 9 + 1);
+    for (f = 0; f <= queue->count; f++)
+    {
+        for (i = 0; i < nloops; i++)
+        {
+            if (loopFrames[i] == f)
+            {
+                save_loop_state(&aloops[i], state);
+            }
+        }
+        if (f == queue->count)
+        {
+            break;
+        }
+
+        if (fast)
+        {
+            predictor = predictors[f];
+        }
+        else
+        {
+            predictor = vfindpredictor(queue->samples[f], state, coefTable, order, npredictors);
+        }
+        vquantizeframe(&out[f * 9], queue->samples[f], state, coefTable, order, predictor);
+    }
+    fwrite(out, 9, queue->count, ofile);
+
+    free(out);
+    free(predictors);
+}
 
 int main(int argc, char **argv)
 {
@@ -17,11 +218,12 @@ int main(int argc, char **argv)
     s16 ts;
     s32 minLoopLength = 800;
     s32 ***coefTable = NULL;
-    s32 *state;
     s32 order;
     s32 npredictors;
     s32 done = 0;
     s32 truncate = 0;
+    s32 fast = 0;
+    s32 njobs = 0;
     s32 num;
     s32 tableSize;
     s32 nsam;
@@ -40,6 +242,8 @@ int main(int argc, char **argv)
     s32 startSoundPointer = 0;
     s32 cType;
     s32 nBytes = 0;
+    s32 *loopFrames = NULL;
+    FrameQueue frames = { NULL, 0, 0 };
     u32 loopEnd;
     char *compName = "VADPCM ~4-1";
     char *appCodeName = "VADPCMCODES";
@@ -53,7 +257,7 @@ int main(int argc, char **argv)
     SoundDataChunk SndDChunk;
     InstrumentChunk InstChunk;
     Loop *loops = NULL;
-    ALADPCMloop *aloops;
+    ALADPCMloop *aloops = NULL;
     Marker *markers;
     CodeChunk cChunk;
     char filename[1024];
@@ -67,7 +271,7 @@ int main(int argc, char **argv)
         exit(1);
     }
 
-    while ((c = getopt(argc, argv, "tc:l:")) != -1)
+    while ((c = getopt(argc, argv, "tfc:l:j:")) != -1)
     {
         switch (c)
         {
@@ -95,6 +299,14 @@ int main(int argc, char **argv)
             sscanf(optarg, "%d", &minLoopLength);
             break;
 
+        case 'f':
+            fast = 1;
+            break;
+
+        case 'j':
+            sscanf(optarg, "%d", &njobs);
+            break;
+
         default:
             break;
         }
@@ -118,12 +330,6 @@ int main(int argc, char **argv)
         exit(1);
     }
 
-    state = malloc(16 * sizeof(s32));
-    for (i = 0; i < 16; i++)
-    {
-        state[i] = 0;
-    }
-
 #ifndef __sgi
     // If there is no instrument chunk, make sure to output zeroes instead of
     // garbage. (This matches how the IRIX -g-compiled version behaves.)
@@ -351,6 +557,11 @@ int main(int argc, char **argv)
     BSWAP32(SndDChunk.blockSize)
     fwrite(&SndDChunk, sizeof(SoundDataChunk), 1, ofile);
     startSoundPointer = ftell(ifile);
+    loopFrames = malloc((nloops > 0 ? nloops : 1) * sizeof(s32));
+    for (i = 0; i < nloops; i++)
+    {
+        loopFrames[i] = -1;
+    }
     for (i = 0; i < nloops; i++)
     {
         if (lookupMarker(&aloops[i].start, loops[i].beginLoop, markers, numMarkers) != 0)
@@ -377,7 +588,7 @@ int main(int argc, char **argv)
                 if (fread(inBuffer, sizeof(s16), 16, ifile) == 16)
                 {
                     BSWAP16_MANY(inBuffer, 16)
-                    vencodeframe(ofile, inBuffer, state, coefTable, order, npredictors, 16);
+                    queue_frame(&frames, inBuffer, 16);
                     currentPos += 16;
                     nBytes += 9;
                 }
@@ -388,18 +599,8 @@ int main(int argc, char **argv)
                 }
             }
 
-            for (j = 0; j < 16; j++)
-            {
-                if (state[j] >= 0x8000)
-                {
-                    state[j] = 0x7fff;
-                }
-                if (state[j] < -0x7fff)
-                {
-                    state[j] = -0x7fff;
-                }
-                aloops[i].state[j] = state[j];
-            }
+            // The state is saved once the frames so far have been encoded.
+            loopFrames[i] = frames.count;
 
             aloops[i].count = -1;
             while (nRepeats > 0)
@@ -409,7 +610,7 @@ int main(int argc, char **argv)
                     if (fread(inBuffer, sizeof(s16), 16, ifile) == 16)
                     {
                         BSWAP16_MANY(inBuffer, 16)
-                        vencodeframe(ofile, inBuffer, state, coefTable, order, npredictors, 16);
+                        queue_frame(&frames, inBuffer, 16);
                         nBytes += 9;
                     }
                 }
@@ -419,7 +620,7 @@ int main(int argc, char **argv)
                 fseek(ifile, startPointer, SEEK_SET);
                 fread(inBuffer + left, sizeof(s16), 16 - left, ifile);
                 BSWAP16_MANY(inBuffer + left, 16 - left)
-                vencodeframe(ofile, inBuffer, state, coefTable, order, npredictors, 16);
+                queue_frame(&frames, inBuffer, 16);
                 nBytes += 9;
                 currentPos = aloops[i].start - left + 16;
                 nRepeats--;
@@ -449,7 +650,7 @@ int main(int argc, char **argv)
         if (fread(inBuffer, 2, nsam, ifile) == nsam)
         {
             BSWAP16_MANY(inBuffer, nsam)
-            vencodeframe(ofile, inBuffer, state, coefTable, order, npredictors, nsam);
+            queue_frame(&frames, inBuffer, nsam);
             currentPos += nsam;
             nBytes += 9;
         }
@@ -460,6 +661,12 @@ int main(int argc, char **argv)
         }
     }
 
+    if (fast && njobs == 0)
+    {
+        njobs = default_job_count();
+    }
+    encode_frames(ofile, &frames, coefTable, order, npredictors, aloops, loopFrames, nloops, fast, njobs);
+
     if (nBytes % 2)
     {
         nBytes++;
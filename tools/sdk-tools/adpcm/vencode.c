@@ -3,40 +3,25 @@
 #include <math.h>
 #include "vadpcm.h"
 
-void vencodeframe(FILE *ofile, s16 *inBuffer, s32 *state, s32 ***coefTable, s32 order, s32 npredictors, s32 nsam)
+/**
+ * Find the predictor that best fits the 16 samples in inBuffer, given the last 'order' decoded
+ * samples at the end of 'state', by the L2 norm of its prediction errors.
+ *
+ * The norm only grows as errors are added, so a predictor is dropped as soon as the errors of
+ * its first 8 samples exceed the best norm so far. This picks the same predictor as trying
+ * every one in full.
+ */
+s32 vfindpredictor(s16 *inBuffer, s32 *state, s32 ***coefTable, s32 order, s32 npredictors)
 {
-    s16 ix[16];
     s32 prediction[16];
     s32 inVector[16];
-    s32 saveState[16];
     s32 optimalp;
-    s32 scale;
-    s32 llevel;
-    s32 ulevel;
     s32 i;
-    s32 j;
     s32 k;
-    s32 ie[16];
-    s32 nIter;
-    s32 max;
-    s32 cV;
-    s32 maxClip;
-    u8 header;
-    u8 c;
     f32 e[16];
     f32 se;
     f32 min;
 
-    // We are only given 'nsam' samples; pad with zeroes to 16.
-    for (i = nsam; i < 16; i++)
-    {
-        inBuffer[i] = 0;
-    }
-
-    llevel = -8;
-    ulevel = -llevel - 1;
-
-    // Determine the best-fitting predictor.
     min = 1e30;
     optimalp = 0;
     for (k = 0; k < npredictors; k++)
@@ -61,6 +46,17 @@ void vencodeframe(FILE *ofile, s16 *inBuffer, s32 *state, s32 ***coefTable, s32
             e[i] = (f32) inVector[i + order];
         }
 
+        // Sum in the same order as below, so the partial sum is exactly a prefix of the full one.
+        se = 0.0f;
+        for (i = 0; i < 8; i++)
+        {
+            se += e[i] * e[i];
+        }
+        if (se >= min)
+        {
+            continue;
+        }
+
         // For the next 8 samples, start with 'order' values from the end of
         // the previous 8-sample chunk of inBuffer. (The code is equivalent to
         // inVector[i] = inBuffer[8 - order + i].)
@@ -79,10 +75,9 @@ void vencodeframe(FILE *ofile, s16 *inBuffer, s32 *state, s32 ***coefTable, s32
 
         // Compute the L2 norm of the errors; the lowest norm decides which
         // predictor to use.
-        se = 0.0f;
-        for (j = 0; j < 16; j++)
+        for (i = 8; i < 16; i++)
         {
-            se += e[j] * e[j];
+            se += e[i] * e[i];
         }
 
         if (se < min)
@@ -92,7 +87,35 @@ void vencodeframe(FILE *ofile, s16 *inBuffer, s32 *state, s32 ***coefTable, s32
         }
     }
 
-    // Do exactly the same thing again, for real.
+    return optimalp;
+}
+
+/**
+ * Encode the 16 samples in inBuffer with the given predictor, writing the 9 byte frame to 'out'
+ * and the decoded samples to 'state'.
+ */
+void vquantizeframe(u8 *out, s16 *inBuffer, s32 *state, s32 ***coefTable, s32 order, s32 optimalp)
+{
+    s16 ix[16];
+    s32 prediction[16];
+    s32 inVector[16];
+    s32 saveState[16];
+    s32 scale;
+    s32 llevel;
+    s32 ulevel;
+    s32 i;
+    s32 ie[16];
+    s32 nIter;
+    s32 max;
+    s32 cV;
+    s32 maxClip;
+    f32 e[16];
+    f32 se;
+
+    llevel = -8;
+    ulevel = -llevel - 1;
+
+    // Compute the unquantized errors of the chosen predictor.
     for (i = 0; i < order; i++)
     {
         inVector[i] = state[16 - order + i];
@@ -226,11 +249,25 @@ out:;
 
     // The scale, the predictor index, and the 16 computed outputs are now all
     // 4-bit numbers. Write them out as 1 + 8 bytes.
-    header = (scale << 4) | (optimalp & 0xf);
-    fwrite(&header, 1, 1, ofile);
+    out[0] = (scale << 4) | (optimalp & 0xf);
     for (i = 0; i < 16; i += 2)
     {
-        c = (ix[i] << 4) | (ix[i + 1] & 0xf);
-        fwrite(&c, 1, 1, ofile);
+        out[1 + i / 2] = (ix[i] << 4) | (ix[i + 1] & 0xf);
     }
 }
+
+void vencodeframe(FILE *ofile, s16 *inBuffer, s32 *state, s32 ***coefTable, s32 order, s32 npredictors, s32 nsam)
+{
+    u8 frame[9];
+    s32 i;
+
+    // We are only given 'nsam' samples; pad with zeroes to 16.
+    for (i = nsam; i < 16; i++)
+    {
+        inBuffer[i] = 0;
+    }
+
+    vquantizeframe(frame, inBuffer, state, coefTable, order,
+                   vfindpredictor(inBuffer, state, coefTable, order, npredictors));
+    fwrite(frame, 1, sizeof(frame), ofile);
+}
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+Decodes the per-frame records streamed by a TELEMETRY build (see src/game/telemetry.h).
+
+Inputs can be any mix of:
+ - the raw binaries UNFLoader saves for every USB transfer, and
+ - text logs with "TLM <hex>" lines, as printed to the IS-Viewer by ISVPRINT builds.
+   Emulators that support it (cen64, ares, ...) can write that output to a file.
+
+Records are written as CSV, or as JSON with --json, sorted by frame number.
+
+Usage:
+    telemetry.py [--json] [-o <output>] <inputs...>
+"""
+
+import json
+import re
+import struct
+import sys
+
+MAGIC = 0x5446
+VERSION = 1
+
+# Matches struct TelemetryFrame.
+FRAME = struct.Struct(">HBBIHHHHHHHHHHII")
+FIELDS = [
+    "magic", "version", "size", "frame",
+    "cpu_us", "rsp_us", "rdp_us", "objects",
+    "floor_checks", "wall_checks", "ceil_checks", "water_checks", "raycasts", "matrix_muls",
+    "gfx_pool_used", "audio_heap_used",
+]
+OUTPUT_FIELDS = FIELDS[3:]
+
+TEXT_RECORD = re.compile(rb"TLM ([0-9A-Fa-f]+)")
+
+def decode_record(data, offset=0):
+    if len(data) - offset < FRAME.size:
+        return None
+    values = dict(zip(FIELDS, FRAME.unpack_from(data, offset)))
+    if values["magic"] != MAGIC or values["size"] != FRAME.size:
+        return None
+    if values["version"] != VERSION:
+        sys.exit("unsupported telemetry version %d" % values["version"])
+    return values
+
+def read_binary(data):
+    records = []
+    offset = 0
+    while offset + FRAME.size <= len(data):
+        record = decode_record(data, offset)
+        if record is None:
+            # Not a telemetry transfer (profiler samples, screenshots, ...).
+            break
+        records.append(record)
+        offset += FRAME.size
+    return records
+
+def read_text(data):
+    records = []
+    for match in TEXT_RECORD.finditer(data):
+        record = decode_record(bytes.fromhex(match.group(1).decode("ascii")))
+        if record is not None:
+            records.append(record)
+    return records
+
+def read_file(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) >= 2 and struct.unpack_from(">H", data)[0] == MAGIC:
+        return read_binary(data)
+    return read_text(data)
+
+def main():
+    args = sys.argv[1:]
+    asJson = False
+    output = None
+    inputs = []
+    while args:
+        arg = args.pop(0)
+        if arg == "--json":
+            asJson = True
+        elif arg == "-o" and args:
+            output = args.pop(0)
+        else:
+            inputs.append(arg)
+    if not inputs:
+        sys.exit(__doc__)
+
+    records = []
+    for path in inputs:
+        records += read_file(path)
+    records.sort(key=lambda r: r["frame"])
+
+    out = open(output, "w") if output else sys.stdout
+    if asJson:
+        json.dump([{k: r[k] for k in OUTPUT_FIELDS} for r in records], out, indent=1)
+        out.write("\n")
+    else:
+        out.write(",".join(OUTPUT_FIELDS) + "\n")
+        for r in records:
+            out.write(",".join(str(r[k]) for k in OUTPUT_FIELDS) + "\n")
+    if output:
+        out.close()
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,269 @@
+#!/usr/bin/env python3
+"""
+Generates the texture scroll descriptor tables used by src/game/texscroll.c
+from the scroll functions Fast64 exports to levels/*/texscroll.inc.c.
+
+Fast64 writes one function per scrolling mesh or material, and a
+scroll_<level>() function calling all of them. Each of those calls becomes a
+struct TexScroll descriptor:
+- Vertex scrolls become TEXSCROLL_TILE on the G_SETTILESIZE commands of their
+  material, when the level's model.inc.c only draws that material with those
+  vertices, since shifting the tile costs the same whatever the vertex count.
+  Otherwise they become TEXSCROLL_VTX, with the exact speeds and texture size
+  of the generated function. Both drop scrolls whose speed truncates to 0.
+- Material scrolls that only shift_s()/shift_t() tile sizes by constants
+  become one TEXSCROLL_TILE per G_SETTILESIZE command.
+- Anything else, like interval based or hand written scrolls, becomes
+  TEXSCROLL_FUNC and keeps calling the exported function.
+
+The exported files are left untouched, so re-exporting a level from Fast64
+just regenerates its table on the next build.
+
+Usage:
+    texscroll_tables.py levels > texscroll_tables.inc.c
+"""
+
+import os
+import re
+import sys
+
+FUNC_RE = re.compile(r"^void\s+(\w+)\s*\(\s*(?:void)?\s*\)\s*\{", re.M)
+CALL_RE = re.compile(r"^(\w+)\s*\(\s*\)\s*;$")
+LEVEL_RE = re.compile(r"^DEFINE_LEVEL\(\s*\"[^\"]*\"\s*,\s*(\w+)\s*,\s*\w+\s*,\s*(\w+)\s*,", re.M)
+
+NUMBER = r"(-?[0-9.]+(?:[eE][-+]?[0-9]+)?)"
+VTX_PATTERNS = {
+    "count": re.compile(r"\bint\s+count\s*=\s*(\d+)\s*;"),
+    "width": re.compile(r"\bint\s+width\s*=\s*(\d+)\s*\*\s*0x20\s*;"),
+    "height": re.compile(r"\bint\s+height\s*=\s*(\d+)\s*\*\s*0x20\s*;"),
+    "vtx": re.compile(r"Vtx\s*\*\s*vertices\s*=\s*segmented_to_virtual\(\s*(\w+)\s*\)\s*;"),
+    "speedS": re.compile(r"deltaX\s*=\s*\(int\)\s*\(\s*" + NUMBER + r"\s*\*\s*0x20\s*\)\s*%\s*width\s*;"),
+    "speedT": re.compile(r"deltaY\s*=\s*\(int\)\s*\(\s*" + NUMBER + r"\s*\*\s*0x20\s*\)\s*%\s*height\s*;"),
+}
+GFX_RE = re.compile(r"^Gfx\s+(\w+)\s*\[\s*\w*\s*\]\s*=\s*\{(.*?)^\};", re.M | re.S)
+GFX_CMD_RE = re.compile(r"^(\w+)\s*\((.*)\)$", re.S)
+MAT_RE = re.compile(r"^Gfx\s*\*\s*mat\s*=\s*segmented_to_virtual\(\s*(\w+)\s*\)\s*;$")
+SHIFT_RE = re.compile(r"^shift_([st])\(\s*mat\s*,\s*(\d+)\s*,\s*(?:PACK_TILESIZE\(\s*(\d+)\s*,\s*(\d+)\s*\)|(\d+))\s*\)\s*;$")
+
+
+# Display list macros that are a single Gfx command, so a command's index can be counted in a material.
+SINGLE_GFX_CMDS = {
+    "gsDPPipeSync", "gsDPTileSync", "gsDPLoadSync", "gsDPSetCombineLERP", "gsDPSetCombineMode",
+    "gsDPSetAlphaDither", "gsDPSetColorDither", "gsDPSetTextureLUT", "gsDPSetTextureFilter",
+    "gsDPSetTexturePersp", "gsDPSetTextureDetail", "gsDPSetTextureLOD", "gsDPSetTextureConvert",
+    "gsDPSetCycleType", "gsDPSetRenderMode", "gsDPSetAlphaCompare", "gsDPSetDepthSource",
+    "gsDPSetPrimColor", "gsDPSetEnvColor", "gsDPSetFogColor", "gsDPSetBlendColor", "gsDPSetPrimDepth",
+    "gsDPSetTextureImage", "gsDPSetTile", "gsDPSetTileSize", "gsDPLoadTLUTCmd", "gsDPLoadBlock",
+    "gsDPLoadTile", "gsSPTexture", "gsSPSetGeometryMode", "gsSPClearGeometryMode", "gsSPGeometryMode",
+    "gsSPLoadGeometryMode", "gsSPSetOtherMode", "gsSPFogPosition", "gsSPEndDisplayList",
+}
+
+
+def read_display_lists(level_dir):
+    """Return the commands of every display list in the level's model.inc.c, by name."""
+    path = os.path.join(level_dir, "model.inc.c")
+    if not os.path.isfile(path):
+        return {}
+    with open(path) as f:
+        src = f.read()
+
+    dls = {}
+    for m in GFX_RE.finditer(src):
+        cmds = []
+        depth = 0
+        start = 0
+        body = m.group(2)
+        for i, c in enumerate(body):
+            if c == "(":
+                depth += 1
+            elif c == ")":
+                depth -= 1
+            elif c == "," and depth == 0:
+                cmds.append(body[start:i].strip())
+                start = i + 1
+        if body[start:].strip():
+            cmds.append(body[start:].strip())
+        dls[m.group(1)] = [GFX_CMD_RE.match(cmd).groups() if GFX_CMD_RE.match(cmd) else (cmd, "") for cmd in cmds]
+    return dls
+
+
+def first_arg(args):
+    return re.split(r"[\s,+]", args.strip(), 1)[0]
+
+
+def vtx_material_tiles(dls, vtx):
+    """
+    Return the material and the indices of its G_SETTILESIZE commands if shifting them scrolls
+    exactly the vertices of vtx, or None. That is the case when only one display list loads vtx,
+    it loads nothing else, and it is drawn once, right after a material that isn't used elsewhere.
+    """
+    loaders = [name for name, cmds in dls.items() if any(cmd == "gsSPVertex" and first_arg(args) == vtx for cmd, args in cmds)]
+    if len(loaders) != 1:
+        return None
+    tri = loaders[0]
+    if any(cmd == "gsSPVertex" and first_arg(args) != vtx for cmd, args in dls[tri]):
+        return None
+
+    calls = [(cmds, i) for cmds in dls.values() for i, (cmd, args) in enumerate(cmds)
+             if cmd == "gsSPDisplayList" and first_arg(args) == tri]
+    if len(calls) != 1 or calls[0][1] == 0:
+        return None
+    cmd, args = calls[0][0][calls[0][1] - 1]
+    mat = first_arg(args)
+    if cmd != "gsSPDisplayList" or mat not in dls:
+        return None
+    if sum(1 for cmds in dls.values() for cmd, args in cmds if cmd == "gsSPDisplayList" and first_arg(args) == mat) != 1:
+        return None
+
+    tiles = []
+    for i, (cmd, args) in enumerate(dls[mat]):
+        if cmd not in SINGLE_GFX_CMDS:
+            return None
+        if cmd == "gsDPSetTileSize":
+            tiles.append(i)
+    return (mat, tiles) if tiles else None
+
+
+def read_functions(path):
+    """Return the body of every function in the file, by name."""
+    with open(path) as f:
+        src = f.read()
+
+    funcs = {}
+    for m in FUNC_RE.finditer(src):
+        depth = 1
+        i = m.end()
+        while depth > 0:
+            if i >= len(src):
+                sys.exit("%s: unterminated function %s" % (path, m.group(1)))
+            if src[i] == "{":
+                depth += 1
+            elif src[i] == "}":
+                depth -= 1
+            i += 1
+        funcs[m.group(1)] = src[m.end():i - 1]
+    return funcs
+
+
+def statements(body):
+    return [s.strip() + ";" for s in body.split(";") if s.strip()]
+
+
+def vtx_descriptor(body, dls):
+    fields = {}
+    for key, pattern in VTX_PATTERNS.items():
+        m = pattern.search(body)
+        if m is None:
+            return None
+        fields[key] = m.group(1)
+
+    # The exported function truncates its speeds to whole texture coordinate units (1/32 of a texel).
+    deltaS = int(float(fields["speedS"]) * 0x20)
+    deltaT = int(float(fields["speedT"]) * 0x20)
+    if deltaS == 0 and deltaT == 0:
+        return []
+
+    width, height = int(fields["width"]), int(fields["height"])
+    material = vtx_material_tiles(dls, fields["vtx"])
+    if material is not None and (width & (width - 1)) == 0 and (height & (height - 1)) == 0:
+        # Moving the tile by a texel moves the texture the other way on the vertices.
+        mat, tiles = material
+        return ["TEXSCROLL_TILE(%s, %d, %g, %g)" % (mat, cmd, -deltaS / 8, -deltaT / 8) for cmd in tiles]
+
+    return ["TEXSCROLL_VTX(%s, %s, %s, %s, %s, %s)" % (
+        fields["vtx"], fields["count"], fields["speedS"], fields["speedT"], fields["width"], fields["height"])]
+
+
+def tile_descriptors(body):
+    stmts = statements(body)
+    if not stmts:
+        return None
+
+    m = MAT_RE.match(stmts[0])
+    if m is None:
+        return None
+    mat = m.group(1)
+
+    # Speeds of each G_SETTILESIZE command, in the order they are first shifted
+    cmds = {}
+    for stmt in stmts[1:]:
+        m = SHIFT_RE.match(stmt)
+        if m is None:
+            return None
+        axis, cmd = m.group(1), int(m.group(2))
+        amount = int(m.group(3)) * 4 + int(m.group(4)) if m.group(3) is not None else int(m.group(5))
+        speeds = cmds.setdefault(cmd, [0, 0])
+        speeds[0 if axis == "s" else 1] += amount
+
+    return ["TEXSCROLL_TILE(%s, %d, %d, %d)" % (mat, cmd, s, t) for cmd, (s, t) in cmds.items()]
+
+
+def level_descriptors(path, level):
+    """Return the descriptors of a level, and whether its exported file has to be compiled."""
+    funcs = read_functions(path)
+    dls = read_display_lists(os.path.dirname(path))
+    root = "scroll_" + level
+    if root not in funcs:
+        sys.exit("%s: missing %s()" % (path, root))
+
+    descriptors = []
+    needs_source = False
+    for stmt in statements(funcs[root]):
+        m = CALL_RE.match(stmt)
+        if m is None or m.group(1) not in funcs:
+            sys.exit("%s: %s() can only call the scroll functions of the file, found '%s'" % (path, root, stmt))
+
+        body = funcs[m.group(1)]
+        result = vtx_descriptor(body, dls)
+        if result is None:
+            result = tile_descriptors(body)
+        if result is None:
+            result = ["TEXSCROLL_FUNC(%s)" % m.group(1)]
+            needs_source = True
+        descriptors += result
+
+    return descriptors, needs_source
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__.strip())
+    levels_dir = sys.argv[1]
+
+    with open(os.path.join(levels_dir, "level_defines.h")) as f:
+        level_ids = {folder: level_id for level_id, folder in LEVEL_RE.findall(f.read())}
+
+    out = ["// Generated by tools/texscroll_tables.py from %s/*/texscroll.inc.c, do not edit." % levels_dir, ""]
+    entries = []
+
+    for level in sorted(os.listdir(levels_dir)):
+        path = os.path.join(levels_dir, level, "texscroll.inc.c")
+        if not os.path.isfile(path):
+            continue
+        if level not in level_ids:
+            sys.exit("%s: %s is not defined in level_defines.h" % (path, level))
+
+        descriptors, needs_source = level_descriptors(path, level)
+        if not descriptors:
+            continue
+
+        out.append('#include "%s/%s/header.h"' % (levels_dir, level))
+        if needs_source:
+            out.append('#include "%s/%s/texscroll.inc.c"' % (levels_dir, level))
+        out.append("")
+        out.append("static const struct TexScroll %s_texscrolls[] = {" % level)
+        out += ["    %s," % d for d in descriptors]
+        out.append("};")
+        out.append("static struct TexScrollState %s_texscroll_states[ARRAY_COUNT(%s_texscrolls)];" % (level, level))
+        out.append("")
+        entries.append("    LEVEL_TEXSCROLLS(%s, %s)," % (level_ids[level], level))
+
+    out.append("static const struct LevelTexScrolls sLevelTexScrolls[] = {")
+    out += entries if entries else ["    { LEVEL_NONE, 0, NULL, NULL, 0 },"]
+    out.append("};")
+
+    print("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
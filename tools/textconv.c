@@ -1,25 +1,68 @@
 #include <ctype.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
-#include "hashtable.h"
 #include "utf8.h"
 
 #define ARRAY_COUNT(arr) (sizeof(arr) / sizeof(arr[0]))
 
+#define CHARMAP_MAX_LENGTH 3
+
 struct CharmapEntry
 {
-    uint32_t unicode[3];
+    uint32_t unicode[CHARMAP_MAX_LENGTH];
     int length; // length of the unicode array. TODO: use dynamic memory allocation
     int bytesCount;
     uint8_t bytes[2]; // bytes to convert unicode array to, (e.g. 'A' = 0x0A)
 };
 
-static struct HashTable *charmap;
+// The charmap is stored as a trie, with one edge per character, so the longest entry
+// matching a string is found in a single walk. Node 0 is the root, and the edges of a
+// node are sorted by character so they can be binary searched.
+// Nodes that end a charmap entry have a nonzero bytesCount.
+struct TrieNode
+{
+    uint32_t firstEdge;
+    uint32_t edgeCount;
+    uint8_t bytesCount;
+    uint8_t bytes[2];
+};
+
+struct TrieEdge
+{
+    uint32_t parent;
+    uint32_t unicode;
+    uint32_t node;
+};
+
+struct Charmap
+{
+    char *filename;
+    struct TrieNode *nodes;
+    uint32_t nodeCount;
+    struct TrieEdge *edges;
+    uint32_t edgeCount;
+};
+
+// Compiled charmaps (see write_charmap) start with this, followed by the node and edge counts,
+// the nodes and the edges. All values are little endian.
+#define CHARMAP_MAGIC "TCM1"
+#define CHARMAP_NODE_SIZE 12
+#define CHARMAP_EDGE_SIZE 8
+
+// Contents of an output file, built in memory so it can be compared with the existing file
+struct OutputBuffer
+{
+    char *data;
+    size_t size;
+    size_t capacity;
+};
 
 static void fatal_error(const char *msgfmt, ...)
 {
@@ -178,7 +221,92 @@ static int get_escape_char(int c)
         return 0;
 }
 
-static void read_charmap(const char *filename)
+static void *checked_realloc(void *ptr, size_t size)
+{
+    ptr = realloc(ptr, size);
+    if (ptr == NULL)
+        fatal_error("could not allocate buffer of size %u", (uint32_t)size);
+    return ptr;
+}
+
+static int trie_edge_cmp(const void *a, const void *b)
+{
+    const struct TrieEdge *ea = a;
+    const struct TrieEdge *eb = b;
+
+    if (ea->parent != eb->parent)
+        return ea->parent < eb->parent ? -1 : 1;
+    if (ea->unicode != eb->unicode)
+        return ea->unicode < eb->unicode ? -1 : 1;
+    return 0;
+}
+
+// Returns the child of node for the given character, or NULL if there is none
+static const struct TrieNode *trie_child(const struct Charmap *charmap, const struct TrieNode *node, uint32_t unicode)
+{
+    const struct TrieEdge *edges = charmap->edges + node->firstEdge;
+    uint32_t lo = 0;
+    uint32_t hi = node->edgeCount;
+
+    while (lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+
+        if (edges[mid].unicode < unicode)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < node->edgeCount && edges[lo].unicode == unicode)
+        return &charmap->nodes[edges[lo].node];
+    return NULL;
+}
+
+// Returns the node for the entry's characters, creating it if needed.
+// Edges are searched linearly here, since they are only sorted once the whole charmap is read.
+static struct TrieNode *trie_insert(struct Charmap *charmap, const struct CharmapEntry *entry)
+{
+    uint32_t node = 0;
+
+    for (int i = 0; i < entry->length; i++)
+    {
+        uint32_t e;
+
+        for (e = 0; e < charmap->edgeCount; e++)
+        {
+            if (charmap->edges[e].parent == node && charmap->edges[e].unicode == entry->unicode[i])
+                break;
+        }
+        if (e == charmap->edgeCount)
+        {
+            charmap->nodes = checked_realloc(charmap->nodes, (charmap->nodeCount + 1) * sizeof(struct TrieNode));
+            memset(&charmap->nodes[charmap->nodeCount], 0, sizeof(struct TrieNode));
+            charmap->edges = checked_realloc(charmap->edges, (charmap->edgeCount + 1) * sizeof(struct TrieEdge));
+            charmap->edges[e].parent = node;
+            charmap->edges[e].unicode = entry->unicode[i];
+            charmap->edges[e].node = charmap->nodeCount;
+            charmap->nodeCount++;
+            charmap->edgeCount++;
+        }
+        node = charmap->edges[e].node;
+    }
+    return &charmap->nodes[node];
+}
+
+// Sorts the edges by node and character, and points each node at its edges
+static void trie_finish(struct Charmap *charmap)
+{
+    qsort(charmap->edges, charmap->edgeCount, sizeof(struct TrieEdge), trie_edge_cmp);
+    for (uint32_t e = charmap->edgeCount; e-- > 0;)
+    {
+        struct TrieNode *parent = &charmap->nodes[charmap->edges[e].parent];
+
+        parent->firstEdge = e;
+        parent->edgeCount++;
+    }
+}
+
+static void read_charmap(struct Charmap *charmap, const char *filename)
 {
     char *filedata = read_text_file(filename);
     char *line = filedata;
@@ -189,6 +317,7 @@ static void read_charmap(const char *filename)
         char *nextLine = line_split(line);
 
         struct CharmapEntry entry;
+        struct TrieNode *node;
 
         line = skip_whitespace(line);
         if (line[0] != 0 && line[0] != '#')  // ignore empty lines and comments
@@ -274,9 +403,11 @@ static void read_charmap(const char *filename)
                 line++;
             }
 
-            if (hashtable_query(charmap, &entry) != NULL)
+            node = trie_insert(charmap, &entry);
+            if (node->bytesCount != 0)
                 parse_error(filename, lineNum, "entry for character already exists");
-            hashtable_insert(charmap, &entry);
+            node->bytesCount = entry.bytesCount;
+            memcpy(node->bytes, entry.bytes, sizeof(node->bytes));
         }
 
         line = nextLine;
@@ -286,6 +417,144 @@ static void read_charmap(const char *filename)
     free(filedata);
 }
 
+static void put_u32(uint8_t *buf, uint32_t value)
+{
+    buf[0] = value;
+    buf[1] = value >> 8;
+    buf[2] = value >> 16;
+    buf[3] = value >> 24;
+}
+
+static uint32_t get_u32(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static void write_charmap(const struct Charmap *charmap, const char *filename)
+{
+    size_t size = 12 + charmap->nodeCount * CHARMAP_NODE_SIZE + charmap->edgeCount * CHARMAP_EDGE_SIZE;
+    uint8_t *data = calloc(size, 1);
+    uint8_t *pos = data;
+    FILE *file;
+
+    if (data == NULL)
+        fatal_error("could not allocate buffer of size %u", (uint32_t)size);
+
+    memcpy(pos, CHARMAP_MAGIC, 4);
+    put_u32(pos + 4, charmap->nodeCount);
+    put_u32(pos + 8, charmap->edgeCount);
+    pos += 12;
+    for (uint32_t i = 0; i < charmap->nodeCount; i++, pos += CHARMAP_NODE_SIZE)
+    {
+        put_u32(pos, charmap->nodes[i].firstEdge);
+        put_u32(pos + 4, charmap->nodes[i].edgeCount);
+        pos[8] = charmap->nodes[i].bytesCount;
+        pos[9] = charmap->nodes[i].bytes[0];
+        pos[10] = charmap->nodes[i].bytes[1];
+    }
+    for (uint32_t i = 0; i < charmap->edgeCount; i++, pos += CHARMAP_EDGE_SIZE)
+    {
+        put_u32(pos, charmap->edges[i].unicode);
+        put_u32(pos + 4, charmap->edges[i].node);
+    }
+
+    file = fopen(filename, "wb");
+    if (file == NULL)
+        fatal_error("failed to open file '%s' for writing: %s", filename, strerror(errno));
+    if (fwrite(data, size, 1, file) != 1)
+        fatal_error("error writing to file '%s': %s", filename, strerror(errno));
+    fclose(file);
+    free(data);
+}
+
+static void read_compiled_charmap(struct Charmap *charmap, const char *filename, const uint8_t *data, size_t size)
+{
+    const uint8_t *pos = data + 12;
+
+    charmap->nodeCount = get_u32(data + 4);
+    charmap->edgeCount = get_u32(data + 8);
+    if (charmap->nodeCount == 0 || charmap->edgeCount != charmap->nodeCount - 1
+     || size != 12 + (size_t)charmap->nodeCount * CHARMAP_NODE_SIZE + (size_t)charmap->edgeCount * CHARMAP_EDGE_SIZE)
+        fatal_error("compiled charmap '%s' is corrupt", filename);
+
+    charmap->nodes = checked_realloc(NULL, charmap->nodeCount * sizeof(struct TrieNode));
+    charmap->edges = checked_realloc(NULL, (charmap->edgeCount + 1) * sizeof(struct TrieEdge));
+    for (uint32_t i = 0; i < charmap->nodeCount; i++, pos += CHARMAP_NODE_SIZE)
+    {
+        struct TrieNode *node = &charmap->nodes[i];
+
+        node->firstEdge = get_u32(pos);
+        node->edgeCount = get_u32(pos + 4);
+        node->bytesCount = pos[8];
+        node->bytes[0] = pos[9];
+        node->bytes[1] = pos[10];
+        if (node->firstEdge > charmap->edgeCount || node->edgeCount > charmap->edgeCount - node->firstEdge
+         || node->bytesCount > ARRAY_COUNT(node->bytes))
+            fatal_error("compiled charmap '%s' is corrupt", filename);
+        for (uint32_t e = node->firstEdge; e < node->firstEdge + node->edgeCount; e++)
+            charmap->edges[e].parent = i;
+    }
+    for (uint32_t i = 0; i < charmap->edgeCount; i++, pos += CHARMAP_EDGE_SIZE)
+    {
+        charmap->edges[i].unicode = get_u32(pos);
+        charmap->edges[i].node = get_u32(pos + 4);
+        if (charmap->edges[i].node >= charmap->nodeCount)
+            fatal_error("compiled charmap '%s' is corrupt", filename);
+    }
+}
+
+// Loads a charmap, either as text or as compiled by "textconv -c"
+static struct Charmap *load_charmap(const char *filename)
+{
+    struct Charmap *charmap = calloc(1, sizeof(*charmap));
+    FILE *file = strcmp(filename, "-") != 0 ? fopen(filename, "rb") : NULL;
+    uint8_t *data = NULL;
+    size_t size = 0;
+
+    if (charmap == NULL)
+        fatal_error("could not allocate charmap");
+    charmap->filename = strdup(filename);
+
+    if (file != NULL)
+    {
+        uint8_t magic[4];
+
+        if (fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, CHARMAP_MAGIC, 4) == 0)
+        {
+            fseek(file, 0, SEEK_END);
+            size = ftell(file);
+            fseek(file, 0, SEEK_SET);
+            data = checked_realloc(NULL, size);
+            if (size < 12 || fread(data, size, 1, file) != 1)
+                fatal_error("compiled charmap '%s' is corrupt", filename);
+        }
+        fclose(file);
+    }
+
+    if (data != NULL)
+    {
+        read_compiled_charmap(charmap, filename, data, size);
+        free(data);
+    }
+    else
+    {
+        // the root node
+        charmap->nodes = calloc(1, sizeof(struct TrieNode));
+        charmap->nodeCount = 1;
+        read_charmap(charmap, filename);
+        trie_finish(charmap);
+    }
+    return charmap;
+}
+
+static void free_charmap(struct Charmap *charmap)
+{
+    free(charmap->filename);
+    free(charmap->nodes);
+    free(charmap->edges);
+    free(charmap);
+}
+
 static int count_line_num(const char *start, const char *pos)
 {
     const char *c;
@@ -299,7 +568,27 @@ static int count_line_num(const char *start, const char *pos)
     return lineNum;
 }
 
-static char *convert_string(char *pos, FILE *fout, const char *inputFileName, char *start, int uncompressed)
+static void output_write(struct OutputBuffer *out, const void *data, size_t size)
+{
+    if (out->size + size > out->capacity)
+    {
+        while (out->size + size > out->capacity)
+            out->capacity = out->capacity != 0 ? out->capacity * 2 : 0x10000;
+        out->data = checked_realloc(out->data, out->capacity);
+    }
+    memcpy(out->data + out->size, data, size);
+    out->size += size;
+}
+
+static void output_byte(struct OutputBuffer *out, uint8_t byte)
+{
+    static const char hexDigits[] = "0123456789ABCDEF";
+    char str[5] = { '0', 'x', hexDigits[byte >> 4], hexDigits[byte & 0xF], ',' };
+
+    output_write(out, str, sizeof(str));
+}
+
+static char *convert_string(const struct Charmap *charmap, char *pos, struct OutputBuffer *out, const char *inputFileName, char *start, int uncompressed)
 {
     int hasString = 0;
 
@@ -322,21 +611,19 @@ static char *convert_string(char *pos, FILE *fout, const char *inputFileName, ch
         // convert quoted string
         while (*pos != '"')
         {
-            struct CharmapEntry input;
-            struct CharmapEntry *last_valid_entry = NULL;
-            struct CharmapEntry *entry;
+            const struct TrieNode *node = &charmap->nodes[0];
+            const struct TrieNode *last_valid_entry = NULL;
             int i, c;
             int length = 0;
+            uint32_t first = 0;
             char* last_valid_pos = NULL;
 
-            // safely erase the unicode area before use
-            memset(input.unicode, 0, sizeof (input.unicode));
-            input.length = 0;
-
             // Find a charmap entry of longest length possible starting from this position
             while (*pos != '"')
             {
-                if ((uncompressed && length == 1) || length == ARRAY_COUNT(entry->unicode))
+                uint32_t unicode;
+
+                if ((uncompressed && length == 1) || length == CHARMAP_MAX_LENGTH)
                 {
                     // Stop searching after length 3; we only support strings of lengths up
                     // to that right now. Unless uncompressed is set, in which we ignore multi
@@ -352,48 +639,46 @@ static char *convert_string(char *pos, FILE *fout, const char *inputFileName, ch
                     c = get_escape_char(*pos);
                     if (c == 0)
                         parse_error(inputFileName, count_line_num(start, pos), "unknown escape sequence \\%c", *pos);
-                    input.unicode[length] = c;
+                    unicode = c;
                     pos++;
                 }
                 else
                 {
-                    pos = utf8_decode(pos, &input.unicode[length]);
+                    pos = utf8_decode(pos, &unicode);
                     if (pos == NULL)
                         parse_error(inputFileName, count_line_num(start, pos), "invalid unicode encountered in file");
                 }
+                if (length == 0)
+                    first = unicode;
                 length++;
-                input.length = length;
 
-                entry = hashtable_query(charmap, &input);
-                if (entry != NULL)
+                // no longer entry can match once the walk falls off the trie
+                node = trie_child(charmap, node, unicode);
+                if (node == NULL)
+                    break;
+                if (node->bytesCount != 0)
                 {
-                    last_valid_entry = entry;
+                    last_valid_entry = node;
                     last_valid_pos = pos;
                 }
             }
 
-            entry = last_valid_entry;
             pos = last_valid_pos;
-            if (entry == NULL)
-                parse_error(inputFileName, count_line_num(start, pos), "no charmap entry for U+%X", input.unicode[0]);
-            for (i = 0; i < entry->bytesCount; i++)
-                fprintf(fout, "0x%02X,", entry->bytes[i]);
+            if (last_valid_entry == NULL)
+                parse_error(inputFileName, count_line_num(start, pos), "no charmap entry for U+%X", first);
+            for (i = 0; i < last_valid_entry->bytesCount; i++)
+                output_byte(out, last_valid_entry->bytes[i]);
         }
         pos++;  // skip over closing '"'
     }
     pos++;  // skip over closing ')'
-    fputs("0xFF", fout);
+    output_write(out, "0xFF", 4);
     return pos;
 }
 
-static void convert_file(const char *infilename, const char *outfilename)
+static void convert_file(const struct Charmap *charmap, const char *infilename, struct OutputBuffer *out)
 {
     char *in = read_text_file(infilename);
-    FILE *fout = strcmp(outfilename, "-") != 0 ? fopen(outfilename, "wb") : stdout;
-
-    if (fout == NULL)
-        fatal_error("failed to open file '%s' for writing: %s", strerror(errno));
-
     char *start = in;
     char *end = in;
     char *pos = in;
@@ -461,8 +746,8 @@ static void convert_file(const char *infilename, const char *outfilename)
             if (*pos == '(')
             {
                 pos++;
-                fwrite(start, end - start, 1, fout);
-                pos = convert_string(pos, fout, infilename, in, uncompressed);
+                output_write(out, start, end - start);
+                pos = convert_string(charmap, pos, out, infilename, in, uncompressed);
                 start = pos;
             }
         }
@@ -473,52 +758,235 @@ static void convert_file(const char *infilename, const char *outfilename)
     }
 
   eof:
-    fwrite(start, pos - start, 1, fout);
-    if (strcmp(outfilename, "-") != 0)
-        fclose(fout);
+    output_write(out, start, pos - start);
     free(in);
 }
 
-static unsigned int charmap_hash(const void *value)
+static void write_output(const struct OutputBuffer *out, const char *filename)
 {
-    const struct CharmapEntry* entry = value;
-    unsigned int ret = 0;
-    for (int i = 0; i < entry->length; i++)
-        ret = ret * 17 + entry->unicode[i];
-    return ret;
+    FILE *file = strcmp(filename, "-") != 0 ? fopen(filename, "wb") : stdout;
+
+    if (file == NULL)
+        fatal_error("failed to open file '%s' for writing: %s", filename, strerror(errno));
+    if (out->size != 0 && fwrite(out->data, out->size, 1, file) != 1)
+        fatal_error("error writing to file '%s': %s", filename, strerror(errno));
+    if (file != stdout)
+        fclose(file);
 }
 
-static int charmap_cmp(const void *a, const void *b)
+// Returns whether the file already holds exactly the contents of out
+static int output_matches_file(const struct OutputBuffer *out, const char *filename)
 {
-    const struct CharmapEntry *ea = a;
-    const struct CharmapEntry *eb = b;
-    if (ea->length != eb->length)
+    FILE *file = fopen(filename, "rb");
+    char *data;
+    int matches = 0;
+
+    if (file == NULL)
         return 0;
-    for(int i = 0; i < ea->length; i++)
-        if(ea->unicode[i] != eb->unicode[i])
-            return 0;
-    return 1;
+    fseek(file, 0, SEEK_END);
+    if ((size_t)ftell(file) == out->size)
+    {
+        data = checked_realloc(NULL, out->size + 1);
+        fseek(file, 0, SEEK_SET);
+        matches = fread(data, 1, out->size, file) == out->size && memcmp(data, out->data, out->size) == 0;
+        free(data);
+    }
+    fclose(file);
+    return matches;
+}
+
+//---------------------------------------------------------
+// batch conversion
+//---------------------------------------------------------
+
+// Converts every file listed in a manifest with a pool of threads, so a build pays for one process and
+// one charmap parse instead of one per file. Each manifest line is "CHARMAP INPUT OUTPUT", '#' starts a comment.
+// An output is only written when its contents change, which leaves its timestamp alone otherwise.
+
+#define BATCH_PATH_MAX 1024
+
+struct BatchJob
+{
+    const struct Charmap *charmap;
+    char *input;
+    char *output;
+};
+
+struct BatchQueue
+{
+    struct BatchJob *jobs;
+    int count;
+    int next;
+    pthread_mutex_t lock;
+};
+
+static void *batch_worker(void *arg)
+{
+    struct BatchQueue *queue = arg;
+    struct OutputBuffer out = { NULL, 0, 0 };
+
+    for (;;)
+    {
+        struct BatchJob *job;
+        int index;
+
+        pthread_mutex_lock(&queue->lock);
+        index = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+
+        if (index >= queue->count)
+            break;
+        job = &queue->jobs[index];
+
+        out.size = 0;
+        convert_file(job->charmap, job->input, &out);
+        if (!output_matches_file(&out, job->output))
+            write_output(&out, job->output);
+    }
+    free(out.data);
+    return NULL;
+}
+
+// Reads the manifest, loading each distinct charmap once
+static int read_manifest(const char *filename, struct BatchJob **jobs, struct Charmap ***charmaps, int *charmapCount)
+{
+    FILE *file = fopen(filename, "r");
+    char line[3 * BATCH_PATH_MAX + 16];
+    int count = 0;
+    int lineNum = 0;
+
+    if (file == NULL)
+        fatal_error("failed to open file '%s' for reading: %s", filename, strerror(errno));
+
+    *jobs = NULL;
+    *charmaps = NULL;
+    *charmapCount = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        char charmapName[BATCH_PATH_MAX], input[BATCH_PATH_MAX], output[BATCH_PATH_MAX];
+        char *str = skip_whitespace(line);
+        struct BatchJob *job;
+        int i;
+
+        lineNum++;
+        if (*str == 0 || *str == '#')
+            continue;
+        if (sscanf(str, "%1023s %1023s %1023s", charmapName, input, output) != 3)
+            parse_error(filename, lineNum, "expected \"CHARMAP INPUT OUTPUT\"");
+
+        for (i = 0; i < *charmapCount; i++)
+        {
+            if (strcmp((*charmaps)[i]->filename, charmapName) == 0)
+                break;
+        }
+        if (i == *charmapCount)
+        {
+            *charmaps = checked_realloc(*charmaps, (i + 1) * sizeof(struct Charmap *));
+            (*charmaps)[i] = load_charmap(charmapName);
+            (*charmapCount)++;
+        }
+
+        *jobs = checked_realloc(*jobs, (count + 1) * sizeof(struct BatchJob));
+        job = &(*jobs)[count++];
+        job->charmap = (*charmaps)[i];
+        job->input = strdup(input);
+        job->output = strdup(output);
+    }
+    fclose(file);
+    return count;
+}
+
+static int default_job_count(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0)
+        return cpus;
+#endif
+    return 4;
+}
+
+static void batch_convert(const char *manifest, int numThreads)
+{
+    struct BatchQueue queue;
+    struct Charmap **charmaps;
+    int charmapCount;
+    pthread_t *threads;
+
+    queue.count = read_manifest(manifest, &queue.jobs, &charmaps, &charmapCount);
+    queue.next = 0;
+    pthread_mutex_init(&queue.lock, NULL);
+
+    if (numThreads <= 0)
+        numThreads = default_job_count();
+    if (numThreads > queue.count)
+        numThreads = queue.count;
+    threads = malloc(numThreads * sizeof(pthread_t));
+    for (int i = 0; i < numThreads; i++)
+        pthread_create(&threads[i], NULL, batch_worker, &queue);
+    for (int i = 0; i < numThreads; i++)
+        pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&queue.lock);
+    free(threads);
+
+    for (int i = 0; i < queue.count; i++)
+    {
+        free(queue.jobs[i].input);
+        free(queue.jobs[i].output);
+    }
+    free(queue.jobs);
+    for (int i = 0; i < charmapCount; i++)
+        free_charmap(charmaps[i]);
+    free(charmaps);
 }
 
 static void usage(const char *execName)
 {
-    fprintf(stderr, "Usage: %s CHARMAP INPUT OUTPUT\n", execName);
+    fprintf(stderr, "Usage: %s CHARMAP INPUT OUTPUT\n"
+                    "       %s -c CHARMAP OUTPUT       compile CHARMAP for faster loading\n"
+                    "       %s -m MANIFEST [-j JOBS]   convert every \"CHARMAP INPUT OUTPUT\" line of MANIFEST\n"
+                    "CHARMAP may be a text or a compiled charmap.\n", execName, execName, execName);
 }
 
 int main(int argc, char **argv)
 {
-    if (argc != 4)
+    if (argc == 4 && strcmp(argv[1], "-c") == 0)
     {
-        usage(argv[0]);
-        return 1;
-    }
+        struct Charmap *charmap = load_charmap(argv[2]);
 
-    charmap = hashtable_new(charmap_hash, charmap_cmp, 256, sizeof(struct CharmapEntry));
+        write_charmap(charmap, argv[3]);
+        free_charmap(charmap);
+    }
+    else if ((argc == 3 || argc == 5) && strcmp(argv[1], "-m") == 0)
+    {
+        int numThreads = 0;
 
-    read_charmap(argv[1]);
-    convert_file(argv[2], argv[3]);
+        if (argc == 5)
+        {
+            if (strcmp(argv[3], "-j") != 0)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            numThreads = atoi(argv[4]);
+        }
+        batch_convert(argv[2], numThreads);
+    }
+    else if (argc == 4)
+    {
+        struct Charmap *charmap = load_charmap(argv[1]);
+        struct OutputBuffer out = { NULL, 0, 0 };
 
-    hashtable_free(charmap);
+        convert_file(charmap, argv[2], &out);
+        write_output(&out, argv[3]);
+        free(out.data);
+        free_charmap(charmap);
+    }
+    else
+    {
+        usage(argv[0]);
+        return 1;
+    }
 
     return 0;
 }